@@ -28,6 +28,7 @@
 #include "error_handler/error_handler.h"
 
 #include <common/manikin_bit_manipulation.h>
+#include <common/manikin_time.h>
 
 #define HASH_ADS7138 0x157F34F4u
 
@@ -64,6 +65,283 @@ ads7138_check_params (const manikin_sensor_ctx_t *sensor_ctx)
     return MANIKIN_STATUS_OK;
 }
 
+/**
+ * @brief Write a table of registers, stops at the first failing write
+ */
+static manikin_status_t
+ads7138_write_regs (manikin_sensor_ctx_t *sensor_ctx, const manikin_sensor_reg_t *regs, size_t cnt)
+{
+    for (size_t i = 0; i < cnt; i++)
+    {
+        const manikin_status_t status
+            = manikin_i2c_write_reg(sensor_ctx->i2c,
+                                    sensor_ctx->i2c_addr,
+                                    regs[i].reg,
+                                    GET_LOWER_8_BITS_OF_SHORT(regs[i].val));
+        MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+static uint8_t
+ads7138_config_valid (const ads7138_config_t *config)
+{
+    if (config->osr > ADS7138_OSR_128 || config->clk_div > ADS7138_REG_CLK_DIV_MASK)
+    {
+        return 0;
+    }
+    if (config->wake_channels == 0)
+    {
+        return 1;
+    }
+    if (config->idle_clk_div > ADS7138_REG_CLK_DIV_MASK
+        || config->alert_logic > ADS7138_ALERT_PULSED_HIGH)
+    {
+        return 0;
+    }
+    for (uint8_t ch = 0; ch < ADS7138_NUMBER_OF_CHANNELS; ch++)
+    {
+        const ads7138_window_t *window = &config->window[ch];
+        if (BIT_IS_SET(config->wake_channels, ch)
+            && (window->high_threshold > ADS7138_THRESHOLD_MAX
+                || window->low_threshold > window->high_threshold
+                || window->hysteresis > ADS7138_HYSTERESIS_MAX
+                || window->event_count > ADS7138_EVENT_COUNT_MAX))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint8_t
+ads7138_opmode (const ads7138_config_t *config, uint8_t clk_div)
+{
+    return (uint8_t)(ADS7138_REG_CONV_MODE_AUTONOMOUS
+                     | (config->low_power_osc ? ADS7138_REG_OSC_SEL_LOW_POWER : 0u)
+                     | (clk_div & ADS7138_REG_CLK_DIV_MASK));
+}
+
+/**
+ * @brief Change the conversion rate, the sequence is stopped while OPMODE_CFG is written
+ */
+static manikin_status_t
+ads7138_set_rate (manikin_sensor_ctx_t *sensor_ctx, const ads7138_config_t *config, uint8_t clk_div)
+{
+    const manikin_sensor_reg_t rate_regs[] = {
+        { ADS7138_REG(ADS7138_REG_SEQUENCE_CFG, ADS7138_OP_CLEAR_BIT),
+          ADS7138_REG_SEQ_START_BIT,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_OPMODE_CFG, ADS7138_OP_SINGLE_WRITE),
+          ads7138_opmode(config, clk_div),
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_SEQUENCE_CFG, ADS7138_OP_SET_BIT),
+          ADS7138_REG_SEQ_START_BIT,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+    };
+    return ads7138_write_regs(sensor_ctx, rate_regs, sizeof(rate_regs) / sizeof(rate_regs[0]));
+}
+
+static manikin_status_t
+ads7138_clear_events (manikin_sensor_ctx_t *sensor_ctx)
+{
+    // NOTE: The flags are write-1-to-clear
+    static const manikin_sensor_reg_t clear_regs[] = {
+        { ADS7138_REG(ADS7138_REG_EVENT_HIGH_FLAG, ADS7138_OP_SINGLE_WRITE),
+          ADS7138_REG_EVENT_FLAGS_CLEAR_ALL,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_EVENT_LOW_FLAG, ADS7138_OP_SINGLE_WRITE),
+          ADS7138_REG_EVENT_FLAGS_CLEAR_ALL,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+    };
+    return ads7138_write_regs(sensor_ctx, clear_regs, sizeof(clear_regs) / sizeof(clear_regs[0]));
+}
+
+/**
+ * @brief Program the window comparators of the wake channels and route them to ALERT
+ */
+static manikin_status_t
+ads7138_setup_wake (manikin_sensor_ctx_t *sensor_ctx, const ads7138_config_t *config)
+{
+    manikin_status_t status;
+    for (uint8_t ch = 0; ch < ADS7138_NUMBER_OF_CHANNELS; ch++)
+    {
+        if (!BIT_IS_SET(config->wake_channels, ch))
+        {
+            continue;
+        }
+        // NOTE: The 4 LSBs of both 12-bit thresholds share a register with hysteresis/count
+        const ads7138_window_t *window = &config->window[ch];
+        const uint8_t           reg    = (uint8_t)(ch * ADS7138_REG_WINDOW_CH_STRIDE);
+        const manikin_sensor_reg_t window_regs[] = {
+            { ADS7138_REG(ADS7138_REG_HYSTERESIS_CH0 + reg, ADS7138_OP_SINGLE_WRITE),
+              (uint16_t)(((window->high_threshold & ADS7138_REG_NIBBLE_MASK)
+                          << ADS7138_REG_THRESHOLD_LSB_SHIFT)
+                         | window->hysteresis),
+              MANIKIN_SENSOR_REG_TYPE_WRITE },
+            { ADS7138_REG(ADS7138_REG_HIGH_TH_CH0 + reg, ADS7138_OP_SINGLE_WRITE),
+              (uint16_t)(window->high_threshold >> ADS7138_REG_THRESHOLD_LSB_SHIFT),
+              MANIKIN_SENSOR_REG_TYPE_WRITE },
+            { ADS7138_REG(ADS7138_REG_EVENT_COUNT_CH0 + reg, ADS7138_OP_SINGLE_WRITE),
+              (uint16_t)(((window->low_threshold & ADS7138_REG_NIBBLE_MASK)
+                          << ADS7138_REG_THRESHOLD_LSB_SHIFT)
+                         | window->event_count),
+              MANIKIN_SENSOR_REG_TYPE_WRITE },
+            { ADS7138_REG(ADS7138_REG_LOW_TH_CH0 + reg, ADS7138_OP_SINGLE_WRITE),
+              (uint16_t)(window->low_threshold >> ADS7138_REG_THRESHOLD_LSB_SHIFT),
+              MANIKIN_SENSOR_REG_TYPE_WRITE },
+        };
+        status = ads7138_write_regs(
+            sensor_ctx, window_regs, sizeof(window_regs) / sizeof(window_regs[0]));
+        MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    }
+    const manikin_sensor_reg_t alert_regs[] = {
+        { ADS7138_REG(ADS7138_REG_ALERT_CH_SEL, ADS7138_OP_SINGLE_WRITE),
+          config->wake_channels,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_ALERT_PIN_CFG, ADS7138_OP_SINGLE_WRITE),
+          (uint16_t)((config->alert_push_pull ? ADS7138_REG_ALERT_DRIVE_PUSH_PULL : 0u)
+                     | config->alert_logic),
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_GEN_CFG, ADS7138_OP_SET_BIT),
+          ADS7138_REG_DWC_EN_BIT,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+    };
+    status = ads7138_write_regs(sensor_ctx, alert_regs, sizeof(alert_regs) / sizeof(alert_regs[0]));
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    return ads7138_clear_events(sensor_ctx);
+}
+
+/**
+ * @brief Enable averaging and start the sequence, the ADC keeps converting from then on
+ */
+static manikin_status_t
+ads7138_start_autonomous (manikin_sensor_ctx_t *sensor_ctx, ads7138_config_t *config)
+{
+    manikin_status_t status;
+    config->active        = 0;
+    config->idle_calls    = 0;
+    config->quiet_samples = 0;
+    if (config->wake_channels != 0)
+    {
+        status = ads7138_setup_wake(sensor_ctx, config);
+        MANIKIN_ASSERT(
+            HASH_ADS7138, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    }
+    const uint8_t clk_div = (config->wake_channels != 0) ? config->idle_clk_div : config->clk_div;
+    const manikin_sensor_reg_t mode_regs[] = {
+        // Statistics module keeps the RECENT registers up to date
+        { ADS7138_REG(ADS7138_REG_GEN_CFG, ADS7138_OP_SET_BIT),
+          ADS7138_REG_STATS_EN_BIT,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_OSR_CFG, ADS7138_OP_SINGLE_WRITE),
+          config->osr,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_OPMODE_CFG, ADS7138_OP_SINGLE_WRITE),
+          ads7138_opmode(config, clk_div),
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { ADS7138_REG(ADS7138_REG_SEQUENCE_CFG, ADS7138_OP_SET_BIT),
+          ADS7138_REG_SEQ_START_BIT,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+    };
+    status = ads7138_write_regs(sensor_ctx, mode_regs, sizeof(mode_regs) / sizeof(mode_regs[0]));
+    MANIKIN_ASSERT(
+        HASH_ADS7138, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Fetch the latest result of every channel in one continuous read
+ */
+static manikin_status_t
+ads7138_read_autonomous (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
+{
+    uint8_t raw_buf[ADS7138_RECENT_BUF_SIZE];
+    manikin_sample_stamp(sensor_ctx);
+    const manikin_status_t status
+        = manikin_i2c_read_regs(sensor_ctx->i2c,
+                                sensor_ctx->i2c_addr,
+                                ADS7138_REG(ADS7138_REG_RECENT_CH0_LSB, ADS7138_OP_CONTINUOUS_READ),
+                                raw_buf,
+                                ADS7138_RECENT_BUF_SIZE);
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+
+    // NOTE: RECENT registers are LSB first, the (averaged) result is left-aligned in 16 bits
+    for (uint8_t i = 0; i < ADS7138_NUMBER_OF_CHANNELS; i++)
+    {
+        const uint16_t val  = TRUNCATE_TO_12B_VAL(raw_buf[2 * i + 1], raw_buf[2 * i]);
+        read_buf[2 * i]     = GET_UPPER_8_BITS_OF_SHORT(val);
+        read_buf[2 * i + 1] = GET_LOWER_8_BITS_OF_SHORT(val);
+    }
+    manikin_sample_complete(sensor_ctx);
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Check whether all wake channels of the sample are inside their window
+ */
+static uint8_t
+ads7138_sample_quiet (const ads7138_config_t *config, const uint8_t *read_buf)
+{
+    for (uint8_t ch = 0; ch < ADS7138_NUMBER_OF_CHANNELS; ch++)
+    {
+        const uint16_t val = CONSTRUCT_SHORT_FROM_BYTES(read_buf[2 * ch], read_buf[2 * ch + 1]);
+        if (BIT_IS_SET(config->wake_channels, ch)
+            && (val > config->window[ch].high_threshold || val < config->window[ch].low_threshold))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Poll the event flags at a low rate while idle, sample at full rate after an event
+ */
+static manikin_status_t
+ads7138_read_wake (manikin_sensor_ctx_t *sensor_ctx, ads7138_config_t *config, uint8_t *read_buf)
+{
+    manikin_status_t status;
+    if (!config->active)
+    {
+        // NOTE: With drdy_irq this call was triggered by the ALERT pin, so the flags are polled
+        config->idle_calls++;
+        if (!sensor_ctx->drdy_irq && config->idle_calls < config->idle_divider)
+        {
+            return MANIKIN_STATUS_OK;
+        }
+        config->idle_calls = 0;
+        uint8_t events;
+        status = ads7138_read_events(sensor_ctx, &events);
+        MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+        if ((events & config->wake_channels) == 0)
+        {
+            return MANIKIN_STATUS_OK;
+        }
+        status = ads7138_set_rate(sensor_ctx, config, config->clk_div);
+        MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+        config->active        = 1;
+        config->quiet_samples = 0;
+    }
+
+    status = ads7138_read_autonomous(sensor_ctx, read_buf);
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    if (!ads7138_sample_quiet(config, read_buf))
+    {
+        config->quiet_samples = 0;
+        return MANIKIN_STATUS_OK;
+    }
+    if (++config->quiet_samples < config->idle_hold_samples)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+    // NOTE: Events of the active period are stale, clear them before idling
+    config->active = 0;
+    status         = ads7138_set_rate(sensor_ctx, config, config->idle_clk_div);
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    return ads7138_clear_events(sensor_ctx);
+}
+
 manikin_status_t
 ads7138_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
 {
@@ -73,6 +351,11 @@ ads7138_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
     // NOTE: needs_reinit is internal variable, which might be uninitialized when entered as param.
     sensor_ctx->needs_reinit = 0;
 
+    ads7138_config_t *config = (ads7138_config_t *)sensor_ctx->driver_ctx;
+    MANIKIN_ASSERT(HASH_ADS7138,
+                   config == NULL || ads7138_config_valid(config),
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+
     uint8_t data;
     status = manikin_i2c_read_reg(sensor_ctx->i2c,
                                   sensor_ctx->i2c_addr,
@@ -92,6 +375,10 @@ ads7138_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
                               ads7138_init_regs[i].reg,
                               GET_LOWER_8_BITS_OF_SHORT(ads7138_init_regs[i].val));
     }
+    if (config != NULL)
+    {
+        return ads7138_start_autonomous(sensor_ctx, config);
+    }
     return MANIKIN_STATUS_OK;
 }
 
@@ -107,6 +394,18 @@ ads7138_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
         ads7138_init_sensor(sensor_ctx);
     }
 
+    ads7138_config_t *config = (ads7138_config_t *)sensor_ctx->driver_ctx;
+    if (config != NULL && config->wake_channels != 0)
+    {
+        return ads7138_read_wake(sensor_ctx, config, read_buf);
+    }
+    if (config != NULL)
+    {
+        return ads7138_read_autonomous(sensor_ctx, read_buf);
+    }
+
+    // NOTE: The conversions start with the sequence, so that is the acquisition time
+    manikin_sample_stamp(sensor_ctx);
     status = manikin_i2c_write_reg(sensor_ctx->i2c,
                                    sensor_ctx->i2c_addr,
                                    ADS7138_REG(ADS7138_REG_SEQUENCE_CFG, ADS7138_OP_SET_BIT),
@@ -129,9 +428,27 @@ ads7138_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
         read_buf[2 * i]     = GET_UPPER_8_BITS_OF_SHORT(val);
         read_buf[2 * i + 1] = GET_LOWER_8_BITS_OF_SHORT(val);
     }
+    if (status == MANIKIN_STATUS_OK)
+    {
+        manikin_sample_complete(sensor_ctx);
+    }
     return status;
 }
 
+manikin_status_t
+ads7138_read_events (manikin_sensor_ctx_t *sensor_ctx, uint8_t *events)
+{
+    MANIKIN_ASSERT(HASH_ADS7138, (events != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_status_t status = ads7138_check_params(sensor_ctx);
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    status = manikin_i2c_read_reg(sensor_ctx->i2c,
+                                  sensor_ctx->i2c_addr,
+                                  ADS7138_REG(ADS7138_REG_EVENT_FLAG, ADS7138_OP_SINGLE_READ),
+                                  events);
+    MANIKIN_ASSERT(HASH_ADS7138, (status == MANIKIN_STATUS_OK), status);
+    return ads7138_clear_events(sensor_ctx);
+}
+
 manikin_status_t
 ads7138_deinit_sensor (manikin_sensor_ctx_t *sensor_ctx)
 {
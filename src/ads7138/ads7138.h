@@ -30,6 +30,103 @@ extern "C"
 #endif
 #include "common/manikin_types.h"
 
+/**
+ * @brief I2C traffic of one ads7138_read_sensor() call, used by bus_planner:
+ *        sequence start write (3), 16-byte channel read, sequence stop write (3)
+ */
+#define ADS7138_READ_TRANSACTIONS 3u
+#define ADS7138_READ_BYTES        22u
+
+/**
+ * @brief I2C traffic of one ads7138_read_sensor() call in autonomous mode, used by bus_planner:
+ *        continuous read of the 16 RECENT registers (2 + 16)
+ */
+#define ADS7138_AUTO_READ_TRANSACTIONS 2u
+#define ADS7138_AUTO_READ_BYTES        18u
+
+/**
+ * @brief I2C traffic of one ads7138_read_sensor() call in wake mode while idle, used by
+ *        bus_planner: event flag read (2 + 1). Only every idle_divider-th call polls the flags,
+ *        once an event fired the reads are the same as in autonomous mode.
+ */
+#define ADS7138_IDLE_READ_TRANSACTIONS 2u
+#define ADS7138_IDLE_READ_BYTES        3u
+
+#define ADS7138_CHANNEL_COUNT     8u
+#define ADS7138_THRESHOLD_MAX     0x0FFFu
+#define ADS7138_HYSTERESIS_MAX    0x0Fu
+#define ADS7138_EVENT_COUNT_MAX   0x0Fu
+
+    /**
+     * @brief Number of conversions averaged into each result, OSR_CFG register
+     */
+    typedef enum
+    {
+        ADS7138_OSR_1 = 0,
+        ADS7138_OSR_2,
+        ADS7138_OSR_4,
+        ADS7138_OSR_8,
+        ADS7138_OSR_16,
+        ADS7138_OSR_32,
+        ADS7138_OSR_64,
+        ADS7138_OSR_128,
+    } ads7138_osr_t;
+
+    /**
+     * @brief Behaviour of the ALERT pin, ALERT_PIN_CFG register
+     */
+    typedef enum
+    {
+        ADS7138_ALERT_ACTIVE_LOW = 0,
+        ADS7138_ALERT_ACTIVE_HIGH,
+        ADS7138_ALERT_PULSED_LOW,
+        ADS7138_ALERT_PULSED_HIGH,
+    } ads7138_alert_logic_t;
+
+    /**
+     * @brief Digital window comparator settings of one channel
+     *        An event fires when event_count + 1 consecutive results are above high_threshold
+     *        or below low_threshold, both 12-bit codes.
+     */
+    typedef struct
+    {
+        uint16_t high_threshold; /* At most ADS7138_THRESHOLD_MAX */
+        uint16_t low_threshold;  /* At most high_threshold */
+        uint8_t  hysteresis;     /* HYSTERESIS_CHx, at most ADS7138_HYSTERESIS_MAX */
+        uint8_t  event_count;    /* EVENT_COUNT_CHx, at most ADS7138_EVENT_COUNT_MAX */
+    } ads7138_window_t;
+
+    /**
+     * @brief Autonomous mode settings, point sensor_ctx->driver_ctx at it before init.
+     *        The ADC then converts the channel sequence continuously with on-chip averaging and
+     *        a read only fetches the most recent result of every channel, instead of starting
+     *        and stopping a sequence for each sample.
+     *
+     *        With wake_channels set the driver starts idle: the ADC converts at idle_clk_div and
+     *        a read only polls the event flags, every idle_divider-th call (every call with
+     *        drdy_irq set, the ALERT pin then triggers the reads). Reads without an event
+     *        return MANIKIN_STATUS_OK without writing a sample. Once a window comparator fires
+     *        the ADC switches to clk_div and every read returns a sample, until all wake
+     *        channels stayed inside their window for idle_hold_samples reads.
+     */
+    typedef struct
+    {
+        uint8_t          osr;           /* ads7138_osr_t */
+        uint8_t          clk_div;       /* OPMODE_CFG CLK_DIV (0-15), sets the conversion rate */
+        uint8_t          low_power_osc; /* Use the low-power oscillator, lowers the rate */
+        uint8_t          wake_channels; /* Bitmask of channels which end idle, 0 disables wake */
+        /* Window comparator of each wake channel, indexed by channel */
+        ads7138_window_t window[ADS7138_CHANNEL_COUNT];
+        uint8_t          alert_logic;       /* ads7138_alert_logic_t */
+        uint8_t          alert_push_pull;   /* Drive ALERT push-pull instead of open-drain */
+        uint8_t          idle_clk_div;      /* CLK_DIV while idle, usually slower than clk_div */
+        uint8_t          idle_divider;      /* Calls per event flag poll while idle, 0 is 1 */
+        uint16_t         idle_hold_samples; /* Quiet samples before returning to idle */
+        uint8_t          active;            /* Driver state: set from event until idle again */
+        uint8_t          idle_calls;        /* Driver state: calls since the last poll */
+        uint16_t         quiet_samples;     /* Driver state: consecutive samples inside windows */
+    } ads7138_config_t;
+
     /**
      * @brief This struct contains the structure of samples for ADS7138 ADC
      *        Which consists of 8-channels with the value in millivolt
@@ -47,18 +144,22 @@ extern "C"
     } ads7138_sample_data_t;
 
     /**
-     * @brief Initialize the sensor, which disables continuous sampling mode.
+     * @brief Initialize the sensor, which disables continuous sampling mode. With a
+     *        ads7138_config_t in sensor_ctx->driver_ctx autonomous conversion is started.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
      *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL on unable to set registers (due to lost
      *          connection, e.g.)
      *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on an out of range setting in the config
      */
     manikin_status_t ads7138_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
      * @brief Read the sensor, which should read 16-bytes of data (8-channels, 2 bytes each)
+     *        In autonomous mode these are the latest averaged results, truncated to 12 bits.
+     *        In wake mode nothing is written while idle, see ads7138_config_t.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @param read_buf Ptr to read-buffer which is used for storing the samples
@@ -68,6 +169,17 @@ extern "C"
      */
     manikin_status_t ads7138_read_sensor(manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf);
 
+    /**
+     * @brief Read and clear the window comparator event flags, e.g. after the ALERT pin fired
+     * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
+     * address
+     * @param events Ptr which receives the bitmask of channels with an event
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle or events ptr,
+     *         MANIKIN_STATUS_ERR_READ_FAIL or MANIKIN_STATUS_ERR_WRITE_FAIL on bus failure
+     */
+    manikin_status_t ads7138_read_events(manikin_sensor_ctx_t *sensor_ctx, uint8_t *events);
+
     /**
      * @brief Deinitialize the sensor, which disables continuous sampling mode.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
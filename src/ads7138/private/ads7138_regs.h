@@ -28,14 +28,28 @@
 extern "C"
 {
 #endif
-#define ADS7138_REG(reg, opcode)    (reg | opcode << 8u)
+#define ADS7138_REG(reg, opcode)    ((reg) | (opcode) << 8u)
 #define ADS7138_READ_BUF_SIZE       16u // 2 bytes per channel, 8 channels
 #define ADS7138_NUMBER_OF_CHANNELS  8u
 #define ADS7138_REG_SYSTEM_STATUS   0x00u
 #define ADS7138_REG_GEN_CFG         0x01u
+#define ADS7138_REG_OSR_CFG         0x03u
+#define ADS7138_REG_OPMODE_CFG      0x04u
 #define ADS7138_REG_PIN_CFG         0x05u
 #define ADS7138_REG_SEQUENCE_CFG    0x10u
 #define ADS7138_REG_AUTO_SEQ_CH_SEL 0x12u
+#define ADS7138_REG_ALERT_CH_SEL    0x14u
+#define ADS7138_REG_ALERT_PIN_CFG   0x17u
+#define ADS7138_REG_EVENT_FLAG      0x18u
+#define ADS7138_REG_EVENT_HIGH_FLAG 0x1Au
+#define ADS7138_REG_EVENT_LOW_FLAG  0x1Cu
+#define ADS7138_REG_HYSTERESIS_CH0  0x20u
+#define ADS7138_REG_HIGH_TH_CH0     0x21u
+#define ADS7138_REG_EVENT_COUNT_CH0 0x22u
+#define ADS7138_REG_LOW_TH_CH0      0x23u
+#define ADS7138_REG_RECENT_CH0_LSB  0xA0u
+
+#define ADS7138_REG_WINDOW_CH_STRIDE 4u // Four window comparator registers per channel
 
 #define ADS7138_REG_ALL_PINS_ANALOG_INP_BIT 0x00u
 #define ADS7138_REG_CAL_BIT                 0x02u
@@ -44,9 +58,21 @@ extern "C"
 #define ADS7138_REG_SEQ_START_BIT           (1 << 4u)
 #define ADS7138_REG_ENABLE_AUTO_SEQ         0x01u
 #define ADS7138_REG_SYSTEM_STATUS_RSVD_BIT  (7u)
+#define ADS7138_REG_STATS_EN_BIT            (1u << 5u)
+#define ADS7138_REG_CONV_MODE_AUTONOMOUS    (1u << 5u)
+#define ADS7138_REG_OSC_SEL_LOW_POWER       (1u << 4u)
+#define ADS7138_REG_CLK_DIV_MASK            0x0Fu
+#define ADS7138_REG_OSR_MASK                0x07u
+#define ADS7138_REG_DWC_EN_BIT              (1u << 4u)
+#define ADS7138_REG_ALERT_DRIVE_PUSH_PULL   (1u << 2u)
+#define ADS7138_REG_EVENT_FLAGS_CLEAR_ALL   0xFFu
+#define ADS7138_REG_THRESHOLD_LSB_SHIFT     4u
+#define ADS7138_REG_NIBBLE_MASK             0x0Fu
+
+#define ADS7138_RECENT_BUF_SIZE 16u // LSB then MSB per channel, 8 channels
 
 #define ADS7138_OP_SINGLE_READ      0x10u
-#define ADS7138_OP_SINGLE_WRITE     0x10u
+#define ADS7138_OP_SINGLE_WRITE     0x08u
 #define ADS7138_OP_SET_BIT          0x18u
 #define ADS7138_OP_CLEAR_BIT        0x20u
 #define ADS7138_OP_CONTINUOUS_READ  0x30u
@@ -12,6 +12,7 @@
 
 #include <bhi360_fusion/bhi360_fusion.h>
 #include "i2c/i2c.h"
+#include "common/manikin_time.h"
 #include "error_handler/error_handler.h"
 #include "bhy.h"
 #include "bhy_virtual_sensor_conf_param.h"
@@ -20,7 +21,9 @@
 #include "external/bhy.h"
 #include "external/bhy_defs.h"
 #include "external/bhi3_defs.h"
+#if BHI360_FUSION_EMBEDDED_FW
 #include "firmware/BHI360.fw.h"
+#endif
 
 #include <inttypes.h>
 #ifdef DEBUG
@@ -48,6 +51,7 @@
 #define DEFAULT_SENSOR_LATENCY 0
 
 static uint8_t        write_buf[1024];
+static uint8_t        fw_chunk[2][BHI360_FUSION_FW_CHUNK_SIZE];
 static uint8_t        work_buffer[WORK_BUFFER_SIZE];
 static struct bhy_dev bhy;
 static enum bhy_intf  intf;
@@ -166,13 +170,95 @@ bhi360_delay (uint32_t period, void *intf_ptr)
     MANIKIN_DELAY_US(period);
 }
 
-static void
-upload_firmware (uint8_t boot_stat, struct bhy_dev *dev)
+static manikin_status_t
+bhi360_check_fw_source (const bhi360_fusion_fw_source_t *source)
+{
+#if !BHI360_FUSION_EMBEDDED_FW
+    MANIKIN_ASSERT(HASH_BHI360, source != NULL, MANIKIN_STATUS_ERR_INVALID_CONFIG);
+#endif
+    if (source == NULL)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+    MANIKIN_ASSERT(HASH_BHI360, source->read_start != NULL, MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    MANIKIN_ASSERT(HASH_BHI360,
+                   source->size != 0 && (source->size % 4u) == 0,
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    return MANIKIN_STATUS_OK;
+}
+
+static uint32_t
+bhi360_fw_chunk_len (uint32_t remaining)
+{
+    return (remaining > BHI360_FUSION_FW_CHUNK_SIZE) ? BHI360_FUSION_FW_CHUNK_SIZE : remaining;
+}
+
+static manikin_status_t
+bhi360_fw_read_wait (const bhi360_fusion_fw_source_t *source)
+{
+    return (source->read_wait != NULL) ? source->read_wait(source->user) : MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Upload the image chunk by chunk, the read of chunk n + 1 runs while chunk n is written
+ */
+static manikin_status_t
+upload_firmware_streamed (const bhi360_fusion_fw_source_t *source, struct bhy_dev *dev)
+{
+    uint8_t          cur    = 0;
+    uint32_t         len    = bhi360_fw_chunk_len(source->size);
+    manikin_status_t status = source->read_start(source->user, fw_chunk[cur], 0, len);
+    if (status == MANIKIN_STATUS_OK)
+    {
+        status = bhi360_fw_read_wait(source);
+    }
+
+    uint32_t pos = 0;
+    while (pos < source->size && status == MANIKIN_STATUS_OK)
+    {
+        const uint32_t next_pos = pos + len;
+        const uint32_t next_len = bhi360_fw_chunk_len(source->size - next_pos);
+        if (next_len != 0)
+        {
+            status = source->read_start(source->user, fw_chunk[cur ^ 1u], next_pos, next_len);
+        }
+        const int8_t rslt
+            = bhy_upload_firmware_to_ram_partly(fw_chunk[cur], source->size, pos, len, dev);
+        // NOTE: Wait for a started read even on errors, the reader may still fill the buffer
+        if (next_len != 0 && status == MANIKIN_STATUS_OK)
+        {
+            status = bhi360_fw_read_wait(source);
+        }
+        if (rslt != BHY_OK)
+        {
+            LOG_DEBUG("%s\r\n", get_api_error(rslt));
+            status = MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+        }
+        cur ^= 1u;
+        pos = next_pos;
+        len = next_len;
+    }
+    return status;
+}
+
+static manikin_status_t
+upload_firmware (const bhi360_fusion_fw_source_t *source, struct bhy_dev *dev)
 {
-    (void)boot_stat;
     LOG_DEBUG("Loading firmware into RAM.\r\n");
 
-    int8_t  rslt = bhy_upload_firmware_to_ram(bhy_firmware_image, sizeof(bhy_firmware_image), dev);
+    int8_t rslt = BHY_OK;
+    if (source != NULL)
+    {
+        MANIKIN_ASSERT(HASH_BHI360,
+                       upload_firmware_streamed(source, dev) == MANIKIN_STATUS_OK,
+                       MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    }
+#if BHI360_FUSION_EMBEDDED_FW
+    else
+    {
+        rslt = bhy_upload_firmware_to_ram(bhy_firmware_image, sizeof(bhy_firmware_image), dev);
+    }
+#endif
     uint8_t sensor_error;
     int8_t  temp_rslt = bhy_get_error_value(&sensor_error, dev);
     print_api_error(rslt, dev);
@@ -183,6 +269,7 @@ upload_firmware (uint8_t boot_stat, struct bhy_dev *dev)
     temp_rslt = bhy_get_error_value(&sensor_error, dev);
     print_api_error(rslt, dev);
     print_api_error(temp_rslt, dev);
+    return MANIKIN_STATUS_OK;
 }
 
 static void
@@ -252,6 +339,11 @@ bhi360_fusion_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
     MANIKIN_ASSERT(HASH_BHI360,
                    bhi360_check_params(sensor_ctx) == MANIKIN_STATUS_OK,
                    MANIKIN_STATUS_ERR_NULL_PARAM);
+    const bhi360_fusion_fw_source_t *source
+        = (const bhi360_fusion_fw_source_t *)sensor_ctx->driver_ctx;
+    MANIKIN_ASSERT(HASH_BHI360,
+                   bhi360_check_fw_source(source) == MANIKIN_STATUS_OK,
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
     sensor_ctx->needs_reinit = 0;
     intf                     = BHY_I2C_INTERFACE;
 
@@ -292,7 +384,9 @@ bhi360_fusion_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
         return 1;
     }
 
-    upload_firmware(boot_status, &bhy);
+    MANIKIN_ASSERT(HASH_BHI360,
+                   upload_firmware(source, &bhy) == MANIKIN_STATUS_OK,
+                   MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
 
     uint16_t version;
     rslt = bhy_get_kernel_version(&version, &bhy);
@@ -329,9 +423,11 @@ bhi360_fusion_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
     {
         bhi360_fusion_init_sensor(sensor_ctx);
     }
+    manikin_sample_stamp(sensor_ctx);
     print_api_error(bhy_get_and_process_fifo(work_buffer, WORK_BUFFER_SIZE, &bhy), &bhy);
 
     memcpy(read_buf, &sample_data, sizeof(sample_data));
+    manikin_sample_complete(sensor_ctx);
     return MANIKIN_STATUS_OK;
 }
 
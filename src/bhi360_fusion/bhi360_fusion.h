@@ -22,14 +22,54 @@
  * Author:          Victor Hogeweij
  */
 
-#ifndef BHI360_H
-#define BHI360_H
+#ifndef BHI360_FUSION_H
+#define BHI360_FUSION_H
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 #include "common/manikin_types.h"
 
+/*
+ * NOTE: With this set to 0 the ~100 KB firmware image is left out of MCU flash and has to be
+ * streamed in from a bhi360_fusion_fw_source_t, e.g. bhi360_fusion_w25q.h.
+ * Can be overridden in manikin_software_conf.h.
+ */
+#ifndef BHI360_FUSION_EMBEDDED_FW
+#define BHI360_FUSION_EMBEDDED_FW 1
+#endif
+
+/* Bytes per upload chunk, a multiple of 4 which fits in one I2C write with its register */
+#define BHI360_FUSION_FW_CHUNK_SIZE 512u
+
+    /**
+     * @brief Start reading len bytes of the image at offset into buf. May return before the read
+     *        is done (e.g. SPI DMA), read_wait is then called before buf is used.
+     */
+    typedef manikin_status_t (*bhi360_fusion_fw_read_start_t)(void    *user,
+                                                              uint8_t *buf,
+                                                              uint32_t offset,
+                                                              uint32_t len);
+
+    /**
+     * @brief Block until the read started last is done
+     */
+    typedef manikin_status_t (*bhi360_fusion_fw_read_wait_t)(void *user);
+
+    /**
+     * Firmware image which is streamed to the BHI360 RAM in chunks, instead of uploaded from MCU
+     * flash. The next chunk is read into one buffer while the previous one is written over I2C
+     * from the other, so an asynchronous reader hides the flash reads behind the upload.
+     * Set sensor_ctx->driver_ctx to the source before init.
+     */
+    typedef struct
+    {
+        bhi360_fusion_fw_read_start_t read_start; /* Starts reading a chunk of the image */
+        bhi360_fusion_fw_read_wait_t  read_wait;  /* NULL when read_start is blocking */
+        void                         *user;       /* Passed as-is to the callbacks */
+        uint32_t                      size;       /* Image size in bytes, a multiple of 4 */
+    } bhi360_fusion_fw_source_t;
+
     /**
      * @brief This struct contains the structure of samples for bhi360 IMU
      *        Which consists of 3-axis 16-bit integers. The unit is degrees
@@ -43,17 +83,23 @@ extern "C"
 
     /**
      * @brief Initialize the sensor, which disables continuous sampling mode.
+     *        The firmware is streamed from the bhi360_fusion_fw_source_t in driver_ctx, or
+     *        uploaded from MCU flash when driver_ctx is NULL and BHI360_FUSION_EMBEDDED_FW is set.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
      *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL on unable to set registers (due to lost
-     *          connection, e.g.)
+     *          connection, e.g.) or when the firmware upload failed
      *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on a firmware source without reader or with a
+     *          size which is 0 or not a multiple of 4, or no source without embedded firmware
      */
     manikin_status_t bhi360_fusion_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
      * @brief Read the sensor, which should read 16-bytes of data (8-channels, 2 bytes each)
+     *        The host interrupt line (HIRQ, active high) is asserted while the FIFO holds
+     *        samples, so with sensor_ctx->drdy_irq set the FIFO is only drained on that line.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @param read_buf Ptr to read-buffer which is used for storing the samples
@@ -86,4 +132,4 @@ extern "C"
 #ifdef __cplusplus
 }
 #endif
-#endif /* BHI360_H */
+#endif /* BHI360_FUSION_H */
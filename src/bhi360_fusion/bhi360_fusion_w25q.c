@@ -0,0 +1,57 @@
+/**
+ * @file            bhi360_fusion_w25q.c
+ * @brief           BHI360 firmware source which streams the image from a W25Q flash
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "bhi360_fusion_w25q.h"
+
+#include "w25qxx128/w25qxx128.h"
+#include "error_handler/error_handler.h"
+
+#define HASH_BHI360_FUSION_W25Q 0xA974208Eu
+
+manikin_status_t
+bhi360_fusion_w25q_read_start (void *user, uint8_t *buf, uint32_t offset, uint32_t len)
+{
+    bhi360_fusion_w25q_image_t *image = (bhi360_fusion_w25q_image_t *)user;
+    MANIKIN_ASSERT(HASH_BHI360_FUSION_W25Q, image != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BHI360_FUSION_W25Q, image->mem != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BHI360_FUSION_W25Q, buf != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    const manikin_memory_result_t res = w25qxx_read(image->mem, buf, image->addr + offset, len);
+    MANIKIN_ASSERT(
+        HASH_BHI360_FUSION_W25Q, res == MANIKIN_MEMORY_RESULT_OK, MANIKIN_STATUS_ERR_READ_FAIL);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+bhi360_fusion_w25q_source (bhi360_fusion_fw_source_t  *source,
+                           bhi360_fusion_w25q_image_t *image,
+                           uint32_t                    size)
+{
+    MANIKIN_ASSERT(HASH_BHI360_FUSION_W25Q, source != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BHI360_FUSION_W25Q, image != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    source->read_start = bhi360_fusion_w25q_read_start;
+    source->read_wait  = NULL;
+    source->user       = image;
+    source->size       = size;
+    return MANIKIN_STATUS_OK;
+}
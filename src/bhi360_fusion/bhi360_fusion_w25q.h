@@ -0,0 +1,71 @@
+/**
+ * @file            bhi360_fusion_w25q.h
+ * @brief           BHI360 firmware source which streams the image from a W25Q flash
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef BHI360_FUSION_W25Q_H
+#define BHI360_FUSION_W25Q_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "bhi360_fusion/bhi360_fusion.h"
+
+    typedef struct
+    {
+        manikin_spi_memory_ctx_t *mem;  /* Initialized flash context, see w25qxx_init() */
+        uint32_t                  addr; /* Flash address of the first byte of the image */
+    } bhi360_fusion_w25q_image_t;
+
+    /**
+     * @brief Reader for bhi360_fusion_fw_source_t which reads the image from a W25Q flash.
+     *        The W25Q driver reads blocking, so read_wait is left NULL.
+     * @param user Ptr to a bhi360_fusion_w25q_image_t
+     * @param buf Ptr to the chunk buffer
+     * @param offset Offset of the chunk in the image
+     * @param len Chunk size in bytes
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid user, flash context or buf,
+     *         MANIKIN_STATUS_ERR_READ_FAIL when the flash read failed
+     */
+    manikin_status_t bhi360_fusion_w25q_read_start(void    *user,
+                                                   uint8_t *buf,
+                                                   uint32_t offset,
+                                                   uint32_t len);
+
+    /**
+     * @brief Fill in a firmware source which streams the image from a W25Q flash
+     * @param source Ptr to the source, pass it as sensor_ctx->driver_ctx before init
+     * @param image Ptr to the image location, has to stay valid while the sensor is (re)initialized
+     * @param size Image size in bytes
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid source or image
+     */
+    manikin_status_t bhi360_fusion_w25q_source(bhi360_fusion_fw_source_t  *source,
+                                               bhi360_fusion_w25q_image_t *image,
+                                               uint32_t                    size);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // BHI360_FUSION_W25Q_H
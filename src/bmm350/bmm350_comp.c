@@ -0,0 +1,249 @@
+/**
+ * @file            bmm350_comp.c
+ * @brief           Precomputed OTP compensation for the BMM350 magnetometer
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+
+#include "bmm350_comp.h"
+
+#include "error_handler/error_handler.h"
+
+#define HASH_BMM350_COMP 0x2C570AE3u
+
+#define BMM350_COMP_Q30_ONE (1ll << 30)
+
+/* Fraction bits of the gains, as many as fit in 32 bits for the largest OTP corrections */
+#define BMM350_COMP_GAIN_Q      37u
+#define BMM350_COMP_TEMP_GAIN_Q 40u
+#define BMM350_COMP_COEF_Q      30u
+#define BMM350_COMP_Q16         16u
+
+/* Temperature offset removed by the Bosch API after scaling, in degC */
+#define BMM350_COMP_TEMP_BIAS 25.49
+
+/**
+ * @brief uT and degC per LSB, as update_default_coefiecents() in the Bosch API computes them
+ */
+static void
+bmm350_comp_lsb_scale (double *lsb_to_ut_degc)
+{
+    const double bxy_sens         = 14.55f;
+    const double bz_sens          = 9.0f;
+    const double temp_sens        = 0.00204f;
+    const double ina_xy_gain_trgt = 19.46f;
+    const double ina_z_gain_trgt  = 31.0f;
+    const double adc_gain         = 1 / 1.5f;
+    const double lut_gain         = 0.714607238769531f;
+    const double power            = 1000000.0 / 1048576.0;
+
+    lsb_to_ut_degc[0] = (power / (bxy_sens * ina_xy_gain_trgt * adc_gain * lut_gain));
+    lsb_to_ut_degc[1] = lsb_to_ut_degc[0];
+    lsb_to_ut_degc[2] = (power / (bz_sens * ina_z_gain_trgt * adc_gain * lut_gain));
+    lsb_to_ut_degc[3] = 1 / (temp_sens * adc_gain * lut_gain * 1048576);
+}
+
+/**
+ * @brief Round val to a fixed point number with frac_bits fraction bits
+ * @return 1 when it fits in 32 bits, 0 otherwise
+ */
+static uint8_t
+bmm350_comp_to_fixed (double val, uint8_t frac_bits, int32_t *fixed)
+{
+    const double scaled = val * (double)(1ll << frac_bits);
+    if (scaled >= (double)INT32_MAX || scaled <= (double)-INT32_MAX)
+    {
+        return 0;
+    }
+    *fixed = (int32_t)((scaled < 0.0) ? scaled - 0.5 : scaled + 0.5);
+    return 1;
+}
+
+/**
+ * @brief Shift right with rounding to nearest
+ * NOTE: Relies on an arithmetic shift for negative values, as all supported compilers do
+ */
+static int64_t
+bmm350_comp_shift (int64_t val, uint8_t shift)
+{
+    return (val + (1ll << (shift - 1u))) >> shift;
+}
+
+static int32_t
+bmm350_comp_saturate (int64_t val)
+{
+    if (val > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (val < -INT32_MAX)
+    {
+        return -INT32_MAX;
+    }
+    return (int32_t)val;
+}
+
+manikin_status_t
+bmm350_comp_init (bmm350_comp_t *comp, const struct bmm350_mag_compensate *mag_comp)
+{
+    MANIKIN_ASSERT(HASH_BMM350_COMP, comp != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, mag_comp != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    const double cxy         = (double)mag_comp->cross_axis.cross_x_y;
+    const double cyx         = (double)mag_comp->cross_axis.cross_y_x;
+    const double czx         = (double)mag_comp->cross_axis.cross_z_x;
+    const double czy         = (double)mag_comp->cross_axis.cross_z_y;
+    const double denominator = 1 - cyx * cxy;
+    MANIKIN_ASSERT(HASH_BMM350_COMP, denominator != 0.0, MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    const double inv_denominator = 1 / denominator;
+
+    double lsb_to_ut_degc[4];
+    bmm350_comp_lsb_scale(lsb_to_ut_degc);
+    const double sens[3]   = { mag_comp->dut_sensit_coef.sens_x,
+                               mag_comp->dut_sensit_coef.sens_y,
+                               mag_comp->dut_sensit_coef.sens_z };
+    const double offset[3] = { mag_comp->dut_offset_coef.offset_x,
+                               mag_comp->dut_offset_coef.offset_y,
+                               mag_comp->dut_offset_coef.offset_z };
+    const double tco[3]    = { mag_comp->dut_tco.tco_x, mag_comp->dut_tco.tco_y,
+                               mag_comp->dut_tco.tco_z };
+    const double tcs[3]    = { mag_comp->dut_tcs.tcs_x, mag_comp->dut_tcs.tcs_y,
+                               mag_comp->dut_tcs.tcs_z };
+
+    // NOTE: x' = (x - cxy * y) / d, y' = (y - cyx * x) / d and
+    //       z' = z + (x * (cyx * czy - czx) - y * (czy - cxy * czx)) / d
+    const double cross[3][3] = {
+        { inv_denominator, -cxy * inv_denominator, 0.0 },
+        { -cyx * inv_denominator, inv_denominator, 0.0 },
+        { (cyx * czy - czx) * inv_denominator, -(czy - cxy * czx) * inv_denominator, 1.0 },
+    };
+
+    uint8_t fits = 1;
+    for (uint8_t i = 0; i < 3u; i++)
+    {
+        const double gain = lsb_to_ut_degc[i] * (1 + sens[i]);
+        comp->gain[i]     = (float)gain;
+        comp->offset[i]   = (float)offset[i];
+        comp->tco[i]      = (float)tco[i];
+        comp->tcs[i]      = (float)tcs[i];
+        fits &= bmm350_comp_to_fixed(gain, BMM350_COMP_GAIN_Q, &comp->gain_q37[i]);
+        fits &= bmm350_comp_to_fixed(offset[i], BMM350_COMP_Q16, &comp->offset_q16[i]);
+        fits &= bmm350_comp_to_fixed(tco[i], BMM350_COMP_Q16, &comp->tco_q16[i]);
+        fits &= bmm350_comp_to_fixed(tcs[i], BMM350_COMP_COEF_Q, &comp->tcs_q30[i]);
+        for (uint8_t j = 0; j < 3u; j++)
+        {
+            comp->cross[i][j] = (float)cross[i][j];
+            fits &= bmm350_comp_to_fixed(cross[i][j], BMM350_COMP_COEF_Q, &comp->cross_q30[i][j]);
+        }
+    }
+
+    const double temp_sens = 1 + (double)mag_comp->dut_sensit_coef.t_sens;
+    const double temp_gain = lsb_to_ut_degc[3] * temp_sens;
+    const double temp_bias = BMM350_COMP_TEMP_BIAS * temp_sens;
+    comp->temp_gain        = (float)temp_gain;
+    comp->temp_bias        = (float)temp_bias;
+    comp->temp_offset      = mag_comp->dut_offset_coef.t_offs;
+    comp->dut_t0           = mag_comp->dut_t0;
+    fits &= bmm350_comp_to_fixed(temp_gain, BMM350_COMP_TEMP_GAIN_Q, &comp->temp_gain_q40);
+    fits &= bmm350_comp_to_fixed(temp_bias, BMM350_COMP_Q16, &comp->temp_bias_q16);
+    fits &= bmm350_comp_to_fixed(comp->temp_offset, BMM350_COMP_Q16, &comp->temp_offset_q16);
+    fits &= bmm350_comp_to_fixed(comp->dut_t0, BMM350_COMP_Q16, &comp->dut_t0_q16);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, fits, MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+bmm350_comp_apply_float (const bmm350_comp_t              *comp,
+                         const struct bmm350_raw_mag_data *raw,
+                         struct bmm350_mag_temp_data      *out)
+{
+    MANIKIN_ASSERT(HASH_BMM350_COMP, comp != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, raw != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, out != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    float temperature = comp->temp_gain * (float)raw->raw_data_t + comp->temp_offset;
+    if (raw->raw_data_t > 0)
+    {
+        temperature -= comp->temp_bias;
+    }
+    else if (raw->raw_data_t < 0)
+    {
+        temperature += comp->temp_bias;
+    }
+    const float dt         = temperature - comp->dut_t0;
+    const float raw_xyz[3] = { (float)raw->raw_xdata, (float)raw->raw_ydata,
+                               (float)raw->raw_zdata };
+    float       mag[3];
+    for (uint8_t i = 0; i < 3u; i++)
+    {
+        mag[i] = (comp->gain[i] * raw_xyz[i] + comp->offset[i] + comp->tco[i] * dt)
+                 / (1 + comp->tcs[i] * dt);
+    }
+    out->x           = comp->cross[0][0] * mag[0] + comp->cross[0][1] * mag[1];
+    out->y           = comp->cross[1][0] * mag[0] + comp->cross[1][1] * mag[1];
+    out->z           = comp->cross[2][0] * mag[0] + comp->cross[2][1] * mag[1] + mag[2];
+    out->temperature = temperature;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+bmm350_comp_apply_q16 (const bmm350_comp_t              *comp,
+                       const struct bmm350_raw_mag_data *raw,
+                       bmm350_mag_q16_t                 *out)
+{
+    MANIKIN_ASSERT(HASH_BMM350_COMP, comp != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, raw != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BMM350_COMP, out != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    int64_t temperature
+        = bmm350_comp_shift((int64_t)comp->temp_gain_q40 * raw->raw_data_t,
+                            BMM350_COMP_TEMP_GAIN_Q - BMM350_COMP_Q16)
+          + comp->temp_offset_q16;
+    if (raw->raw_data_t > 0)
+    {
+        temperature -= comp->temp_bias_q16;
+    }
+    else if (raw->raw_data_t < 0)
+    {
+        temperature += comp->temp_bias_q16;
+    }
+    const int64_t dt         = temperature - comp->dut_t0_q16;
+    const int32_t raw_xyz[3] = { raw->raw_xdata, raw->raw_ydata, raw->raw_zdata };
+    int64_t       mag[3];
+    for (uint8_t i = 0; i < 3u; i++)
+    {
+        // NOTE: Saturating the numerator and quotient keeps the products below within 64 bits
+        const int64_t numerator = bmm350_comp_saturate(
+            bmm350_comp_shift((int64_t)comp->gain_q37[i] * raw_xyz[i],
+                              BMM350_COMP_GAIN_Q - BMM350_COMP_Q16)
+            + comp->offset_q16[i] + bmm350_comp_shift(comp->tco_q16[i] * dt, BMM350_COMP_Q16));
+        int64_t denominator
+            = BMM350_COMP_Q30_ONE + bmm350_comp_shift(comp->tcs_q30[i] * dt, BMM350_COMP_Q16);
+        // NOTE: Only reachable for temperatures far outside of the operating range
+        denominator = (denominator > 0) ? denominator : 1;
+        mag[i]      = bmm350_comp_saturate((numerator * BMM350_COMP_Q30_ONE) / denominator);
+    }
+    const int64_t cross_x = comp->cross_q30[0][0] * mag[0] + comp->cross_q30[0][1] * mag[1];
+    const int64_t cross_y = comp->cross_q30[1][0] * mag[0] + comp->cross_q30[1][1] * mag[1];
+    const int64_t cross_z = comp->cross_q30[2][0] * mag[0] + comp->cross_q30[2][1] * mag[1];
+    out->x = bmm350_comp_saturate(bmm350_comp_shift(cross_x, BMM350_COMP_COEF_Q));
+    out->y = bmm350_comp_saturate(bmm350_comp_shift(cross_y, BMM350_COMP_COEF_Q));
+    out->z = bmm350_comp_saturate(bmm350_comp_shift(cross_z, BMM350_COMP_COEF_Q) + mag[2]);
+    out->temperature = bmm350_comp_saturate(temperature);
+    return MANIKIN_STATUS_OK;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file            bmm350_comp.h
+ * @brief           Precomputed OTP compensation for the BMM350 magnetometer
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+
+#ifndef BMM350_COMP_H
+#define BMM350_COMP_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "bmm350/external/bmm350_defs.h"
+
+/**
+ * bmm350_get_compensated_mag_xyz_temp_data() derives its LSB scaling and every OTP term again on
+ * each sample. bmm350_comp_init() folds them, incl. the reciprocal of the cross-axis denominator,
+ * into per-axis gains and a cross-axis matrix once after the OTP was read. What is left per sample
+ * is one division per axis, since the temperature coefficient of the sensitivity depends on the
+ * measured temperature.
+ *
+ * The Q16 path uses 32/64-bit integers only, so it suits parts without an FPU. Its outputs are in
+ * Q16.16 (1/65536 uT and 1/65536 degC) and saturate at +-32768.
+ *
+ * Both paths stay within BMM350_COMP_TOLERANCE (uT and degC) of the Bosch float path for fields
+ * of +-2000 uT at -40 to 85 degC, with any OTP coefficients. That is the float rounding of the
+ * Bosch path itself at these magnitudes, the Q16 path is closer to the exact result.
+ */
+#define BMM350_COMP_Q16_ONE   65536
+#define BMM350_COMP_TOLERANCE 0.005f
+
+    typedef enum
+    {
+        BMM350_COMP_BOSCH = 0, /* bmm350_get_compensated_mag_xyz_temp_data() */
+        BMM350_COMP_FLOAT,     /* bmm350_comp_apply_float() */
+        BMM350_COMP_Q16,       /* bmm350_comp_apply_q16() */
+    } bmm350_comp_mode_t;
+
+    typedef struct
+    {
+        int32_t x;           /* Magnetic field X in 1/65536 uT */
+        int32_t y;           /* Magnetic field Y in 1/65536 uT */
+        int32_t z;           /* Magnetic field Z in 1/65536 uT */
+        int32_t temperature; /* Temperature in 1/65536 degC */
+    } bmm350_mag_q16_t;
+
+    typedef struct
+    {
+        float   gain[3];         /* uT per LSB incl. the sensitivity correction */
+        float   offset[3];       /* Offset in uT */
+        float   tco[3];          /* Offset per degC from dut_t0 */
+        float   tcs[3];          /* Relative sensitivity per degC from dut_t0 */
+        float   cross[3][3];     /* Cross-axis matrix, divided by the denominator */
+        float   temp_gain;       /* degC per LSB incl. the sensitivity correction */
+        float   temp_bias;       /* Subtracted from positive, added to negative temperatures */
+        float   temp_offset;     /* Temperature offset in degC */
+        float   dut_t0;          /* OTP reference temperature in degC */
+        int32_t gain_q37[3];     /* gain in 1/2^37 uT per LSB */
+        int32_t offset_q16[3];   /* offset in Q16.16 */
+        int32_t tco_q16[3];      /* tco in Q16.16 */
+        int32_t tcs_q30[3];      /* tcs in Q2.30 */
+        int32_t cross_q30[3][3]; /* cross in Q2.30 */
+        int32_t temp_gain_q40;   /* temp_gain in 1/2^40 degC per LSB */
+        int32_t temp_bias_q16;   /* temp_bias in Q16.16 */
+        int32_t temp_offset_q16; /* temp_offset in Q16.16 */
+        int32_t dut_t0_q16;      /* dut_t0 in Q16.16 */
+    } bmm350_comp_t;
+
+    /**
+     * @brief Precompute the compensation constants, call it after bmm350_init() read the OTP
+     * @param comp Ptr to the constants to fill in
+     * @param mag_comp Ptr to the OTP-derived coefficients, e.g. &dev->mag_comp
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when a param is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG when the cross-axis denominator is 0 or a
+     *         coefficient does not fit the fixed point format
+     */
+    manikin_status_t bmm350_comp_init(bmm350_comp_t                      *comp,
+                                      const struct bmm350_mag_compensate *mag_comp);
+
+    /**
+     * @brief Compensate one raw sample in float, equal to the Bosch path up to rounding
+     * @param comp Ptr to the constants from bmm350_comp_init()
+     * @param raw Ptr to the sample from bmm350_read_uncomp_mag_temp_data()
+     * @param out Ptr to the result in uT and degC
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when a param is NULL
+     */
+    manikin_status_t bmm350_comp_apply_float(const bmm350_comp_t              *comp,
+                                             const struct bmm350_raw_mag_data *raw,
+                                             struct bmm350_mag_temp_data      *out);
+
+    /**
+     * @brief Compensate one raw sample in fixed point
+     * @param comp Ptr to the constants from bmm350_comp_init()
+     * @param raw Ptr to the sample from bmm350_read_uncomp_mag_temp_data()
+     * @param out Ptr to the result in Q16.16 uT and degC
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when a param is NULL
+     */
+    manikin_status_t bmm350_comp_apply_q16(const bmm350_comp_t              *comp,
+                                           const struct bmm350_raw_mag_data *raw,
+                                           bmm350_mag_q16_t                 *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // BMM350_COMP_H
@@ -23,6 +23,7 @@
  */
 
 #include "common/manikin_bit_manipulation.h"
+#include "common/manikin_time.h"
 #include "bmm350_driver.h"
 #include "external/bmm350_defs.h"
 #include <bmm350.h>
@@ -35,7 +36,27 @@
 
 #define HASH_BMM350 0x10C9F1D2u
 
-static struct bmm350_dev dev;
+/* Rate used when the instance holds no odr */
+#define BMM350_DEFAULT_ODR       BMM350_DATA_RATE_100HZ
+#define BMM350_DEFAULT_AVERAGING BMM350_AVERAGING_4
+
+/* Sample period at 400 Hz, every next ODR code halves the rate */
+#define BMM350_400HZ_PERIOD_US 2500u
+
+/* Samples dropped after init while the output settles */
+#define BMM350_WARMUP_SAMPLES 10u
+/* Warm-up gives up when the samples take twice their nominal time */
+#define BMM350_WARMUP_TIMEOUT_PERIODS (2u * BMM350_WARMUP_SAMPLES)
+
+/* Instance used when sensor_ctx->driver_ctx holds none */
+static bmm350_instance_t default_instance;
+
+static bmm350_instance_t *
+bmm350_instance (const manikin_sensor_ctx_t *sensor_ctx)
+{
+    return (sensor_ctx->driver_ctx != NULL) ? (bmm350_instance_t *)sensor_ctx->driver_ctx
+                                            : &default_instance;
+}
 
 /**
  * @brief Internal function to check the parameters entered into function
@@ -54,8 +75,8 @@ bmm350_check_params (const manikin_sensor_ctx_t *sensor_ctx)
 /*!
  * I2C read function map to COINES platform
  */
-BMM350_INTF_RET_TYPE
-bmm350_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr)
+static BMM350_INTF_RET_TYPE
+bmm350_i2c_read (uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr)
 {
     manikin_sensor_ctx_t *sensor_ctx = (manikin_sensor_ctx_t *)intf_ptr;
 
@@ -66,56 +87,187 @@ bmm350_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf
 
     return res == length && status == 1 ? 0 : -1;
 }
-uint8_t write_buf[50];
+
 /*!
  * I2C write function map to COINES platform
  */
-BMM350_INTF_RET_TYPE
-bmm350_i2c_write(uint8_t reg_addr, const uint8_t *reg_data, uint32_t length, void *intf_ptr)
+static BMM350_INTF_RET_TYPE
+bmm350_i2c_write (uint8_t reg_addr, const uint8_t *reg_data, uint32_t length, void *intf_ptr)
 {
     manikin_sensor_ctx_t *sensor_ctx = (manikin_sensor_ctx_t *)intf_ptr;
-    write_buf[0]                     = reg_addr;
+    uint8_t              *write_buf  = bmm350_instance(sensor_ctx)->write_buf;
+    if (length >= BMM350_WRITE_BUF_SIZE)
+    {
+        return -1;
+    }
+    write_buf[0] = reg_addr;
     memcpy(write_buf + 1, reg_data, length);
     size_t res = MANIKIN_I2C_HAL_WRITE_BYTES(
         sensor_ctx->i2c, sensor_ctx->i2c_addr, write_buf, (uint16_t)length + 1);
     return res == length + 1 ? 0 : -1;
 }
 
-void
+static void
 bmm350_delay (uint32_t period, void *intf_ptr)
 {
     (void)intf_ptr;
     MANIKIN_DELAY_US(period);
 }
 
+/**
+ * @brief bmm350_init() without the OTP dump, for a device whose compensation data was read before
+ */
+static int8_t
+bmm350_reinit (struct bmm350_dev *dev)
+{
+    uint8_t cmd     = BMM350_CMD_SOFTRESET;
+    uint8_t chip_id = 0;
+    dev->axis_en    = BMM350_EN_XYZ_MSK;
+    int8_t rslt     = bmm350_set_regs(BMM350_REG_CMD, &cmd, 1, dev);
+    if (rslt == BMM350_OK)
+    {
+        rslt = bmm350_delay_us(BMM350_SOFT_RESET_DELAY, dev);
+    }
+    if (rslt == BMM350_OK)
+    {
+        rslt = bmm350_get_regs(BMM350_REG_CHIP_ID, &chip_id, 1, dev);
+    }
+    if (rslt != BMM350_OK)
+    {
+        return rslt;
+    }
+    if (chip_id != BMM350_CHIP_ID)
+    {
+        return BMM350_E_DEV_NOT_FOUND;
+    }
+    // NOTE: The OTP is powered again by the soft reset
+    cmd  = BMM350_OTP_CMD_PWR_OFF_OTP;
+    rslt = bmm350_set_regs(BMM350_REG_OTP_CMD_REG, &cmd, 1, dev);
+    if (rslt == BMM350_OK)
+    {
+        rslt = bmm350_magnetic_reset_and_wait(dev);
+    }
+    return rslt;
+}
+
+/**
+ * @brief Read and compensate one sample with the compensation path of the instance
+ */
+static int8_t
+bmm350_read_compensated (bmm350_instance_t *inst, struct bmm350_mag_temp_data *mag_temp_data)
+{
+    if (inst->comp_mode == BMM350_COMP_BOSCH)
+    {
+        return bmm350_get_compensated_mag_xyz_temp_data(mag_temp_data, &inst->dev);
+    }
+    struct bmm350_raw_mag_data raw_data;
+    int8_t                     rslt = bmm350_read_uncomp_mag_temp_data(&raw_data, &inst->dev);
+    if (rslt != BMM350_OK)
+    {
+        return rslt;
+    }
+    if (inst->comp_mode != BMM350_COMP_Q16)
+    {
+        bmm350_comp_apply_float(&inst->comp, &raw_data, mag_temp_data);
+        return BMM350_OK;
+    }
+    const float      q16_to_float = 1.0f / BMM350_COMP_Q16_ONE;
+    bmm350_mag_q16_t mag_q16;
+    bmm350_comp_apply_q16(&inst->comp, &raw_data, &mag_q16);
+    mag_temp_data->x           = (float)mag_q16.x * q16_to_float;
+    mag_temp_data->y           = (float)mag_q16.y * q16_to_float;
+    mag_temp_data->z           = (float)mag_q16.z * q16_to_float;
+    mag_temp_data->temperature = (float)mag_q16.temperature * q16_to_float;
+    return BMM350_OK;
+}
+
+/**
+ * @brief Check an ODR and averaging pair, higher rates leave no time for more averaging:
+ *        400 Hz allows none, 200 Hz 2, 100 Hz 4 and lower rates 8 samples
+ */
+static uint8_t
+bmm350_rate_valid (uint8_t odr, uint8_t averaging)
+{
+    return odr >= BMM350_ODR_400HZ && odr <= BMM350_ODR_1_5625HZ && averaging <= BMM350_AVG_8
+           && averaging <= odr - BMM350_ODR_400HZ;
+}
+
+/**
+ * @brief Drop one warm-up sample when DRDY is set, give up once the deadline passed
+ */
+static manikin_status_t
+bmm350_warmup_step (manikin_sensor_ctx_t *sensor_ctx, bmm350_instance_t *inst, uint8_t drdy)
+{
+    if (drdy)
+    {
+        struct bmm350_raw_mag_data raw_data;
+        const int8_t rslt = bmm350_read_uncomp_mag_temp_data(&raw_data, &inst->dev);
+        MANIKIN_ASSERT(HASH_BMM350, rslt == BMM350_OK, MANIKIN_STATUS_ERR_READ_FAIL);
+        inst->warmup_left--;
+        if (inst->warmup_left == 0)
+        {
+            inst->state = BMM350_STATE_READY;
+            return MANIKIN_STATUS_OK;
+        }
+    }
+    if (manikin_time_now_us() > inst->warmup_deadline_us)
+    {
+        // NOTE: DRDY never came, the next read initializes the device again
+        inst->state              = BMM350_STATE_UNINIT;
+        sensor_ctx->needs_reinit = 1;
+        return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+    }
+    return MANIKIN_STATUS_OK;
+}
+
 manikin_status_t
 bmm350_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
 {
     manikin_status_t status = bmm350_check_params(sensor_ctx);
     MANIKIN_ASSERT(HASH_BMM350, (status == MANIKIN_STATUS_OK), status);
-    uint8_t  int_status, int_ctrl = 0;
-    uint8_t  loop = 10;
-    uint32_t secs, nano_secs = 0;
+    uint8_t int_ctrl = 0;
 
     // NOTE: needs_reinit is internal variable, which might be uninitialized when entered as param.
     sensor_ctx->needs_reinit = 0;
-    dev.intf_ptr             = (void *)sensor_ctx;
-    dev.read                 = bmm350_i2c_read;
-    dev.write                = bmm350_i2c_write;
-    dev.delay_us             = bmm350_delay;
-    int8_t rslt              = bmm350_init(&dev);
-    rslt                     = bmm350_configure_interrupt(
-        BMM350_PULSED, BMM350_ACTIVE_HIGH, BMM350_INTR_PUSH_PULL, BMM350_UNMAP_FROM_PIN, &dev);
+    bmm350_instance_t *inst  = bmm350_instance(sensor_ctx);
+    struct bmm350_dev *dev   = &inst->dev;
+    const uint8_t      odr   = (inst->odr != 0) ? inst->odr : BMM350_DEFAULT_ODR;
+    const uint8_t averaging  = (inst->odr != 0) ? inst->averaging : BMM350_DEFAULT_AVERAGING;
+    MANIKIN_ASSERT(
+        HASH_BMM350, bmm350_rate_valid(odr, averaging), MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    inst->state = BMM350_STATE_UNINIT;
+    dev->intf_ptr            = (void *)sensor_ctx;
+    dev->read                = bmm350_i2c_read;
+    dev->write               = bmm350_i2c_write;
+    dev->delay_us            = bmm350_delay;
+    int8_t rslt              = inst->otp_valid ? bmm350_reinit(dev) : bmm350_init(dev);
+    if (rslt == BMM350_OK && !inst->otp_valid
+        && bmm350_comp_init(&inst->comp, &dev->mag_comp) != MANIKIN_STATUS_OK)
+    {
+        rslt = BMM350_E_INVALID_CONFIG;
+    }
+    inst->otp_valid = (rslt == BMM350_OK);
+    if (rslt != BMM350_OK)
+    {
+        return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+    }
+    // NOTE: In drdy_irq mode the INT pin pulses (active high) on every new sample
+    rslt = bmm350_configure_interrupt(BMM350_PULSED,
+                                      BMM350_ACTIVE_HIGH,
+                                      BMM350_INTR_PUSH_PULL,
+                                      sensor_ctx->drdy_irq ? BMM350_MAP_TO_PIN
+                                                           : BMM350_UNMAP_FROM_PIN,
+                                      dev);
     if (rslt != BMM350_OK)
     {
         return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
     }
-    rslt = bmm350_enable_interrupt(BMM350_ENABLE_INTERRUPT, &dev);
+    rslt = bmm350_enable_interrupt(BMM350_ENABLE_INTERRUPT, dev);
     if (rslt != BMM350_OK)
     {
         return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
     }
-    rslt = bmm350_get_regs(BMM350_REG_INT_CTRL, &int_ctrl, 1, &dev);
+    rslt = bmm350_get_regs(BMM350_REG_INT_CTRL, &int_ctrl, 1, dev);
     if (rslt != BMM350_OK)
     {
         return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
@@ -130,46 +282,52 @@ bmm350_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
     }
 
     /* Set ODR and performance */
-    rslt = bmm350_set_odr_performance(BMM350_DATA_RATE_100HZ, BMM350_AVERAGING_4, &dev);
+    rslt = bmm350_set_odr_performance(
+        (enum bmm350_data_rates)odr, (enum bmm350_performance_parameters)averaging, dev);
     if (rslt != BMM350_OK)
     {
         return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
     }
-    struct bmm350_raw_mag_data raw_data;
     /* Enable all axis */
-    rslt = bmm350_enable_axes(BMM350_X_EN, BMM350_Y_EN, BMM350_Z_EN, &dev);
+    rslt = bmm350_enable_axes(BMM350_X_EN, BMM350_Y_EN, BMM350_Z_EN, dev);
     if (rslt == BMM350_OK)
     {
-        rslt = bmm350_set_powermode(BMM350_NORMAL_MODE, &dev);
-        while (loop > 0)
-        {
-            int_status = 0;
-
-            /* Get data ready interrupt status */
-            rslt = bmm350_get_regs(BMM350_REG_INT_STATUS, &int_status, 1, &dev);
-            if (rslt != BMM350_OK)
-            {
-                return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
-            }
-            /* Check if data ready interrupt occurred */
-            if (int_status & BMM350_DRDY_DATA_REG_MSK)
-            {
-                /* Get uncompensated mag data */
-                rslt = bmm350_read_uncomp_mag_temp_data(&raw_data, &dev);
-                if (rslt != BMM350_OK)
-                {
-                    return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
-                }
-                rslt = bmm350_read_sensortime(&secs, &nano_secs, &dev);
-                if (rslt != BMM350_OK)
-                {
-                    return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
-                }
-                loop--;
-            }
-        }
+        // NOTE: bmm350_set_powermode() would wait for the first sample, the warm-up does instead
+        uint8_t pmu_cmd = BMM350_PMU_CMD_NM;
+        rslt            = bmm350_set_regs(BMM350_REG_PMU_CMD, &pmu_cmd, 1, dev);
     }
-    return rslt == 0 ? MANIKIN_STATUS_OK : MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+    if (rslt != BMM350_OK)
+    {
+        return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+    }
+    const uint32_t period_us = BMM350_400HZ_PERIOD_US << (odr - BMM350_ODR_400HZ);
+    inst->state              = BMM350_STATE_WARMUP;
+    inst->warmup_left        = BMM350_WARMUP_SAMPLES;
+    inst->warmup_deadline_us = manikin_time_now_us() + BMM350_SUSPEND_TO_NORMAL_DELAY
+                               + BMM350_WARMUP_TIMEOUT_PERIODS * period_us;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+bmm350_set_rate (manikin_sensor_ctx_t              *sensor_ctx,
+                 enum bmm350_data_rates             odr,
+                 enum bmm350_performance_parameters averaging)
+{
+    manikin_status_t status = bmm350_check_params(sensor_ctx);
+    MANIKIN_ASSERT(HASH_BMM350, (status == MANIKIN_STATUS_OK), status);
+    MANIKIN_ASSERT(HASH_BMM350,
+                   bmm350_rate_valid((uint8_t)odr, (uint8_t)averaging),
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    bmm350_instance_t *inst = bmm350_instance(sensor_ctx);
+    inst->odr               = (uint8_t)odr;
+    inst->averaging         = (uint8_t)averaging;
+    if (inst->state == BMM350_STATE_UNINIT)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+    const int8_t rslt = bmm350_set_odr_performance(odr, averaging, &inst->dev);
+    MANIKIN_ASSERT(HASH_BMM350, rslt == BMM350_OK, MANIKIN_STATUS_ERR_WRITE_FAIL);
+    return MANIKIN_STATUS_OK;
 }
 
 manikin_status_t
@@ -185,16 +343,46 @@ bmm350_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
     }
     struct bmm350_mag_temp_data mag_temp_data;
 
-    uint8_t int_status = 0;
+    bmm350_instance_t *inst = bmm350_instance(sensor_ctx);
+    if (inst->state == BMM350_STATE_UNINIT)
+    {
+        sensor_ctx->needs_reinit = 1;
+        return MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL;
+    }
+    uint8_t int_status = BMM350_DRDY_DATA_REG_MSK;
+    int8_t  rslt       = BMM350_OK;
 
-    /* Get data ready interrupt status */
-    int8_t rslt = bmm350_get_regs(BMM350_REG_INT_STATUS, &int_status, 1, &dev);
+    /* Get data ready interrupt status, the INT pin already signalled it in drdy_irq mode */
+    if (!sensor_ctx->drdy_irq)
+    {
+        int_status = 0;
+        rslt       = bmm350_get_regs(BMM350_REG_INT_STATUS, &int_status, 1, &inst->dev);
+    }
+
+    MANIKIN_ASSERT(HASH_BMM350, rslt == BMM350_OK, MANIKIN_STATUS_ERR_READ_FAIL);
+    if (inst->state == BMM350_STATE_WARMUP)
+    {
+        return bmm350_warmup_step(sensor_ctx, inst, int_status & BMM350_DRDY_DATA_REG_MSK);
+    }
 
     /* Check if data ready interrupt occurred */
     if (int_status & BMM350_DRDY_DATA_REG_MSK)
     {
-        rslt = bmm350_get_compensated_mag_xyz_temp_data(&mag_temp_data, &dev);
+        manikin_sample_stamp(sensor_ctx);
+        rslt = bmm350_read_compensated(inst, &mag_temp_data);
         memcpy(read_buf, &mag_temp_data, sizeof(mag_temp_data));
+        // WARNING: Cast in line below
+        // NOTE: Only the lower 32 bits fit sensor_time_us, the full time is in sensor_ctx->sample
+        const uint32_t time_us = (uint32_t)sensor_ctx->sample.timestamp_us;
+
+        read_buf[sizeof(mag_temp_data)]      = GET_LOWER_8_BITS_OF_SHORT(time_us);
+        read_buf[sizeof(mag_temp_data) + 1u] = GET_UPPER_8_BITS_OF_SHORT(time_us);
+        read_buf[sizeof(mag_temp_data) + 2u] = GET_LAST_8_BITS_OF_24B(time_us);
+        read_buf[sizeof(mag_temp_data) + 3u] = (uint8_t)(time_us >> 24);
+        if (rslt == 0)
+        {
+            manikin_sample_complete(sensor_ctx);
+        }
     }
 
     return rslt == 0 ? MANIKIN_STATUS_OK : MANIKIN_STATUS_ERR_READ_FAIL;
@@ -222,11 +410,18 @@ bmm350_parse_raw_data (const uint8_t *raw_data, bmm350_sample_data_t *data)
      * [6-8]   - magneto_z
      * [9-11]  - temperature
      * [12-14] - sensor_time
+     *
+     * NOTE: The compensated struct is stored instead, followed by the acquisition time
      */
     data->magneto_x_ut     = raw_mag_data.x;
     data->magneto_y_ut     = raw_mag_data.y;
     data->magneto_z_ut     = raw_mag_data.z;
     data->temperature_mdeg = raw_mag_data.temperature;
-    data->sensor_time_us   = 0;
+
+    const uint8_t *time_us = raw_data + sizeof(struct bmm350_mag_temp_data);
+    // WARNING: Cast in line below
+    // NOTE: sensor_time_us is the lower 32 bits of the manikin time base, it wraps after ~71 min
+    data->sensor_time_us = (int32_t)((uint32_t)time_us[0] | ((uint32_t)time_us[1] << 8)
+                                     | ((uint32_t)time_us[2] << 16) | ((uint32_t)time_us[3] << 24));
     return MANIKIN_STATUS_OK;
 }
\ No newline at end of file
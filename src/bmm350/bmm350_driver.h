@@ -29,6 +29,59 @@ extern "C"
 {
 #endif
 #include "common/manikin_types.h"
+#include "bmm350/external/bmm350_defs.h"
+#include "bmm350/bmm350_comp.h"
+
+/**
+ * @brief I2C traffic of one bmm350_read_sensor() call, used by bus_planner:
+ *        register reads of INT_STATUS (1 + 3) and MAG_X..TEMP (1 + 14), incl. 2 dummy bytes
+ */
+#define BMM350_READ_TRANSACTIONS 4u
+#define BMM350_READ_BYTES        19u
+
+/**
+ * @brief I2C traffic of one bmm350_read_sensor() call with drdy_irq set:
+ *        register read of MAG_X..TEMP (1 + 14), incl. 2 dummy bytes
+ */
+#define BMM350_DRDY_READ_TRANSACTIONS 2u
+#define BMM350_DRDY_READ_BYTES        15u
+
+/**
+ * @brief Size of the read_buf of bmm350_read_sensor(): compensated x, y, z and temperature
+ *        (4 floats) followed by the lower 32 bits of the acquisition time in us (little-endian)
+ */
+#define BMM350_READ_BUF_SIZE 20u
+
+/**
+ * @brief Size of the register write scratch buffer of one instance: register address + payload
+ */
+#define BMM350_WRITE_BUF_SIZE 50u
+
+    typedef enum
+    {
+        BMM350_STATE_UNINIT = 0, /* Not initialized, init failed or the warm-up timed out */
+        BMM350_STATE_WARMUP,     /* Initialized, the first samples are dropped */
+        BMM350_STATE_READY,      /* Samples are returned */
+    } bmm350_state_t;
+
+    /**
+     * @brief State of one BMM350. Point sensor_ctx->driver_ctx at a caller-owned instance before
+     *        init so multiple magnetometers can be used on different buses or addresses. With
+     *        driver_ctx NULL a single instance shared by the driver is used.
+     */
+    typedef struct
+    {
+        struct bmm350_dev dev;                              /* Bosch API device state */
+        uint8_t           write_buf[BMM350_WRITE_BUF_SIZE]; /* Register address + payload */
+        uint8_t           otp_valid; /* Set once the OTP compensation data was read */
+        uint8_t           comp_mode; /* bmm350_comp_mode_t, read_buf holds floats in every mode */
+        bmm350_comp_t     comp;      /* Constants precomputed from the OTP data by init */
+        uint8_t           odr;       /* enum bmm350_data_rates, 0 for 100 Hz with averaging 4 */
+        uint8_t           averaging; /* enum bmm350_performance_parameters, see bmm350_set_rate() */
+        uint8_t           state;     /* Driver state: bmm350_state_t */
+        uint8_t           warmup_left;        /* Driver state: samples still to drop */
+        uint64_t          warmup_deadline_us; /* Driver state: warm-up fails after this time */
+    } bmm350_instance_t;
 
     /**
      * @brief Sample data from BMM350 magnetometer.
@@ -47,23 +100,51 @@ extern "C"
 
     /**
      * @brief Initialize the sensor, which disables continuous sampling mode.
+     *        The OTP compensation data is read on the first init of an instance only, a
+     *        re-initialization keeps it as long as the chip id still matches.
+     *        Init does not wait for samples: bmm350_read_sensor() drops the first samples
+     *        afterwards and fails when they do not arrive in time.
+     *        With sensor_ctx->drdy_irq set the INT pin pulses (active high) on every new sample,
+     *        bmm350_read_sensor() then skips polling the interrupt status.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
      *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL on unable to set registers (due to lost
      *          connection, e.g.)
      *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on an invalid odr and averaging in the instance
      */
     manikin_status_t bmm350_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
-     * @brief Read the sensor, which should read 16-bytes of data (8-channels, 2 bytes each)
+     * @brief Set the output data rate and averaging, applied right away when initialized and
+     *        kept for the next init. Higher rates leave no time for more averaging: 400 Hz
+     *        allows none, 200 Hz 2, 100 Hz 4 and lower rates 8 samples.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
-     * @param read_buf Ptr to read-buffer which is used for storing the samples
+     * @param odr Output data rate, BMM350_DATA_RATE_400HZ up to BMM350_DATA_RATE_1_5625HZ
+     * @param averaging Samples averaged per output, BMM350_NO_AVERAGING to BMM350_AVERAGING_8
      * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle,
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on an invalid rate or combination,
+     *         MANIKIN_STATUS_ERR_WRITE_FAIL when the device could not be updated
+     */
+    manikin_status_t bmm350_set_rate(manikin_sensor_ctx_t              *sensor_ctx,
+                                     enum bmm350_data_rates             odr,
+                                     enum bmm350_performance_parameters averaging);
+
+    /**
+     * @brief Read the sensor, which should read 16-bytes of data (8-channels, 2 bytes each)
+     * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
+     * address
+     * @param read_buf Ptr to read-buffer of BMM350_READ_BUF_SIZE bytes, used for storing the
+     * samples
+     * @return MANIKIN_STATUS_OK on success, also without a new sample during the warm-up after
+     *         init (read_buf and sensor_ctx->sample are then untouched),
      *         MANIKIN_STATUS_READ_FAIL on failure while reading,
-     *         MANIKIN_STATUS_WRITE_FAIL on failure while writing.
+     *         MANIKIN_STATUS_WRITE_FAIL on failure while writing,
+     *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL when not initialized or the warm-up timed out,
+     *         needs_reinit is then set so the next read initializes the device again.
      */
     manikin_status_t bmm350_read_sensor(manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf);
 
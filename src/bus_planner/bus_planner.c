@@ -0,0 +1,162 @@
+/**
+ * @file            bus_planner.c
+ * @brief           Bus capacity planner and admission control for sensor configurations
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "bus_planner.h"
+#include "error_handler/error_handler.h"
+
+#define HASH_BUS_PLANNER 0x380622F3u
+
+#define BUS_PLANNER_US_PER_S     1000000u
+#define BUS_PLANNER_PERMILLE     1000u
+#define BUS_PLANNER_NO_DOWNGRADE 0xFFu
+
+uint32_t
+bus_planner_read_time_us (const bus_planner_transfer_t *transfer,
+                          uint32_t                      i2c_speed_hz,
+                          uint16_t                      transaction_overhead_us)
+{
+    if (transfer == NULL || i2c_speed_hz == 0)
+    {
+        return 0;
+    }
+    const uint64_t bits = (uint64_t)transfer->transactions * BUS_PLANNER_TRANSACTION_BITS
+                          + (uint64_t)transfer->bytes * BUS_PLANNER_BYTE_BITS;
+    const uint64_t bus_time_us = (bits * BUS_PLANNER_US_PER_S + i2c_speed_hz - 1u) / i2c_speed_hz;
+    // WARNING: Cast in line below
+    // NOTE: At most 255 * 11 + 65535 * 9 bits, which takes < 600 s at 1 Hz SCL
+    return (uint32_t)bus_time_us + (uint32_t)transfer->transactions * transaction_overhead_us;
+}
+
+static manikin_status_t
+bus_planner_check_params (const bus_planner_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_BUS_PLANNER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BUS_PLANNER, ctx->sensors != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_BUS_PLANNER, ctx->i2c_speed_hz != 0, MANIKIN_STATUS_ERR_INVALID_I2C_BAUD);
+    MANIKIN_ASSERT(HASH_BUS_PLANNER,
+                   (ctx->sensor_cnt > 0 && ctx->sensor_cnt <= BUS_PLANNER_MAX_SENSORS),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    for (uint8_t i = 0; i < ctx->sensor_cnt; i++)
+    {
+        MANIKIN_ASSERT(HASH_BUS_PLANNER,
+                       (ctx->sensors[i].rate_hz != 0
+                        && ctx->sensors[i].min_rate_hz <= ctx->sensors[i].rate_hz),
+                       MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Evaluate the planned rates
+ * @return 1 when the plan fits the budget and all deadlines, 0 otherwise
+ */
+static uint8_t
+bus_planner_evaluate (bus_planner_ctx_t *ctx)
+{
+    uint64_t busy_us_per_s = 0;
+    uint32_t all_reads_us  = 0;
+    for (uint8_t i = 0; i < ctx->sensor_cnt; i++)
+    {
+        const bus_planner_sensor_t *sensor = &ctx->sensors[i];
+        busy_us_per_s += (uint64_t)sensor->read_time_us * sensor->planned_rate_hz;
+        all_reads_us += sensor->read_time_us;
+    }
+    const uint64_t utilisation
+        = (busy_us_per_s * BUS_PLANNER_PERMILLE + BUS_PLANNER_US_PER_S - 1u) / BUS_PLANNER_US_PER_S;
+    // WARNING: Cast in line below
+    // NOTE: Saturated, anything above 100% is over budget anyway
+    ctx->utilisation_permille = (uint16_t)((utilisation > UINT16_MAX) ? UINT16_MAX : utilisation);
+
+    //
+    // The bus is not preemptive, so in the worst case a read is queued behind one read of
+    // every other sensor. It has to complete before the next sample of the same sensor is due.
+    //
+    uint8_t fits = ctx->utilisation_permille <= ctx->budget_permille;
+    for (uint8_t i = 0; i < ctx->sensor_cnt; i++)
+    {
+        bus_planner_sensor_t *sensor = &ctx->sensors[i];
+        sensor->worst_latency_us     = all_reads_us;
+        if (all_reads_us > BUS_PLANNER_US_PER_S / sensor->planned_rate_hz)
+        {
+            fits = 0;
+        }
+    }
+    return fits;
+}
+
+/**
+ * @brief Pick the sensor occupying the most bus time that can still be halved
+ */
+static uint8_t
+bus_planner_downgrade_candidate (const bus_planner_ctx_t *ctx)
+{
+    uint8_t  candidate = BUS_PLANNER_NO_DOWNGRADE;
+    uint64_t max_load  = 0;
+    for (uint8_t i = 0; i < ctx->sensor_cnt; i++)
+    {
+        const bus_planner_sensor_t *sensor   = &ctx->sensors[i];
+        const uint16_t              min_rate = sensor->min_rate_hz ? sensor->min_rate_hz
+                                                                   : sensor->rate_hz;
+        // NOTE: Odd rates are not halved, that would break the rate multiples of the scheduler
+        if ((sensor->planned_rate_hz & 1u) != 0 || sensor->planned_rate_hz / 2u < min_rate)
+        {
+            continue;
+        }
+        const uint64_t load = (uint64_t)sensor->read_time_us * sensor->planned_rate_hz;
+        if (candidate == BUS_PLANNER_NO_DOWNGRADE || load > max_load)
+        {
+            candidate = i;
+            max_load  = load;
+        }
+    }
+    return candidate;
+}
+
+manikin_status_t
+bus_planner_plan (bus_planner_ctx_t *ctx)
+{
+    manikin_status_t status = bus_planner_check_params(ctx);
+    MANIKIN_ASSERT(HASH_BUS_PLANNER, (status == MANIKIN_STATUS_OK), status);
+
+    for (uint8_t i = 0; i < ctx->sensor_cnt; i++)
+    {
+        bus_planner_sensor_t *sensor = &ctx->sensors[i];
+        sensor->planned_rate_hz      = sensor->rate_hz;
+        sensor->read_time_us         = bus_planner_read_time_us(
+            &sensor->transfer, ctx->i2c_speed_hz, ctx->transaction_overhead_us);
+    }
+
+    while (!bus_planner_evaluate(ctx))
+    {
+        const uint8_t candidate = (ctx->policy == BUS_PLANNER_POLICY_DOWNGRADE)
+                                      ? bus_planner_downgrade_candidate(ctx)
+                                      : BUS_PLANNER_NO_DOWNGRADE;
+        if (candidate == BUS_PLANNER_NO_DOWNGRADE)
+        {
+            return MANIKIN_STATUS_ERR_BUS_OVER_BUDGET;
+        }
+        ctx->sensors[candidate].planned_rate_hz /= 2u;
+    }
+    return MANIKIN_STATUS_OK;
+}
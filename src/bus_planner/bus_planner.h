@@ -0,0 +1,117 @@
+/**
+ * @file            bus_planner.h
+ * @brief           Bus capacity planner and admission control for sensor configurations
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef BUS_PLANNER_H
+#define BUS_PLANNER_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+
+/**
+ * I2C bit-time model: every transaction costs a START, the address byte (+ACK) and a STOP,
+ * every data byte costs 8 bits + ACK. The software overhead per transaction (HAL call, ISR,
+ * bus-free time) is platform dependent and configured by the caller.
+ */
+#define BUS_PLANNER_TRANSACTION_BITS 11u
+#define BUS_PLANNER_BYTE_BITS        9u
+#define BUS_PLANNER_MAX_SENSORS      16u
+
+/**
+ * @brief Transfer descriptor of a driver, e.g. BUS_PLANNER_DRIVER_TRANSFER(ADS7138)
+ */
+#define BUS_PLANNER_DRIVER_TRANSFER(DRIVER)                   \
+    {                                                         \
+        DRIVER##_READ_TRANSACTIONS, DRIVER##_READ_BYTES       \
+    }
+
+    typedef enum
+    {
+        BUS_PLANNER_POLICY_REJECT = 0, /* Fail when the configuration does not fit */
+        BUS_PLANNER_POLICY_DOWNGRADE,  /* Halve rates (down to min_rate_hz) until it fits */
+    } bus_planner_policy_t;
+
+    typedef struct
+    {
+        uint8_t  transactions; /* I2C transactions per read */
+        uint16_t bytes;        /* Data bytes per read (written and read, excluding addresses) */
+    } bus_planner_transfer_t;
+
+    typedef struct
+    {
+        bus_planner_transfer_t transfer;
+        uint16_t               rate_hz;          /* Requested sample rate */
+        uint16_t               min_rate_hz;      /* Lowest acceptable rate, 0 == rate_hz */
+        uint16_t               planned_rate_hz;  /* Output: admitted sample rate */
+        uint32_t               read_time_us;     /* Output: bus time of one read */
+        uint32_t               worst_latency_us; /* Output: worst-case read completion latency */
+    } bus_planner_sensor_t;
+
+    typedef struct
+    {
+        uint32_t              i2c_speed_hz;            /* SCL frequency of the bus */
+        uint16_t              transaction_overhead_us; /* Software overhead per transaction */
+        uint16_t              budget_permille;         /* Max bus utilisation, e.g. 700 == 70% */
+        bus_planner_policy_t  policy;
+        bus_planner_sensor_t *sensors;
+        uint8_t               sensor_cnt;
+        uint16_t              utilisation_permille; /* Output: utilisation of the planned rates */
+    } bus_planner_ctx_t;
+
+    /**
+     * @brief Bus time of one read according to the bit-time model
+     * @param transfer Ptr to the transfer descriptor of the read
+     * @param i2c_speed_hz SCL frequency of the bus
+     * @param transaction_overhead_us Software overhead per transaction
+     * @return Bus time in microseconds (rounded up), 0 when transfer is NULL or speed is 0
+     */
+    uint32_t bus_planner_read_time_us(const bus_planner_transfer_t *transfer,
+                                      uint32_t                      i2c_speed_hz,
+                                      uint16_t                      transaction_overhead_us);
+
+    /**
+     * @brief Compute the bus utilisation and worst-case latency of a sensor configuration and
+     *        admit it. A configuration is admitted when the utilisation stays within the budget
+     *        and every read completes within its sample period, also when it is queued behind
+     *        one read of every other sensor on the bus.
+     *        With BUS_PLANNER_POLICY_DOWNGRADE the sensor occupying the most bus time is halved
+     *        repeatedly (as long as its rate is even and stays >= min_rate_hz) until it fits.
+     * @param ctx Ptr to the planner context
+     * @return MANIKIN_STATUS_OK when the (possibly downgraded) configuration fits,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or sensors is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_I2C_BAUD when i2c_speed_hz is 0,
+     *         MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE when a rate is 0 or min_rate_hz is
+     *         above rate_hz,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when sensor_cnt is out of range,
+     *         MANIKIN_STATUS_ERR_BUS_OVER_BUDGET when it does not fit (the outputs describe the
+     *         last attempted plan)
+     */
+    manikin_status_t bus_planner_plan(bus_planner_ctx_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // BUS_PLANNER_H
@@ -0,0 +1,426 @@
+/**
+ * @file            cbor.c
+ * @brief           Minimal allocation-free CBOR (RFC 8949) writer and reader
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "cbor.h"
+#include "error_handler/error_handler.h"
+#include <string.h>
+
+#define HASH_CBOR 0x37DC9ADFu
+
+#define CBOR_ADDITIONAL_INFO_MASK  0x1Fu
+#define CBOR_HALF_FLOAT_EXP_MASK   0x1Fu
+#define CBOR_HALF_FLOAT_MANT_MASK  0x3FFu
+#define CBOR_HALF_TO_SINGLE_BIAS   112u
+#define CBOR_HALF_SUBNORMAL_SCALE  16777216.0f
+#define CBOR_MAX_SIGNED_32B_ARGUMENT 0x7FFFFFFFu
+
+static manikin_status_t
+cbor_write_head (cbor_writer_t *writer, uint8_t major_type, uint32_t arg)
+{
+    MANIKIN_ASSERT(HASH_CBOR, writer != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t head[5];
+    size_t  head_len;
+    if (arg < CBOR_ADDITIONAL_INFO_U8)
+    {
+        // WARNING: Cast in line below
+        // NOTE: arg is smaller than 24, so it fits the additional info bits
+        head[0]  = CBOR_INITIAL_BYTE(major_type, (uint8_t)arg);
+        head_len = 1;
+    }
+    else if (arg <= 0xFFu)
+    {
+        head[0]  = CBOR_INITIAL_BYTE(major_type, CBOR_ADDITIONAL_INFO_U8);
+        head[1]  = (uint8_t)arg;
+        head_len = 2;
+    }
+    else if (arg <= 0xFFFFu)
+    {
+        head[0]  = CBOR_INITIAL_BYTE(major_type, CBOR_ADDITIONAL_INFO_U16);
+        head[1]  = (uint8_t)(arg >> 8);
+        head[2]  = (uint8_t)arg;
+        head_len = 3;
+    }
+    else
+    {
+        head[0]  = CBOR_INITIAL_BYTE(major_type, CBOR_ADDITIONAL_INFO_U32);
+        head[1]  = (uint8_t)(arg >> 24);
+        head[2]  = (uint8_t)(arg >> 16);
+        head[3]  = (uint8_t)(arg >> 8);
+        head[4]  = (uint8_t)arg;
+        head_len = 5;
+    }
+    if (writer->size - writer->len < head_len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+    memcpy(&writer->buf[writer->len], head, head_len);
+    writer->len += head_len;
+    return MANIKIN_STATUS_OK;
+}
+
+static manikin_status_t
+cbor_read_head (cbor_reader_t *reader, uint8_t *major_type, uint8_t *info, uint64_t *arg)
+{
+    MANIKIN_ASSERT(HASH_CBOR, reader != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (reader->offset >= reader->len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    const uint8_t initial_byte = reader->buf[reader->offset];
+    *major_type                = (uint8_t)(initial_byte >> 5);
+    *info                      = (uint8_t)(initial_byte & CBOR_ADDITIONAL_INFO_MASK);
+
+    size_t arg_len;
+    if (*info < CBOR_ADDITIONAL_INFO_U8)
+    {
+        arg_len = 0;
+    }
+    else if (*info <= CBOR_ADDITIONAL_INFO_U64)
+    {
+        arg_len = (size_t)1u << (*info - CBOR_ADDITIONAL_INFO_U8);
+    }
+    else
+    {
+        // NOTE: Indefinite lengths and reserved values are not supported
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    if (reader->len - reader->offset - 1u < arg_len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    *arg = (arg_len == 0u) ? *info : 0u;
+    for (size_t i = 0; i < arg_len; i++)
+    {
+        *arg = (*arg << 8) | reader->buf[reader->offset + 1u + i];
+    }
+    reader->offset += 1u + arg_len;
+    return MANIKIN_STATUS_OK;
+}
+
+static float
+cbor_half_to_float (uint16_t half)
+{
+    const uint32_t sign = (uint32_t)(half >> 15) << 31;
+    const uint32_t exp  = ((uint32_t)half >> 10) & CBOR_HALF_FLOAT_EXP_MASK;
+    const uint32_t mant = (uint32_t)half & CBOR_HALF_FLOAT_MANT_MASK;
+    uint32_t       bits;
+    float          val;
+    if (exp == 0u)
+    {
+        // NOTE: Subnormal half floats are mant * 2^-24
+        val = (float)mant / CBOR_HALF_SUBNORMAL_SCALE;
+        return (sign != 0u) ? -val : val;
+    }
+    if (exp == CBOR_HALF_FLOAT_EXP_MASK)
+    {
+        bits = sign | 0x7F800000u | (mant << 13);
+    }
+    else
+    {
+        bits = sign | ((exp + CBOR_HALF_TO_SINGLE_BIAS) << 23) | (mant << 13);
+    }
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+void
+cbor_writer_init (cbor_writer_t *writer, uint8_t *buf, size_t size)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    writer->buf  = buf;
+    writer->size = (buf != NULL) ? size : 0u;
+    writer->len  = 0;
+}
+
+manikin_status_t
+cbor_write_uint (cbor_writer_t *writer, uint32_t val)
+{
+    return cbor_write_head(writer, CBOR_MAJOR_TYPE_UINT, val);
+}
+
+manikin_status_t
+cbor_write_int (cbor_writer_t *writer, int32_t val)
+{
+    if (val >= 0)
+    {
+        return cbor_write_head(writer, CBOR_MAJOR_TYPE_UINT, (uint32_t)val);
+    }
+    // NOTE: Negative integers are encoded as -1 - val, val + 1 can not overflow
+    return cbor_write_head(writer, CBOR_MAJOR_TYPE_NINT, (uint32_t)(-(val + 1)));
+}
+
+manikin_status_t
+cbor_write_float (cbor_writer_t *writer, float val)
+{
+    MANIKIN_ASSERT(HASH_CBOR, writer != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (writer->size - writer->len < 5u)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    uint8_t *out = &writer->buf[writer->len];
+    out[0]       = CBOR_INITIAL_BYTE(CBOR_MAJOR_TYPE_SIMPLE, CBOR_ADDITIONAL_INFO_U32);
+    out[1]       = (uint8_t)(bits >> 24);
+    out[2]       = (uint8_t)(bits >> 16);
+    out[3]       = (uint8_t)(bits >> 8);
+    out[4]       = (uint8_t)bits;
+    writer->len += 5u;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+cbor_write_bytes (cbor_writer_t *writer, const uint8_t *data, size_t len)
+{
+    MANIKIN_ASSERT(HASH_CBOR, data != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_CBOR, len <= 0xFFFFFFFFu, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    manikin_status_t status = cbor_write_head(writer, CBOR_MAJOR_TYPE_BYTES, (uint32_t)len);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (writer->size - writer->len < len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+    memcpy(&writer->buf[writer->len], data, len);
+    writer->len += len;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+cbor_write_array_header (cbor_writer_t *writer, size_t cnt)
+{
+    MANIKIN_ASSERT(HASH_CBOR, cnt <= 0xFFFFFFFFu, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    return cbor_write_head(writer, CBOR_MAJOR_TYPE_ARRAY, (uint32_t)cnt);
+}
+
+manikin_status_t
+cbor_write_map_header (cbor_writer_t *writer, size_t cnt)
+{
+    MANIKIN_ASSERT(HASH_CBOR, cnt <= 0xFFFFFFFFu, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    return cbor_write_head(writer, CBOR_MAJOR_TYPE_MAP, (uint32_t)cnt);
+}
+
+void
+cbor_reader_init (cbor_reader_t *reader, const uint8_t *buf, size_t len)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    reader->buf    = buf;
+    reader->len    = (buf != NULL) ? len : 0u;
+    reader->offset = 0;
+}
+
+manikin_status_t
+cbor_read_uint (cbor_reader_t *reader, uint32_t *val)
+{
+    MANIKIN_ASSERT(HASH_CBOR, val != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t          major_type;
+    uint8_t          info;
+    uint64_t         arg;
+    manikin_status_t status = cbor_read_head(reader, &major_type, &info, &arg);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (major_type != CBOR_MAJOR_TYPE_UINT)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    if (arg > 0xFFFFFFFFu)
+    {
+        return MANIKIN_STATUS_ERR_CONVERSION_FAILED;
+    }
+    *val = (uint32_t)arg;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+cbor_read_int (cbor_reader_t *reader, int32_t *val)
+{
+    MANIKIN_ASSERT(HASH_CBOR, val != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t          major_type;
+    uint8_t          info;
+    uint64_t         arg;
+    manikin_status_t status = cbor_read_head(reader, &major_type, &info, &arg);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (major_type != CBOR_MAJOR_TYPE_UINT && major_type != CBOR_MAJOR_TYPE_NINT)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    if (arg > CBOR_MAX_SIGNED_32B_ARGUMENT)
+    {
+        return MANIKIN_STATUS_ERR_CONVERSION_FAILED;
+    }
+    *val = (major_type == CBOR_MAJOR_TYPE_UINT) ? (int32_t)arg : -1 - (int32_t)arg;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+cbor_read_float (cbor_reader_t *reader, float *val)
+{
+    MANIKIN_ASSERT(HASH_CBOR, val != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t          major_type;
+    uint8_t          info;
+    uint64_t         arg;
+    manikin_status_t status = cbor_read_head(reader, &major_type, &info, &arg);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    switch (major_type)
+    {
+        case CBOR_MAJOR_TYPE_UINT: {
+            *val = (float)arg;
+            break;
+        }
+        case CBOR_MAJOR_TYPE_NINT: {
+            *val = -1.0f - (float)arg;
+            break;
+        }
+        case CBOR_MAJOR_TYPE_SIMPLE: {
+            if (info == CBOR_ADDITIONAL_INFO_U16)
+            {
+                *val = cbor_half_to_float((uint16_t)arg);
+            }
+            else if (info == CBOR_ADDITIONAL_INFO_U32)
+            {
+                const uint32_t bits = (uint32_t)arg;
+                memcpy(val, &bits, sizeof(*val));
+            }
+            else if (info == CBOR_ADDITIONAL_INFO_U64)
+            {
+                double dval;
+                memcpy(&dval, &arg, sizeof(dval));
+                *val = (float)dval;
+            }
+            else
+            {
+                return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+            }
+            break;
+        }
+        default: {
+            return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+        }
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+static manikin_status_t
+cbor_read_container_header (cbor_reader_t *reader, uint8_t expected_type, size_t *cnt)
+{
+    MANIKIN_ASSERT(HASH_CBOR, cnt != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t          major_type;
+    uint8_t          info;
+    uint64_t         arg;
+    manikin_status_t status = cbor_read_head(reader, &major_type, &info, &arg);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    // NOTE: Every item takes at least one byte, so larger counts can only be malformed
+    if (major_type != expected_type || arg > reader->len - reader->offset)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    *cnt = (size_t)arg;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+cbor_read_array_header (cbor_reader_t *reader, size_t *cnt)
+{
+    return cbor_read_container_header(reader, CBOR_MAJOR_TYPE_ARRAY, cnt);
+}
+
+manikin_status_t
+cbor_read_map_header (cbor_reader_t *reader, size_t *cnt)
+{
+    return cbor_read_container_header(reader, CBOR_MAJOR_TYPE_MAP, cnt);
+}
+
+manikin_status_t
+cbor_skip_item (cbor_reader_t *reader)
+{
+    MANIKIN_ASSERT(HASH_CBOR, reader != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    //
+    // Nested containers are skipped iteratively by counting the items still to be skipped,
+    // which keeps the stack usage constant regardless of the nesting depth.
+    //
+    uint64_t pending = 1;
+    while (pending > 0u)
+    {
+        uint8_t          major_type;
+        uint8_t          info;
+        uint64_t         arg;
+        manikin_status_t status = cbor_read_head(reader, &major_type, &info, &arg);
+        if (status != MANIKIN_STATUS_OK)
+        {
+            return status;
+        }
+        pending--;
+        switch (major_type)
+        {
+            case CBOR_MAJOR_TYPE_BYTES:
+            case CBOR_MAJOR_TYPE_TEXT: {
+                if (arg > reader->len - reader->offset)
+                {
+                    return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+                }
+                reader->offset += (size_t)arg;
+                break;
+            }
+            case CBOR_MAJOR_TYPE_ARRAY:
+            case CBOR_MAJOR_TYPE_MAP: {
+                const uint64_t item_cnt = (major_type == CBOR_MAJOR_TYPE_MAP) ? 2u * arg : arg;
+                if (arg > reader->len - reader->offset || item_cnt > reader->len - reader->offset)
+                {
+                    return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+                }
+                pending += item_cnt;
+                break;
+            }
+            case CBOR_MAJOR_TYPE_TAG: {
+                // NOTE: A tag is followed by the item it tags
+                pending++;
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return MANIKIN_STATUS_OK;
+}
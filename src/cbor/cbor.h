@@ -0,0 +1,163 @@
+/**
+ * @file            cbor.h
+ * @brief           Minimal allocation-free CBOR (RFC 8949) writer and reader
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef CBOR_H
+#define CBOR_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+
+#define CBOR_MAJOR_TYPE_UINT   0u
+#define CBOR_MAJOR_TYPE_NINT   1u
+#define CBOR_MAJOR_TYPE_BYTES  2u
+#define CBOR_MAJOR_TYPE_TEXT   3u
+#define CBOR_MAJOR_TYPE_ARRAY  4u
+#define CBOR_MAJOR_TYPE_MAP    5u
+#define CBOR_MAJOR_TYPE_TAG    6u
+#define CBOR_MAJOR_TYPE_SIMPLE 7u
+
+#define CBOR_ADDITIONAL_INFO_U8  24u
+#define CBOR_ADDITIONAL_INFO_U16 25u
+#define CBOR_ADDITIONAL_INFO_U32 26u
+#define CBOR_ADDITIONAL_INFO_U64 27u
+
+#define CBOR_INITIAL_BYTE(major_type, info) (uint8_t)(((major_type) << 5) | (info))
+
+    typedef struct
+    {
+        uint8_t *buf;
+        size_t   size;
+        size_t   len; /* Number of bytes written so far */
+    } cbor_writer_t;
+
+    typedef struct
+    {
+        const uint8_t *buf;
+        size_t         len;
+        size_t         offset; /* Number of bytes consumed so far */
+    } cbor_reader_t;
+
+    /**
+     * @brief Initialize a writer which encodes into the caller-provided buffer
+     * @param writer Ptr to writer state
+     * @param buf Ptr to output buffer
+     * @param size Size of the output buffer
+     */
+    void cbor_writer_init(cbor_writer_t *writer, uint8_t *buf, size_t size);
+
+    /**
+     * @brief Write an unsigned integer using the shortest encoding
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid writer,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the output buffer is full
+     */
+    manikin_status_t cbor_write_uint(cbor_writer_t *writer, uint32_t val);
+
+    /**
+     * @brief Write a signed integer using the shortest encoding
+     * @return See cbor_write_uint()
+     */
+    manikin_status_t cbor_write_int(cbor_writer_t *writer, int32_t val);
+
+    /**
+     * @brief Write a single-precision float
+     * @return See cbor_write_uint()
+     */
+    manikin_status_t cbor_write_float(cbor_writer_t *writer, float val);
+
+    /**
+     * @brief Write a byte string, the data is copied into the output buffer
+     * @return See cbor_write_uint(), MANIKIN_STATUS_ERR_NULL_PARAM also on invalid data
+     */
+    manikin_status_t cbor_write_bytes(cbor_writer_t *writer, const uint8_t *data, size_t len);
+
+    /**
+     * @brief Write the header of an array with cnt items, the items have to be written after
+     * @return See cbor_write_uint()
+     */
+    manikin_status_t cbor_write_array_header(cbor_writer_t *writer, size_t cnt);
+
+    /**
+     * @brief Write the header of a map with cnt key/value pairs, the pairs have to be written
+     *        after
+     * @return See cbor_write_uint()
+     */
+    manikin_status_t cbor_write_map_header(cbor_writer_t *writer, size_t cnt);
+
+    /**
+     * @brief Initialize a reader which decodes from the caller-provided buffer
+     * @param reader Ptr to reader state
+     * @param buf Ptr to encoded data
+     * @param len Number of encoded bytes
+     */
+    void cbor_reader_init(cbor_reader_t *reader, const uint8_t *buf, size_t len);
+
+    /**
+     * @brief Read an unsigned integer (any encoding width)
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid reader or val,
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED on truncated data or wrong type,
+     *         MANIKIN_STATUS_ERR_CONVERSION_FAILED when the value does not fit in val
+     */
+    manikin_status_t cbor_read_uint(cbor_reader_t *reader, uint32_t *val);
+
+    /**
+     * @brief Read a signed or unsigned integer (any encoding width)
+     * @return See cbor_read_uint()
+     */
+    manikin_status_t cbor_read_int(cbor_reader_t *reader, int32_t *val);
+
+    /**
+     * @brief Read a half, single or double precision float, integers are converted as well
+     * @return See cbor_read_uint()
+     */
+    manikin_status_t cbor_read_float(cbor_reader_t *reader, float *val);
+
+    /**
+     * @brief Read the header of a definite-length array
+     * @return See cbor_read_uint()
+     */
+    manikin_status_t cbor_read_array_header(cbor_reader_t *reader, size_t *cnt);
+
+    /**
+     * @brief Read the header of a definite-length map
+     * @return See cbor_read_uint()
+     */
+    manikin_status_t cbor_read_map_header(cbor_reader_t *reader, size_t *cnt);
+
+    /**
+     * @brief Skip one complete data item, including nested arrays and maps
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid reader,
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED on truncated data or indefinite lengths
+     */
+    manikin_status_t cbor_skip_item(cbor_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // CBOR_H
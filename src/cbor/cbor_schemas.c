@@ -0,0 +1,183 @@
+/**
+ * @file            cbor_schemas.c
+ * @brief           Compile-time CBOR schemas for the sensor sample structs
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "cbor_schemas.h"
+#include "cbor.h"
+#include "error_handler/error_handler.h"
+#include <string.h>
+
+#define HASH_CBOR_SCHEMAS 0xE72671D0u
+
+static inline uint8_t *
+cbor_schema_put_key (uint8_t *out, uint8_t key)
+{
+    out[0] = CBOR_INITIAL_BYTE(CBOR_MAJOR_TYPE_UINT, key);
+    return out + 1;
+}
+
+static inline uint8_t *
+cbor_schema_put_u32_arg (uint8_t *out, uint8_t major_type, uint32_t arg)
+{
+    out[0] = CBOR_INITIAL_BYTE(major_type, CBOR_ADDITIONAL_INFO_U32);
+    out[1] = (uint8_t)(arg >> 24);
+    out[2] = (uint8_t)(arg >> 16);
+    out[3] = (uint8_t)(arg >> 8);
+    out[4] = (uint8_t)arg;
+    return out + CBOR_SCHEMA_I32_ENCODED_SIZE;
+}
+
+static inline uint8_t *
+cbor_schema_put_U16 (uint8_t *out, uint16_t val)
+{
+    out[0] = CBOR_INITIAL_BYTE(CBOR_MAJOR_TYPE_UINT, CBOR_ADDITIONAL_INFO_U16);
+    out[1] = (uint8_t)(val >> 8);
+    out[2] = (uint8_t)val;
+    return out + CBOR_SCHEMA_U16_ENCODED_SIZE;
+}
+
+static inline uint8_t *
+cbor_schema_put_I32 (uint8_t *out, int32_t val)
+{
+    if (val < 0)
+    {
+        return cbor_schema_put_u32_arg(out, CBOR_MAJOR_TYPE_NINT, (uint32_t)(-(val + 1)));
+    }
+    return cbor_schema_put_u32_arg(out, CBOR_MAJOR_TYPE_UINT, (uint32_t)val);
+}
+
+static inline uint8_t *
+cbor_schema_put_F32 (uint8_t *out, float val)
+{
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return cbor_schema_put_u32_arg(out, CBOR_MAJOR_TYPE_SIMPLE, bits);
+}
+
+static manikin_status_t
+cbor_schema_get_U16 (cbor_reader_t *reader, uint16_t *val)
+{
+    uint32_t         tmp;
+    manikin_status_t status = cbor_read_uint(reader, &tmp);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (tmp > 0xFFFFu)
+    {
+        return MANIKIN_STATUS_ERR_CONVERSION_FAILED;
+    }
+    *val = (uint16_t)tmp;
+    return MANIKIN_STATUS_OK;
+}
+
+static manikin_status_t
+cbor_schema_get_I32 (cbor_reader_t *reader, int32_t *val)
+{
+    return cbor_read_int(reader, val);
+}
+
+static manikin_status_t
+cbor_schema_get_F32 (cbor_reader_t *reader, float *val)
+{
+    return cbor_read_float(reader, val);
+}
+
+/**
+ * X-macro expanders, these turn a schema into straight-line stores (encode) and a switch on the
+ * map key (decode).
+ */
+#define CBOR_SCHEMA_ENCODE_FIELD(key, field, type) \
+    out = cbor_schema_put_key(out, key);           \
+    out = cbor_schema_put_##type(out, sample->field);
+
+#define CBOR_SCHEMA_DECODE_FIELD(key, field, type)                 \
+    case key: {                                                    \
+        status = cbor_schema_get_##type(&reader, &sample->field); \
+        break;                                                     \
+    }
+
+#define CBOR_SCHEMA_FIELD_MASK(key, field, type) | (1u << (key))
+
+#define CBOR_SCHEMA_DEFINE_CODEC(name, sample_type, SCHEMA)                               \
+    manikin_status_t cbor_encode_##name(                                                  \
+        const sample_type *sample, uint8_t *out, size_t out_max_len, size_t *out_len)     \
+    {                                                                                     \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS, sample != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);  \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS, out != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);     \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS, out_len != NULL, MANIKIN_STATUS_ERR_NULL_PARAM); \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS,                                                 \
+                       out_max_len >= CBOR_SCHEMA_ENCODED_SIZE(SCHEMA),                   \
+                       MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);                           \
+        *out++ = CBOR_INITIAL_BYTE(CBOR_MAJOR_TYPE_MAP, CBOR_SCHEMA_CNT(SCHEMA));         \
+        SCHEMA(CBOR_SCHEMA_ENCODE_FIELD)                                                  \
+        *out_len = CBOR_SCHEMA_ENCODED_SIZE(SCHEMA);                                      \
+        return MANIKIN_STATUS_OK;                                                         \
+    }                                                                                     \
+                                                                                          \
+    manikin_status_t cbor_decode_##name(const uint8_t *in, size_t len, sample_type *sample) \
+    {                                                                                     \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS, in != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);      \
+        MANIKIN_ASSERT(HASH_CBOR_SCHEMAS, sample != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);  \
+        cbor_reader_t reader;                                                             \
+        size_t        cnt;                                                                \
+        uint32_t      seen_fields = 0;                                                    \
+        cbor_reader_init(&reader, in, len);                                               \
+        manikin_status_t status = cbor_read_map_header(&reader, &cnt);                    \
+        for (size_t i = 0; i < cnt && status == MANIKIN_STATUS_OK; i++)                   \
+        {                                                                                 \
+            uint32_t key;                                                                 \
+            status = cbor_read_uint(&reader, &key);                                       \
+            if (status != MANIKIN_STATUS_OK)                                              \
+            {                                                                             \
+                break;                                                                    \
+            }                                                                             \
+            switch (key)                                                                  \
+            {                                                                             \
+                SCHEMA(CBOR_SCHEMA_DECODE_FIELD)                                          \
+                default: {                                                                \
+                    /* NOTE: Unknown keys are skipped for forward compatibility */        \
+                    status = cbor_skip_item(&reader);                                     \
+                    break;                                                                \
+                }                                                                         \
+            }                                                                             \
+            seen_fields |= (key < 32u) ? (1u << key) : 0u;                                \
+        }                                                                                 \
+        if (status != MANIKIN_STATUS_OK)                                                  \
+        {                                                                                 \
+            return status;                                                                \
+        }                                                                                 \
+        const uint32_t required_fields = 0u SCHEMA(CBOR_SCHEMA_FIELD_MASK);               \
+        if ((seen_fields & required_fields) != required_fields)                           \
+        {                                                                                 \
+            return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;                           \
+        }                                                                                 \
+        return MANIKIN_STATUS_OK;                                                         \
+    }
+
+CBOR_SCHEMA_DEFINE_CODEC(ads7138_sample, ads7138_sample_data_t, CBOR_SCHEMA_ADS7138_SAMPLE)
+CBOR_SCHEMA_DEFINE_CODEC(sdp810_sample, sdp810_sample_data_t, CBOR_SCHEMA_SDP810_SAMPLE)
+CBOR_SCHEMA_DEFINE_CODEC(bmm350_sample, bmm350_sample_data_t, CBOR_SCHEMA_BMM350_SAMPLE)
+CBOR_SCHEMA_DEFINE_CODEC(bhi360_fusion_sample,
+                         bhi360_fusion_sample_data_t,
+                         CBOR_SCHEMA_BHI360_FUSION_SAMPLE)
@@ -0,0 +1,178 @@
+/**
+ * @file            cbor_schemas.h
+ * @brief           Compile-time CBOR schemas for the sensor sample structs
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef CBOR_SCHEMAS_H
+#define CBOR_SCHEMAS_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "ads7138/ads7138.h"
+#include "sdp810/sdp810.h"
+#include "bmm350/bmm350_driver.h"
+#include "bhi360_fusion/bhi360_fusion.h"
+
+/**
+ * Every sample struct is encoded as a CBOR map with small integer keys (< 24, so each key is a
+ * single byte). Values always use a fixed-width encoding, so the encoded size of each struct is
+ * a compile-time constant and the encoder is a sequence of stores at fixed offsets:
+ *
+ *   U16: uint16_t, major type 0 with 2-byte argument (3 bytes)
+ *   I32: int32_t, major type 0/1 with 4-byte argument (5 bytes)
+ *   F32: float, single precision float (5 bytes)
+ *
+ * The decoders accept any valid encoding (key order, integer width or float precision), so
+ * payloads produced by generic CBOR libraries on the host can be decoded as well.
+ *
+ * Schema entries are X(key, field, type), the field count must stay below 24.
+ */
+#define CBOR_SCHEMA_ADS7138_SAMPLE(X) \
+    X(0u, ch1_mv, U16)                \
+    X(1u, ch2_mv, U16)                \
+    X(2u, ch3_mv, U16)                \
+    X(3u, ch4_mv, U16)                \
+    X(4u, ch5_mv, U16)                \
+    X(5u, ch6_mv, U16)                \
+    X(6u, ch7_mv, U16)                \
+    X(7u, ch8_mv, U16)
+
+#define CBOR_SCHEMA_SDP810_SAMPLE(X) \
+    X(0u, air_pressure_mbar, F32)    \
+    X(1u, air_temp_mbar, F32)
+
+#define CBOR_SCHEMA_BMM350_SAMPLE(X) \
+    X(0u, magneto_x_ut, F32)         \
+    X(1u, magneto_y_ut, F32)         \
+    X(2u, magneto_z_ut, F32)         \
+    X(3u, temperature_mdeg, F32)     \
+    X(4u, sensor_time_us, I32)
+
+#define CBOR_SCHEMA_BHI360_FUSION_SAMPLE(X) \
+    X(0u, pitch_deg, F32)                   \
+    X(1u, roll_deg, F32)                    \
+    X(2u, yaw_deg, F32)
+
+#define CBOR_SCHEMA_U16_ENCODED_SIZE 3u
+#define CBOR_SCHEMA_I32_ENCODED_SIZE 5u
+#define CBOR_SCHEMA_F32_ENCODED_SIZE 5u
+
+#define CBOR_SCHEMA_FIELD_CNT(key, field, type)  +1u
+#define CBOR_SCHEMA_FIELD_SIZE(key, field, type) +1u + CBOR_SCHEMA_##type##_ENCODED_SIZE
+
+/**
+ * @brief Number of fields in a schema
+ */
+#define CBOR_SCHEMA_CNT(SCHEMA) (0u SCHEMA(CBOR_SCHEMA_FIELD_CNT))
+
+/**
+ * @brief Encoded size of a schema in bytes (map header + keys + values)
+ */
+#define CBOR_SCHEMA_ENCODED_SIZE(SCHEMA) (1u SCHEMA(CBOR_SCHEMA_FIELD_SIZE))
+
+#define CBOR_ADS7138_SAMPLE_ENCODED_SIZE       CBOR_SCHEMA_ENCODED_SIZE(CBOR_SCHEMA_ADS7138_SAMPLE)
+#define CBOR_SDP810_SAMPLE_ENCODED_SIZE        CBOR_SCHEMA_ENCODED_SIZE(CBOR_SCHEMA_SDP810_SAMPLE)
+#define CBOR_BMM350_SAMPLE_ENCODED_SIZE        CBOR_SCHEMA_ENCODED_SIZE(CBOR_SCHEMA_BMM350_SAMPLE)
+#define CBOR_BHI360_FUSION_SAMPLE_ENCODED_SIZE \
+    CBOR_SCHEMA_ENCODED_SIZE(CBOR_SCHEMA_BHI360_FUSION_SAMPLE)
+
+    /**
+     * @brief Encode an ADS7138 sample as CBOR map
+     * @param sample Ptr to the sample to encode
+     * @param out Ptr to output buffer, at least CBOR_ADS7138_SAMPLE_ENCODED_SIZE bytes
+     * @param out_max_len Size of the output buffer
+     * @param out_len Ptr to write the number of encoded bytes to
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid sample, out or out_len,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the output buffer is too small
+     */
+    manikin_status_t cbor_encode_ads7138_sample(const ads7138_sample_data_t *sample,
+                                                uint8_t                     *out,
+                                                size_t                       out_max_len,
+                                                size_t                      *out_len);
+
+    /**
+     * @brief Decode an ADS7138 sample from a CBOR map
+     * @param in Ptr to the encoded data
+     * @param len Number of encoded bytes
+     * @param sample Ptr to the sample struct to fill
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid in or sample,
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED on invalid CBOR or missing fields,
+     *         MANIKIN_STATUS_ERR_CONVERSION_FAILED when a value does not fit its field
+     */
+    manikin_status_t cbor_decode_ads7138_sample(const uint8_t         *in,
+                                                size_t                 len,
+                                                ads7138_sample_data_t *sample);
+
+    /**
+     * @brief Encode an SDP810 sample as CBOR map, see cbor_encode_ads7138_sample()
+     */
+    manikin_status_t cbor_encode_sdp810_sample(const sdp810_sample_data_t *sample,
+                                               uint8_t                    *out,
+                                               size_t                      out_max_len,
+                                               size_t                     *out_len);
+
+    /**
+     * @brief Decode an SDP810 sample from a CBOR map, see cbor_decode_ads7138_sample()
+     */
+    manikin_status_t cbor_decode_sdp810_sample(const uint8_t        *in,
+                                               size_t                len,
+                                               sdp810_sample_data_t *sample);
+
+    /**
+     * @brief Encode a BMM350 sample as CBOR map, see cbor_encode_ads7138_sample()
+     */
+    manikin_status_t cbor_encode_bmm350_sample(const bmm350_sample_data_t *sample,
+                                               uint8_t                    *out,
+                                               size_t                      out_max_len,
+                                               size_t                     *out_len);
+
+    /**
+     * @brief Decode a BMM350 sample from a CBOR map, see cbor_decode_ads7138_sample()
+     */
+    manikin_status_t cbor_decode_bmm350_sample(const uint8_t        *in,
+                                               size_t                len,
+                                               bmm350_sample_data_t *sample);
+
+    /**
+     * @brief Encode a BHI360 fusion sample as CBOR map, see cbor_encode_ads7138_sample()
+     */
+    manikin_status_t cbor_encode_bhi360_fusion_sample(const bhi360_fusion_sample_data_t *sample,
+                                                      uint8_t                           *out,
+                                                      size_t                             out_max_len,
+                                                      size_t                            *out_len);
+
+    /**
+     * @brief Decode a BHI360 fusion sample from a CBOR map, see cbor_decode_ads7138_sample()
+     */
+    manikin_status_t cbor_decode_bhi360_fusion_sample(const uint8_t               *in,
+                                                      size_t                       len,
+                                                      bhi360_fusion_sample_data_t *sample);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // CBOR_SCHEMAS_H
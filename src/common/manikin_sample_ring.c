@@ -0,0 +1,243 @@
+/**
+ * @file            manikin_sample_ring.c
+ * @brief           Lock-free single-producer/single-consumer ring of fixed-size sample records
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "manikin_sample_ring.h"
+#include "error_handler/error_handler.h"
+#include <string.h>
+
+#define HASH_MANIKIN_SAMPLE_RING 0x6935A01Bu
+
+#define MANIKIN_SAMPLE_RING_MAX_CAPACITY 0x80000000u
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RING_LOAD_ACQUIRE(PTR)       __atomic_load_n((PTR), __ATOMIC_ACQUIRE)
+#define RING_STORE_RELEASE(PTR, VAL) __atomic_store_n((PTR), (VAL), __ATOMIC_RELEASE)
+#define RING_CAS(PTR, EXPECTED, DESIRED) \
+    __atomic_compare_exchange_n((PTR), (EXPECTED), (DESIRED), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+// NOTE: Without compiler atomics the ring is only safe between an ISR and a thread on one core
+#define RING_LOAD_ACQUIRE(PTR)       (*(volatile const uint32_t *)(PTR))
+#define RING_STORE_RELEASE(PTR, VAL) (*(volatile uint32_t *)(PTR) = (VAL))
+static int
+ring_cas (uint32_t *ptr, uint32_t *expected, uint32_t desired)
+{
+    if (*(volatile uint32_t *)ptr != *expected)
+    {
+        *expected = *(volatile uint32_t *)ptr;
+        return 0;
+    }
+    *(volatile uint32_t *)ptr = desired;
+    return 1;
+}
+#define RING_CAS(PTR, EXPECTED, DESIRED) ring_cas((PTR), (EXPECTED), (DESIRED))
+#endif
+
+static uint8_t *
+manikin_sample_ring_record (const manikin_sample_ring_t *ring, uint32_t idx)
+{
+    return ring->buf + (size_t)(idx & (ring->capacity - 1u)) * ring->record_size;
+}
+
+/**
+ * @brief Describe cnt records starting at idx as (at most) two contiguous spans
+ */
+static void
+manikin_sample_ring_fill_span (const manikin_sample_ring_t *ring,
+                               uint32_t                     idx,
+                               uint32_t                     cnt,
+                               manikin_sample_ring_span_t  *span)
+{
+    const uint32_t to_end = ring->capacity - (idx & (ring->capacity - 1u));
+    span->first           = manikin_sample_ring_record(ring, idx);
+    span->first_cnt       = (cnt < to_end) ? cnt : to_end;
+    span->second_cnt      = cnt - span->first_cnt;
+    span->second          = (span->second_cnt != 0) ? ring->buf : NULL;
+}
+
+manikin_status_t
+manikin_sample_ring_init (manikin_sample_ring_t *ring)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring->buf != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING,
+                   ring->record_size != 0 && ring->capacity >= 2u
+                       && ring->capacity <= MANIKIN_SAMPLE_RING_MAX_CAPACITY
+                       && (ring->capacity & (ring->capacity - 1u)) == 0,
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring->head           = 0;
+    ring->reserved       = 0;
+    ring->dropped_newest = 0;
+    ring->dropped_oldest = 0;
+    ring->tail           = 0;
+    ring->peek_tail      = 0;
+    ring->peeked         = 0;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+manikin_sample_ring_reserve (manikin_sample_ring_t      *ring,
+                             uint32_t                    cnt,
+                             manikin_sample_ring_span_t *span)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, span != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING,
+                   cnt != 0 && cnt <= ring->capacity,
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring->reserved = 0;
+    uint32_t tail  = RING_LOAD_ACQUIRE(&ring->tail);
+    uint32_t space = ring->capacity - (ring->head - tail);
+    while (space < cnt)
+    {
+        if (ring->policy != MANIKIN_SAMPLE_RING_DROP_OLDEST)
+        {
+            RING_STORE_RELEASE(&ring->dropped_newest, ring->dropped_newest + cnt);
+            return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+        }
+        //
+        // Make room by moving tail forward. This races with the consumer releasing records, so
+        // it is a CAS: when the consumer was first the free space is simply recomputed.
+        //
+        const uint32_t deficit = cnt - space;
+        if (RING_CAS(&ring->tail, &tail, tail + deficit))
+        {
+            RING_STORE_RELEASE(&ring->dropped_oldest, ring->dropped_oldest + deficit);
+            break;
+        }
+        space = ring->capacity - (ring->head - tail);
+    }
+    ring->reserved = cnt;
+    manikin_sample_ring_fill_span(ring, ring->head, cnt, span);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+manikin_sample_ring_commit (manikin_sample_ring_t *ring, uint32_t cnt)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(
+        HASH_MANIKIN_SAMPLE_RING, cnt <= ring->reserved, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring->reserved = 0;
+    // NOTE: Release ordering makes the record contents visible before the new head
+    RING_STORE_RELEASE(&ring->head, ring->head + cnt);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+manikin_sample_ring_peek (manikin_sample_ring_t      *ring,
+                          uint32_t                    max_cnt,
+                          manikin_sample_ring_span_t *span)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, span != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    const uint32_t tail  = RING_LOAD_ACQUIRE(&ring->tail);
+    const uint32_t head  = RING_LOAD_ACQUIRE(&ring->head);
+    uint32_t       avail = head - tail;
+    // NOTE: The producer can move head and tail in between both loads, release catches that
+    avail           = (avail > ring->capacity) ? ring->capacity : avail;
+    avail           = (avail > max_cnt) ? max_cnt : avail;
+    ring->peek_tail = tail;
+    ring->peeked    = avail;
+    manikin_sample_ring_fill_span(ring, tail, avail, span);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+manikin_sample_ring_release (manikin_sample_ring_t *ring, uint32_t cnt)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(
+        HASH_MANIKIN_SAMPLE_RING, cnt <= ring->peeked, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring->peeked = 0;
+    if (ring->policy != MANIKIN_SAMPLE_RING_DROP_OLDEST)
+    {
+        RING_STORE_RELEASE(&ring->tail, ring->peek_tail + cnt);
+        return MANIKIN_STATUS_OK;
+    }
+    //
+    // The producer only overwrites records after moving tail past them. If tail is still where
+    // the peek started, nothing that was read has been overwritten.
+    //
+    uint32_t expected = ring->peek_tail;
+    if (!RING_CAS(&ring->tail, &expected, ring->peek_tail + cnt))
+    {
+        return MANIKIN_STATUS_ERR_BUFFER_OVERRUN;
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+manikin_sample_ring_push (manikin_sample_ring_t *ring, const void *record)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, record != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_sample_ring_span_t span;
+    manikin_status_t           status = manikin_sample_ring_reserve(ring, 1u, &span);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    memcpy(span.first, record, ring->record_size);
+    return manikin_sample_ring_commit(ring, 1u);
+}
+
+manikin_status_t
+manikin_sample_ring_pop (manikin_sample_ring_t *ring, void *record)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, record != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_sample_ring_span_t span;
+    manikin_status_t           status = manikin_sample_ring_peek(ring, 1u, &span);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (span.first_cnt == 0)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+    memcpy(record, span.first, ring->record_size);
+    return manikin_sample_ring_release(ring, 1u);
+}
+
+uint32_t
+manikin_sample_ring_count (const manikin_sample_ring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return 0;
+    }
+    const uint32_t tail = RING_LOAD_ACQUIRE(&ring->tail);
+    const uint32_t used = RING_LOAD_ACQUIRE(&ring->head) - tail;
+    return (used > ring->capacity) ? ring->capacity : used;
+}
+
+manikin_status_t
+manikin_sample_ring_get_stats (const manikin_sample_ring_t *ring,
+                               manikin_sample_ring_stats_t *stats)
+{
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, ring != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_MANIKIN_SAMPLE_RING, stats != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    stats->dropped_newest = RING_LOAD_ACQUIRE(&ring->dropped_newest);
+    stats->dropped_oldest = RING_LOAD_ACQUIRE(&ring->dropped_oldest);
+    return MANIKIN_STATUS_OK;
+}
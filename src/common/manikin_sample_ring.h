@@ -0,0 +1,194 @@
+/**
+ * @file            manikin_sample_ring.h
+ * @brief           Lock-free single-producer/single-consumer ring of fixed-size sample records
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef MANIKIN_SAMPLE_RING_H
+#define MANIKIN_SAMPLE_RING_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+
+/**
+ * One producer (e.g. the sample ISR) writes records, one consumer (e.g. the flash writer or
+ * transmit thread) reads them. No locks are taken, head is only written by the producer and
+ * tail by the consumer. With MANIKIN_SAMPLE_RING_DROP_OLDEST the producer may also advance tail,
+ * the consumer then detects the overrun when releasing the records it peeked.
+ *
+ * Records are reserved/peeked in batches. A batch can wrap around the end of the storage, so it
+ * is handed out as (at most) two contiguous spans which point straight into the ring storage.
+ */
+
+/*
+ * NOTE: head and tail are kept this many bytes apart, so producer and consumer do not share a
+ * cache-line. MCUs without data cache can lower this in manikin_software_conf.h to save RAM.
+ */
+#ifndef MANIKIN_SAMPLE_RING_CACHE_LINE_SIZE
+#define MANIKIN_SAMPLE_RING_CACHE_LINE_SIZE 64u
+#endif
+
+    typedef enum
+    {
+        MANIKIN_SAMPLE_RING_DROP_NEWEST = 0, /* A full ring rejects new records */
+        MANIKIN_SAMPLE_RING_DROP_OLDEST,     /* A full ring overwrites the oldest records */
+    } manikin_sample_ring_policy_t;
+
+    typedef struct
+    {
+        uint8_t *first;      /* First contiguous run of records */
+        uint32_t first_cnt;  /* Number of records in first */
+        uint8_t *second;     /* Continuation at the start of the storage, NULL if not wrapped */
+        uint32_t second_cnt; /* Number of records in second */
+    } manikin_sample_ring_span_t;
+
+    typedef struct
+    {
+        uint32_t dropped_newest; /* Records rejected because the ring was full */
+        uint32_t dropped_oldest; /* Records overwritten before the consumer released them */
+    } manikin_sample_ring_stats_t;
+
+    typedef struct
+    {
+        uint8_t *buf;         /* Caller-provided storage of capacity * record_size bytes */
+        uint32_t record_size; /* Size of one record in bytes */
+        uint32_t capacity;    /* Number of records, has to be a power of two */
+        uint8_t  policy;      /* manikin_sample_ring_policy_t */
+        uint8_t  pad0[MANIKIN_SAMPLE_RING_CACHE_LINE_SIZE];
+        /* Producer side */
+        uint32_t head;
+        uint32_t reserved;
+        uint32_t dropped_newest;
+        uint32_t dropped_oldest;
+        uint8_t  pad1[MANIKIN_SAMPLE_RING_CACHE_LINE_SIZE];
+        /* Consumer side */
+        uint32_t tail;
+        uint32_t peek_tail;
+        uint32_t peeked;
+    } manikin_sample_ring_t;
+
+    /**
+     * @brief Initialize an empty ring, buf, record_size, capacity and policy have to be filled
+     *        in by the caller beforehand
+     * @param ring Ptr to the ring
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring or buf is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when record_size is 0 or capacity is not a
+     *         power of two between 2 and 2^31
+     */
+    manikin_status_t manikin_sample_ring_init(manikin_sample_ring_t *ring);
+
+    /**
+     * @brief Reserve space for cnt records (producer only)
+     *        Fill the spans and publish them with manikin_sample_ring_commit(). With
+     *        MANIKIN_SAMPLE_RING_DROP_OLDEST the oldest records are dropped to make room.
+     * @param ring Ptr to the ring
+     * @param cnt Number of records, at most capacity
+     * @param span Ptr to the span which receives the reserved storage
+     * @return MANIKIN_STATUS_OK when all cnt records were reserved,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring or span is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when cnt is 0 or exceeds capacity, or when
+     *         the ring is full with MANIKIN_SAMPLE_RING_DROP_NEWEST (the cnt records are counted
+     *         as dropped)
+     */
+    manikin_status_t manikin_sample_ring_reserve(manikin_sample_ring_t      *ring,
+                                                 uint32_t                    cnt,
+                                                 manikin_sample_ring_span_t *span);
+
+    /**
+     * @brief Publish the first cnt records of the last reservation to the consumer (producer only)
+     * @param ring Ptr to the ring
+     * @param cnt Number of records written, at most the number reserved
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when cnt exceeds the reservation
+     */
+    manikin_status_t manikin_sample_ring_commit(manikin_sample_ring_t *ring, uint32_t cnt);
+
+    /**
+     * @brief Look at up to max_cnt of the oldest records without copying them (consumer only)
+     *        Records stay in the ring until manikin_sample_ring_release() is called.
+     * @param ring Ptr to the ring
+     * @param max_cnt Maximum number of records to peek
+     * @param span Ptr to the span which receives the records, first_cnt + second_cnt is 0 when
+     *        the ring is empty
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring or span is NULL
+     */
+    manikin_status_t manikin_sample_ring_peek(manikin_sample_ring_t      *ring,
+                                              uint32_t                    max_cnt,
+                                              manikin_sample_ring_span_t *span);
+
+    /**
+     * @brief Free the first cnt records of the last peek (consumer only)
+     * @param ring Ptr to the ring
+     * @param cnt Number of records consumed, at most the number peeked
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when cnt exceeds the peeked records,
+     *         MANIKIN_STATUS_ERR_BUFFER_OVERRUN when the producer overwrote peeked records in
+     *         the meantime (MANIKIN_SAMPLE_RING_DROP_OLDEST), discard what was read and peek again
+     */
+    manikin_status_t manikin_sample_ring_release(manikin_sample_ring_t *ring, uint32_t cnt);
+
+    /**
+     * @brief Copy one record into the ring (producer only)
+     * @param ring Ptr to the ring
+     * @param record Ptr to record_size bytes
+     * @return See manikin_sample_ring_reserve()
+     */
+    manikin_status_t manikin_sample_ring_push(manikin_sample_ring_t *ring, const void *record);
+
+    /**
+     * @brief Copy the oldest record out of the ring (consumer only)
+     * @param ring Ptr to the ring
+     * @param record Ptr to record_size bytes
+     * @return MANIKIN_STATUS_OK when a record was copied,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring or record is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the ring is empty,
+     *         MANIKIN_STATUS_ERR_BUFFER_OVERRUN when the record was overwritten while copying
+     */
+    manikin_status_t manikin_sample_ring_pop(manikin_sample_ring_t *ring, void *record);
+
+    /**
+     * @brief Number of records the consumer can read
+     * @param ring Ptr to the ring
+     * @return Number of committed records, 0 when ring is NULL
+     */
+    uint32_t manikin_sample_ring_count(const manikin_sample_ring_t *ring);
+
+    /**
+     * @brief Read the drop counters, safe to call from any context
+     * @param ring Ptr to the ring
+     * @param stats Ptr to the stats struct to fill
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ring or stats is NULL
+     */
+    manikin_status_t manikin_sample_ring_get_stats(const manikin_sample_ring_t *ring,
+                                                   manikin_sample_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // MANIKIN_SAMPLE_RING_H
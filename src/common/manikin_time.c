@@ -0,0 +1,82 @@
+/**
+ * @file            manikin_time.c
+ * @brief           64-bit monotonic microsecond time base and sample timestamping
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "manikin_time.h"
+#include <manikin_platform.h>
+
+#ifndef MANIKIN_HAL_TICK_PERIOD_US
+#define MANIKIN_HAL_TICK_PERIOD_US 1000u
+#endif
+
+static uint32_t manikin_time_last_tick;
+static uint32_t manikin_time_wraps;
+static uint64_t manikin_time_offset;
+
+void
+manikin_time_init (void)
+{
+    // WARNING: Cast in line below
+    // NOTE: Only the lower 32 bits are used, so 32 and 64-bit HAL ticks wrap the same way
+    manikin_time_last_tick = (uint32_t)MANIKIN_HAL_GET_TICK();
+    manikin_time_wraps     = 0;
+    manikin_time_offset    = manikin_time_last_tick;
+}
+
+uint64_t
+manikin_time_now_us (void)
+{
+    // WARNING: Cast in line below
+    // NOTE: Only the lower 32 bits are used, so 32 and 64-bit HAL ticks wrap the same way
+    const uint32_t tick = (uint32_t)MANIKIN_HAL_GET_TICK();
+    if (tick < manikin_time_last_tick)
+    {
+        manikin_time_wraps++;
+    }
+    manikin_time_last_tick = tick;
+    const uint64_t ticks   = ((uint64_t)manikin_time_wraps << 32) | tick;
+    return (ticks - manikin_time_offset) * MANIKIN_HAL_TICK_PERIOD_US;
+}
+
+void
+manikin_sample_stamp (manikin_sensor_ctx_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return;
+    }
+    sensor->sample.timestamp_us = manikin_time_now_us();
+    sensor->sample.seq++;
+    sensor->sample.sensor_id = sensor->i2c_addr;
+    sensor->sample.status    = MANIKIN_STATUS_ERR_READ_FAIL;
+}
+
+void
+manikin_sample_complete (manikin_sensor_ctx_t *sensor)
+{
+    if (sensor == NULL)
+    {
+        return;
+    }
+    sensor->sample.status = MANIKIN_STATUS_OK;
+}
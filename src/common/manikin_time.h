@@ -0,0 +1,70 @@
+/**
+ * @file            manikin_time.h
+ * @brief           64-bit monotonic microsecond time base and sample timestamping
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef MANIKIN_TIME_H
+#define MANIKIN_TIME_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+
+/**
+ * MANIKIN_HAL_GET_TICK() wraps (after ~49 days for a 32-bit millisecond tick). The time base
+ * counts these wraps, so it never goes backwards. It has to be read at least once per wrap,
+ * every sensor read does this already. MANIKIN_HAL_TICK_PERIOD_US in manikin_platform.h sets the
+ * length of one HAL tick, the default is 1000 us.
+ */
+
+    /**
+     * @brief Restart the time base, the next reading continues from the current HAL tick
+     */
+    void manikin_time_init(void);
+
+    /**
+     * @brief Get the time since manikin_time_init() (or start-up) in microseconds
+     * @note  Not reentrant, call it from one context (e.g. the sampling thread)
+     * @return Monotonic time in microseconds, resolution is one HAL tick
+     */
+    uint64_t manikin_time_now_us(void);
+
+    /**
+     * @brief Stamp a new sample of a sensor, call right before its data is read from the bus
+     *        Fills sensor->sample with the time, the next sequence number and the i2c address.
+     *        The status is MANIKIN_STATUS_ERR_READ_FAIL until manikin_sample_complete().
+     * @param sensor Ptr to the sensor context
+     */
+    void manikin_sample_stamp(manikin_sensor_ctx_t *sensor);
+
+    /**
+     * @brief Mark the sample stamped by manikin_sample_stamp() as successfully read
+     * @param sensor Ptr to the sensor context
+     */
+    void manikin_sample_complete(manikin_sensor_ctx_t *sensor);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // MANIKIN_TIME_H
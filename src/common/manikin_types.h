@@ -49,6 +49,9 @@ extern "C"
         MANIKIN_STATUS_ERR_INVALID_PACKET_CRC_FAIL,
         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED,
         MANIKIN_STATUS_ERR_CONVERSION_FAILED,
+        MANIKIN_STATUS_ERR_BUS_OVER_BUDGET,
+        MANIKIN_STATUS_ERR_BUFFER_OVERRUN,
+        MANIKIN_STATUS_ERR_INVALID_CONFIG,
     } manikin_status_t;
 
     typedef enum
@@ -78,9 +81,32 @@ extern "C"
 
     typedef struct
     {
-        manikin_i2c_inst_t i2c;
-        uint8_t            i2c_addr;
-        uint8_t            needs_reinit;
+        uint32_t retry_tick; /* HAL tick from which a backed-off sensor is sampled again */
+        uint8_t  fault_cnt;  /* Consecutive device faults, drives the back-off time */
+        uint8_t  skipped;    /* Set when the start hook skipped the sample */
+        uint8_t  bus_epoch;  /* Bus power cycles this sensor has been re-initialized for */
+    } manikin_sensor_recovery_t;
+
+    /**
+     * @brief Header of one sample, stamped by the driver read path at acquisition time
+     */
+    typedef struct
+    {
+        uint64_t timestamp_us; /* manikin_time_now_us() right before the data was read */
+        uint32_t seq;          /* Read attempts of this sensor, gaps show skipped samples */
+        uint8_t  sensor_id;    /* i2c address of the sensor */
+        uint8_t  status;       /* manikin_status_t of the read */
+    } manikin_sample_header_t;
+
+    typedef struct
+    {
+        manikin_i2c_inst_t        i2c;
+        uint8_t                   i2c_addr;
+        uint8_t                   needs_reinit;
+        uint8_t                   drdy_irq; /* Set before init: reads follow the data-ready line */
+        void                     *driver_ctx; /* Optional per-instance driver state, see driver */
+        manikin_sensor_recovery_t recovery; /* Fault isolation state, owned by sample_timer */
+        manikin_sample_header_t   sample;   /* Header of the last read, see manikin_time.h */
     } manikin_sensor_ctx_t;
 
     typedef struct
@@ -0,0 +1,181 @@
+/**
+ * @file            drdy_sampler.c
+ * @brief           Event-driven sampling of sensors on their data-ready interrupt lines
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+
+#include "drdy_sampler.h"
+#include "manikin_platform.h"
+#include "error_handler/error_handler.h"
+
+#define HASH_DRDY_SAMPLER 0x949931A2u
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DRDY_FETCH_OR(PTR, VAL)  __atomic_fetch_or((PTR), (VAL), __ATOMIC_ACQ_REL)
+#define DRDY_EXCHANGE(PTR, VAL)  __atomic_exchange_n((PTR), (VAL), __ATOMIC_ACQ_REL)
+#define DRDY_LOAD_ACQUIRE(PTR)   __atomic_load_n((PTR), __ATOMIC_ACQUIRE)
+#define DRDY_INCREMENT(PTR)      __atomic_fetch_add((PTR), 1u, __ATOMIC_RELAXED)
+#else
+// NOTE: Without compiler atomics the read-modify-writes below can lose an interrupt
+#define DRDY_FETCH_OR(PTR, VAL)  drdy_fetch_or((PTR), (VAL))
+#define DRDY_EXCHANGE(PTR, VAL)  drdy_exchange((PTR), (VAL))
+#define DRDY_LOAD_ACQUIRE(PTR)   (*(volatile const drdy_sampler_mask_t *)(PTR))
+#define DRDY_INCREMENT(PTR)      ((*(volatile uint32_t *)(PTR))++)
+static drdy_sampler_mask_t
+drdy_fetch_or (drdy_sampler_mask_t *ptr, drdy_sampler_mask_t val)
+{
+    const drdy_sampler_mask_t old = *(volatile drdy_sampler_mask_t *)ptr;
+    *(volatile drdy_sampler_mask_t *)ptr = (drdy_sampler_mask_t)(old | val);
+    return old;
+}
+static drdy_sampler_mask_t
+drdy_exchange (drdy_sampler_mask_t *ptr, drdy_sampler_mask_t val)
+{
+    const drdy_sampler_mask_t old = *(volatile drdy_sampler_mask_t *)ptr;
+    *(volatile drdy_sampler_mask_t *)ptr = val;
+    return old;
+}
+#endif
+
+/**
+ * @brief Data-ready interrupt of one entry (ISR-context!), only marks the entry pending
+ */
+static void
+drdy_sampler_isr (void *user)
+{
+    drdy_sampler_entry_t     *entry = (drdy_sampler_entry_t *)user;
+    const drdy_sampler_mask_t bit   = (drdy_sampler_mask_t)(1u << entry->idx);
+    if (DRDY_FETCH_OR(&entry->owner->pending, bit) & bit)
+    {
+        // NOTE: The previous sample was not read yet, the sensor overwrote it
+        DRDY_INCREMENT(&entry->owner->overruns);
+    }
+}
+
+static manikin_status_t
+drdy_sampler_check_params (const drdy_sampler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER, ctx->entries != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER,
+                   (ctx->entry_cnt > 0 && ctx->entry_cnt <= DRDY_SAMPLER_MAX_ENTRIES),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        MANIKIN_ASSERT(
+            HASH_DRDY_SAMPLER, ctx->entries[i].sensor != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+        MANIKIN_ASSERT(
+            HASH_DRDY_SAMPLER, ctx->entries[i].read != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+drdy_sampler_init (drdy_sampler_ctx_t *ctx)
+{
+    manikin_status_t status = drdy_sampler_check_params(ctx);
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER, (status == MANIKIN_STATUS_OK), status);
+    ctx->pending  = 0;
+    ctx->overruns = 0;
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        drdy_sampler_entry_t *entry = &ctx->entries[i];
+        entry->owner                = ctx;
+        entry->idx                  = i;
+        if (MANIKIN_GPIO_IRQ_ENABLE(entry->gpio, drdy_sampler_isr, entry) != 0)
+        {
+            // NOTE: Leave no half-registered sampler behind
+            while (i-- > 0)
+            {
+                MANIKIN_GPIO_IRQ_DISABLE(ctx->entries[i].gpio);
+            }
+            MANIKIN_ASSERT(HASH_DRDY_SAMPLER, 0, MANIKIN_STATUS_ERR_PERIPHERAL_INIT_FAIL);
+        }
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+drdy_sampler_deinit (drdy_sampler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_status_t status = MANIKIN_STATUS_OK;
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        if (MANIKIN_GPIO_IRQ_DISABLE(ctx->entries[i].gpio) != 0)
+        {
+            status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+        }
+    }
+    DRDY_EXCHANGE(&ctx->pending, 0);
+    return status;
+}
+
+manikin_status_t
+drdy_sampler_process (drdy_sampler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_DRDY_SAMPLER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_status_t    result  = MANIKIN_STATUS_OK;
+    drdy_sampler_mask_t retry   = 0;
+    drdy_sampler_mask_t pending = DRDY_EXCHANGE(&ctx->pending, 0);
+    for (uint8_t i = 0; pending != 0; i++, pending >>= 1)
+    {
+        if ((pending & 1u) == 0)
+        {
+            continue;
+        }
+        drdy_sampler_entry_t *entry  = &ctx->entries[i];
+        manikin_status_t      status = MANIKIN_STATUS_OK;
+        if (ctx->timer != NULL)
+        {
+            status = sample_timer_start_cb_handler(ctx->timer, entry->sensor);
+        }
+        const manikin_status_t read_status
+            = (status == MANIKIN_STATUS_OK) ? entry->read(entry->user) : status;
+        status = (ctx->timer != NULL)
+                     ? sample_timer_end_cb_handler(ctx->timer, entry->sensor, read_status)
+                     : MANIKIN_STATUS_OK;
+        if (read_status != MANIKIN_STATUS_OK || status != MANIKIN_STATUS_OK)
+        {
+            retry |= (drdy_sampler_mask_t)(1u << i);
+        }
+        if (result == MANIKIN_STATUS_OK)
+        {
+            result = (status != MANIKIN_STATUS_OK) ? status : read_status;
+        }
+    }
+    if (retry != 0)
+    {
+        DRDY_FETCH_OR(&ctx->pending, retry);
+    }
+    return result;
+}
+
+drdy_sampler_mask_t
+drdy_sampler_pending (const drdy_sampler_ctx_t *ctx)
+{
+    if (ctx == NULL)
+    {
+        return 0;
+    }
+    return DRDY_LOAD_ACQUIRE(&ctx->pending);
+}
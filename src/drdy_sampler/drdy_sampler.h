@@ -0,0 +1,119 @@
+/**
+ * @file            drdy_sampler.h
+ * @brief           Event-driven sampling of sensors on their data-ready interrupt lines
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef DRDY_SAMPLER_H
+#define DRDY_SAMPLER_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "sample_timer/sample_timer.h"
+
+/**
+ * Instead of polling every sensor at a fixed rate, each sensor is read once its data-ready line
+ * fires. The ISR only marks the entry pending, drdy_sampler_process() does the bus traffic from
+ * thread context. No "no new data" status reads are needed and a sample is read one conversion
+ * time after it was started, instead of up to one poll period later.
+ *
+ * The sensors have to be initialized with manikin_sensor_ctx_t.drdy_irq set, so that they route
+ * their data-ready signal to the interrupt pin.
+ */
+#define DRDY_SAMPLER_MAX_ENTRIES 16u
+
+    /**
+     * @brief Sample function of one sensor, e.g. a wrapper around vl6180x_read_sensor()
+     * @param user Ptr given in the entry
+     * @return Status of the read, passed on to sample_timer_end_cb_handler()
+     */
+    typedef manikin_status_t (*drdy_sampler_read_fn_t)(void *user);
+
+    typedef uint16_t drdy_sampler_mask_t; /* Bitmask of entries */
+
+    struct drdy_sampler_ctx;
+
+    typedef struct
+    {
+        manikin_sensor_ctx_t    *sensor; /* Sensor handed to the sample_timer recovery hooks */
+        drdy_sampler_read_fn_t   read;   /* Called after every data-ready interrupt */
+        void                    *user;   /* Passed to read */
+        manikin_gpio_inst_t      gpio;   /* Data-ready line of the sensor */
+        struct drdy_sampler_ctx *owner;  /* Set by init, used by the ISR */
+        uint8_t                  idx;    /* Set by init, used by the ISR */
+    } drdy_sampler_entry_t;
+
+    typedef struct drdy_sampler_ctx
+    {
+        sample_timer_ctx_t   *timer;     /* Initialized timer for the recovery hooks, or NULL */
+        drdy_sampler_entry_t *entries;   /* Caller-provided entry table */
+        uint8_t               entry_cnt; /* At most DRDY_SAMPLER_MAX_ENTRIES */
+        drdy_sampler_mask_t   pending;   /* Entries signalled by their data-ready line */
+        uint32_t              overruns;  /* Interrupts of entries which were still pending */
+    } drdy_sampler_ctx_t;
+
+    /**
+     * @brief Register the data-ready interrupt of every entry
+     * @param ctx Ptr to the sampler context, entries and entry_cnt have to be filled in by the
+     *        caller beforehand
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx, entries or a sensor or read fn is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when entry_cnt is out of range,
+     *         MANIKIN_STATUS_ERR_PERIPHERAL_INIT_FAIL when an interrupt could not be enabled
+     */
+    manikin_status_t drdy_sampler_init(drdy_sampler_ctx_t *ctx);
+
+    /**
+     * @brief Unregister the data-ready interrupts, pending reads are dropped
+     * @param ctx Ptr to the sampler context
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx is NULL,
+     *         MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG when an interrupt could not be disabled
+     */
+    manikin_status_t drdy_sampler_deinit(drdy_sampler_ctx_t *ctx);
+
+    /**
+     * @brief Read every sensor whose data-ready line fired since the last call
+     *        Call outside ISR-context, e.g. from a thread woken by the interrupt. With a timer
+     *        the reads are wrapped in the sample_timer start/end hooks, like sample_scheduler.
+     *        A read which fails or is skipped stays pending: level triggered lines (VL6180X)
+     *        do not fire again before the sensor is read, so it is retried on the next call.
+     * @param ctx Ptr to the sampler context
+     * @return MANIKIN_STATUS_OK when all pending reads succeeded (or none were pending),
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx is NULL,
+     *         otherwise the status of the first failed or skipped read
+     */
+    manikin_status_t drdy_sampler_process(drdy_sampler_ctx_t *ctx);
+
+    /**
+     * @brief Check whether reads are pending, e.g. to decide whether to sleep
+     * @param ctx Ptr to the sampler context
+     * @return Bitmask of the pending entries, 0 when ctx is NULL
+     */
+    drdy_sampler_mask_t drdy_sampler_pending(const drdy_sampler_ctx_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // DRDY_SAMPLER_H
@@ -150,6 +150,28 @@ manikin_i2c_read_reg16 (manikin_i2c_inst_t i2c_inst, uint8_t i2c_addr, uint16_t
     return MANIKIN_STATUS_OK;
 }
 
+manikin_status_t
+manikin_i2c_read_regs (manikin_i2c_inst_t i2c_inst,
+                       const uint8_t      i2c_addr,
+                       const uint16_t     reg,
+                       uint8_t           *data,
+                       const size_t       len)
+{
+    MANIKIN_ASSERT(HASH_I2C, (i2c_inst != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
+    uint8_t bytes[2];
+    bytes[0] = GET_UPPER_8_BITS_OF_SHORT(reg);
+    bytes[1] = GET_LOWER_8_BITS_OF_SHORT(reg);
+    if (MANIKIN_I2C_HAL_WRITE_BYTES(i2c_inst, i2c_addr, bytes, sizeof(bytes)) != sizeof(bytes))
+    {
+        return MANIKIN_STATUS_ERR_READ_FAIL;
+    }
+    if (MANIKIN_I2C_HAL_READ_BYTES(i2c_inst, i2c_addr, data, len) != len)
+    {
+        return MANIKIN_STATUS_ERR_READ_FAIL;
+    }
+    return MANIKIN_STATUS_OK;
+}
+
 size_t
 manikin_i2c_read_bytes (manikin_i2c_inst_t i2c_inst,
                         const uint8_t      i2c_addr,
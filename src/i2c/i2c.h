@@ -116,6 +116,22 @@ extern "C"
                                             uint16_t           reg,
                                             uint8_t           *data);
 
+    /**
+     * @brief Reads len consecutive registers of an i2c-device in one burst
+     * @param i2c_inst The direct (ptr) handle to the i2c peripheral used for the device
+     * @param i2c_addr The address of the I2C device
+     * @param reg      The (16-bit) address of the first register
+     * @param data     A pointer to the buffer to save the register values to
+     * @param len      The number of registers to read
+     * @return MANIKIN_STATUS_OK when all registers were read,
+     *         MANIKIN_STATUS_ERR_READ_FAIL otherwise
+     */
+    manikin_status_t manikin_i2c_read_regs(manikin_i2c_inst_t i2c_inst,
+                                           uint8_t            i2c_addr,
+                                           uint16_t           reg,
+                                           uint8_t           *data,
+                                           size_t             len);
+
     /**
      * @brief Reads multiple bytes from an i2c-device
      * @param i2c_inst The direct (ptr) handle to the i2c peripheral used for the device
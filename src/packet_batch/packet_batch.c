@@ -0,0 +1,205 @@
+/**
+ * @file            packet_batch.c
+ * @brief           Packs multiple sensor samples into a single packet_parser payload
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "packet_batch.h"
+#include "error_handler/error_handler.h"
+#include "common/manikin_bit_manipulation.h"
+#include <string.h>
+
+#define HASH_PACKET_BATCH 0xB137E6DDu
+
+static void
+packet_batch_reset (packet_batch_ctx_t *ctx)
+{
+    ctx->len        = PACKET_BATCH_HEADER_SIZE;
+    ctx->sample_cnt = 0;
+    ctx->base_tick  = 0;
+    ctx->prev_tick  = 0;
+}
+
+static size_t
+packet_batch_get_flush_len (const packet_batch_ctx_t *ctx)
+{
+    return (ctx->flush_len == 0u) ? ctx->buf_size : ctx->flush_len;
+}
+
+static uint32_t
+packet_batch_read_u32 (const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16)
+           | ((uint32_t)buf[3] << 24);
+}
+
+manikin_status_t
+packet_batch_init (packet_batch_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, ctx->buf != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH,
+                   (ctx->buf_size > PACKET_BATCH_HEADER_SIZE + PACKET_BATCH_RECORD_HEADER_SIZE
+                    && ctx->buf_size <= PACKET_PARSER_MAX_PAYLOAD_LEN),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH,
+                   ctx->flush_len <= ctx->buf_size,
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, ctx->max_samples > 0, MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    packet_batch_reset(ctx);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_batch_add (packet_batch_ctx_t *ctx,
+                  uint8_t             sensor_id,
+                  uint32_t            tick,
+                  const uint8_t      *data,
+                  uint8_t             len)
+{
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, data != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    const size_t record_len = PACKET_BATCH_RECORD_HEADER_SIZE + len;
+    if (ctx->sample_cnt >= ctx->max_samples || ctx->len + record_len > ctx->buf_size)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+
+    if (ctx->sample_cnt == 0)
+    {
+        ctx->base_tick = tick;
+        ctx->prev_tick = tick;
+    }
+
+    // NOTE: Unsigned subtraction keeps the delta correct across a tick wrap-around
+    const uint32_t tick_delta = tick - ctx->prev_tick;
+    if (tick_delta > PACKET_BATCH_MAX_TICK_DELTA)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+
+    uint8_t *record = &ctx->buf[ctx->len];
+    record[0]       = sensor_id;
+    record[1]       = GET_LOWER_8_BITS_OF_SHORT(tick_delta);
+    record[2]       = GET_UPPER_8_BITS_OF_SHORT(tick_delta);
+    record[3]       = len;
+    memcpy(&record[PACKET_BATCH_RECORD_HEADER_SIZE], data, len);
+
+    ctx->len += record_len;
+    ctx->prev_tick = tick;
+    ctx->sample_cnt++;
+    return MANIKIN_STATUS_OK;
+}
+
+uint8_t
+packet_batch_flush_needed (const packet_batch_ctx_t *ctx, uint32_t now_tick)
+{
+    if (ctx == NULL || ctx->sample_cnt == 0)
+    {
+        return 0;
+    }
+    if (ctx->sample_cnt >= ctx->max_samples || ctx->len >= packet_batch_get_flush_len(ctx))
+    {
+        return 1;
+    }
+    if (ctx->max_latency_ticks != 0u && (now_tick - ctx->base_tick) >= ctx->max_latency_ticks)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+manikin_status_t
+packet_batch_flush (packet_batch_ctx_t *ctx, packet_parser_cmd_t *cmd)
+{
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, cmd != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (ctx->sample_cnt == 0)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+
+    ctx->buf[0] = ctx->sample_cnt;
+    ctx->buf[1] = GET_LOWER_8_BITS_OF_SHORT(ctx->base_tick);
+    ctx->buf[2] = GET_UPPER_8_BITS_OF_SHORT(ctx->base_tick);
+    ctx->buf[3] = GET_LOWER_8_BITS_OF_SHORT(ctx->base_tick >> 16);
+    ctx->buf[4] = GET_UPPER_8_BITS_OF_SHORT(ctx->base_tick >> 16);
+
+    // WARNING: Cast in line below
+    // NOTE: len is bounded by buf_size, which is checked against PACKET_PARSER_MAX_PAYLOAD_LEN
+    cmd->len  = (uint16_t)ctx->len;
+    cmd->data = ctx->buf;
+
+    packet_batch_reset(ctx);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_batch_reader_init (packet_batch_reader_t *reader, const packet_parser_cmd_t *cmd)
+{
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, reader != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, cmd != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, cmd->data != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (cmd->len < PACKET_BATCH_HEADER_SIZE)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    reader->data      = cmd->data;
+    reader->len       = cmd->len;
+    reader->offset    = PACKET_BATCH_HEADER_SIZE;
+    reader->remaining = cmd->data[0];
+    reader->tick      = packet_batch_read_u32(&cmd->data[1]);
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_batch_reader_next (packet_batch_reader_t *reader, packet_batch_sample_t *sample)
+{
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, reader != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_PACKET_BATCH, sample != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (reader->remaining == 0)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+    if (reader->offset + PACKET_BATCH_RECORD_HEADER_SIZE > reader->len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    const uint8_t *record = &reader->data[reader->offset];
+    const uint8_t  len    = record[3];
+    if (reader->offset + PACKET_BATCH_RECORD_HEADER_SIZE + len > reader->len)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    reader->tick += CONSTRUCT_SHORT_FROM_BYTES(record[2], record[1]);
+    sample->sensor_id = record[0];
+    sample->len       = len;
+    sample->tick      = reader->tick;
+    sample->data      = &record[PACKET_BATCH_RECORD_HEADER_SIZE];
+
+    reader->offset += PACKET_BATCH_RECORD_HEADER_SIZE + len;
+    reader->remaining--;
+    return MANIKIN_STATUS_OK;
+}
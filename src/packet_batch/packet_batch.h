@@ -0,0 +1,155 @@
+/**
+ * @file            packet_batch.h
+ * @brief           Packs multiple sensor samples into a single packet_parser payload
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef PACKET_BATCH_H
+#define PACKET_BATCH_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "packet_parser/packet_parser.h"
+
+/**
+ * Batch payload layout (all multi-byte fields little-endian):
+ *
+ *   | sample_cnt (u8) | base_tick (u32) | record 0 | record 1 | ... |
+ *
+ * Every record is prefixed with a compact header:
+ *
+ *   | sensor_id (u8) | tick_delta (u16) | len (u8) | sample data (len bytes) |
+ *
+ * tick_delta is relative to the previous record (or base_tick for the first record).
+ */
+#define PACKET_BATCH_HEADER_SIZE        5u
+#define PACKET_BATCH_RECORD_HEADER_SIZE 4u
+#define PACKET_BATCH_MAX_TICK_DELTA     0xFFFFu
+
+    typedef struct
+    {
+        uint8_t *buf;               /* Caller-provided buffer the batch is assembled in */
+        size_t   buf_size;          /* Size of buf, at most PACKET_PARSER_MAX_PAYLOAD_LEN */
+        size_t   flush_len;         /* Flush once batch reaches this many bytes, 0 == buf_size */
+        uint32_t max_latency_ticks; /* Flush once oldest sample is this old, 0 == disabled */
+        uint8_t  max_samples;       /* Flush once batch holds this many samples */
+        size_t   len;
+        uint32_t base_tick;
+        uint32_t prev_tick;
+        uint8_t  sample_cnt;
+    } packet_batch_ctx_t;
+
+    typedef struct
+    {
+        uint8_t        sensor_id;
+        uint8_t        len;
+        uint32_t       tick;
+        const uint8_t *data;
+    } packet_batch_sample_t;
+
+    typedef struct
+    {
+        const uint8_t *data;
+        size_t         len;
+        size_t         offset;
+        uint32_t       tick;
+        uint8_t        remaining; /* Number of samples left to read from the batch */
+    } packet_batch_reader_t;
+
+    /**
+     * @brief Initialize the batch context, the buf, buf_size, flush_len, max_latency_ticks and
+     *        max_samples settings have to be filled in by the caller beforehand
+     * @param ctx Ptr to the batch context
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or buf is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when buf_size, flush_len or max_samples is
+     *         out of range
+     */
+    manikin_status_t packet_batch_init(packet_batch_ctx_t *ctx);
+
+    /**
+     * @brief Append one sample to the current batch
+     * @param ctx Ptr to the batch context
+     * @param sensor_id Identifier of the sensor that produced the sample
+     * @param tick Tick on which the sample was taken
+     * @param data Ptr to the (already parsed or raw) sample bytes, copied into the batch
+     * @param len Number of sample bytes
+     * @return MANIKIN_STATUS_OK when the sample was added,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or data is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the sample does not fit the current
+     *         batch (full, or tick delta too large). Flush the batch and add the sample again.
+     */
+    manikin_status_t packet_batch_add(packet_batch_ctx_t *ctx,
+                                      uint8_t             sensor_id,
+                                      uint32_t            tick,
+                                      const uint8_t      *data,
+                                      uint8_t             len);
+
+    /**
+     * @brief Check whether one of the flush thresholds (count, size or latency) has been reached
+     * @param ctx Ptr to the batch context
+     * @param now_tick The current tick, used for the max-latency threshold
+     * @return 1 when the batch should be flushed, 0 otherwise
+     */
+    uint8_t packet_batch_flush_needed(const packet_batch_ctx_t *ctx, uint32_t now_tick);
+
+    /**
+     * @brief Finalize the current batch and start a new (empty) one
+     * @note  cmd references the batch buffer, encapsulate/transmit it before the next
+     *        packet_batch_add() call.
+     * @param ctx Ptr to the batch context
+     * @param cmd Ptr to cmd struct which will reference the finished batch payload
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or cmd is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the batch contains no samples
+     */
+    manikin_status_t packet_batch_flush(packet_batch_ctx_t *ctx, packet_parser_cmd_t *cmd);
+
+    /**
+     * @brief Start reading samples from a received batch payload
+     * @param reader Ptr to reader state
+     * @param cmd Ptr to the parsed batch payload
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when reader, cmd or cmd->data is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED when the payload is too short
+     */
+    manikin_status_t packet_batch_reader_init(packet_batch_reader_t     *reader,
+                                              const packet_parser_cmd_t *cmd);
+
+    /**
+     * @brief Read the next sample from the batch, sample data is referenced (not copied)
+     * @param reader Ptr to reader state
+     * @param sample Ptr to sample struct to fill
+     * @return MANIKIN_STATUS_OK when a sample was read,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when reader or sample is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when all samples have been read,
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED when a record exceeds the payload
+     */
+    manikin_status_t packet_batch_reader_next(packet_batch_reader_t *reader,
+                                              packet_batch_sample_t *sample);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // PACKET_BATCH_H
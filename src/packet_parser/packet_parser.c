@@ -32,6 +32,8 @@
 #define END_BYTE   0x17
 #define CRC16_POLY 0x8D95
 
+#define COBS_MAX_BLOCK_CODE 0xFFu
+
 static uint16_t
 calculate_crc16 (const uint8_t *data, size_t len)
 {
@@ -96,6 +98,23 @@ packet_parser_parse (const uint8_t *recv_bytes, size_t buf_length, packet_parser
     return MANIKIN_STATUS_OK;
 }
 
+static void
+packet_parser_write_header (const packet_parser_cmd_t *cmd, uint8_t *header)
+{
+    header[0] = START_BYTE;
+    header[1] = GET_LOWER_8_BITS_OF_SHORT(cmd->len);
+    header[2] = COLON;
+}
+
+static void
+packet_parser_write_trailer (const packet_parser_cmd_t *cmd, uint8_t *trailer)
+{
+    uint16_t crc = calculate_crc16(cmd->data, cmd->len);
+    trailer[0]   = GET_LOWER_8_BITS_OF_SHORT(crc);
+    trailer[1]   = GET_UPPER_8_BITS_OF_SHORT(crc);
+    trailer[2]   = END_BYTE;
+}
+
 manikin_status_t
 packet_parser_encapsulate (const packet_parser_cmd_t *cmd, uint8_t *out_data, size_t out_max_len)
 {
@@ -104,25 +123,283 @@ packet_parser_encapsulate (const packet_parser_cmd_t *cmd, uint8_t *out_data, si
         return MANIKIN_STATUS_ERR_NULL_PARAM;
     }
 
-    size_t total_len = 3 + cmd->len + 2 + 1;
-    if (out_max_len < total_len)
+    size_t total_len = PACKET_PARSER_HEADER_SIZE + cmd->len + PACKET_PARSER_TRAILER_SIZE;
+    if (out_max_len < total_len || cmd->len > PACKET_PARSER_MAX_PAYLOAD_LEN)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    packet_parser_write_header(cmd, out_data);
+    memcpy(&out_data[PACKET_PARSER_HEADER_SIZE], cmd->data, cmd->len);
+    packet_parser_write_trailer(cmd, &out_data[PACKET_PARSER_HEADER_SIZE + cmd->len]);
+
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_parser_encapsulate_segments (const packet_parser_cmd_t *cmd,
+                                    uint8_t                   *header,
+                                    uint8_t                   *trailer,
+                                    packet_parser_segment_t   *segments)
+{
+    if (!cmd || !cmd->data || !header || !trailer || !segments)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+
+    if (cmd->len > PACKET_PARSER_MAX_PAYLOAD_LEN)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    packet_parser_write_header(cmd, header);
+    packet_parser_write_trailer(cmd, trailer);
+
+    // NOTE: Payload is referenced in place, so the DMA can pick it up from where it lives
+    segments[0].data = header;
+    segments[0].len  = PACKET_PARSER_HEADER_SIZE;
+    segments[1].data = cmd->data;
+    segments[1].len  = cmd->len;
+    segments[2].data = trailer;
+    segments[2].len  = PACKET_PARSER_TRAILER_SIZE;
+
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Run the COBS block logic without writing, to get the exact encoded length
+ */
+static size_t
+packet_parser_cobs_encoded_len (const uint8_t *data, size_t len)
+{
+    size_t  encoded_len = 1;
+    uint8_t code        = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] != 0u)
+        {
+            encoded_len++;
+            code++;
+        }
+        if (data[i] == 0u || code == COBS_MAX_BLOCK_CODE)
+        {
+            code = 1;
+            if (data[i] == 0u || (i + 1u) < len)
+            {
+                encoded_len++;
+            }
+        }
+    }
+    return encoded_len;
+}
+
+manikin_status_t
+packet_parser_cobs_encode (uint8_t *buf, size_t len, size_t buf_size, size_t *encoded_len)
+{
+    if (!buf || !encoded_len)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+
+    const size_t total_len = packet_parser_cobs_encoded_len(buf, len);
+    if (total_len > buf_size)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+
+    //
+    // Move the data to the end of the encoded area. The write index then never passes the read
+    // index (the gap equals the number of code bytes still to be inserted), so the encoding can
+    // be done front-to-back in the same buffer.
+    //
+    const size_t src = total_len - len;
+    memmove(&buf[src], buf, len);
+
+    size_t  code_idx  = 0;
+    size_t  write_idx = 1;
+    uint8_t code      = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        const uint8_t byte = buf[src + i];
+        if (byte != 0u)
+        {
+            buf[write_idx++] = byte;
+            code++;
+        }
+        if (byte == 0u || code == COBS_MAX_BLOCK_CODE)
+        {
+            buf[code_idx] = code;
+            code          = 1;
+            code_idx      = write_idx;
+            if (byte == 0u || (i + 1u) < len)
+            {
+                write_idx++;
+            }
+        }
+    }
+    // NOTE: A full block at the very end needs no trailing (empty) block
+    if (code_idx < write_idx)
+    {
+        buf[code_idx] = code;
+    }
+    *encoded_len = write_idx;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_parser_cobs_decode (uint8_t *buf, size_t len, size_t *decoded_len)
+{
+    if (!buf || !decoded_len)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+
+    // NOTE: Decoded data is never longer than the encoded data, so writing trails reading
+    size_t read_idx  = 0;
+    size_t write_idx = 0;
+    while (read_idx < len)
+    {
+        const uint8_t code = buf[read_idx++];
+        if (code == 0u || (size_t)(code - 1u) > len - read_idx)
+        {
+            return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            const uint8_t byte = buf[read_idx++];
+            if (byte == 0u)
+            {
+                return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+            }
+            buf[write_idx++] = byte;
+        }
+        if (code != COBS_MAX_BLOCK_CODE && read_idx < len)
+        {
+            buf[write_idx++] = 0u;
+        }
+    }
+    *decoded_len = write_idx;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+packet_parser_link_init (packet_parser_link_t *link, packet_parser_framing_t framing)
+{
+    if (!link)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+    if (framing != PACKET_PARSER_FRAMING_LEGACY && framing != PACKET_PARSER_FRAMING_COBS)
     {
         return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
     }
+    link->framing = framing;
+    return MANIKIN_STATUS_OK;
+}
 
-    size_t idx      = 0;
-    out_data[idx++] = START_BYTE;
-    out_data[idx++] = (uint8_t)cmd->len;
-    out_data[idx++] = COLON;
+static manikin_status_t
+packet_parser_cobs_encapsulate (const packet_parser_cmd_t *cmd,
+                                uint8_t                   *out_data,
+                                size_t                     out_max_len,
+                                size_t                    *out_len)
+{
+    const size_t raw_len = cmd->len + PACKET_PARSER_CRC_SIZE;
+    // NOTE: One byte is kept free for the delimiter
+    if (out_max_len < raw_len + 1u)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
 
-    memcpy(&out_data[idx], cmd->data, cmd->len);
-    idx += cmd->len;
+    memcpy(out_data, cmd->data, cmd->len);
+    const uint16_t crc     = calculate_crc16(cmd->data, cmd->len);
+    out_data[cmd->len]     = GET_LOWER_8_BITS_OF_SHORT(crc);
+    out_data[cmd->len + 1] = GET_UPPER_8_BITS_OF_SHORT(crc);
 
-    uint16_t crc    = calculate_crc16(cmd->data, cmd->len);
-    out_data[idx++] = GET_LOWER_8_BITS_OF_SHORT(crc);
-    out_data[idx++] = GET_UPPER_8_BITS_OF_SHORT(crc);
+    size_t           encoded_len;
+    manikin_status_t status
+        = packet_parser_cobs_encode(out_data, raw_len, out_max_len - 1u, &encoded_len);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    out_data[encoded_len] = PACKET_PARSER_COBS_DELIMITER;
+    *out_len              = encoded_len + 1u;
+    return MANIKIN_STATUS_OK;
+}
 
-    out_data[idx] = END_BYTE;
+manikin_status_t
+packet_parser_link_encapsulate (const packet_parser_link_t *link,
+                                const packet_parser_cmd_t  *cmd,
+                                uint8_t                    *out_data,
+                                size_t                      out_max_len,
+                                size_t                     *out_len)
+{
+    if (!link || !cmd || !cmd->data || !out_data || !out_len)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+    if (cmd->len > PACKET_PARSER_MAX_PAYLOAD_LEN)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    if (link->framing == PACKET_PARSER_FRAMING_COBS)
+    {
+        return packet_parser_cobs_encapsulate(cmd, out_data, out_max_len, out_len);
+    }
+
+    manikin_status_t status = packet_parser_encapsulate(cmd, out_data, out_max_len);
+    if (status == MANIKIN_STATUS_OK)
+    {
+        *out_len = PACKET_PARSER_HEADER_SIZE + cmd->len + PACKET_PARSER_TRAILER_SIZE;
+    }
+    return status;
+}
+
+manikin_status_t
+packet_parser_link_parse (const packet_parser_link_t *link,
+                          uint8_t                    *frame,
+                          size_t                      frame_len,
+                          packet_parser_cmd_t        *cmd)
+{
+    if (!link || !frame || !cmd)
+    {
+        return MANIKIN_STATUS_ERR_NULL_PARAM;
+    }
+
+    if (link->framing != PACKET_PARSER_FRAMING_COBS)
+    {
+        return packet_parser_parse(frame, frame_len, cmd);
+    }
+
+    if (frame_len > 0u && frame[frame_len - 1u] == PACKET_PARSER_COBS_DELIMITER)
+    {
+        frame_len--;
+    }
+
+    size_t           decoded_len;
+    manikin_status_t status = packet_parser_cobs_decode(frame, frame_len, &decoded_len);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    if (decoded_len < PACKET_PARSER_CRC_SIZE
+        || decoded_len - PACKET_PARSER_CRC_SIZE > PACKET_PARSER_MAX_PAYLOAD_LEN)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+
+    const size_t   payload_len = decoded_len - PACKET_PARSER_CRC_SIZE;
+    const uint16_t received_crc
+        = CONSTRUCT_SHORT_FROM_BYTES(frame[payload_len + 1u], frame[payload_len]);
+    if (received_crc != calculate_crc16(frame, payload_len))
+    {
+        return MANIKIN_STATUS_ERR_INVALID_PACKET_CRC_FAIL;
+    }
 
+    // WARNING: Cast in line below
+    // NOTE: payload_len is checked against PACKET_PARSER_MAX_PAYLOAD_LEN above
+    cmd->len  = (uint16_t)payload_len;
+    cmd->data = frame;
     return MANIKIN_STATUS_OK;
 }
@@ -22,20 +22,75 @@
  * Author:          Victor Hogeweij
  */
 
-#ifndef SDP810_H
-#define SDP810_H
+#ifndef PACKET_PARSER_H
+#define PACKET_PARSER_H
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
 #include "common/manikin_types.h"
+
+#define PACKET_PARSER_HEADER_SIZE     3u
+#define PACKET_PARSER_TRAILER_SIZE    3u
+#define PACKET_PARSER_SEGMENT_CNT     3u
+#define PACKET_PARSER_MAX_PAYLOAD_LEN 255u
+#define PACKET_PARSER_CRC_SIZE        2u
+
+/**
+ * @brief Worst-case size of len bytes after COBS encoding (without the 0x00 delimiter)
+ *        COBS adds one code byte per started block of 254 bytes, so at most ~0.4% overhead.
+ */
+#define PACKET_PARSER_COBS_MAX_ENCODED_LEN(len) ((len) + ((len) / 254u) + 1u)
+
+/**
+ * @brief Worst-case size of a COBS-framed packet: encoded payload + CRC, plus the delimiter
+ */
+#define PACKET_PARSER_COBS_MAX_FRAME_LEN(payload_len) \
+    (PACKET_PARSER_COBS_MAX_ENCODED_LEN((payload_len) + PACKET_PARSER_CRC_SIZE) + 1u)
+
+#define PACKET_PARSER_COBS_DELIMITER 0x00u
+
+/**
+ * @brief Buffer size which fits a frame in either framing mode
+ *        For payloads up to PACKET_PARSER_MAX_PAYLOAD_LEN the COBS frame is never longer than
+ *        the legacy frame.
+ */
+#define PACKET_PARSER_LINK_MAX_FRAME_LEN(payload_len) \
+    ((payload_len) + PACKET_PARSER_HEADER_SIZE + PACKET_PARSER_TRAILER_SIZE)
+
     typedef struct
     {
         uint16_t       len;
         const uint8_t *data;
     } packet_parser_cmd_t;
 
+    /**
+     * @brief Framing used on a link
+     *        - LEGACY: START_BYTE, len, COLON, payload, CRC16, END_BYTE (payload not escaped)
+     *        - COBS:   COBS(payload, CRC16), 0x00. A zero byte only ever appears as frame
+     *                  delimiter, so a receiver regains sync at the next 0x00 after corruption.
+     */
+    typedef enum
+    {
+        PACKET_PARSER_FRAMING_LEGACY = 0,
+        PACKET_PARSER_FRAMING_COBS,
+    } packet_parser_framing_t;
+
+    typedef struct
+    {
+        packet_parser_framing_t framing;
+    } packet_parser_link_t;
+
+    /**
+     * @brief One contiguous piece of an encapsulated packet (scatter-gather list entry)
+     */
+    typedef struct
+    {
+        const uint8_t *data;
+        size_t         len;
+    } packet_parser_segment_t;
+
     /**
      * @brief Parse received packet from byte array to cmd struct
      * @param recv_bytes
@@ -64,7 +119,102 @@ extern "C"
                                                uint8_t                   *out_data,
                                                size_t                     out_max_len);
 
+    /**
+     * @brief Encapsulate cmd struct without copying the payload
+     *        The header and trailer are written to the (small) caller buffers, the payload is
+     *        referenced where it already lives. The three segments, sent back-to-back (e.g. as a
+     *        DMA scatter list), form the same packet as packet_parser_encapsulate() produces.
+     * @note  The payload must stay valid and unchanged until the segments are transmitted.
+     * @param cmd Ptr to struct containing cmd to encapsulate
+     * @param header Ptr to buffer of PACKET_PARSER_HEADER_SIZE bytes to write the header to
+     * @param trailer Ptr to buffer of PACKET_PARSER_TRAILER_SIZE bytes to write the CRC and end
+     * byte to
+     * @param segments Ptr to array of PACKET_PARSER_SEGMENT_CNT segments (header, payload, trailer)
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid cmd, header, trailer or segments (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED when payload exceeds
+     *         PACKET_PARSER_MAX_PAYLOAD_LEN
+     */
+    manikin_status_t packet_parser_encapsulate_segments(const packet_parser_cmd_t *cmd,
+                                                        uint8_t                   *header,
+                                                        uint8_t                   *trailer,
+                                                        packet_parser_segment_t   *segments);
+
+    /**
+     * @brief COBS-encode len bytes in place
+     * @param buf Ptr to buffer holding the data, the encoded data overwrites it
+     * @param len Number of data bytes in buf
+     * @param buf_size Size of buf, at least PACKET_PARSER_COBS_MAX_ENCODED_LEN(len)
+     * @param encoded_len Ptr to write the encoded length to (excluding delimiter)
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid buf or encoded_len (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when buf is too small for the encoded data
+     */
+    manikin_status_t packet_parser_cobs_encode(uint8_t *buf,
+                                               size_t   len,
+                                               size_t   buf_size,
+                                               size_t  *encoded_len);
+
+    /**
+     * @brief COBS-decode len bytes in place
+     * @param buf Ptr to buffer holding the encoded data (without delimiter), overwritten by the
+     * decoded data
+     * @param len Number of encoded bytes
+     * @param decoded_len Ptr to write the decoded length to
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid buf or decoded_len (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED on zero bytes or truncated blocks
+     */
+    manikin_status_t packet_parser_cobs_decode(uint8_t *buf, size_t len, size_t *decoded_len);
+
+    /**
+     * @brief Select the framing used on a link
+     * @param link Ptr to link struct
+     * @param framing The framing mode
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid link (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED on unknown framing mode
+     */
+    manikin_status_t packet_parser_link_init(packet_parser_link_t   *link,
+                                             packet_parser_framing_t framing);
+
+    /**
+     * @brief Encapsulate cmd struct to byte array using the framing of the link
+     * @param link Ptr to initialized link struct
+     * @param cmd Ptr to struct containing cmd to encapsulate
+     * @param out_data Ptr to buffer to contain the frame
+     * @param out_max_len Size of out_data, PACKET_PARSER_LINK_MAX_FRAME_LEN(cmd->len) bytes always
+     * suffice
+     * @param out_len Ptr to write the frame length to
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid link, cmd, out_data or out_len (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED when out_data is too small or payload
+     *         exceeds PACKET_PARSER_MAX_PAYLOAD_LEN
+     */
+    manikin_status_t packet_parser_link_encapsulate(const packet_parser_link_t *link,
+                                                    const packet_parser_cmd_t  *cmd,
+                                                    uint8_t                    *out_data,
+                                                    size_t                      out_max_len,
+                                                    size_t                     *out_len);
+
+    /**
+     * @brief Parse a received frame using the framing of the link
+     * @note  In COBS mode the frame is decoded in place, cmd->data then points into frame.
+     * @param link Ptr to initialized link struct
+     * @param frame Ptr to received frame, in COBS mode with or without trailing delimiter
+     * @param frame_len Length of the frame
+     * @param cmd Ptr to cmd struct to fill
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid link, frame or cmd (eq NULL)
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_CRC_FAIL when failing to validate CRC of packet
+     *         MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED when structure of packet is malformed
+     */
+    manikin_status_t packet_parser_link_parse(const packet_parser_link_t *link,
+                                              uint8_t                    *frame,
+                                              size_t                      frame_len,
+                                              packet_parser_cmd_t        *cmd);
+
 #ifdef __cplusplus
 }
 #endif
-#endif // SDP810_H
\ No newline at end of file
+#endif // PACKET_PARSER_H
\ No newline at end of file
@@ -0,0 +1,351 @@
+/**
+ * @file            reliable_link.c
+ * @brief           Optional sliding-window reliability layer on top of packet_parser frames
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "reliable_link.h"
+#include "error_handler/error_handler.h"
+#include "common/manikin_bit_manipulation.h"
+#include <string.h>
+
+#define HASH_RELIABLE_LINK 0x489F2304u
+
+// NOTE: Sequence numbers further than this behind are treated as old duplicates
+#define RELIABLE_LINK_SEQ_HALF_RANGE 128u
+
+enum reliable_link_slot_state
+{
+    RELIABLE_LINK_SLOT_FREE,
+    RELIABLE_LINK_SLOT_SENT,
+    RELIABLE_LINK_SLOT_ACKED,
+    RELIABLE_LINK_SLOT_RECEIVED
+};
+
+static size_t
+reliable_link_slot_idx (const reliable_link_ctx_t *ctx, uint8_t seq)
+{
+    // NOTE: window is a power of two, so the mapping stays continuous across the seq wrap
+    return (size_t)(seq & (uint8_t)(ctx->window - 1u));
+}
+
+static uint8_t *
+reliable_link_tx_payload (const reliable_link_ctx_t *ctx, uint8_t seq)
+{
+    return &ctx->tx_storage[reliable_link_slot_idx(ctx, seq) * ctx->slot_size];
+}
+
+static manikin_status_t
+reliable_link_transmit (reliable_link_ctx_t *ctx, const uint8_t *payload, uint8_t len)
+{
+    uint8_t                 header[PACKET_PARSER_HEADER_SIZE];
+    uint8_t                 trailer[PACKET_PARSER_TRAILER_SIZE];
+    packet_parser_segment_t segments[PACKET_PARSER_SEGMENT_CNT];
+    const packet_parser_cmd_t cmd = { .len = len, .data = payload };
+
+    manikin_status_t status = packet_parser_encapsulate_segments(&cmd, header, trailer, segments);
+    if (status != MANIKIN_STATUS_OK)
+    {
+        return status;
+    }
+    ctx->stats.tx_frames++;
+    return ctx->tx(ctx->user_ctx, segments, PACKET_PARSER_SEGMENT_CNT);
+}
+
+static manikin_status_t
+reliable_link_transmit_slot (reliable_link_ctx_t *ctx, uint8_t seq, uint32_t now_tick)
+{
+    reliable_link_slot_t *slot = &ctx->tx_slots[reliable_link_slot_idx(ctx, seq)];
+    slot->sent_tick            = now_tick;
+    return reliable_link_transmit(ctx, reliable_link_tx_payload(ctx, seq), slot->len);
+}
+
+static manikin_status_t
+reliable_link_send_ack (reliable_link_ctx_t *ctx)
+{
+    uint32_t sack = 0;
+    for (uint8_t i = 0; i < (uint8_t)(ctx->window - 1u); i++)
+    {
+        const uint8_t seq = (uint8_t)(ctx->rx_next + 1u + i);
+        if (ctx->rx_slots[reliable_link_slot_idx(ctx, seq)].state == RELIABLE_LINK_SLOT_RECEIVED)
+        {
+            sack |= (uint32_t)1u << i;
+        }
+    }
+    const uint8_t ack[RELIABLE_LINK_ACK_SIZE] = { RELIABLE_LINK_TYPE_ACK,
+                                                  ctx->rx_next,
+                                                  GET_LOWER_8_BITS_OF_SHORT(sack),
+                                                  GET_UPPER_8_BITS_OF_SHORT(sack),
+                                                  GET_LOWER_8_BITS_OF_SHORT(sack >> 16),
+                                                  GET_UPPER_8_BITS_OF_SHORT(sack >> 16) };
+    return reliable_link_transmit(ctx, ack, RELIABLE_LINK_ACK_SIZE);
+}
+
+static void
+reliable_link_deliver (reliable_link_ctx_t *ctx, const uint8_t *data, size_t len)
+{
+    ctx->stats.delivered_bytes += (uint32_t)len;
+    ctx->rx(ctx->user_ctx, data, len);
+    ctx->rx_next++;
+}
+
+static manikin_status_t
+reliable_link_handle_data (reliable_link_ctx_t *ctx, const uint8_t *payload, uint16_t len)
+{
+    const uint8_t seq      = payload[1];
+    const uint8_t offset   = (uint8_t)(seq - ctx->rx_next);
+    const size_t  data_len = (size_t)len - RELIABLE_LINK_HEADER_SIZE;
+
+    if (offset >= ctx->window || len > ctx->slot_size)
+    {
+        //
+        // Either a retransmission of a frame that was already delivered (our ACK got lost),
+        // or a frame outside the window. Re-ACK so the sender can advance.
+        //
+        ctx->stats.rx_duplicates++;
+        return reliable_link_send_ack(ctx);
+    }
+
+    reliable_link_slot_t *slot = &ctx->rx_slots[reliable_link_slot_idx(ctx, seq)];
+    if (offset == 0u)
+    {
+        // NOTE: In-order frames are delivered straight from the frame, without a copy
+        reliable_link_deliver(ctx, &payload[RELIABLE_LINK_HEADER_SIZE], data_len);
+        slot->state = RELIABLE_LINK_SLOT_FREE;
+
+        //
+        // The gap is filled, deliver whatever was waiting in the reorder buffer behind it
+        //
+        slot = &ctx->rx_slots[reliable_link_slot_idx(ctx, ctx->rx_next)];
+        while (slot->state == RELIABLE_LINK_SLOT_RECEIVED)
+        {
+            const size_t idx = reliable_link_slot_idx(ctx, ctx->rx_next);
+            slot->state      = RELIABLE_LINK_SLOT_FREE;
+            reliable_link_deliver(ctx, &ctx->rx_storage[idx * ctx->slot_size], slot->len);
+            slot = &ctx->rx_slots[reliable_link_slot_idx(ctx, ctx->rx_next)];
+        }
+    }
+    else if (slot->state == RELIABLE_LINK_SLOT_RECEIVED)
+    {
+        ctx->stats.rx_duplicates++;
+    }
+    else
+    {
+        const size_t idx = reliable_link_slot_idx(ctx, seq);
+        memcpy(&ctx->rx_storage[idx * ctx->slot_size],
+               &payload[RELIABLE_LINK_HEADER_SIZE],
+               data_len);
+        // WARNING: Cast in line below
+        // NOTE: data_len is smaller than slot_size, which is at most 255
+        slot->len   = (uint8_t)data_len;
+        slot->state = RELIABLE_LINK_SLOT_RECEIVED;
+    }
+    return reliable_link_send_ack(ctx);
+}
+
+static manikin_status_t
+reliable_link_handle_ack (reliable_link_ctx_t *ctx, const uint8_t *payload, uint32_t now_tick)
+{
+    const uint8_t  cum_ack   = payload[1];
+    const uint32_t sack      = (uint32_t)payload[2] | ((uint32_t)payload[3] << 8)
+                          | ((uint32_t)payload[4] << 16) | ((uint32_t)payload[5] << 24);
+    const uint8_t  in_flight = reliable_link_in_flight(ctx);
+    const uint8_t  acked_cnt = (uint8_t)(cum_ack - ctx->tx_base);
+
+    if (acked_cnt > in_flight)
+    {
+        // NOTE: Stale ACK (re-ordered or duplicated), everything it reports is already known
+        return MANIKIN_STATUS_OK;
+    }
+
+    for (uint8_t i = 0; i < acked_cnt; i++)
+    {
+        ctx->tx_slots[reliable_link_slot_idx(ctx, (uint8_t)(ctx->tx_base + i))].state
+            = RELIABLE_LINK_SLOT_FREE;
+    }
+    ctx->tx_base = cum_ack;
+
+    uint8_t highest_sacked = 0;
+    for (uint8_t i = 0; i < (uint8_t)(ctx->window - 1u); i++)
+    {
+        const uint8_t seq = (uint8_t)(cum_ack + 1u + i);
+        if (BIT_IS_SET(sack, i) && (uint8_t)(seq - ctx->tx_base) < reliable_link_in_flight(ctx))
+        {
+            ctx->tx_slots[reliable_link_slot_idx(ctx, seq)].state = RELIABLE_LINK_SLOT_ACKED;
+            highest_sacked                                         = (uint8_t)(i + 1u);
+        }
+    }
+
+    //
+    // Frames before the highest selectively acknowledged one are missing at the receiver, resend
+    // them once right away instead of waiting for the retransmission timeout.
+    //
+    manikin_status_t status = MANIKIN_STATUS_OK;
+    for (uint8_t i = 0; i < highest_sacked; i++)
+    {
+        const uint8_t         seq  = (uint8_t)(cum_ack + i);
+        reliable_link_slot_t *slot = &ctx->tx_slots[reliable_link_slot_idx(ctx, seq)];
+        if (slot->state == RELIABLE_LINK_SLOT_SENT && !slot->fast_retransmitted)
+        {
+            slot->fast_retransmitted = 1;
+            ctx->stats.retransmissions++;
+            status = reliable_link_transmit_slot(ctx, seq, now_tick);
+        }
+    }
+    return status;
+}
+
+manikin_status_t
+reliable_link_init (reliable_link_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK,
+                   ctx->tx_storage != NULL && ctx->tx_slots != NULL,
+                   MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK,
+                   ctx->rx_storage != NULL && ctx->rx_slots != NULL,
+                   MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK,
+                   ctx->tx != NULL && ctx->rx != NULL,
+                   MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK,
+                   (ctx->window > 0u && ctx->window <= RELIABLE_LINK_MAX_WINDOW
+                    && (ctx->window & (ctx->window - 1u)) == 0u),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK,
+                   (ctx->slot_size > RELIABLE_LINK_HEADER_SIZE
+                    && ctx->slot_size <= PACKET_PARSER_MAX_PAYLOAD_LEN),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    ctx->tx_base = 0;
+    ctx->tx_next = 0;
+    ctx->rx_next = 0;
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    memset(ctx->tx_slots, 0, ctx->window * sizeof(reliable_link_slot_t));
+    memset(ctx->rx_slots, 0, ctx->window * sizeof(reliable_link_slot_t));
+    return MANIKIN_STATUS_OK;
+}
+
+uint8_t
+reliable_link_in_flight (const reliable_link_ctx_t *ctx)
+{
+    if (ctx == NULL)
+    {
+        return 0;
+    }
+    return (uint8_t)(ctx->tx_next - ctx->tx_base);
+}
+
+manikin_status_t
+reliable_link_send (reliable_link_ctx_t *ctx, const uint8_t *data, size_t len, uint32_t now_tick)
+{
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, data != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    if (len > ctx->slot_size - RELIABLE_LINK_HEADER_SIZE
+        || reliable_link_in_flight(ctx) >= ctx->window)
+    {
+        return MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE;
+    }
+
+    const uint8_t seq     = ctx->tx_next;
+    uint8_t      *payload = reliable_link_tx_payload(ctx, seq);
+    payload[0]            = RELIABLE_LINK_TYPE_DATA;
+    payload[1]            = seq;
+    memcpy(&payload[RELIABLE_LINK_HEADER_SIZE], data, len);
+
+    reliable_link_slot_t *slot = &ctx->tx_slots[reliable_link_slot_idx(ctx, seq)];
+    // WARNING: Cast in line below
+    // NOTE: len is checked against slot_size, which is at most 255
+    slot->len                = (uint8_t)(len + RELIABLE_LINK_HEADER_SIZE);
+    slot->state              = RELIABLE_LINK_SLOT_SENT;
+    slot->fast_retransmitted = 0;
+    ctx->tx_next++;
+    return reliable_link_transmit_slot(ctx, seq, now_tick);
+}
+
+manikin_status_t
+reliable_link_receive (reliable_link_ctx_t *ctx,
+                       const uint8_t       *frame,
+                       size_t               frame_len,
+                       uint32_t             now_tick)
+{
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, frame != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    packet_parser_cmd_t cmd;
+    manikin_status_t    status = packet_parser_parse(frame, frame_len, &cmd);
+    if (status != MANIKIN_STATUS_OK || cmd.len < RELIABLE_LINK_HEADER_SIZE)
+    {
+        //
+        // Corrupted frames are dropped, the sender recovers them through the SACK bitmap of the
+        // next ACK or the retransmission timeout.
+        //
+        ctx->stats.rx_errors++;
+        return (status != MANIKIN_STATUS_OK) ? status
+                                             : MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+    }
+    ctx->stats.rx_frames++;
+
+    switch (cmd.data[0])
+    {
+        case RELIABLE_LINK_TYPE_DATA: {
+            status = reliable_link_handle_data(ctx, cmd.data, cmd.len);
+            break;
+        }
+        case RELIABLE_LINK_TYPE_ACK: {
+            if (cmd.len < RELIABLE_LINK_ACK_SIZE)
+            {
+                ctx->stats.rx_errors++;
+                status = MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+                break;
+            }
+            status = reliable_link_handle_ack(ctx, cmd.data, now_tick);
+            break;
+        }
+        default: {
+            ctx->stats.rx_errors++;
+            status = MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED;
+            break;
+        }
+    }
+    return status;
+}
+
+manikin_status_t
+reliable_link_poll (reliable_link_ctx_t *ctx, uint32_t now_tick)
+{
+    MANIKIN_ASSERT(HASH_RELIABLE_LINK, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_status_t status    = MANIKIN_STATUS_OK;
+    const uint8_t    in_flight = reliable_link_in_flight(ctx);
+    for (uint8_t i = 0; i < in_flight; i++)
+    {
+        const uint8_t         seq  = (uint8_t)(ctx->tx_base + i);
+        reliable_link_slot_t *slot = &ctx->tx_slots[reliable_link_slot_idx(ctx, seq)];
+        if (slot->state == RELIABLE_LINK_SLOT_SENT
+            && (now_tick - slot->sent_tick) >= ctx->rto_ticks)
+        {
+            slot->fast_retransmitted = 0;
+            ctx->stats.retransmissions++;
+            status = reliable_link_transmit_slot(ctx, seq, now_tick);
+        }
+    }
+    return status;
+}
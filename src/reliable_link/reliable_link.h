@@ -0,0 +1,165 @@
+/**
+ * @file            reliable_link.h
+ * @brief           Optional sliding-window reliability layer on top of packet_parser frames
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef RELIABLE_LINK_H
+#define RELIABLE_LINK_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "packet_parser/packet_parser.h"
+
+/**
+ * Link payloads are carried inside packet_parser frames:
+ *
+ *   DATA: | type (0x01) | seq (u8) | data ... |
+ *   ACK:  | type (0x02) | cum_ack (u8) | sack (u32 LE) |
+ *
+ * cum_ack is the next sequence number the receiver expects, so every frame before it has been
+ * received. Bit n of sack is set when frame cum_ack + 1 + n has been received out of order.
+ * Only frames that were actually lost are retransmitted: on timeout, or as soon as an ACK shows
+ * that later frames did arrive (fast retransmit).
+ */
+#define RELIABLE_LINK_TYPE_DATA       0x01u
+#define RELIABLE_LINK_TYPE_ACK        0x02u
+#define RELIABLE_LINK_HEADER_SIZE     2u
+#define RELIABLE_LINK_ACK_SIZE        6u
+#define RELIABLE_LINK_MAX_WINDOW      32u
+#define RELIABLE_LINK_MAX_PAYLOAD_LEN (PACKET_PARSER_MAX_PAYLOAD_LEN - RELIABLE_LINK_HEADER_SIZE)
+
+    /**
+     * @brief Transmit callback, the frame is passed as a header/payload/trailer scatter list.
+     * @note  The segments are only valid during the call, copy them or transmit them before
+     *        returning.
+     */
+    typedef manikin_status_t (*reliable_link_tx_fn_t)(void                          *user_ctx,
+                                                      const packet_parser_segment_t *segments,
+                                                      size_t                         segment_cnt);
+
+    /**
+     * @brief Receive callback, called with the payloads in order and without gaps or duplicates
+     */
+    typedef void (*reliable_link_rx_fn_t)(void *user_ctx, const uint8_t *data, size_t len);
+
+    /**
+     * @brief Bookkeeping of one TX ring or RX reorder buffer slot
+     */
+    typedef struct
+    {
+        uint32_t sent_tick;
+        uint8_t  len;
+        uint8_t  state;
+        uint8_t  fast_retransmitted;
+    } reliable_link_slot_t;
+
+    typedef struct
+    {
+        uint32_t tx_frames;
+        uint32_t retransmissions;
+        uint32_t rx_frames;
+        uint32_t rx_errors;
+        uint32_t rx_duplicates;
+        uint32_t delivered_bytes;
+    } reliable_link_stats_t;
+
+    typedef struct
+    {
+        uint8_t               *tx_storage; /* window * slot_size bytes, the TX ring */
+        reliable_link_slot_t  *tx_slots;   /* window entries */
+        uint8_t               *rx_storage; /* window * slot_size bytes, the RX reorder buffer */
+        reliable_link_slot_t  *rx_slots;   /* window entries */
+        size_t                 slot_size;  /* Max link payload incl. header, <= 255 */
+        uint8_t                window;     /* Frames in flight, power of two <= 32 */
+        uint32_t               rto_ticks;  /* Retransmission timeout */
+        reliable_link_tx_fn_t  tx;
+        reliable_link_rx_fn_t  rx;
+        void                  *user_ctx;
+        uint8_t                tx_base; /* Oldest unacknowledged sequence number */
+        uint8_t                tx_next; /* Next sequence number to send */
+        uint8_t                rx_next; /* Next sequence number to deliver */
+        reliable_link_stats_t  stats;
+    } reliable_link_ctx_t;
+
+    /**
+     * @brief Initialize the link, the storage, window, rto and callback settings have to be
+     *        filled in by the caller beforehand
+     * @param ctx Ptr to link context
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on missing storage or callbacks,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE on invalid window or slot_size
+     */
+    manikin_status_t reliable_link_init(reliable_link_ctx_t *ctx);
+
+    /**
+     * @brief Queue a payload in the TX ring and transmit it
+     * @param ctx Ptr to link context
+     * @param data Ptr to payload, copied into the TX ring
+     * @param len Payload length, at most slot_size - RELIABLE_LINK_HEADER_SIZE
+     * @param now_tick Current tick, used for the retransmission timeout
+     * @return MANIKIN_STATUS_OK when the payload was queued,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid ctx or data,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when the window is full or len is too large,
+     *         or the status of the tx callback (the frame stays queued for retransmission)
+     */
+    manikin_status_t reliable_link_send(reliable_link_ctx_t *ctx,
+                                        const uint8_t       *data,
+                                        size_t               len,
+                                        uint32_t             now_tick);
+
+    /**
+     * @brief Process one received packet_parser frame (DATA or ACK)
+     * @param ctx Ptr to link context
+     * @param frame Ptr to complete frame as received from the wire
+     * @param frame_len Length of the frame
+     * @param now_tick Current tick
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid ctx or frame,
+     *         the packet_parser_parse() status on CRC failure or malformed frames
+     */
+    manikin_status_t reliable_link_receive(reliable_link_ctx_t *ctx,
+                                           const uint8_t       *frame,
+                                           size_t               frame_len,
+                                           uint32_t             now_tick);
+
+    /**
+     * @brief Retransmit the frames whose retransmission timeout expired, call periodically
+     * @param ctx Ptr to link context
+     * @param now_tick Current tick
+     * @return MANIKIN_STATUS_OK on success, MANIKIN_STATUS_ERR_NULL_PARAM on invalid ctx
+     */
+    manikin_status_t reliable_link_poll(reliable_link_ctx_t *ctx, uint32_t now_tick);
+
+    /**
+     * @brief Number of frames which are sent but not yet acknowledged
+     * @param ctx Ptr to link context
+     * @return Number of frames in flight
+     */
+    uint8_t reliable_link_in_flight(const reliable_link_ctx_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // RELIABLE_LINK_H
@@ -0,0 +1,248 @@
+/**
+ * @file            sample_scheduler.c
+ * @brief           Multi-rate sample scheduler driving several sensors from one timer
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "sample_scheduler.h"
+#include "error_handler/error_handler.h"
+
+#define HASH_SAMPLE_SCHEDULER 0xA3BF5787u
+
+#define SAMPLE_SCHEDULER_MAX_BASE_RATE_HZ 1000u
+
+static uint32_t
+sample_scheduler_gcd (uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        const uint32_t rem = a % b;
+        a                  = b;
+        b                  = rem;
+    }
+    return a;
+}
+
+static uint8_t
+sample_scheduler_slot_load (sample_scheduler_slot_t slot)
+{
+    uint8_t load = 0;
+    while (slot != 0)
+    {
+        slot &= (sample_scheduler_slot_t)(slot - 1u);
+        load++;
+    }
+    return load;
+}
+
+static manikin_status_t
+sample_scheduler_check_params (const sample_scheduler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx->timer != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx->entries != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx->slots != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                   (ctx->entry_cnt > 0 && ctx->entry_cnt <= SAMPLE_SCHEDULER_MAX_ENTRIES),
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                       ctx->entries[i].sensor != NULL,
+                       MANIKIN_STATUS_ERR_NULL_PARAM);
+        MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                       ctx->entries[i].read != NULL,
+                       MANIKIN_STATUS_ERR_NULL_PARAM);
+        MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                       ctx->entries[i].rate_hz != 0,
+                       MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Mark entry idx in every slot it is read in
+ */
+static void
+sample_scheduler_place (sample_scheduler_ctx_t *ctx,
+                        uint8_t                 idx,
+                        uint16_t                period,
+                        uint16_t                phase)
+{
+    for (uint16_t slot = phase; slot < ctx->hyperperiod; slot = (uint16_t)(slot + period))
+    {
+        ctx->slots[slot] |= (sample_scheduler_slot_t)(1u << idx);
+    }
+}
+
+/**
+ * @brief Find the phase which keeps the busiest slot of the entry least loaded
+ *        Ties are broken on the total load, so reads also avoid moderately busy slots.
+ */
+static uint16_t
+sample_scheduler_best_phase (const sample_scheduler_ctx_t *ctx, uint16_t period)
+{
+    uint16_t best_phase = 0;
+    uint8_t  best_max   = UINT8_MAX;
+    uint32_t best_sum   = UINT32_MAX;
+    for (uint16_t phase = 0; phase < period; phase++)
+    {
+        uint8_t  max = 0;
+        uint32_t sum = 0;
+        for (uint16_t slot = phase; slot < ctx->hyperperiod; slot = (uint16_t)(slot + period))
+        {
+            const uint8_t load = sample_scheduler_slot_load(ctx->slots[slot]);
+            max                = (load > max) ? load : max;
+            sum += load;
+        }
+        if (max < best_max || (max == best_max && sum < best_sum))
+        {
+            best_phase = phase;
+            best_max   = max;
+            best_sum   = sum;
+        }
+    }
+    return best_phase;
+}
+
+manikin_status_t
+sample_scheduler_init (sample_scheduler_ctx_t *ctx)
+{
+    manikin_status_t status = sample_scheduler_check_params(ctx);
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, (status == MANIKIN_STATUS_OK), status);
+
+    //
+    // Base rate is the LCM of all rates, the hyperperiod (in base ticks) is base / GCD
+    //
+    uint32_t base_rate = 1;
+    uint32_t rate_gcd  = 0;
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        const uint32_t rate = ctx->entries[i].rate_hz;
+        base_rate           = base_rate / sample_scheduler_gcd(base_rate, rate) * rate;
+        rate_gcd            = sample_scheduler_gcd(rate_gcd, rate);
+        MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                       base_rate <= SAMPLE_SCHEDULER_MAX_BASE_RATE_HZ,
+                       MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    const uint32_t hyperperiod = base_rate / rate_gcd;
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                   hyperperiod <= ctx->slot_capacity,
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    // WARNING: Casts in lines below
+    // NOTE: base_rate is bounded by SAMPLE_SCHEDULER_MAX_BASE_RATE_HZ, so all fit 16 bits
+    ctx->hyperperiod = (uint16_t)hyperperiod;
+    ctx->slot_idx    = 0;
+    for (uint16_t slot = 0; slot < ctx->hyperperiod; slot++)
+    {
+        ctx->slots[slot] = 0;
+    }
+
+    //
+    // Fixed phases are placed first, the automatic phases are spread around them.
+    // Fast sensors are placed before slow ones, as they have the fewest phases to choose from.
+    //
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        const uint16_t period = (uint16_t)(base_rate / ctx->entries[i].rate_hz);
+        if (ctx->entries[i].phase != SAMPLE_SCHEDULER_PHASE_AUTO)
+        {
+            MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER,
+                           ctx->entries[i].phase < period,
+                           MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+            sample_scheduler_place(ctx, i, period, ctx->entries[i].phase);
+        }
+    }
+    uint16_t placed = 0;
+    for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+    {
+        placed |= (uint16_t)((ctx->entries[i].phase != SAMPLE_SCHEDULER_PHASE_AUTO) << i);
+    }
+    for (uint8_t round = 0; round < ctx->entry_cnt; round++)
+    {
+        uint8_t fastest = SAMPLE_SCHEDULER_MAX_ENTRIES;
+        for (uint8_t i = 0; i < ctx->entry_cnt; i++)
+        {
+            if ((placed & (1u << i)) == 0
+                && (fastest == SAMPLE_SCHEDULER_MAX_ENTRIES
+                    || ctx->entries[i].rate_hz > ctx->entries[fastest].rate_hz))
+            {
+                fastest = i;
+            }
+        }
+        if (fastest == SAMPLE_SCHEDULER_MAX_ENTRIES)
+        {
+            break;
+        }
+        const uint16_t period         = (uint16_t)(base_rate / ctx->entries[fastest].rate_hz);
+        ctx->entries[fastest].phase = sample_scheduler_best_phase(ctx, period);
+        sample_scheduler_place(ctx, fastest, period, ctx->entries[fastest].phase);
+        placed |= (uint16_t)(1u << fastest);
+    }
+
+    ctx->timer->frequency = (uint16_t)base_rate;
+    return sample_timer_init(ctx->timer);
+}
+
+manikin_status_t
+sample_scheduler_start (sample_scheduler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    return sample_timer_start(ctx->timer);
+}
+
+manikin_status_t
+sample_scheduler_stop (sample_scheduler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    return sample_timer_stop(ctx->timer);
+}
+
+manikin_status_t
+sample_scheduler_tick (sample_scheduler_ctx_t *ctx)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_SCHEDULER, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    manikin_status_t        result = MANIKIN_STATUS_OK;
+    sample_scheduler_slot_t slot   = ctx->slots[ctx->slot_idx];
+    ctx->slot_idx = (uint16_t)((ctx->slot_idx + 1u == ctx->hyperperiod) ? 0u : ctx->slot_idx + 1u);
+    for (uint8_t i = 0; slot != 0; i++, slot >>= 1)
+    {
+        if ((slot & 1u) == 0)
+        {
+            continue;
+        }
+        sample_scheduler_entry_t *entry  = &ctx->entries[i];
+        manikin_status_t          status = sample_timer_start_cb_handler(ctx->timer, entry->sensor);
+        const manikin_status_t    read_status
+            = (status == MANIKIN_STATUS_OK) ? entry->read(entry->user) : status;
+        //
+        // Faults are isolated per sensor by the hooks: a faulty sensor is skipped while it backs
+        // off or while its bus recovers, the other entries of the slot are still read.
+        //
+        status = sample_timer_end_cb_handler(ctx->timer, entry->sensor, read_status);
+        if (result == MANIKIN_STATUS_OK)
+        {
+            result = (status != MANIKIN_STATUS_OK) ? status : read_status;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file            sample_scheduler.h
+ * @brief           Multi-rate sample scheduler driving several sensors from one timer
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef SAMPLE_SCHEDULER_H
+#define SAMPLE_SCHEDULER_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+#include "sample_timer/sample_timer.h"
+
+/**
+ * The scheduler runs one timer at the base rate, the least common multiple of all sensor rates.
+ * A sensor sampled at rate_hz is read every base_rate_hz / rate_hz ticks, offset by its phase.
+ * The pattern repeats every hyperperiod, for which a static slot table is built at init:
+ *
+ *   slot:   0   1   2   3   4   5   6   7  ...
+ *   100 Hz  x   x   x   x   x   x   x   x
+ *    50 Hz      x       x       x       x
+ *    25 Hz  x               x
+ */
+#define SAMPLE_SCHEDULER_MAX_ENTRIES 16u
+#define SAMPLE_SCHEDULER_PHASE_AUTO  0xFFFFu
+
+    /**
+     * @brief Sample function of one sensor, e.g. a wrapper around sdp810_read()
+     * @param user Ptr given in the schedule entry
+     * @return Status of the read, passed on to sample_timer_end_cb_handler()
+     */
+    typedef manikin_status_t (*sample_scheduler_read_fn_t)(void *user);
+
+    typedef uint16_t sample_scheduler_slot_t; /* Bitmask of the entries read in a slot */
+
+    typedef struct
+    {
+        manikin_sensor_ctx_t      *sensor;  /* Sensor handed to the sample_timer recovery hooks */
+        sample_scheduler_read_fn_t read;    /* Called in every slot of this sensor */
+        void                      *user;    /* Passed to read */
+        uint16_t                   rate_hz; /* Sample rate, has to divide the base rate */
+        uint16_t                   phase;   /* Slot offset or SAMPLE_SCHEDULER_PHASE_AUTO */
+    } sample_scheduler_entry_t;
+
+    typedef struct
+    {
+        sample_timer_ctx_t       *timer;         /* Timer running at the base rate */
+        sample_scheduler_entry_t *entries;       /* Caller-provided schedule table */
+        uint8_t                   entry_cnt;     /* At most SAMPLE_SCHEDULER_MAX_ENTRIES */
+        sample_scheduler_slot_t  *slots;         /* Caller-provided slot table storage */
+        uint16_t                  slot_capacity; /* Number of elements in slots */
+        uint16_t                  hyperperiod;   /* Number of slots used, set by init */
+        uint16_t                  slot_idx;
+    } sample_scheduler_ctx_t;
+
+    /**
+     * @brief Build the slot table and initialize the timer at the base rate
+     *        Entries with phase SAMPLE_SCHEDULER_PHASE_AUTO get the phase that keeps the
+     *        number of reads per slot lowest, the chosen phase is written back to the entry.
+     * @note  timer->frequency is overwritten with the base rate
+     * @param ctx Ptr to the scheduler context, timer, entries, entry_cnt, slots and
+     *        slot_capacity have to be filled in by the caller beforehand
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or one of its pointers is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE when a rate is 0, the base rate
+     *         exceeds the maximum timer rate or a phase is not below the sensor period,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when entry_cnt is out of range or the
+     *         hyperperiod does not fit slot_capacity
+     */
+    manikin_status_t sample_scheduler_init(sample_scheduler_ctx_t *ctx);
+
+    /**
+     * @brief Start the base rate timer
+     * @param ctx Ptr to the scheduler context
+     * @return Status of sample_timer_start()
+     */
+    manikin_status_t sample_scheduler_start(sample_scheduler_ctx_t *ctx);
+
+    /**
+     * @brief Stop the base rate timer
+     * @param ctx Ptr to the scheduler context
+     * @return Status of sample_timer_stop()
+     */
+    manikin_status_t sample_scheduler_stop(sample_scheduler_ctx_t *ctx);
+
+    /**
+     * @brief Read all sensors of the current slot and advance to the next slot
+     *        Call once per timer tick (outside ISR-context!). Every read is wrapped in the
+     *        sample_timer start/end hooks, which skip a faulty sensor while it backs off or
+     *        while its bus is recovered. The other sensors keep their full rate.
+     * @param ctx Ptr to the scheduler context
+     * @return MANIKIN_STATUS_OK when all reads of the slot succeeded,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx is NULL,
+     *         otherwise the status of the first failed or skipped read
+     */
+    manikin_status_t sample_scheduler_tick(sample_scheduler_ctx_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SAMPLE_SCHEDULER_H
@@ -24,6 +24,8 @@
 
 #include "sample_timer.h"
 #include "error_handler/error_handler.h"
+#include "common/manikin_bit_manipulation.h"
+#include <string.h>
 #include <manikin_software_conf.h>
 #include <manikin_platform.h>
 
@@ -32,6 +34,14 @@
 #define SAMPLE_TIMER_I2C_BUS_RESET_FREQ_HZ 1u
 #define SAMPLE_TIMER_I2C_BUS_MAX_FREQ_HZ   1000u
 
+// NOTE: Recovery timing is in HAL ticks, which are milliseconds on the template platforms
+#define SAMPLE_TIMER_BUS_RESET_HOLD_TICKS      1000u
+#define SAMPLE_TIMER_DEVICE_BACKOFF_MIN_TICKS  10u
+#define SAMPLE_TIMER_DEVICE_BACKOFF_MAX_TICKS  1000u
+
+// NOTE: Consecutive fast bus clears before falling back to a bus power cycle
+#define SAMPLE_TIMER_BUS_CLEAR_MAX_ATTEMPTS 3u
+
 enum sample_timer_state
 {
     SAMPLE_TIMER_STATE_SAMPLING,
@@ -63,7 +73,8 @@ sample_timer_init (sample_timer_ctx_t *timer_inst)
     manikin_status_t status = sample_timer_check_params(timer_inst);
     MANIKIN_ASSERT(HASH_SAMPLE_TIMER, (status == MANIKIN_STATUS_OK), status);
     status            = MANIKIN_TIMER_HAL_INIT(timer_inst->timer, timer_inst->frequency);
-    timer_inst->state = SAMPLE_TIMER_STATE_SAMPLING;
+    timer_inst->state           = SAMPLE_TIMER_STATE_SAMPLING;
+    timer_inst->recovery_sensor = NULL;
     MANIKIN_ASSERT(HASH_SAMPLE_TIMER, (status == MANIKIN_STATUS_OK), status);
     // NOTE: Initialize watchdog with window of 2*sample-freq
     status = MANIKIN_WATCHDOG_HAL_TIMER_INIT(timer_inst->watchdog, timer_inst->frequency / 2);
@@ -98,6 +109,103 @@ sample_timer_deinit (sample_timer_ctx_t *timer_inst)
     status = MANIKIN_WATCHDOG_HAL_DEINIT(timer_inst->watchdog);
     return status;
 }
+/**
+ * @brief Find the stats entry of a sensor
+ * @return Ptr to the stats entry, NULL when instrumentation is off for this sensor
+ */
+static sample_timer_stats_t *
+sample_timer_find_stats (const sample_timer_ctx_t *timer_inst, const manikin_sensor_ctx_t *sensor)
+{
+    if (timer_inst->stats == NULL)
+    {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < timer_inst->stats_cnt; i++)
+    {
+        if (timer_inst->stats[i].sensor == sensor)
+        {
+            return &timer_inst->stats[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t
+sample_timer_stats_bucket (uint32_t ticks)
+{
+    uint8_t bucket = 0;
+    while (ticks != 0 && bucket < SAMPLE_TIMER_STATS_BUCKET_CNT - 1u)
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Ticks elapsed since tick, 0 when tick still lies in the future (an early start)
+ * @note  Unsigned difference, so it is also correct when the tick counter wraps
+ */
+static uint32_t
+sample_timer_ticks_since (uint32_t now, uint32_t tick)
+{
+    const uint32_t elapsed = now - tick;
+    return (elapsed > UINT32_MAX / 2u) ? 0u : elapsed;
+}
+
+static void
+sample_timer_stats_on_start (sample_timer_stats_t *stats)
+{
+    const uint32_t now = (uint32_t)MANIKIN_HAL_GET_TICK();
+    if (!stats->synced || stats->period_ticks == 0)
+    {
+        // NOTE: First sample (or first after a bus reset) defines the sampling grid
+        stats->expected_tick = now;
+        stats->synced        = 1;
+    }
+    const uint32_t latency = sample_timer_ticks_since(now, stats->expected_tick);
+    stats->counters.start_latency_hist[sample_timer_stats_bucket(latency)]++;
+    if (latency > stats->counters.max_start_latency)
+    {
+        stats->counters.max_start_latency = latency;
+    }
+    stats->start_tick = now;
+    stats->running    = 1;
+}
+
+static void
+sample_timer_stats_on_end (sample_timer_stats_t *stats)
+{
+    if (!stats->running)
+    {
+        return;
+    }
+    const uint32_t now      = (uint32_t)MANIKIN_HAL_GET_TICK();
+    const uint32_t duration = sample_timer_ticks_since(now, stats->start_tick);
+    const uint32_t deadline = stats->deadline_ticks ? stats->deadline_ticks : stats->period_ticks;
+    stats->counters.read_duration_hist[sample_timer_stats_bucket(duration)]++;
+    if (duration > stats->counters.max_read_duration)
+    {
+        stats->counters.max_read_duration = duration;
+    }
+    const uint32_t late = sample_timer_ticks_since(now, stats->expected_tick);
+    if (deadline != 0 && late > deadline)
+    {
+        stats->counters.deadline_misses++;
+    }
+    stats->counters.samples++;
+    stats->running = 0;
+
+    //
+    // Advance the grid to the next due tick. Samples which were skipped entirely (e.g. a read
+    // overrunning several periods) are not due anymore.
+    //
+    if (stats->period_ticks != 0)
+    {
+        stats->expected_tick += stats->period_ticks * (1u + late / stats->period_ticks);
+    }
+}
+
 static manikin_status_t
 sample_timer_disable_i2c (manikin_sensor_ctx_t *sensor)
 {
@@ -113,23 +221,101 @@ sample_timer_recover_i2c (manikin_sensor_ctx_t *sensor)
     status                  = MANIKIN_I2C_HAL_INIT(sensor->i2c, baud);
     return status;
 }
+
+/**
+ * @brief Fast recovery path, clock the bus free and re-init the peripheral without power cycle
+ * @return MANIKIN_STATUS_OK when the bus is operational again
+ */
 static manikin_status_t
-sample_timer_set_timeout_freq (sample_timer_ctx_t *timer_inst)
+sample_timer_clear_i2c (manikin_sensor_ctx_t *sensor)
 {
-    manikin_status_t status;
-    status = MANIKIN_TIMER_HAL_STOP(timer_inst->timer);
-    status = MANIKIN_TIMER_HAL_INIT(timer_inst->timer, SAMPLE_TIMER_I2C_BUS_RESET_FREQ_HZ);
-    status = MANIKIN_TIMER_HAL_START(timer_inst->timer);
-    return status;
+    const uint32_t baud = MANIKIN_I2C_GET_BAUD(sensor->i2c);
+    if (MANIKIN_I2C_BUS_CLEAR(sensor->i2c) != 0)
+    {
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
+    MANIKIN_I2C_HAL_DEINIT(sensor->i2c);
+    if (MANIKIN_I2C_HAL_INIT(sensor->i2c, baud) != 0)
+    {
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
+    manikin_status_t status = MANIKIN_I2C_HAL_ERROR_FLAG_CHECK(sensor->i2c);
+    return (status == MANIKIN_STATUS_OK) ? MANIKIN_STATUS_OK
+                                         : MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
 }
+
+/**
+ * @brief Check whether tick has been reached, also correct when the tick counter wraps
+ */
+static uint8_t
+sample_timer_tick_reached (uint32_t now, uint32_t tick)
+{
+    return (now - tick) <= UINT32_MAX / 2u;
+}
+
+/**
+ * @brief Let a sensor with a device fault back off, without touching the shared bus
+ */
+static void
+sample_timer_backoff_sensor (manikin_sensor_ctx_t *sensor, uint32_t now)
+{
+    if (sensor->recovery.fault_cnt < UINT8_MAX)
+    {
+        sensor->recovery.fault_cnt++;
+    }
+    // NOTE: Back-off doubles on each consecutive fault, up to the maximum
+    uint32_t backoff = SAMPLE_TIMER_DEVICE_BACKOFF_MIN_TICKS;
+    for (uint8_t i = 1;
+         i < sensor->recovery.fault_cnt && backoff < SAMPLE_TIMER_DEVICE_BACKOFF_MAX_TICKS; i++)
+    {
+        backoff <<= 1;
+    }
+    if (backoff > SAMPLE_TIMER_DEVICE_BACKOFF_MAX_TICKS)
+    {
+        backoff = SAMPLE_TIMER_DEVICE_BACKOFF_MAX_TICKS;
+    }
+    sensor->recovery.retry_tick = now + backoff;
+    // NOTE: The device may have lost its configuration, re-init it on the retry
+    sensor->needs_reinit = 1;
+}
+
+/**
+ * @brief Drive the bus power cycle, only the sensor which started it advances the steps
+ * @return MANIKIN_STATUS_OK when the bus is back, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG
+ *         while it is still being recovered
+ */
 static manikin_status_t
-sample_timer_reset_timeout (sample_timer_ctx_t *timer_inst)
+sample_timer_bus_recovery_step (sample_timer_ctx_t *timer_inst, manikin_sensor_ctx_t *sensor)
 {
-    manikin_status_t status;
-    status = MANIKIN_TIMER_HAL_STOP(timer_inst->timer);
-    status = MANIKIN_TIMER_HAL_INIT(timer_inst->timer, timer_inst->frequency);
-    status = MANIKIN_TIMER_HAL_START(timer_inst->timer);
-    return status;
+    const uint32_t now = (uint32_t)MANIKIN_HAL_GET_TICK();
+    if (sensor != timer_inst->recovery_sensor
+        || !sample_timer_tick_reached(now, timer_inst->recovery_tick))
+    {
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
+    switch (timer_inst->state)
+    {
+        case SAMPLE_TIMER_STATE_BUS_RESET: {
+            //
+            // Second state of statemachine, this recovers the voltage on sensor vcc and inits i2c
+            // back to original state.
+            //
+            manikin_status_t status = sample_timer_recover_i2c(sensor);
+            MANIKIN_ASSERT(HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, status);
+            timer_inst->state         = SAMPLE_TIMER_STATE_BUS_RECOVERY;
+            timer_inst->recovery_tick = now + SAMPLE_TIMER_BUS_RESET_HOLD_TICKS;
+            return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+        }
+        default: {
+            //
+            // Last state of statemachine, the sensors had time to power up. Sampling of the
+            // sensors on this bus can start once-again.
+            //
+            timer_inst->state           = SAMPLE_TIMER_STATE_SAMPLING;
+            timer_inst->recovery_sensor = NULL;
+            return MANIKIN_STATUS_OK;
+        }
+    }
 }
 
 manikin_status_t
@@ -139,39 +325,85 @@ sample_timer_end_cb_handler (sample_timer_ctx_t   *timer_inst,
 {
     manikin_status_t status = sample_timer_check_params(timer_inst);
     MANIKIN_ASSERT(HASH_SAMPLE_TIMER, (status == MANIKIN_STATUS_OK), status);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, sensor != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
     MANIKIN_WATCHDOG_HAL_KICK(timer_inst->watchdog);
+    sample_timer_stats_t *stats = sample_timer_find_stats(timer_inst, sensor);
+    if (stats != NULL)
+    {
+        sample_timer_stats_on_end(stats);
+    }
+    if (sensor->recovery.skipped)
+    {
+        // NOTE: Nothing was sampled, the fault is already being handled
+        sensor->recovery.skipped = 0;
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
     switch (read_status)
     {
         case MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG: {
+            const uint32_t now = (uint32_t)MANIKIN_HAL_GET_TICK();
             //
-            // Let's check once again if it is still blocked and we can fix it easily...
+            // Let's check if it is the bus that is blocked, or only this device...
             //
             status = MANIKIN_I2C_HAL_ERROR_FLAG_CHECK(sensor->i2c);
-            if (status != MANIKIN_STATUS_OK)
+            const uint8_t bus_fault
+                = (status != MANIKIN_STATUS_OK && timer_inst->state == SAMPLE_TIMER_STATE_SAMPLING);
+            if (bus_fault
+                && (timer_inst->cleared_bus != sensor->i2c
+                    || timer_inst->bus_clear_cnt < SAMPLE_TIMER_BUS_CLEAR_MAX_ATTEMPTS)
+                && sample_timer_clear_i2c(sensor) == MANIKIN_STATUS_OK)
             {
                 //
-                // Welp, it is still blocked...
+                // Most bus hangs are a device holding SDA after an interrupted transfer. Clocking
+                // it out frees the bus right away, so only this sensor re-inits and it is sampled
+                // again the next period.
                 //
-                if (timer_inst->state == SAMPLE_TIMER_STATE_SAMPLING)
+                if (timer_inst->cleared_bus != sensor->i2c)
                 {
-                    //
-                    // First state of statemachine, reset the voltage on sensor vcc and disable i2c
-                    //
-                    status            = sample_timer_disable_i2c(sensor);
-                    timer_inst->state = SAMPLE_TIMER_STATE_BUS_RESET;
-                    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, status);
+                    timer_inst->cleared_bus   = sensor->i2c;
+                    timer_inst->bus_clear_cnt = 0;
                 }
+                timer_inst->bus_clear_cnt++;
+                sensor->needs_reinit = 1;
+            }
+            else if (bus_fault)
+            {
                 //
-                // Set timer to timeout-state, waiting for bus and sensor to recover
+                // Welp, the bus stays blocked. First state of statemachine, reset the voltage on
+                // sensor vcc and disable i2c. Sensors on other buses keep sampling.
                 //
-                status = sample_timer_set_timeout_freq(timer_inst);
+                timer_inst->bus_clear_cnt   = 0;
+                status                      = sample_timer_disable_i2c(sensor);
+                timer_inst->state           = SAMPLE_TIMER_STATE_BUS_RESET;
+                timer_inst->recovery_sensor = sensor;
+                timer_inst->recovery_tick   = now + SAMPLE_TIMER_BUS_RESET_HOLD_TICKS;
+                timer_inst->bus_epoch++;
+                if (stats != NULL)
+                {
+                    // NOTE: Sampling restarts on a new grid after the bus reset
+                    stats->synced = 0;
+                }
                 MANIKIN_ASSERT(HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, status);
-                // NOTE: Return error state to make sure the statemachine fully finishes
-                status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
             }
+            else
+            {
+                //
+                // The bus is fine (or already being recovered for another sensor), so only this
+                // device misbehaves. It backs off on its own, the other sensors are not affected.
+                //
+                sample_timer_backoff_sensor(sensor, now);
+            }
+            // NOTE: Return error state, the sample is not valid
+            status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
             break;
         }
         case MANIKIN_STATUS_OK: {
+            sensor->recovery.fault_cnt = 0;
+            if (timer_inst->cleared_bus == sensor->i2c)
+            {
+                // NOTE: The bus works again, a new hang gets the fast path again
+                timer_inst->bus_clear_cnt = 0;
+            }
             break;
         }
         default: {
@@ -186,60 +418,120 @@ sample_timer_start_cb_handler (sample_timer_ctx_t *timer_inst, manikin_sensor_ct
 {
     manikin_status_t status = sample_timer_check_params(timer_inst);
     MANIKIN_ASSERT(HASH_SAMPLE_TIMER, (status == MANIKIN_STATUS_OK), status);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, sensor != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
     MANIKIN_WATCHDOG_HAL_KICK(timer_inst->watchdog);
-    switch (timer_inst->state)
+    sensor->recovery.skipped = 0;
+
+    //
+    // Sensors on a bus which is being power cycled wait until it is back
+    //
+    if (timer_inst->state != SAMPLE_TIMER_STATE_SAMPLING
+        && timer_inst->recovery_sensor->i2c == sensor->i2c
+        && sample_timer_bus_recovery_step(timer_inst, sensor) != MANIKIN_STATUS_OK)
     {
-        case SAMPLE_TIMER_STATE_BUS_RESET: {
-            //
-            // Second state of statemachine, this recovers the voltage on sensor vcc and inits i2c
-            // back to original state.
-            //
-            status = sample_timer_recover_i2c(sensor);
-            MANIKIN_ASSERT(HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, status);
+        sensor->recovery.skipped = 1;
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
 
-            // NOTE: Make sure the sensor driver inits after hard-reset
-            sensor->needs_reinit = 1;
-            timer_inst->state    = SAMPLE_TIMER_STATE_BUS_RECOVERY;
+    //
+    // A sensor with a device fault is skipped until its back-off time has passed
+    //
+    if (sensor->recovery.fault_cnt != 0
+        && !sample_timer_tick_reached((uint32_t)MANIKIN_HAL_GET_TICK(),
+                                      sensor->recovery.retry_tick))
+    {
+        sensor->recovery.skipped = 1;
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
 
-            // NOTE: It must return an error-state, otherwise the sensor sampling will continue
-            status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
-            break;
-        }
-        case SAMPLE_TIMER_STATE_BUS_RECOVERY: {
-            //
-            // Last state of statemachine, this state is after 2 second reset wait.
-            // It resets the timer back to sample-rate. So sampling of sensor can start once-again.
-            //
-            status = sample_timer_reset_timeout(timer_inst);
-            MANIKIN_ASSERT(HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, status);
-            timer_inst->state = SAMPLE_TIMER_STATE_SAMPLING;
+    // NOTE: Make sure the sensor driver inits after a hard-reset of the bus
+    if (sensor->recovery.bus_epoch != timer_inst->bus_epoch)
+    {
+        sensor->recovery.bus_epoch = timer_inst->bus_epoch;
+        sensor->needs_reinit       = 1;
+    }
 
-            // NOTE: It must return an error-state, otherwise the sensor sampling will continue
-            status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
-            break;
-        }
-        default: {
-            //
-            // This function checks if the scl & sda lines are not blocked and busy flag is not set
-            // If this is the case, it tries a simple recover mechanism. If it fails it returns an
-            // error-state.
-            //
-            status = MANIKIN_I2C_HAL_ERROR_FLAG_CHECK(sensor->i2c);
-            //
-            // If this asserts, something is seriously wrong with the i2c-bus or sensor.
-            // Wrong beyond being easily fixed with a few clock-cycles on i2c-scl. So we need to
-            // hard-reset the sensor, let's start the statemachine.
-            //
-            MANIKIN_ASSERT(HASH_SAMPLE_TIMER,
-                           status == MANIKIN_STATUS_OK,
-                           MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
-            //
-            // Everything seems to be fine, let's reset the statemachine, making sure it does not
-            // trigger sporadically
-            //
-            timer_inst->state = SAMPLE_TIMER_STATE_SAMPLING;
-            break;
-        }
+    //
+    // This function checks if the scl & sda lines are not blocked and busy flag is not set
+    // If this is the case, it tries a simple recover mechanism. If it fails it returns an
+    // error-state.
+    //
+    status = MANIKIN_I2C_HAL_ERROR_FLAG_CHECK(sensor->i2c);
+    //
+    // If this asserts, something is seriously wrong with the i2c-bus or sensor.
+    // Wrong beyond being easily fixed with a few clock-cycles on i2c-scl. So we need to
+    // hard-reset the bus, the end handler starts the statemachine.
+    //
+    MANIKIN_ASSERT(
+        HASH_SAMPLE_TIMER, status == MANIKIN_STATUS_OK, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+
+    sample_timer_stats_t *stats = sample_timer_find_stats(timer_inst, sensor);
+    if (stats != NULL)
+    {
+        sample_timer_stats_on_start(stats);
     }
-    return status;
-}
\ No newline at end of file
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+sample_timer_stats_reset (sample_timer_stats_t *stats)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, stats != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    memset(&stats->counters, 0, sizeof(stats->counters));
+    stats->synced  = 0;
+    stats->running = 0;
+    return MANIKIN_STATUS_OK;
+}
+
+manikin_status_t
+sample_timer_stats_snapshot (const sample_timer_stats_t    *stats,
+                             sample_timer_stats_snapshot_t *snapshot)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, stats != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, stats->sensor != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, snapshot != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    *snapshot             = stats->counters;
+    snapshot->sensor_addr = stats->sensor->i2c_addr;
+    return MANIKIN_STATUS_OK;
+}
+
+static uint8_t *
+sample_timer_write_u32 (uint8_t *out, uint32_t val)
+{
+    out[0] = GET_LOWER_8_BITS_OF_SHORT(val);
+    out[1] = GET_UPPER_8_BITS_OF_SHORT(val);
+    out[2] = GET_LOWER_8_BITS_OF_SHORT(val >> 16);
+    out[3] = GET_UPPER_8_BITS_OF_SHORT(val >> 16);
+    return out + 4;
+}
+
+manikin_status_t
+sample_timer_stats_serialize (const sample_timer_stats_snapshot_t *snapshot,
+                              uint8_t                             *out,
+                              size_t                               out_max_len,
+                              size_t                              *out_len)
+{
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, snapshot != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, out != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER, out_len != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SAMPLE_TIMER,
+                   out_max_len >= SAMPLE_TIMER_STATS_SERIALIZED_SIZE,
+                   MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    uint8_t *pos = out;
+    *pos++       = snapshot->sensor_addr;
+    pos          = sample_timer_write_u32(pos, snapshot->samples);
+    pos          = sample_timer_write_u32(pos, snapshot->deadline_misses);
+    pos          = sample_timer_write_u32(pos, snapshot->max_start_latency);
+    pos          = sample_timer_write_u32(pos, snapshot->max_read_duration);
+    for (uint8_t i = 0; i < SAMPLE_TIMER_STATS_BUCKET_CNT; i++)
+    {
+        pos = sample_timer_write_u32(pos, snapshot->start_latency_hist[i]);
+    }
+    for (uint8_t i = 0; i < SAMPLE_TIMER_STATS_BUCKET_CNT; i++)
+    {
+        pos = sample_timer_write_u32(pos, snapshot->read_duration_hist[i]);
+    }
+    *out_len = SAMPLE_TIMER_STATS_SERIALIZED_SIZE;
+    return MANIKIN_STATUS_OK;
+}
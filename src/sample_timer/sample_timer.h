@@ -31,12 +31,49 @@ extern "C"
 
 #include "common/manikin_types.h"
 
+/**
+ * Latency histograms use log2 buckets of HAL ticks: bucket 0 counts 0 ticks, bucket n counts
+ * [2^(n-1), 2^n) ticks and the last bucket everything above.
+ */
+#define SAMPLE_TIMER_STATS_BUCKET_CNT      8u
+#define SAMPLE_TIMER_STATS_SERIALIZED_SIZE (1u + 4u * (4u + 2u * SAMPLE_TIMER_STATS_BUCKET_CNT))
+
+    typedef struct
+    {
+        uint8_t  sensor_addr;       /* I2C address of the sensor */
+        uint32_t samples;           /* Number of completed reads */
+        uint32_t deadline_misses;   /* Reads that completed after their deadline */
+        uint32_t max_start_latency; /* Largest delay (ticks) of a read start */
+        uint32_t max_read_duration; /* Longest read (ticks) */
+        uint32_t start_latency_hist[SAMPLE_TIMER_STATS_BUCKET_CNT];
+        uint32_t read_duration_hist[SAMPLE_TIMER_STATS_BUCKET_CNT];
+    } sample_timer_stats_snapshot_t;
+
+    typedef struct
+    {
+        const manikin_sensor_ctx_t   *sensor;         /* Sensor these stats belong to */
+        uint32_t                      period_ticks;   /* HAL ticks between samples, 0 == no grid */
+        uint32_t                      deadline_ticks; /* Max ticks from due to done, 0 == period */
+        uint32_t                      expected_tick;
+        uint32_t                      start_tick;
+        uint8_t                       synced;
+        uint8_t                       running;
+        sample_timer_stats_snapshot_t counters;
+    } sample_timer_stats_t;
+
     typedef struct
     {
         manikin_timer_inst_t    timer;
         manikin_watchdog_inst_t watchdog;
         uint16_t                frequency;
         uint8_t                 state;
+        sample_timer_stats_t   *stats;     /* Optional per-sensor instrumentation, NULL == off */
+        uint8_t                 stats_cnt; /* Number of elements in stats */
+        manikin_sensor_ctx_t   *recovery_sensor; /* Sensor driving a bus power cycle */
+        uint32_t                recovery_tick;   /* HAL tick of the next bus recovery step */
+        uint8_t                 bus_epoch;       /* Number of bus power cycles */
+        manikin_i2c_inst_t      cleared_bus;     /* Bus of the last fast bus clear */
+        uint8_t                 bus_clear_cnt;   /* Fast clears of cleared_bus without success */
     } sample_timer_ctx_t;
 
     /**
@@ -75,15 +112,32 @@ extern "C"
      */
     manikin_status_t sample_timer_deinit(sample_timer_ctx_t *timer_inst);
 
+    /**
+     * Fault handling keeps its state per sensor (sensor->recovery) and per bus, the timer keeps
+     * running at its sample rate for all other sensors:
+     *
+     * - Device fault (read fails, bus lines are fine): only this sensor backs off. It is
+     *   skipped for an exponentially growing number of HAL ticks and re-initialized on retry.
+     * - Bus fault (SCL/SDA blocked or busy flag stuck): the bus is first cleared with SCL pulses
+     *   and a STOP, and the peripheral and sensor are re-initialized. This takes one sample
+     *   period. Only when clearing does not free the bus, or the bus hangs again a few times in
+     *   a row, the bus is power cycled. Sensors on that bus are skipped until it is back, all
+     *   sensors re-initialize after the power cycle.
+     */
+
     /**
      * @brief This method should be called before a sample process effort (outside ISR-context!)
      *        It does the following things:
      *        - Reset the watchdog
      *        - Handle Error Conditions (by resetting the I2C-bus or device)
+     *        - Record the start latency when stats are attached for this sensor
      * @param timer_inst Struct handle to sample_timer_ctx_t which contains the settings for the
      * timer peripheral
      * @param sensor The sensor instance which should be sampled
-     * @return MANIKIN_STATUS_OK: No error occured when resetting peripheral
+     * @return MANIKIN_STATUS_OK: The sensor can be sampled
+     *         MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG: Skip this sample, the sensor is backing
+     *         off, its bus is being recovered or the bus turned out to be blocked. Pass the
+     *         status on to sample_timer_end_cb_handler() anyway.
      */
     manikin_status_t sample_timer_start_cb_handler(sample_timer_ctx_t   *timer_inst,
                                                    manikin_sensor_ctx_t *sensor);
@@ -93,15 +147,56 @@ extern "C"
      *        It does the following things:
      *        - Reset the watchdog
      *        - Handle Error Conditions (by resetting the I2C-bus or device)
+     *        - Record the read duration and deadline misses when stats are attached
      * @param timer_inst Struct handle to sample_timer_ctx_t which contains the settings for the
      * timer peripheral
      * @param sensor The sensor instance which has been sampled
      * @param read_status The status received from the sensor_read() function
      * @return MANIKIN_STATUS_OK: No error occured when resetting peripheral
+     *         MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG: The sample failed or was skipped
      */
     manikin_status_t sample_timer_end_cb_handler(sample_timer_ctx_t   *timer_inst,
                                                  manikin_sensor_ctx_t *sensor,
                                                  manikin_status_t      read_status);
+
+    /**
+     * @brief Clear the counters of a stats entry, the sensor and period settings are kept
+     * @param stats Ptr to the stats entry
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when stats is NULL
+     */
+    manikin_status_t sample_timer_stats_reset(sample_timer_stats_t *stats);
+
+    /**
+     * @brief Copy the counters of a stats entry
+     * @note  The counters are only updated by the start/end hooks, call this from the same
+     *        context as the hooks for a consistent snapshot.
+     * @param stats Ptr to the stats entry
+     * @param snapshot Ptr to the snapshot to fill
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when stats, its sensor or snapshot is NULL
+     */
+    manikin_status_t sample_timer_stats_snapshot(const sample_timer_stats_t    *stats,
+                                                 sample_timer_stats_snapshot_t *snapshot);
+
+    /**
+     * @brief Serialize a snapshot (little-endian), so it fits a single packet_parser payload:
+     *
+     *   | sensor_addr (u8) | samples | deadline_misses | max_start_latency | max_read_duration |
+     *   | start_latency_hist[8] | read_duration_hist[8] |  (all u32)
+     *
+     * @param snapshot Ptr to the snapshot
+     * @param out Ptr to output buffer
+     * @param out_max_len Size of out, at least SAMPLE_TIMER_STATS_SERIALIZED_SIZE
+     * @param out_len Ptr to the number of bytes written
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when a pointer is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE when out is too small
+     */
+    manikin_status_t sample_timer_stats_serialize(const sample_timer_stats_snapshot_t *snapshot,
+                                                  uint8_t                             *out,
+                                                  size_t                               out_max_len,
+                                                  size_t                              *out_len);
 #ifdef __cplusplus
 }
 #endif
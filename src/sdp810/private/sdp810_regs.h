@@ -41,6 +41,14 @@ extern "C"
 #define SDP810_READ_SCALE_FACTOR_LSB  7u
 #define SDP810_READ_SCALE_FACTOR_CRC  8u
 
+/* The sensor may be NACKed after any word, so it is read as 1, 2 or 3 words of 2 bytes + CRC */
+#define SDP810_WORD_SIZE             3u
+#define SDP810_READ_PRESSURE_SIZE    SDP810_WORD_SIZE
+#define SDP810_READ_TEMPERATURE_SIZE (2u * SDP810_WORD_SIZE)
+
+/* Sensirion CRC-8 over each 16-bit word */
+#define SDP810_CRC8_INIT 0xFFu
+
 #ifdef __cplusplus
 }
 #endif
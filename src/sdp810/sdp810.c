@@ -25,6 +25,7 @@
 #include "sdp810.h"
 
 #include "common/manikin_bit_manipulation.h"
+#include "common/manikin_time.h"
 #include "i2c/i2c.h"
 #include "private/sdp810_regs.h"
 #include "error_handler/error_handler.h"
@@ -36,6 +37,30 @@
 static const manikin_sensor_reg_t SDP810_init_regs[]
     = { { SDP810_REG_CONT_MASS_FLOW, 0x00, MANIKIN_SENSOR_REG_TYPE_WRITE } };
 
+/* Sensirion CRC-8, polynomial 0x31 */
+static const uint8_t sdp810_crc8_table[256] = {
+    0x00u, 0x31u, 0x62u, 0x53u, 0xC4u, 0xF5u, 0xA6u, 0x97u, 0xB9u, 0x88u, 0xDBu, 0xEAu, 0x7Du,
+    0x4Cu, 0x1Fu, 0x2Eu, 0x43u, 0x72u, 0x21u, 0x10u, 0x87u, 0xB6u, 0xE5u, 0xD4u, 0xFAu, 0xCBu,
+    0x98u, 0xA9u, 0x3Eu, 0x0Fu, 0x5Cu, 0x6Du, 0x86u, 0xB7u, 0xE4u, 0xD5u, 0x42u, 0x73u, 0x20u,
+    0x11u, 0x3Fu, 0x0Eu, 0x5Du, 0x6Cu, 0xFBu, 0xCAu, 0x99u, 0xA8u, 0xC5u, 0xF4u, 0xA7u, 0x96u,
+    0x01u, 0x30u, 0x63u, 0x52u, 0x7Cu, 0x4Du, 0x1Eu, 0x2Fu, 0xB8u, 0x89u, 0xDAu, 0xEBu, 0x3Du,
+    0x0Cu, 0x5Fu, 0x6Eu, 0xF9u, 0xC8u, 0x9Bu, 0xAAu, 0x84u, 0xB5u, 0xE6u, 0xD7u, 0x40u, 0x71u,
+    0x22u, 0x13u, 0x7Eu, 0x4Fu, 0x1Cu, 0x2Du, 0xBAu, 0x8Bu, 0xD8u, 0xE9u, 0xC7u, 0xF6u, 0xA5u,
+    0x94u, 0x03u, 0x32u, 0x61u, 0x50u, 0xBBu, 0x8Au, 0xD9u, 0xE8u, 0x7Fu, 0x4Eu, 0x1Du, 0x2Cu,
+    0x02u, 0x33u, 0x60u, 0x51u, 0xC6u, 0xF7u, 0xA4u, 0x95u, 0xF8u, 0xC9u, 0x9Au, 0xABu, 0x3Cu,
+    0x0Du, 0x5Eu, 0x6Fu, 0x41u, 0x70u, 0x23u, 0x12u, 0x85u, 0xB4u, 0xE7u, 0xD6u, 0x7Au, 0x4Bu,
+    0x18u, 0x29u, 0xBEu, 0x8Fu, 0xDCu, 0xEDu, 0xC3u, 0xF2u, 0xA1u, 0x90u, 0x07u, 0x36u, 0x65u,
+    0x54u, 0x39u, 0x08u, 0x5Bu, 0x6Au, 0xFDu, 0xCCu, 0x9Fu, 0xAEu, 0x80u, 0xB1u, 0xE2u, 0xD3u,
+    0x44u, 0x75u, 0x26u, 0x17u, 0xFCu, 0xCDu, 0x9Eu, 0xAFu, 0x38u, 0x09u, 0x5Au, 0x6Bu, 0x45u,
+    0x74u, 0x27u, 0x16u, 0x81u, 0xB0u, 0xE3u, 0xD2u, 0xBFu, 0x8Eu, 0xDDu, 0xECu, 0x7Bu, 0x4Au,
+    0x19u, 0x28u, 0x06u, 0x37u, 0x64u, 0x55u, 0xC2u, 0xF3u, 0xA0u, 0x91u, 0x47u, 0x76u, 0x25u,
+    0x14u, 0x83u, 0xB2u, 0xE1u, 0xD0u, 0xFEu, 0xCFu, 0x9Cu, 0xADu, 0x3Au, 0x0Bu, 0x58u, 0x69u,
+    0x04u, 0x35u, 0x66u, 0x57u, 0xC0u, 0xF1u, 0xA2u, 0x93u, 0xBDu, 0x8Cu, 0xDFu, 0xEEu, 0x79u,
+    0x48u, 0x1Bu, 0x2Au, 0xC1u, 0xF0u, 0xA3u, 0x92u, 0x05u, 0x34u, 0x67u, 0x56u, 0x78u, 0x49u,
+    0x1Au, 0x2Bu, 0xBCu, 0x8Du, 0xDEu, 0xEFu, 0x82u, 0xB3u, 0xE0u, 0xD1u, 0x46u, 0x77u, 0x24u,
+    0x15u, 0x3Bu, 0x0Au, 0x59u, 0x68u, 0xFFu, 0xCEu, 0x9Du, 0xACu
+};
+
 /**
  * @brief Internal function to check the parameters entered into function
  * @param sensor_ctx The sensor settings ptr which should contain i2c bus details
@@ -50,12 +75,83 @@ sdp810_check_params (manikin_sensor_ctx_t *sensor_ctx)
     return MANIKIN_STATUS_OK;
 }
 
+/**
+ * @brief Check the CRC of each word in buf
+ * @param buf Ptr to len bytes of words followed by their CRC
+ * @param len Number of bytes, a multiple of SDP810_WORD_SIZE
+ * @return 1 when all CRCs match, 0 otherwise
+ */
+static uint8_t
+sdp810_words_valid (const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i += SDP810_WORD_SIZE)
+    {
+        uint8_t crc = sdp810_crc8_table[SDP810_CRC8_INIT ^ buf[i]];
+        crc         = sdp810_crc8_table[crc ^ buf[i + 1u]];
+        if (crc != buf[i + 2u])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Read the pressure, and only when due the temperature and scale factor
+ */
+static manikin_status_t
+sdp810_read_fast (manikin_sensor_ctx_t *sensor_ctx, sdp810_fast_ctx_t *fast, uint8_t *read_buf)
+{
+    size_t len = SDP810_READ_PRESSURE_SIZE;
+    if (!fast->scale_factor_valid)
+    {
+        len = SDP810_READ_BUFFER_SIZE;
+    }
+    else if (fast->temp_refresh_interval != 0
+             && fast->samples_since_temp + 1u >= fast->temp_refresh_interval)
+    {
+        len = SDP810_READ_TEMPERATURE_SIZE;
+    }
+
+    manikin_sample_stamp(sensor_ctx);
+    const size_t bytes_read
+        = manikin_i2c_read_bytes(sensor_ctx->i2c, sensor_ctx->i2c_addr, read_buf, len);
+    MANIKIN_ASSERT(HASH_SDP810, bytes_read == len, MANIKIN_STATUS_ERR_READ_FAIL);
+    MANIKIN_ASSERT(HASH_SDP810, sdp810_words_valid(read_buf, len), MANIKIN_STATUS_ERR_READ_FAIL);
+
+    if (len == SDP810_READ_BUFFER_SIZE)
+    {
+        memcpy(fast->scale_factor, &read_buf[SDP810_READ_SCALE_FACTOR_MSB], SDP810_WORD_SIZE);
+        fast->scale_factor_valid = 1;
+    }
+    if (len >= SDP810_READ_TEMPERATURE_SIZE)
+    {
+        memcpy(fast->temperature, &read_buf[SDP810_READ_TEMPERATURE_MSB], SDP810_WORD_SIZE);
+        fast->samples_since_temp = 0;
+    }
+    else
+    {
+        fast->samples_since_temp++;
+    }
+    memcpy(&read_buf[SDP810_READ_TEMPERATURE_MSB], fast->temperature, SDP810_WORD_SIZE);
+    memcpy(&read_buf[SDP810_READ_SCALE_FACTOR_MSB], fast->scale_factor, SDP810_WORD_SIZE);
+    manikin_sample_complete(sensor_ctx);
+    return MANIKIN_STATUS_OK;
+}
+
 manikin_status_t
 sdp810_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
 {
     manikin_status_t status = sdp810_check_params(sensor_ctx);
     MANIKIN_ASSERT(HASH_SDP810, (status == MANIKIN_STATUS_OK), status);
     sensor_ctx->needs_reinit = 0;
+    if (sensor_ctx->driver_ctx != NULL)
+    {
+        // NOTE: The scale factor is re-read, the sensor may have been swapped or power cycled
+        sdp810_fast_ctx_t *fast  = (sdp810_fast_ctx_t *)sensor_ctx->driver_ctx;
+        fast->scale_factor_valid = 0;
+        fast->samples_since_temp = 0;
+    }
     for (size_t i = 0; i < sizeof(SDP810_init_regs) / sizeof(manikin_sensor_reg_t); i++)
     {
         // WARNING: Cast in line below.
@@ -79,12 +175,19 @@ sdp810_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
         sdp810_init_sensor(sensor_ctx);
     }
 
+    if (sensor_ctx->driver_ctx != NULL)
+    {
+        return sdp810_read_fast(sensor_ctx, (sdp810_fast_ctx_t *)sensor_ctx->driver_ctx, read_buf);
+    }
+
+    manikin_sample_stamp(sensor_ctx);
     size_t bytes_read = manikin_i2c_read_bytes(
         sensor_ctx->i2c, sensor_ctx->i2c_addr, read_buf, SDP810_READ_BUFFER_SIZE);
 
     MANIKIN_ASSERT(
         HASH_SDP810, bytes_read == SDP810_READ_BUFFER_SIZE, MANIKIN_STATUS_ERR_READ_FAIL);
 
+    manikin_sample_complete(sensor_ctx);
     return MANIKIN_STATUS_OK;
 }
 
@@ -101,9 +204,13 @@ sdp810_parse_raw_data (const uint8_t *raw_data, sdp810_sample_data_t *data)
 {
     MANIKIN_ASSERT(HASH_SDP810, (raw_data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
     MANIKIN_ASSERT(HASH_SDP810, (data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810,
+                   sdp810_words_valid(raw_data, SDP810_READ_BUFFER_SIZE),
+                   MANIKIN_STATUS_ERR_CONVERSION_FAILED);
     const int16_t  unscaled_data = (int16_t)(CONSTRUCT_SHORT_FROM_BYTES(raw_data[0], raw_data[1]));
     const uint16_t temp          = (CONSTRUCT_SHORT_FROM_BYTES(raw_data[3], raw_data[4]));
     const uint16_t scale_factor  = (CONSTRUCT_SHORT_FROM_BYTES(raw_data[6], raw_data[7]));
+    MANIKIN_ASSERT(HASH_SDP810, scale_factor != 0, MANIKIN_STATUS_ERR_CONVERSION_FAILED);
     data->air_pressure_mbar      = (float)unscaled_data / (float)scale_factor;
     data->air_temp_mbar          = (float)temp / (float)scale_factor;
     return MANIKIN_STATUS_OK;
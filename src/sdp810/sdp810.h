@@ -30,6 +30,41 @@ extern "C"
 #endif
 
 #include "common/manikin_types.h"
+
+/**
+ * @brief I2C traffic of one sdp810_read_sensor() call, used by bus_planner:
+ *        9-byte read of both measurements including CRCs
+ */
+#define SDP810_READ_TRANSACTIONS 1u
+#define SDP810_READ_BYTES        9u
+
+/**
+ * @brief I2C traffic of one sdp810_read_sensor() call in fast mode, used by bus_planner:
+ *        3-byte read of the pressure and its CRC. Every temp_refresh_interval samples the read
+ *        is 6 bytes, the first read after init is the full 9 bytes.
+ */
+#define SDP810_FAST_READ_TRANSACTIONS 1u
+#define SDP810_FAST_READ_BYTES        3u
+
+/**
+ * @brief Size of the raw sample written by sdp810_read_sensor() in both modes
+ */
+#define SDP810_SAMPLE_SIZE 9u
+
+    /**
+     * @brief State of the fast read mode, point sensor_ctx->driver_ctx at it before init.
+     *        The scale factor is read once after init and the temperature every
+     *        temp_refresh_interval samples, other samples only read the pressure. The cached
+     *        words are copied into each sample, so its layout is the same as in the full read.
+     */
+    typedef struct
+    {
+        uint16_t temp_refresh_interval; /* Samples per temperature read, 0 only reads it once */
+        uint16_t samples_since_temp;    /* Driver state: pressure-only reads since the last one */
+        uint8_t  temperature[3];        /* Driver state: last temperature word and its CRC */
+        uint8_t  scale_factor[3];       /* Driver state: scale factor word and its CRC */
+        uint8_t  scale_factor_valid;    /* Driver state: cleared by init */
+    } sdp810_fast_ctx_t;
     /**
      * @brief This struct contains the structure of samples for sdp810 differential pressure sensor
      *        The units are mBar and degrees Celsius
@@ -41,7 +76,8 @@ extern "C"
     } sdp810_sample_data_t;
 
     /**
-     * @brief Initialize the sensor, which disables continuous sampling mode.
+     * @brief Initialize the sensor, which starts continuous sampling mode. A sdp810_fast_ctx_t
+     *        in sensor_ctx->driver_ctx is reset, so the next read fetches the scale factor.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
@@ -52,13 +88,14 @@ extern "C"
     manikin_status_t sdp810_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
-     * @brief Read the sensor, which should read 6-bytes of data (first four bytes are 32-bit float
-     * diff pressure (mBar), next two bytes temperature (degrees Celsius))
+     * @brief Read the sensor, which writes SDP810_SAMPLE_SIZE bytes of data: the differential
+     *        pressure, the temperature and the scale factor, each 2 bytes followed by a CRC.
+     *        In fast mode (see sdp810_fast_ctx_t) the CRCs of the words read are checked.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @param read_buf Ptr to read-buffer which is used for storing the samples
      * @return MANIKIN_STATUS_OK on success,
-     *         MANIKIN_STATUS_READ_FAIL on failure while reading,
+     *         MANIKIN_STATUS_READ_FAIL on failure while reading or a CRC mismatch,
      *         MANIKIN_STATUS_WRITE_FAIL on failure while writing.
      */
     manikin_status_t sdp810_read_sensor(manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf);
@@ -79,7 +116,8 @@ extern "C"
      * @param data     Ptr to struct to save the processed samples to
      * @return         MANIKIN_STATUS_OK on Successful conversion
      *                 MANIKIN_STATUS_ERR_NULL_PARAM on invalid raw_data or data param
-     *                 MANIKIN_STATUS_ERR_CONVERSION_FAILED on error while converting samples
+     *                 MANIKIN_STATUS_ERR_CONVERSION_FAILED on a CRC mismatch or a zero scale
+     *                 factor
      */
     manikin_status_t sdp810_parse_raw_data(const uint8_t *raw_data, sdp810_sample_data_t *data);
 #ifdef __cplusplus
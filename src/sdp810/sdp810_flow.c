@@ -0,0 +1,248 @@
+/**
+ * @file            sdp810_flow.c
+ * @brief           Streaming flow-to-volume integrator for the SDP810 differential pressure sensor
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "sdp810_flow.h"
+
+#include "common/manikin_bit_manipulation.h"
+#include "private/sdp810_regs.h"
+#include "error_handler/error_handler.h"
+
+#define HASH_SDP810_FLOW 0xA02A5977u
+
+#define SDP810_FLOW_MPA_PER_PA 1000
+
+/* sqrt(mPa * 10^9) is sqrt(Pa) * 10^6, so the root keeps six decimals */
+#define SDP810_FLOW_ROOT_PRESCALE 1000000000ull
+#define SDP810_FLOW_ROOT_SCALE    1000000
+
+/* The trapezoid area is in uL/s * us, twice the actual area */
+#define SDP810_FLOW_AREA_PER_UL (2 * 1000000)
+
+/* Longer gaps between samples are not integrated, so (f0 + f1) * dt cannot overflow */
+#define SDP810_FLOW_MAX_GAP_US 0x7FFFFFFFu
+
+/**
+ * @brief Integer square root, rounded down
+ */
+static uint32_t
+sdp810_flow_isqrt (uint64_t val)
+{
+    uint64_t root = 0;
+    uint64_t bit  = 1ull << 62u;
+    while (bit > val)
+    {
+        bit >>= 2u;
+    }
+    while (bit != 0)
+    {
+        if (val >= root + bit)
+        {
+            val -= root + bit;
+            root = (root >> 1u) + bit;
+        }
+        else
+        {
+            root >>= 1u;
+        }
+        bit >>= 2u;
+    }
+    return (uint32_t)root;
+}
+
+static int32_t
+sdp810_flow_clamp (int64_t val)
+{
+    if (val > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (val < -INT32_MAX)
+    {
+        return -INT32_MAX;
+    }
+    return (int32_t)val;
+}
+
+static int32_t
+sdp810_flow_from_sqrt (const sdp810_flow_config_t *config, int32_t dp_mpa)
+{
+    const uint64_t magnitude = (dp_mpa < 0) ? (uint64_t)(-(int64_t)dp_mpa) : (uint64_t)dp_mpa;
+    const int64_t  root      = sdp810_flow_isqrt(magnitude * SDP810_FLOW_ROOT_PRESCALE);
+    const int64_t  flow      = ((int64_t)config->sqrt_coeff * root) / SDP810_FLOW_ROOT_SCALE;
+    return sdp810_flow_clamp((dp_mpa < 0) ? -flow : flow);
+}
+
+static int32_t
+sdp810_flow_from_table (const sdp810_flow_config_t *config, int32_t dp_mpa)
+{
+    const sdp810_flow_cal_point_t *table = config->table;
+    const uint8_t                  last  = (uint8_t)(config->table_len - 1u);
+    if (dp_mpa <= table[0].dp_mpa)
+    {
+        return table[0].flow_ul_s;
+    }
+    if (dp_mpa >= table[last].dp_mpa)
+    {
+        return table[last].flow_ul_s;
+    }
+    uint8_t lo = 0;
+    uint8_t hi = last;
+    while (hi - lo > 1)
+    {
+        const uint8_t mid = (uint8_t)((lo + hi) / 2u);
+        if (dp_mpa < table[mid].dp_mpa)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    const int64_t span_dp   = (int64_t)table[hi].dp_mpa - table[lo].dp_mpa;
+    const int64_t span_flow = (int64_t)table[hi].flow_ul_s - table[lo].flow_ul_s;
+    const int64_t offset_dp = (int64_t)dp_mpa - table[lo].dp_mpa;
+    return sdp810_flow_clamp(table[lo].flow_ul_s + (span_flow * offset_dp) / span_dp);
+}
+
+manikin_status_t
+sdp810_flow_init (sdp810_flow_ctx_t *ctx, const sdp810_flow_config_t *config)
+{
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, config != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW,
+                   config->cal_type == SDP810_FLOW_CAL_SQRT
+                       || config->cal_type == SDP810_FLOW_CAL_TABLE,
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    if (config->cal_type == SDP810_FLOW_CAL_TABLE)
+    {
+        MANIKIN_ASSERT(HASH_SDP810_FLOW, config->table != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+        MANIKIN_ASSERT(HASH_SDP810_FLOW,
+                       config->table_len >= SDP810_FLOW_TABLE_MIN_POINTS,
+                       MANIKIN_STATUS_ERR_INVALID_CONFIG);
+        for (uint8_t i = 1; i < config->table_len; i++)
+        {
+            MANIKIN_ASSERT(HASH_SDP810_FLOW,
+                           config->table[i].dp_mpa > config->table[i - 1u].dp_mpa,
+                           MANIKIN_STATUS_ERR_INVALID_CONFIG);
+        }
+    }
+    MANIKIN_ASSERT(HASH_SDP810_FLOW,
+                   config->breath_end_ul_s <= config->breath_start_ul_s,
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    ctx->config    = config;
+    ctx->flow_ul_s = 0;
+    ctx->last_us   = 0;
+    ctx->start_us  = 0;
+    ctx->area      = 0;
+    ctx->peak_ul_s = 0;
+    ctx->has_last  = 0;
+    ctx->in_breath = 0;
+    return MANIKIN_STATUS_OK;
+}
+
+int32_t
+sdp810_flow_from_pressure (const sdp810_flow_config_t *config, int32_t dp_mpa)
+{
+    if (config == NULL)
+    {
+        return 0;
+    }
+    if (config->cal_type == SDP810_FLOW_CAL_TABLE)
+    {
+        return sdp810_flow_from_table(config, dp_mpa);
+    }
+    return sdp810_flow_from_sqrt(config, dp_mpa);
+}
+
+manikin_status_t
+sdp810_flow_update (sdp810_flow_ctx_t    *ctx,
+                    const uint8_t        *raw_data,
+                    uint64_t              timestamp_us,
+                    sdp810_flow_breath_t *breath)
+{
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, ctx != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, ctx->config != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, raw_data != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, breath != NULL, MANIKIN_STATUS_ERR_NULL_PARAM);
+    breath->complete = 0;
+
+    const int16_t raw_dp = (int16_t)CONSTRUCT_SHORT_FROM_BYTES(
+        raw_data[SDP810_READ_DIFF_PRESSURE_MSB], raw_data[SDP810_READ_DIFF_PRESSURE_LSB]);
+    const uint16_t scale_factor = CONSTRUCT_SHORT_FROM_BYTES(
+        raw_data[SDP810_READ_SCALE_FACTOR_MSB], raw_data[SDP810_READ_SCALE_FACTOR_LSB]);
+    MANIKIN_ASSERT(HASH_SDP810_FLOW, scale_factor != 0, MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+
+    const sdp810_flow_config_t *config = ctx->config;
+    const int32_t dp_mpa = ((int32_t)raw_dp * SDP810_FLOW_MPA_PER_PA) / (int32_t)scale_factor;
+    const int32_t flow   = sdp810_flow_from_pressure(config, dp_mpa);
+
+    int64_t segment = 0;
+    if (ctx->has_last && timestamp_us > ctx->last_us
+        && timestamp_us - ctx->last_us <= SDP810_FLOW_MAX_GAP_US)
+    {
+        segment = ((int64_t)ctx->flow_ul_s + flow) * (int64_t)(timestamp_us - ctx->last_us);
+    }
+    ctx->flow_ul_s = flow;
+    ctx->last_us   = timestamp_us;
+    ctx->has_last  = 1;
+
+    if (!ctx->in_breath)
+    {
+        if (flow > config->breath_start_ul_s)
+        {
+            ctx->in_breath = 1;
+            ctx->start_us  = timestamp_us;
+            ctx->area      = 0;
+            ctx->peak_ul_s = flow;
+        }
+        return MANIKIN_STATUS_OK;
+    }
+
+    ctx->area += segment;
+    if (flow > ctx->peak_ul_s)
+    {
+        ctx->peak_ul_s = flow;
+    }
+    if (flow >= config->breath_end_ul_s)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+
+    ctx->in_breath          = 0;
+    const uint64_t duration = timestamp_us - ctx->start_us;
+    if (duration < config->min_breath_us)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+    int64_t volume = ctx->area / SDP810_FLOW_AREA_PER_UL;
+    // NOTE: The flow can dip below zero on the last segment of the breath
+    volume                 = (volume < 0) ? 0 : volume;
+    breath->start_us       = ctx->start_us;
+    breath->duration_us    = (duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration;
+    breath->volume_ul      = (volume > UINT32_MAX) ? UINT32_MAX : (uint32_t)volume;
+    breath->peak_flow_ul_s = ctx->peak_ul_s;
+    breath->complete       = 1;
+    return MANIKIN_STATUS_OK;
+}
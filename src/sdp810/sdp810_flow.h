@@ -0,0 +1,132 @@
+/**
+ * @file            sdp810_flow.h
+ * @brief           Streaming flow-to-volume integrator for the SDP810 differential pressure sensor
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef SDP810_FLOW_H
+#define SDP810_FLOW_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "common/manikin_types.h"
+
+/**
+ * Every SDP810 sample is converted to a flow and integrated into the volume of the current
+ * breath as it arrives, so no sample history is kept. All math is integer: pressure in mPa,
+ * flow in uL/s and volume in uL. The flow is integrated with the trapezoidal rule over the
+ * sample timestamps, so a jittering or changing sample rate does not bias the volume.
+ *
+ * A breath starts when the flow rises above breath_start_ul_s and ends when it falls below
+ * breath_end_ul_s. Breaths shorter than min_breath_us are treated as noise and dropped.
+ */
+#define SDP810_FLOW_TABLE_MIN_POINTS 2u
+
+    typedef enum
+    {
+        SDP810_FLOW_CAL_SQRT = 0, /* Orifice law: flow = sqrt_coeff * sqrt(dp) */
+        SDP810_FLOW_CAL_TABLE,    /* Piecewise linear interpolation of a calibration table */
+    } sdp810_flow_cal_type_t;
+
+    typedef struct
+    {
+        int32_t dp_mpa;    /* Differential pressure in mPa */
+        int32_t flow_ul_s; /* Flow at dp_mpa in uL/s */
+    } sdp810_flow_cal_point_t;
+
+    typedef struct
+    {
+        uint8_t                        cal_type;          /* sdp810_flow_cal_type_t */
+        uint32_t                       sqrt_coeff;        /* SQRT: flow in uL/s at 1 Pa */
+        const sdp810_flow_cal_point_t *table;             /* TABLE: points sorted by dp_mpa */
+        uint8_t                        table_len;         /* TABLE: number of points */
+        int32_t                        breath_start_ul_s; /* Flow above which a breath starts */
+        int32_t                        breath_end_ul_s;   /* Flow below which the breath ends */
+        uint32_t                       min_breath_us;     /* Shorter breaths are dropped */
+    } sdp810_flow_config_t;
+
+    typedef struct
+    {
+        uint8_t  complete;       /* Set when a breath ended at this sample */
+        uint64_t start_us;       /* Timestamp of the sample which started the breath */
+        uint32_t duration_us;    /* Time from start to the sample which ended the breath */
+        uint32_t volume_ul;      /* Integrated volume of the breath */
+        int32_t  peak_flow_ul_s; /* Highest flow during the breath */
+    } sdp810_flow_breath_t;
+
+    typedef struct
+    {
+        const sdp810_flow_config_t *config;      /* Calibration and breath detection settings */
+        int32_t                     flow_ul_s;   /* Flow of the last sample */
+        uint64_t                    last_us;     /* Timestamp of the last sample */
+        uint64_t                    start_us;    /* Start of the current breath */
+        int64_t                     area;        /* Sum of (f0 + f1) * dt, in uL/s * us */
+        int32_t                     peak_ul_s;   /* Peak flow of the current breath */
+        uint8_t                     has_last;    /* Cleared by init, the first sample is a base */
+        uint8_t                     in_breath;   /* Set between breath start and end */
+    } sdp810_flow_ctx_t;
+
+    /**
+     * @brief Initialize the integrator, no breath is in progress afterwards
+     * @param ctx Ptr to the integrator context
+     * @param config Ptr to the settings, has to stay valid while the integrator is used
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when ctx or config (or its table) is NULL,
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG when the table is too short or not sorted, or
+     *         breath_end_ul_s is above breath_start_ul_s
+     */
+    manikin_status_t sdp810_flow_init(sdp810_flow_ctx_t          *ctx,
+                                      const sdp810_flow_config_t *config);
+
+    /**
+     * @brief Convert a differential pressure to flow with the configured calibration
+     *        Negative pressures give negative flows. With a table, pressures outside of it are
+     *        clamped to the first or last point.
+     * @param config Ptr to the settings
+     * @param dp_mpa Differential pressure in mPa
+     * @return Flow in uL/s, 0 when config is NULL
+     */
+    int32_t sdp810_flow_from_pressure(const sdp810_flow_config_t *config, int32_t dp_mpa);
+
+    /**
+     * @brief Add one sample, O(1) regardless of the breath length
+     * @param ctx Ptr to the integrator context
+     * @param raw_data Ptr to the SDP810_SAMPLE_SIZE bytes written by sdp810_read_sensor()
+     * @param timestamp_us Acquisition time of the sample, e.g. sensor_ctx->sample.timestamp_us.
+     *        A timestamp which does not advance contributes no volume.
+     * @param breath Ptr to the result, complete is set and the other fields are filled in when
+     *        a breath ended at this sample
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM when a param is NULL or ctx is not initialized,
+     *         MANIKIN_STATUS_ERR_CONVERSION_FAILED when the scale factor is 0, the sample is
+     *         then ignored
+     */
+    manikin_status_t sdp810_flow_update(sdp810_flow_ctx_t    *ctx,
+                                        const uint8_t        *raw_data,
+                                        uint64_t              timestamp_us,
+                                        sdp810_flow_breath_t *breath);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // SDP810_FLOW_H
@@ -59,6 +59,7 @@ extern "C"
 
 /* I2C and configuration registers */
 #define VL53L4CD_I2C_SLAVE_DEVICE_ADDRESS 0x0001u
+#define VL53L4CD_OSC_FREQUENCY            0x0006u
 #define VL53L4CD_OSC_CALIBRATE_VAL        0x00DEu
 
 /* Default I2C addresses */
@@ -66,8 +67,14 @@ extern "C"
 #define VL53L4CD_DEFAULT_ADDR_ALT 0x29u /* Alternative address */
 
 /* Start/stop values */
-#define VL53L4CD_RANGING_START 0x40u
-#define VL53L4CD_RANGING_STOP  0x00u
+#define VL53L4CD_RANGING_START            0x40u /* Autonomous, sleeps between measurements */
+#define VL53L4CD_RANGING_START_CONTINUOUS 0x21u
+#define VL53L4CD_RANGING_STOP             0x00u
+#define VL53L4CD_RANGING_HALT             0x80u /* Stops ranging before reconfiguring it */
+
+/* Only the lower bits of these registers hold the value */
+#define VL53L4CD_RANGE_STATUS_MASK 0x1Fu
+#define VL53L4CD_CLOCK_PLL_MASK    0x3FFu
 
 /* Interrupt clear value */
 #define VL53L4CD_CLEAR_INTERRUPT 0x01u
@@ -25,12 +25,25 @@
 #include "vl53l4cd.h"
 
 #include "common/manikin_bit_manipulation.h"
+#include "common/manikin_time.h"
 #include "i2c/i2c.h"
 #include "private/vl53l4cd_regs.h"
 #include "error_handler/error_handler.h"
 
 #define HASH_VL53L4CD 0xE2B0299Eu
 
+/* Timing used when sensor_ctx->driver_ctx holds no profile */
+#define VL53L4CD_DEFAULT_TIMING_BUDGET_MS 50u
+
+/* The result registers from the range status up to and including the distance */
+#define VL53L4CD_RESULT_OFFSET(REG) ((REG) - VL53L4CD_RESULT_RANGE_STATUS)
+#define VL53L4CD_RESULT_BURST_SIZE  (VL53L4CD_RESULT_OFFSET(VL53L4CD_RESULT_FINAL_RANGE_MM) + 2u)
+
+/* Raw range status to VL53L4CD_RANGE_STATUS_x, as translated by ST's ULD driver */
+static const uint8_t vl53l4cd_range_status_map[] = { 255u, 255u, 255u, 5u,   2u,   4u,  1u,  7u,
+                                                     3u,   0u,   255u, 255u, 9u,   13u, 255u, 255u,
+                                                     255u, 255u, 10u,  6u,   255u, 255u, 11u, 12u };
+
 /* Initialize the sensor with these register settings */
 static const manikin_sensor_reg_t vl53l4cd_init_regs[] = {
     /* System config */
@@ -96,99 +109,144 @@ vl53l4cd_check_params (manikin_sensor_ctx_t *sensor_ctx)
     return MANIKIN_STATUS_OK;
 }
 
-int
-VL53L4CD_SetRangeTiming (manikin_sensor_ctx_t *ctx,
-                         uint32_t              timing_budget_ms,
-                         uint32_t              inter_measurement_ms)
+/**
+ * @brief Write a 32-bit register, most significant byte first
+ */
+static manikin_status_t
+vl53l4cd_write_reg32 (manikin_sensor_ctx_t *sensor_ctx, uint16_t reg, uint32_t val)
 {
-    manikin_status_t status = MANIKIN_STATUS_OK;
-    uint16_t         clock_pll, osc_frequency, ms_byte;
-    uint32_t         macro_period_us = 0, timing_budget_us = 0, ls_byte, tmp;
-    float            inter_measurement_factor = (float)1.055;
-
-    status |= manikin_i2c_read_reg16(ctx->i2c, ctx->i2c_addr, 0x0006, (uint8_t *)&osc_frequency);
-    if (osc_frequency != (uint16_t)0)
-    {
-        timing_budget_us = timing_budget_ms * (uint32_t)1000;
-        macro_period_us
-            = (uint32_t)((uint32_t)2304 * ((uint32_t)0x40000000 / (uint32_t)osc_frequency)) >> 6;
-    }
-    else
+    const uint8_t bytes[6] = { GET_UPPER_8_BITS_OF_SHORT(reg),
+                               GET_LOWER_8_BITS_OF_SHORT(reg),
+                               (uint8_t)(val >> 24),
+                               (uint8_t)(val >> 16),
+                               (uint8_t)(val >> 8),
+                               (uint8_t)val };
+    if (manikin_i2c_write_bytes(sensor_ctx->i2c, sensor_ctx->i2c_addr, bytes, sizeof(bytes))
+        != sizeof(bytes))
     {
-        status |= (uint8_t)MANIKIN_STATUS_ERR_NULL_PARAM;
+        return MANIKIN_STATUS_ERR_WRITE_FAIL;
     }
+    return MANIKIN_STATUS_OK;
+}
 
-    /* Timing budget check validity */
-    if ((timing_budget_ms < (uint32_t)10) || (timing_budget_ms > (uint32_t)200)
-        || (status != (uint8_t)0))
+/**
+ * @brief Internal function to check a timing profile against the limits of the sensor
+ */
+static manikin_status_t
+vl53l4cd_check_profile (const vl53l4cd_profile_t *profile)
+{
+    MANIKIN_ASSERT(HASH_VL53L4CD, (profile != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
+    MANIKIN_ASSERT(HASH_VL53L4CD,
+                   (profile->timing_budget_ms >= VL53L4CD_TIMING_BUDGET_MIN_MS
+                    && profile->timing_budget_ms <= VL53L4CD_TIMING_BUDGET_MAX_MS),
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    MANIKIN_ASSERT(HASH_VL53L4CD,
+                   (profile->inter_measurement_ms == 0
+                    || profile->inter_measurement_ms > profile->timing_budget_ms),
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Read the oscillator calibration into the profile, unless it was read before
+ */
+static manikin_status_t
+vl53l4cd_read_calibration (manikin_sensor_ctx_t *sensor_ctx, vl53l4cd_profile_t *profile)
+{
+    if (profile->osc_frequency != 0 && profile->clock_pll != 0)
     {
-        status |= MANIKIN_STATUS_ERR_NULL_PARAM;
+        return MANIKIN_STATUS_OK;
     }
-    /* Sensor runs in continuous mode */
-    else if (inter_measurement_ms == (uint32_t)0)
+    uint8_t          data[2] = { 0 };
+    manikin_status_t status  = manikin_i2c_read_reg16(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_OSC_FREQUENCY, data);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    const uint16_t osc_frequency = CONSTRUCT_SHORT_FROM_BYTES(data[0], data[1]);
+
+    status = manikin_i2c_read_reg16(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_RESULT__OSC_CALIBRATE_VAL, data);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    const uint16_t clock_pll
+        = CONSTRUCT_SHORT_FROM_BYTES(data[0], data[1]) & VL53L4CD_CLOCK_PLL_MASK;
+
+    // NOTE: A zero would divide by zero below, the sensor is not answering properly
+    MANIKIN_ASSERT(
+        HASH_VL53L4CD, (osc_frequency != 0 && clock_pll != 0), MANIKIN_STATUS_ERR_READ_FAIL);
+    profile->osc_frequency = osc_frequency;
+    profile->clock_pll     = clock_pll;
+    return MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Encode a timeout into the (mantissa, exponent) format of the RANGE_CONFIG registers
+ * @param timeout_us Timeout in us, shifted left by 12
+ * @param macro_period_us Macro period in us, shifted left by 6
+ * @param vcsel_period Period of the VCSEL used by the range config
+ */
+static uint16_t
+vl53l4cd_encode_timeout (uint32_t timeout_us, uint32_t macro_period_us, uint32_t vcsel_period)
+{
+    const uint32_t period  = (macro_period_us * vcsel_period) >> 6;
+    uint32_t       ls_byte = ((timeout_us + (period >> 1)) / period) - 1u;
+    uint16_t       ms_byte = 0;
+    while ((ls_byte & 0xFFFFFF00u) > 0u)
     {
-        status |= manikin_i2c_write_reg16(ctx->i2c, ctx->i2c_addr, VL53L4CD_INTERMEASUREMENT_MS, 0);
-        timing_budget_us -= (uint32_t)2500;
+        ls_byte = ls_byte >> 1;
+        ms_byte++;
     }
-    /* Sensor runs in autonomous low power mode */
-    else if (inter_measurement_ms > timing_budget_ms)
+    return (uint16_t)((uint16_t)(ms_byte << 8) + (uint16_t)(ls_byte & 0xFFu));
+}
+
+/**
+ * @brief Write the timing registers of a validated profile, the same way ST's driver does
+ */
+static manikin_status_t
+vl53l4cd_write_timing (manikin_sensor_ctx_t *sensor_ctx, vl53l4cd_profile_t *profile)
+{
+    manikin_status_t status = vl53l4cd_read_calibration(sensor_ctx, profile);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+
+    const uint32_t macro_period_us
+        = (2304u * (0x40000000u / (uint32_t)profile->osc_frequency)) >> 6;
+    uint32_t timing_budget_us  = (uint32_t)profile->timing_budget_ms * 1000u;
+    uint32_t inter_measurement = 0;
+    if (profile->inter_measurement_ms == 0)
     {
-        status |= manikin_i2c_read_reg16(
-            ctx->i2c, ctx->i2c_addr, VL53L4CD_RESULT__OSC_CALIBRATE_VAL, (uint8_t *)&clock_pll);
-        clock_pll = clock_pll & (uint16_t)0x3FF;
-        inter_measurement_factor
-            = inter_measurement_factor * (float)inter_measurement_ms * (float)clock_pll;
-        uint32_t reg_value = (uint32_t)(inter_measurement_factor + 0.5f);
-
-        // Clamp to 16-bit range, in case PLL or ms are big
-        if (reg_value > 0xFFFF)
-        {
-            reg_value = 0xFFFF;
-        }
-
-        // Write lower 16 bits
-        status |= manikin_i2c_write_reg16(
-            ctx->i2c, ctx->i2c_addr, VL53L4CD_INTERMEASUREMENT_MS, (uint16_t)reg_value);
-        timing_budget_us -= (uint32_t)4300;
-        timing_budget_us /= (uint32_t)2;
+        timing_budget_us -= 2500u;
     }
-    /* Invalid case */
     else
     {
-        status |= (uint8_t)MANIKIN_STATUS_ERR_NULL_PARAM;
+        // NOTE: The period is counted in PLL clocks, with a fixed 1.055 correction factor
+        inter_measurement = (uint32_t)(((uint64_t)profile->inter_measurement_ms
+                                            * profile->clock_pll * 1055u
+                                        + 500u)
+                                       / 1000u);
+        timing_budget_us  = (timing_budget_us - 4300u) / 2u;
     }
+    timing_budget_us = timing_budget_us << 12;
 
-    if (status != (uint8_t)MANIKIN_STATUS_ERR_NULL_PARAM)
-    {
-        ms_byte          = 0;
-        timing_budget_us = timing_budget_us << 12;
-        tmp              = macro_period_us * (uint32_t)16;
-        ls_byte          = ((timing_budget_us + ((tmp >> 6) >> 1)) / (tmp >> 6)) - (uint32_t)1;
-
-        while ((ls_byte & 0xFFFFFF00U) > 0U)
-        {
-            ls_byte = ls_byte >> 1;
-            ms_byte++;
-        }
-        ms_byte = (uint16_t)(ms_byte << 8) + (uint16_t)(ls_byte & (uint32_t)0xFF);
-        status
-            |= manikin_i2c_write_reg16(ctx->i2c, ctx->i2c_addr, VL53L4CD_RANGE_CONFIG_A, ms_byte);
-
-        ms_byte = 0;
-        tmp     = macro_period_us * (uint32_t)12;
-        ls_byte = ((timing_budget_us + ((tmp >> 6) >> 1)) / (tmp >> 6)) - (uint32_t)1;
-
-        while ((ls_byte & 0xFFFFFF00U) > 0U)
-        {
-            ls_byte = ls_byte >> 1;
-            ms_byte++;
-        }
-        ms_byte = (uint16_t)(ms_byte << 8) + (uint16_t)(ls_byte & (uint32_t)0xFF);
-        status
-            |= manikin_i2c_write_reg16(ctx->i2c, ctx->i2c_addr, VL53L4CD_RANGE_CONFIG_B, ms_byte);
-    }
+    const uint16_t range_config_a = vl53l4cd_encode_timeout(timing_budget_us, macro_period_us, 16u);
+    const uint16_t range_config_b = vl53l4cd_encode_timeout(timing_budget_us, macro_period_us, 12u);
 
-    return status;
+    status = vl53l4cd_write_reg32(sensor_ctx, VL53L4CD_INTERMEASUREMENT_MS, inter_measurement);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    status = manikin_i2c_write_reg16(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_RANGE_CONFIG_A, range_config_a);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    return manikin_i2c_write_reg16(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_RANGE_CONFIG_B, range_config_b);
+}
+
+/**
+ * @brief Start ranging, back to back or autonomously depending on the profile
+ */
+static manikin_status_t
+vl53l4cd_start_ranging (manikin_sensor_ctx_t *sensor_ctx, const vl53l4cd_profile_t *profile)
+{
+    const uint8_t start = (profile->inter_measurement_ms == 0) ? VL53L4CD_RANGING_START_CONTINUOUS
+                                                               : VL53L4CD_RANGING_START;
+    return manikin_i2c_write_reg(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, start);
 }
 
 manikin_status_t
@@ -197,6 +255,15 @@ vl53l4cd_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
     manikin_status_t status = vl53l4cd_check_params(sensor_ctx);
     MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
 
+    /* Without a profile from the application the calibration is read on every init */
+    vl53l4cd_profile_t  default_profile = { VL53L4CD_DEFAULT_TIMING_BUDGET_MS, 0, 0, 0 };
+    vl53l4cd_profile_t *profile         = (sensor_ctx->driver_ctx != NULL)
+                                              ? (vl53l4cd_profile_t *)sensor_ctx->driver_ctx
+                                              : &default_profile;
+
+    status = vl53l4cd_check_profile(profile);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+
     sensor_ctx->needs_reinit = 0;
     uint8_t data[2]          = { 0 };
 
@@ -221,17 +288,43 @@ vl53l4cd_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
             HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
     }
 
-    /* Start ranging in continuous mode */
+    /* Run one ranging for the VHV calibration, then stop to apply the timing profile */
     status = manikin_i2c_write_reg(
         sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, VL53L4CD_RANGING_START);
     MANIKIN_ASSERT(
         HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
-    status
-        = manikin_i2c_write_reg(sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, 0x80);
-    VL53L4CD_SetRangeTiming(sensor_ctx, 1, 0);
     status = manikin_i2c_write_reg(
-        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, VL53L4CD_RANGING_START);
-    return status;
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, VL53L4CD_RANGING_HALT);
+    MANIKIN_ASSERT(
+        HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    status = vl53l4cd_write_timing(sensor_ctx, profile);
+    MANIKIN_ASSERT(
+        HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    return vl53l4cd_start_ranging(sensor_ctx, profile);
+}
+
+manikin_status_t
+vl53l4cd_set_profile (manikin_sensor_ctx_t *sensor_ctx, vl53l4cd_profile_t *profile)
+{
+    manikin_status_t status = vl53l4cd_check_params(sensor_ctx);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    status = vl53l4cd_check_profile(profile);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+
+    status = manikin_i2c_write_reg(
+        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_START, VL53L4CD_RANGING_HALT);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    status = vl53l4cd_write_timing(sensor_ctx, profile);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    sensor_ctx->driver_ctx = profile;
+
+    /* Drop a result of the old timing which may still be pending */
+    status = manikin_i2c_write_reg(sensor_ctx->i2c,
+                                   sensor_ctx->i2c_addr,
+                                   VL53L4CD_SYSTEM_INTERRUPT_CLEAR,
+                                   VL53L4CD_CLEAR_INTERRUPT);
+    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    return vl53l4cd_start_ranging(sensor_ctx, profile);
 }
 
 manikin_status_t
@@ -249,11 +342,14 @@ vl53l4cd_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
 
     MANIKIN_ASSERT(HASH_VL53L4CD, (read_buf != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
 
-    /* Check for data ready */
+    /* Check for data ready, the data-ready line already did that in drdy_irq mode */
     uint8_t data_ready = 0;
-    status             = manikin_i2c_read_reg(
-        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_INTERRUPT_CLEAR, &data_ready);
-    MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    if (!sensor_ctx->drdy_irq)
+    {
+        status = manikin_i2c_read_reg(
+            sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_SYSTEM_INTERRUPT_CLEAR, &data_ready);
+        MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
+    }
 
     // /* Check if data is ready (bit 0) */
     // if (!(data_ready & 0x01))
@@ -261,24 +357,24 @@ vl53l4cd_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
     //     return MANIKIN_STATUS_ERR_READ_FAIL;
     // }
 
-    /* Read distance measurement (16-bit value) */
-    uint8_t distance_data[2] = { 0 };
-    status                   = manikin_i2c_read_reg16(
-        sensor_ctx->i2c, sensor_ctx->i2c_addr, VL53L4CD_RESULT_FINAL_RANGE_MM, distance_data);
+    /* Read status, signal rate and distance in one burst */
+    manikin_sample_stamp(sensor_ctx);
+    uint8_t result[VL53L4CD_RESULT_BURST_SIZE] = { 0 };
+    status = manikin_i2c_read_regs(sensor_ctx->i2c,
+                                   sensor_ctx->i2c_addr,
+                                   VL53L4CD_RESULT_RANGE_STATUS,
+                                   result,
+                                   sizeof(result));
     MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
 
-    /* Construct 16-bit distance value */
-    uint16_t distance = (uint16_t)((distance_data[0] << 8) | distance_data[1]);
-
-    /* To match VL6180X behavior, clip the distance to single byte (0-255mm) */
-    if (distance > 255)
-    {
-        read_buf[0] = 255;
-    }
-    else
-    {
-        read_buf[0] = (uint8_t)distance;
-    }
+    const uint8_t range_status = result[0] & VL53L4CD_RANGE_STATUS_MASK;
+    read_buf[0] = result[VL53L4CD_RESULT_OFFSET(VL53L4CD_RESULT_FINAL_RANGE_MM)];
+    read_buf[1] = result[VL53L4CD_RESULT_OFFSET(VL53L4CD_RESULT_FINAL_RANGE_MM) + 1];
+    read_buf[2] = (range_status < sizeof(vl53l4cd_range_status_map))
+                      ? vl53l4cd_range_status_map[range_status]
+                      : VL53L4CD_RANGE_STATUS_UNDEFINED;
+    read_buf[3] = result[VL53L4CD_RESULT_OFFSET(VL53L4CD_RESULT_SIGNAL_RATE)];
+    read_buf[4] = result[VL53L4CD_RESULT_OFFSET(VL53L4CD_RESULT_SIGNAL_RATE) + 1];
 
     /* Clear the interrupt for next measurement */
     status = manikin_i2c_write_reg(sensor_ctx->i2c,
@@ -287,6 +383,7 @@ vl53l4cd_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
                                    VL53L4CD_CLEAR_INTERRUPT);
     MANIKIN_ASSERT(HASH_VL53L4CD, (status == MANIKIN_STATUS_OK), status);
 
+    manikin_sample_complete(sensor_ctx);
     return MANIKIN_STATUS_OK;
 }
 
@@ -310,6 +407,8 @@ vl53l4cd_parse_raw_data (const uint8_t *raw_data, vl53l4cd_sample_data_t *data)
 {
     MANIKIN_ASSERT(HASH_VL53L4CD, (raw_data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
     MANIKIN_ASSERT(HASH_VL53L4CD, (data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
-    data->distance_mm = raw_data[0];
+    data->distance_mm      = CONSTRUCT_SHORT_FROM_BYTES(raw_data[0], raw_data[1]);
+    data->range_status     = raw_data[2];
+    data->signal_rate_kcps = (uint32_t)CONSTRUCT_SHORT_FROM_BYTES(raw_data[3], raw_data[4]) * 8u;
     return MANIKIN_STATUS_OK;
 }
\ No newline at end of file
@@ -31,28 +31,91 @@ extern "C"
 
 #include "common/manikin_types.h"
 
+/**
+ * @brief I2C traffic of one vl53l4cd_read_sensor() call, used by bus_planner:
+ *        interrupt status read (2 + 1), result burst read (2 + 15), interrupt clear (3)
+ */
+#define VL53L4CD_READ_TRANSACTIONS 5u
+#define VL53L4CD_READ_BYTES        23u
+
+/**
+ * @brief I2C traffic of one vl53l4cd_read_sensor() call with drdy_irq set:
+ *        result burst read (2 + 15), interrupt clear (3)
+ */
+#define VL53L4CD_DRDY_READ_TRANSACTIONS 3u
+#define VL53L4CD_DRDY_READ_BYTES        20u
+
+/**
+ * @brief Size of the raw sample written by vl53l4cd_read_sensor():
+ *        distance (2, big-endian), range status (1), signal rate (2, big-endian, 8 kcps/LSB)
+ */
+#define VL53L4CD_SAMPLE_SIZE 5u
+
+/* Range status values, anything but VALID should not be trusted */
+#define VL53L4CD_RANGE_STATUS_VALID             0u
+#define VL53L4CD_RANGE_STATUS_SIGMA_HIGH        1u
+#define VL53L4CD_RANGE_STATUS_SIGNAL_LOW        2u
+#define VL53L4CD_RANGE_STATUS_BELOW_MIN_RANGE   3u
+#define VL53L4CD_RANGE_STATUS_PHASE_OUT_OF_LIMS 4u
+#define VL53L4CD_RANGE_STATUS_HW_FAIL           5u
+#define VL53L4CD_RANGE_STATUS_NO_WRAP_CHECK     6u
+#define VL53L4CD_RANGE_STATUS_WRAPPED_TARGET    7u
+#define VL53L4CD_RANGE_STATUS_PROCESSING_FAIL   8u
+#define VL53L4CD_RANGE_STATUS_XTALK_FAIL        9u
+#define VL53L4CD_RANGE_STATUS_SYNC_INT          10u
+#define VL53L4CD_RANGE_STATUS_MERGED_PULSE      11u
+#define VL53L4CD_RANGE_STATUS_TOO_CLOSE         12u
+#define VL53L4CD_RANGE_STATUS_MIN_RANGE_FAIL    13u
+#define VL53L4CD_RANGE_STATUS_UNDEFINED         255u
+
+/* Timing budget limits of one ranging, in ms */
+#define VL53L4CD_TIMING_BUDGET_MIN_MS 10u
+#define VL53L4CD_TIMING_BUDGET_MAX_MS 200u
+
     /**
-     * @brief This struct contains the structure of samples for vl6180x ToF sensor
-     *        The units are millimeters
+     * @brief Ranging timing of one sensor. Point sensor_ctx->driver_ctx at it before init, or
+     *        pass it to vl53l4cd_set_profile(), to replace the default 50 ms continuous ranging.
+     *        The oscillator calibration is read from the sensor once and cached in here, so
+     *        switching profiles afterwards only writes the timing registers.
      */
     typedef struct
     {
-        uint8_t distance_mm;
+        uint16_t timing_budget_ms;     /* Duration of one ranging, 10 to 200 ms */
+        uint16_t inter_measurement_ms; /* 0 ranges back to back (continuous), a period longer
+                                          than timing_budget_ms ranges autonomously and sleeps in
+                                          between (low power) */
+        uint16_t osc_frequency;        /* Cached calibration, leave 0 so it is read once */
+        uint16_t clock_pll;            /* Cached calibration, leave 0 so it is read once */
+    } vl53l4cd_profile_t;
+
+    /**
+     * @brief This struct contains the structure of samples for VL53L4CD ToF sensor
+     */
+    typedef struct
+    {
+        uint16_t distance_mm;      /* Distance to the target in millimeters */
+        uint8_t  range_status;     /* VL53L4CD_RANGE_STATUS_x */
+        uint32_t signal_rate_kcps; /* Return signal rate in kilo counts per second */
     } vl53l4cd_sample_data_t;
 
     /**
-     * @brief Initialize the sensor, which disables continuous sampling mode.
+     * @brief Initialize the sensor and start ranging with the vl53l4cd_profile_t in
+     *        sensor_ctx->driver_ctx, or 50 ms continuous ranging when that is NULL.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
      *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL on unable to set registers (due to lost
      *          connection, e.g.)
      *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on an invalid profile, see vl53l4cd_set_profile()
      */
     manikin_status_t vl53l4cd_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
-     * @brief Read the sensor, which should read 1-byte of data (distance in mm)
+     * @brief Read the sensor, which writes VL53L4CD_SAMPLE_SIZE bytes of data: the full 16-bit
+     *        distance, the range status and the signal rate, which all come from one burst read.
+     *        The GPIO1 pin signals new samples (active low). With sensor_ctx->drdy_irq set the
+     *        read is triggered by that line, so the interrupt status is not polled first.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @param read_buf Ptr to read-buffer which is used for storing the samples
@@ -62,6 +125,22 @@ extern "C"
      */
     manikin_status_t vl53l4cd_read_sensor(manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf);
 
+    /**
+     * @brief Switch the ranging timing of an initialized sensor. Ranging is stopped, the timing
+     *        registers are written and ranging is restarted. The profile is kept in
+     *        sensor_ctx->driver_ctx so a re-initialization restores it.
+     * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
+     * address
+     * @param profile Ptr to the timing profile, has to outlive the sensor
+     * @return MANIKIN_STATUS_OK on success,
+     *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle or profile,
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on a timing budget outside the limits above or
+     *         an inter-measurement period which is not longer than the timing budget,
+     *         MANIKIN_STATUS_ERR_READ_FAIL / MANIKIN_STATUS_ERR_WRITE_FAIL on bus failures
+     */
+    manikin_status_t vl53l4cd_set_profile(manikin_sensor_ctx_t *sensor_ctx,
+                                          vl53l4cd_profile_t   *profile);
+
     /**
      * @brief Deinitialize the sensor, which disables continuous sampling mode.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
@@ -86,6 +86,19 @@ extern "C"
 #define VL6180X_REG_I2C_SLAVE_DEVICE_ADDRESS             0x0212u
 #define VL6180X_REG_INTERLEAVED_MODE_ENABLE              0x02A3u
 
+/* Data-ready interrupt values */
+#define VL6180X_GPIO1_INTERRUPT_OUTPUT     0x10u /* GPIO1 is the interrupt output, active low */
+#define VL6180X_INTERRUPT_RANGE_NEW_SAMPLE 0x04u
+#define VL6180X_INTERRUPT_RANGE_MASK       0x07u /* Range bits of RESULT_INTERRUPT_STATUS_GPIO */
+#define VL6180X_INTERRUPT_CLEAR_ALL        0x07u /* Range, ALS and error interrupts at once */
+
+/* Measurement start values */
+#define VL6180X_START_CONTINUOUS   0x03u
+#define VL6180X_INTERLEAVED_ENABLE 0x01u
+
+/* The error code sits in the upper nibble of RESULT_RANGE_STATUS, 0 means a valid range */
+#define VL6180X_RANGE_ERROR_SHIFT 4u
+
 #ifdef __cplusplus
 }
 #endif
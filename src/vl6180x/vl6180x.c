@@ -25,12 +25,24 @@
 #include "vl6180x.h"
 
 #include "common/manikin_bit_manipulation.h"
+#include "common/manikin_time.h"
 #include "i2c/i2c.h"
 #include "private/vl6180x_regs.h"
 #include "error_handler/error_handler.h"
 
 #define HASH_VL6180X 0xE1B0199Eu
 
+/* Ranging period when sensor_ctx->driver_ctx holds no config, (1 + 1) * 10 ms */
+#define VL6180X_DEFAULT_INTERMEASUREMENT_PERIOD 0x01u
+
+/* RESULT_RANGE_STATUS up to RESULT_INTERRUPT_STATUS_GPIO, or up to RESULT_ALS_VAL with ALS */
+#define VL6180X_RESULT_STATUS_SIZE     3u
+#define VL6180X_RESULT_STATUS_ALS_SIZE 5u
+#define VL6180X_RESULT_OFFSET(REG)     ((REG) - VL6180X_REG_RESULT_RANGE_STATUS)
+
+/* ALS counts to millilux for the gain (20) and integration time (100 ms) of the init table */
+#define VL6180X_ALS_MLUX_PER_COUNT 16u
+
 // NOTE: Some of these are undocumented private registers
 static const manikin_sensor_reg_t vl6180x_init_regs[]
     = { { 0x0207, 0x01, MANIKIN_SENSOR_REG_TYPE_WRITE },
@@ -76,8 +88,7 @@ static const manikin_sensor_reg_t vl6180x_init_regs[]
         { VL6180X_REG_SYSALS_INTEGRATION_PERIOD, 0x64, MANIKIN_SENSOR_REG_TYPE_WRITE },
         { VL6180X_REG_READOUT_AVERAGING_SAMPLE_PERIOD, 0x30, MANIKIN_SENSOR_REG_TYPE_WRITE },
         { VL6180X_REG_SYSALS_ANALOGUE_GAIN, 0x40, MANIKIN_SENSOR_REG_TYPE_WRITE },
-        { VL6180X_REG_FIRMWARE_RESULT_SCALER, 0x01, MANIKIN_SENSOR_REG_TYPE_WRITE },
-        { VL6180X_REG_SYSRANGE_START, 0x03, MANIKIN_SENSOR_REG_TYPE_WRITE } };
+        { VL6180X_REG_FIRMWARE_RESULT_SCALER, 0x01, MANIKIN_SENSOR_REG_TYPE_WRITE } };
 
 /**
  * @brief Internal function to check the parameters entered into function
@@ -93,11 +104,27 @@ vl6180x_check_params (manikin_sensor_ctx_t *sensor_ctx)
     return MANIKIN_STATUS_OK;
 }
 
+/**
+ * @brief Get the measurement setup of the sensor, the default one when there is none
+ */
+static const vl6180x_config_t *
+vl6180x_get_config (const manikin_sensor_ctx_t *sensor_ctx)
+{
+    static const vl6180x_config_t default_config = { 0, VL6180X_DEFAULT_INTERMEASUREMENT_PERIOD };
+    return (sensor_ctx->driver_ctx != NULL) ? (const vl6180x_config_t *)sensor_ctx->driver_ctx
+                                            : &default_config;
+}
+
 manikin_status_t
 vl6180x_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
 {
     manikin_status_t status = vl6180x_check_params(sensor_ctx);
     MANIKIN_ASSERT(HASH_VL6180X, (status == MANIKIN_STATUS_OK), status);
+    const vl6180x_config_t *config = vl6180x_get_config(sensor_ctx);
+    MANIKIN_ASSERT(HASH_VL6180X,
+                   (!config->interleaved_als
+                    || config->intermeasurement_period >= VL6180X_INTERLEAVED_MIN_PERIOD),
+                   MANIKIN_STATUS_ERR_INVALID_CONFIG);
     sensor_ctx->needs_reinit = 0;
     uint8_t data             = 0;
     status                   = manikin_i2c_read_reg(
@@ -114,6 +141,44 @@ vl6180x_init_sensor (manikin_sensor_ctx_t *sensor_ctx)
                               vl6180x_init_regs[i].reg,
                               GET_LOWER_8_BITS_OF_SHORT(vl6180x_init_regs[i].val));
     }
+
+    //
+    // New ranges are flagged in RESULT_INTERRUPT_STATUS_GPIO (and on GPIO1 in drdy_irq mode).
+    // In interleaved mode the ALS period drives both measurements and the range follows the ALS
+    // measurement, so a new range also means a new ALS value.
+    //
+    const manikin_sensor_reg_t mode_regs[] = {
+        { VL6180X_REG_SYSTEM_MODE_GPIO1,
+          sensor_ctx->drdy_irq ? VL6180X_GPIO1_INTERRUPT_OUTPUT : 0x00u,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { VL6180X_REG_SYSTEM_INTERRUPT_CONFIG_GPIO,
+          VL6180X_INTERRUPT_RANGE_NEW_SAMPLE,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { VL6180X_REG_SYSRANGE_INTERMEASUREMENT_PERIOD,
+          config->intermeasurement_period,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { VL6180X_REG_SYSALS_INTERMEASUREMENT_PERIOD,
+          config->intermeasurement_period,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { VL6180X_REG_INTERLEAVED_MODE_ENABLE,
+          config->interleaved_als ? VL6180X_INTERLEAVED_ENABLE : 0x00u,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { VL6180X_REG_SYSTEM_INTERRUPT_CLEAR,
+          VL6180X_INTERRUPT_CLEAR_ALL,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+        { config->interleaved_als ? VL6180X_REG_SYSALS_START : VL6180X_REG_SYSRANGE_START,
+          VL6180X_START_CONTINUOUS,
+          MANIKIN_SENSOR_REG_TYPE_WRITE },
+    };
+    for (size_t i = 0; i < sizeof(mode_regs) / sizeof(manikin_sensor_reg_t); i++)
+    {
+        status = manikin_i2c_write_reg(sensor_ctx->i2c,
+                                       sensor_ctx->i2c_addr,
+                                       mode_regs[i].reg,
+                                       GET_LOWER_8_BITS_OF_SHORT(mode_regs[i].val));
+        MANIKIN_ASSERT(
+            HASH_VL6180X, (status == MANIKIN_STATUS_OK), MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    }
     return MANIKIN_STATUS_OK;
 }
 
@@ -127,10 +192,42 @@ vl6180x_read_sensor (manikin_sensor_ctx_t *sensor_ctx, uint8_t *read_buf)
         vl6180x_init_sensor(sensor_ctx);
     }
     MANIKIN_ASSERT(HASH_VL6180X, (read_buf != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    /* Range status, interrupt status and (with ALS) the ALS value in one burst */
+    const vl6180x_config_t *config = vl6180x_get_config(sensor_ctx);
+    uint8_t                 result[VL6180X_RESULT_STATUS_ALS_SIZE] = { 0 };
+    status = manikin_i2c_read_regs(sensor_ctx->i2c,
+                                   sensor_ctx->i2c_addr,
+                                   VL6180X_REG_RESULT_RANGE_STATUS,
+                                   result,
+                                   config->interleaved_als ? VL6180X_RESULT_STATUS_ALS_SIZE
+                                                           : VL6180X_RESULT_STATUS_SIZE);
+    MANIKIN_ASSERT(HASH_VL6180X, (status == MANIKIN_STATUS_OK), status);
+
+    /* No new range yet, the data-ready line already told so in drdy_irq mode */
+    const uint8_t int_status
+        = result[VL6180X_RESULT_OFFSET(VL6180X_REG_RESULT_INTERRUPT_STATUS_GPIO)];
+    if (!sensor_ctx->drdy_irq
+        && (int_status & VL6180X_INTERRUPT_RANGE_MASK) != VL6180X_INTERRUPT_RANGE_NEW_SAMPLE)
+    {
+        return MANIKIN_STATUS_OK;
+    }
+
+    manikin_sample_stamp(sensor_ctx);
     status = manikin_i2c_read_reg(
         sensor_ctx->i2c, sensor_ctx->i2c_addr, VL6180X_REG_RESULT_RANGE_VAL, read_buf);
     MANIKIN_ASSERT(HASH_VL6180X, (status == MANIKIN_STATUS_OK), status);
-    MANIKIN_ASSERT(HASH_VL6180X, (read_buf[0] != 0), MANIKIN_STATUS_ERR_READ_FAIL);
+    read_buf[1] = result[0] >> VL6180X_RANGE_ERROR_SHIFT;
+    read_buf[2] = result[VL6180X_RESULT_OFFSET(VL6180X_REG_RESULT_ALS_VAL)];
+    read_buf[3] = result[VL6180X_RESULT_OFFSET(VL6180X_REG_RESULT_ALS_VAL) + 1];
+
+    // NOTE: The status (and GPIO1) stays asserted until cleared, one write clears all sources
+    status = manikin_i2c_write_reg(sensor_ctx->i2c,
+                                   sensor_ctx->i2c_addr,
+                                   VL6180X_REG_SYSTEM_INTERRUPT_CLEAR,
+                                   VL6180X_INTERRUPT_CLEAR_ALL);
+    MANIKIN_ASSERT(HASH_VL6180X, (status == MANIKIN_STATUS_OK), status);
+    manikin_sample_complete(sensor_ctx);
     return MANIKIN_STATUS_OK;
 }
 
@@ -151,6 +248,9 @@ vl6180x_parse_raw_data (const uint8_t *raw_data, vl6180x_sample_data_t *data)
 {
     MANIKIN_ASSERT(HASH_VL6180X, (raw_data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
     MANIKIN_ASSERT(HASH_VL6180X, (data != NULL), MANIKIN_STATUS_ERR_NULL_PARAM);
-    data->distance_mm = raw_data[0];
+    const uint16_t als_count = CONSTRUCT_SHORT_FROM_BYTES(raw_data[2], raw_data[3]);
+    data->distance_mm        = raw_data[0];
+    data->range_error        = raw_data[1];
+    data->als_mlux           = (uint32_t)als_count * VL6180X_ALS_MLUX_PER_COUNT;
     return MANIKIN_STATUS_OK;
 }
\ No newline at end of file
@@ -30,28 +30,79 @@ extern "C"
 #endif
 
 #include "common/manikin_types.h"
+
+/**
+ * @brief I2C traffic of one vl6180x_read_sensor() call, used by bus_planner:
+ *        result status read (2 + 3), range read (2 + 1) and interrupt clear (3).
+ *        Without a new range only the status read is done.
+ */
+#define VL6180X_READ_TRANSACTIONS 5u
+#define VL6180X_READ_BYTES        11u
+
+/**
+ * @brief I2C traffic of one vl6180x_read_sensor() call with interleaved_als set:
+ *        result status and ALS read (2 + 5), range read (2 + 1) and interrupt clear (3)
+ */
+#define VL6180X_ALS_READ_TRANSACTIONS 5u
+#define VL6180X_ALS_READ_BYTES        13u
+
+/**
+ * @brief I2C traffic of one vl6180x_read_sensor() call with drdy_irq set, the status is still
+ *        read for the range error code
+ */
+#define VL6180X_DRDY_READ_TRANSACTIONS VL6180X_READ_TRANSACTIONS
+#define VL6180X_DRDY_READ_BYTES        VL6180X_READ_BYTES
+
+/**
+ * @brief Size of the raw sample written by vl6180x_read_sensor():
+ *        distance (1), range error code (1), ALS count (2, big-endian)
+ */
+#define VL6180X_SAMPLE_SIZE 4u
+
+/* Shortest intermeasurement_period which fits the 100 ms ALS integration plus a range */
+#define VL6180X_INTERLEAVED_MIN_PERIOD 15u
+
+    /**
+     * @brief Measurement setup of one sensor, point sensor_ctx->driver_ctx at it before init.
+     *        Without it the sensor ranges continuously every 20 ms.
+     */
+    typedef struct
+    {
+        uint8_t interleaved_als;         /* Measure ambient light right before every range */
+        uint8_t intermeasurement_period; /* Period between measurements, (value + 1) * 10 ms */
+    } vl6180x_config_t;
+
     /**
      * @brief This struct contains the structure of samples for vl6180x ToF sensor
-     *        The units are millimeters
      */
     typedef struct
     {
-        uint8_t distance_mm;
+        uint8_t  distance_mm; /* Distance to the target in millimeters */
+        uint8_t  range_error; /* Range error code of the datasheet, 0 when distance_mm is valid */
+        uint32_t als_mlux;    /* Ambient light in millilux, 0 without interleaved_als */
     } vl6180x_sample_data_t;
 
     /**
-     * @brief Initialize the sensor, which disables continuous sampling mode.
+     * @brief Initialize the sensor and start continuous ranging, interleaved with ALS when the
+     *        vl6180x_config_t in sensor_ctx->driver_ctx asks for it.
+     *        With sensor_ctx->drdy_irq set, GPIO1 signals every new range sample (active low)
+     *        and stays asserted until vl6180x_read_sensor() clears it.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @return MANIKIN_STATUS_OK on Successful initialization,
      *         MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL on unable to set registers (due to lost
      *          connection, e.g.)
      *         MANIKIN_STATUS_ERR_NULL_PARAM on invalid i2c handle
+     *         MANIKIN_STATUS_ERR_INVALID_CONFIG on interleaved_als with an intermeasurement_period
+     *         below VL6180X_INTERLEAVED_MIN_PERIOD
      */
     manikin_status_t vl6180x_init_sensor(manikin_sensor_ctx_t *sensor_ctx);
 
     /**
-     * @brief Read the sensor, which should read 1-byte of data (distance in mm)
+     * @brief Read the sensor, which writes VL6180X_SAMPLE_SIZE bytes of data when a new range is
+     *        available. Without one, MANIKIN_STATUS_OK is returned while read_buf and
+     *        sensor_ctx->sample are left untouched, so only fresh samples are stamped.
+     *        A 0 mm distance is valid, the range error code tells whether a range can be trusted.
      * @param sensor_ctx Ptr to struct containing all settings for sensor, such as i2c instance &
      * address
      * @param read_buf Ptr to read-buffer which is used for storing the samples
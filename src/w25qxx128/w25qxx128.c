@@ -103,6 +103,11 @@ w25qxx_wait_while_busy (manikin_spi_memory_ctx_t *mem_ctx)
              && W25Q_NO_TIMEOUT_REACHED(time_start, MANIKIN_SOFTWARE_MAX_TIMEOUT));
 
     manikin_spi_end_transaction(mem_ctx->spi_cs);
+    if (status == MANIKIN_STATUS_OK && (w25qxx_reg_read_buf[0] & W25QXX_REG_STATUS_BUSY))
+    {
+        // NOTE: Timed out, the flash did not finish in time
+        status = MANIKIN_STATUS_ERR_READ_FAIL;
+    }
     return status;
 }
 
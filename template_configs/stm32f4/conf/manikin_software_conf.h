@@ -50,6 +50,14 @@ extern "C"
 
     typedef SPI_TypeDef *manikin_spi_inst_t;
 
+    typedef struct
+    {
+        uint8_t port;
+        uint8_t pin;
+    } manikin_gpio_inst_t;
+
+    typedef void (*manikin_gpio_irq_cb_t)(void *user);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@ extern "C"
 #endif
 #include <zephyr/device.h>
 #include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
 #include <stdint.h>
 
 #define MANIKIN_SOFTWARE_MAX_TIMEOUT 1u
@@ -37,6 +38,8 @@ extern "C"
     typedef const struct device *manikin_i2c_inst_t;
     typedef const struct device *manikin_spi_inst_t;
     typedef const struct device *manikin_spi_cs_t;
+    typedef const struct gpio_dt_spec *manikin_gpio_inst_t;
+    typedef void (*manikin_gpio_irq_cb_t)(void *user);
 #ifdef __cplusplus
 }
 #endif
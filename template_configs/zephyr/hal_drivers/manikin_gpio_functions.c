@@ -0,0 +1,85 @@
+#include "manikin_gpio_functions.h"
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/util.h>
+
+#define MANIKIN_GPIO_MAX_IRQ_LINES 8u
+
+typedef struct
+{
+    struct gpio_callback  cb;
+    manikin_gpio_inst_t   gpio;
+    manikin_gpio_irq_cb_t handler;
+    void                 *user;
+} manikin_gpio_irq_line_t;
+
+/*
+ * Zephyr hands the gpio_callback struct to the ISR, it has to outlive the registration.
+ * One line per data-ready pin is plenty, so a static table is used instead of allocating.
+ */
+static manikin_gpio_irq_line_t irq_lines[MANIKIN_GPIO_MAX_IRQ_LINES];
+
+static void
+gpio_hal_irq_trampoline (const struct device *port, struct gpio_callback *cb, gpio_port_pins_t pins)
+{
+    (void)port;
+    (void)pins;
+    manikin_gpio_irq_line_t *line = CONTAINER_OF(cb, manikin_gpio_irq_line_t, cb);
+    line->handler(line->user);
+}
+
+static manikin_gpio_irq_line_t *
+gpio_hal_find_line (manikin_gpio_inst_t gpio)
+{
+    for (size_t i = 0; i < MANIKIN_GPIO_MAX_IRQ_LINES; i++)
+    {
+        if (irq_lines[i].gpio == gpio)
+        {
+            return &irq_lines[i];
+        }
+    }
+    return NULL;
+}
+
+int
+gpio_hal_irq_enable (manikin_gpio_inst_t gpio, manikin_gpio_irq_cb_t cb, void *user)
+{
+    if (gpio == NULL || cb == NULL || !gpio_is_ready_dt(gpio))
+    {
+        return 1;
+    }
+    manikin_gpio_irq_line_t *line = gpio_hal_find_line(gpio);
+    line                          = (line != NULL) ? line : gpio_hal_find_line(NULL);
+    if (line == NULL)
+    {
+        return 1;
+    }
+    if (gpio_pin_configure_dt(gpio, GPIO_INPUT) != 0)
+    {
+        return 1;
+    }
+    line->gpio    = gpio;
+    line->handler = cb;
+    line->user    = user;
+    gpio_init_callback(&line->cb, gpio_hal_irq_trampoline, BIT(gpio->pin));
+    if (gpio_add_callback(gpio->port, &line->cb) != 0)
+    {
+        line->gpio = NULL;
+        return 1;
+    }
+    /* The devicetree flags of the pin decide whether active is high or low */
+    return gpio_pin_interrupt_configure_dt(gpio, GPIO_INT_EDGE_TO_ACTIVE) == 0 ? 0 : 1;
+}
+
+int
+gpio_hal_irq_disable (manikin_gpio_inst_t gpio)
+{
+    manikin_gpio_irq_line_t *line = gpio_hal_find_line(gpio);
+    if (gpio == NULL || line == NULL)
+    {
+        return 1;
+    }
+    int status = gpio_pin_interrupt_configure_dt(gpio, GPIO_INT_DISABLE);
+    gpio_remove_callback(gpio->port, &line->cb);
+    line->gpio = NULL;
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#ifndef MANIKIN_GPIO_FUNCTIONS_H
+#define MANIKIN_GPIO_FUNCTIONS_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stdint.h>
+#include "manikin_software_conf.h"
+
+    int gpio_hal_irq_enable(manikin_gpio_inst_t gpio, manikin_gpio_irq_cb_t cb, void *user);
+
+    int gpio_hal_irq_disable(manikin_gpio_inst_t gpio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MANIKIN_GPIO_FUNCTIONS_H */
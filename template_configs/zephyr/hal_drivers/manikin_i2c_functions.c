@@ -121,4 +121,12 @@ int
 i2c_hal_bus_recover ()
 {
     return 0;
+}
+
+int
+i2c_hal_bus_clear (manikin_i2c_inst_t i2c_inst)
+{
+    /* The i2c bus recovery of Zephyr clocks out SCL pulses until SDA is released + STOP */
+    int status = i2c_recover_bus(i2c_inst);
+    return status == 0 ? MANIKIN_STATUS_OK : 1;
 }
\ No newline at end of file
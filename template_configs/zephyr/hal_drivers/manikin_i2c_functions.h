@@ -30,6 +30,8 @@ extern "C"
 
     int i2c_hal_bus_recover();
 
+    int i2c_hal_bus_clear(manikin_i2c_inst_t i2c_inst);
+
     uint32_t i2c_hal_get_baud(manikin_i2c_inst_t i2c_inst);
 
 #ifdef __cplusplus
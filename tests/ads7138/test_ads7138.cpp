@@ -26,6 +26,9 @@
 #include "ads7138/ads7138.h"
 #include "fake_i2c_functions.h"
 
+#include <algorithm>
+#include <vector>
+
 // Common mocks and types
 static uint8_t       dummy_read_buf[4];
 static uint8_t       handle = 1;
@@ -47,9 +50,76 @@ custom_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, s
     return len;
 }
 
+static std::vector<std::vector<uint8_t>> written_frames;
+static std::vector<size_t>               read_lengths;
+
+size_t
+recording_write_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, const uint8_t *bytes, size_t len)
+{
+    written_frames.emplace_back(bytes, bytes + len);
+    return len;
+}
+
+/* RECENT registers, LSB first: channel n reads 0x100 * (n + 1) + 0x10 * n, left-aligned */
+size_t
+recent_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, size_t len)
+{
+    read_lengths.push_back(len);
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        const uint16_t val = (uint16_t)(((0x100u * (i + 1)) + (0x10u * i)) << 4u);
+        bytes[2 * i]       = (uint8_t)(val & 0xFFu);
+        bytes[2 * i + 1]   = (uint8_t)(val >> 8u);
+    }
+    return len;
+}
+
+static uint8_t  event_flags;
+static uint16_t recent_codes[8];
+
+/* SYSTEM_STATUS with its reserved bit, EVENT_FLAG or recent_codes for the RECENT burst */
+size_t
+wake_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, size_t len)
+{
+    read_lengths.push_back(len);
+    if (len == 1)
+    {
+        bytes[0] = (written_frames.back()[1] == 0x00) ? 0x80 : event_flags;
+        return len;
+    }
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        const uint16_t val = (uint16_t)(recent_codes[i] << 4u);
+        bytes[2 * i]       = (uint8_t)(val & 0xFFu);
+        bytes[2 * i + 1]   = (uint8_t)(val >> 8u);
+    }
+    return len;
+}
+
+static ads7138_config_t
+wake_config ()
+{
+    ads7138_config_t config {};
+    config.osr               = ADS7138_OSR_4;
+    config.clk_div           = 0;
+    config.wake_channels     = 0x04;
+    config.window[2]         = { 0x9A5, 0x123, 3, 1 };
+    config.alert_logic       = ADS7138_ALERT_ACTIVE_HIGH;
+    config.alert_push_pull   = 1;
+    config.idle_clk_div      = 12;
+    config.idle_divider      = 4;
+    config.idle_hold_samples = 2;
+    return config;
+}
+
 void
 reset_mocks ()
 {
+    event_flags = 0;
+    memset(recent_codes, 0, sizeof(recent_codes));
+    written_frames.clear();
+    read_lengths.clear();
+    dummy_ctx.driver_ctx = NULL;
     RESET_FAKE(i2c_hal_init);
     RESET_FAKE(i2c_hal_error_flag_check);
     RESET_FAKE(i2c_hal_read_bytes);
@@ -144,6 +214,219 @@ TEST_CASE("ads7138_parse_raw_data successfully converts valid raw data", "[ads71
     REQUIRE(parsed_data.ch2_mv == 0xABCD);
 }
 
+TEST_CASE("ads7138_init_sensor starts autonomous averaging with a config", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = { ADS7138_OSR_16, 3, 0 };
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+
+    // System status read and the four common init writes come first
+    REQUIRE(written_frames.size() == 9);
+    REQUIRE(written_frames[5] == std::vector<uint8_t> { 0x18, 0x01, 0x20 });
+    REQUIRE(written_frames[6] == std::vector<uint8_t> { 0x08, 0x03, ADS7138_OSR_16 });
+    REQUIRE(written_frames[7] == std::vector<uint8_t> { 0x08, 0x04, 0x23 });
+    REQUIRE(written_frames[8] == std::vector<uint8_t> { 0x18, 0x10, 0x10 });
+}
+
+TEST_CASE("ads7138_init_sensor rejects an invalid autonomous config", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = { ADS7138_OSR_128 + 1, 0, 0 };
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config.osr     = ADS7138_OSR_1;
+    config.clk_div = 16;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    REQUIRE(written_frames.empty());
+}
+
+TEST_CASE("ads7138_read_sensor in autonomous mode is one burst read", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = { ADS7138_OSR_8, 0, 0 };
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = recent_read_func;
+
+    uint8_t read_buf[16] = { 0 };
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(written_frames == std::vector<std::vector<uint8_t>> { { 0x30, 0xA0 } });
+    REQUIRE(read_lengths == std::vector<size_t> { 16 });
+
+    ads7138_sample_data_t data;
+    REQUIRE(ads7138_parse_raw_data(read_buf, &data) == MANIKIN_STATUS_OK);
+    REQUIRE(data.ch1_mv == 0x100);
+    REQUIRE(data.ch2_mv == 0x210);
+    REQUIRE(data.ch8_mv == 0x870);
+    REQUIRE(dummy_ctx.sample.seq != 0);
+}
+
+TEST_CASE("ads7138_read_sensor in autonomous mode reports a failed read", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = { ADS7138_OSR_8, 0, 0 };
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.return_val   = 0;
+
+    uint8_t read_buf[16] = { 0 };
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_ERR_READ_FAIL);
+}
+
+TEST_CASE("ads7138_init_sensor programs the window comparator in wake mode", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = wake_config();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = wake_read_func;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+
+    const std::vector<std::vector<uint8_t>> expected = {
+        { 0x08, 0x28, 0x53 }, // High threshold LSBs and hysteresis
+        { 0x08, 0x29, 0x9A }, // High threshold MSBs
+        { 0x08, 0x2A, 0x31 }, // Low threshold LSBs and event count
+        { 0x08, 0x2B, 0x12 }, // Low threshold MSBs
+        { 0x08, 0x14, 0x04 }, // ALERT on channel 2
+        { 0x08, 0x17, 0x05 }, // Push-pull, active high
+        { 0x18, 0x01, 0x10 }, // Window comparator enable
+        { 0x08, 0x1A, 0xFF }, // Clear high events
+        { 0x08, 0x1C, 0xFF }, // Clear low events
+        { 0x18, 0x01, 0x20 }, // Statistics enable
+        { 0x08, 0x03, ADS7138_OSR_4 },
+        { 0x08, 0x04, 0x2C }, // Autonomous at the idle rate
+        { 0x18, 0x10, 0x10 }, // Sequence start
+    };
+    REQUIRE(std::vector<std::vector<uint8_t>>(written_frames.begin() + 5, written_frames.end())
+            == expected);
+    REQUIRE(config.active == 0);
+
+    config.window[2].low_threshold = 0x9A6;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config                       = wake_config();
+    config.window[2].event_count = 16;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config             = wake_config();
+    config.alert_logic = 4;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+}
+
+TEST_CASE("ads7138 wake mode polls events while idle and samples after one", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = wake_config();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    dummy_ctx.drdy_irq                   = 0;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = wake_read_func;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    written_frames.clear();
+    read_lengths.clear();
+
+    // Idle: only every fourth call polls the event flags, no sample is written
+    uint8_t        read_buf[16] = { 0 };
+    const uint32_t seq          = dummy_ctx.sample.seq;
+    for (int i = 0; i < 8; i++)
+    {
+        REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    }
+    REQUIRE(read_lengths == std::vector<size_t> { 1, 1 });
+    REQUIRE(dummy_ctx.sample.seq == seq);
+    REQUIRE(config.active == 0);
+
+    // Hand contact on channel 2: switch to full rate and sample
+    event_flags     = 0x04;
+    recent_codes[2] = 0xA00;
+    written_frames.clear();
+    read_lengths.clear();
+    for (int i = 0; i < 4; i++)
+    {
+        REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    }
+    REQUIRE(config.active == 1);
+    REQUIRE(read_lengths == std::vector<size_t> { 1, 16 });
+    REQUIRE(dummy_ctx.sample.seq == seq + 1);
+    REQUIRE(std::find(written_frames.begin(),
+                      written_frames.end(),
+                      std::vector<uint8_t> { 0x08, 0x04, 0x20 })
+            != written_frames.end());
+
+    // Every call samples while active, two quiet samples return to idle
+    event_flags = 0;
+    read_lengths.clear();
+    written_frames.clear();
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    recent_codes[2] = 0x500;
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(config.active == 1);
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(config.active == 0);
+    REQUIRE(read_lengths == std::vector<size_t> { 16, 16, 16 });
+    REQUIRE(dummy_ctx.sample.seq == seq + 4);
+    const std::vector<std::vector<uint8_t>> to_idle = {
+        { 0x30, 0xA0 },       { 0x30, 0xA0 },       { 0x30, 0xA0 },
+        { 0x20, 0x10, 0x10 }, { 0x08, 0x04, 0x2C }, { 0x18, 0x10, 0x10 },
+        { 0x08, 0x1A, 0xFF }, { 0x08, 0x1C, 0xFF },
+    };
+    REQUIRE(written_frames == to_idle);
+}
+
+TEST_CASE("ads7138 wake mode polls on every call with drdy_irq", "[ads7138]")
+{
+    reset_mocks();
+    ads7138_config_t config              = wake_config();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    dummy_ctx.driver_ctx                 = &config;
+    dummy_ctx.drdy_irq                   = 1;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = wake_read_func;
+    REQUIRE(ads7138_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    read_lengths.clear();
+
+    uint8_t read_buf[16] = { 0 };
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(ads7138_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(read_lengths == std::vector<size_t> { 1, 1 });
+    dummy_ctx.drdy_irq = 0;
+}
+
+TEST_CASE("ads7138_read_events reads and clears the event flags", "[ads7138]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = ADS7138_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = recording_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = wake_read_func;
+    event_flags                          = 0x81;
+
+    uint8_t events = 0;
+    REQUIRE(ads7138_read_events(&dummy_ctx, &events) == MANIKIN_STATUS_OK);
+    REQUIRE(events == 0x81);
+    const std::vector<std::vector<uint8_t>> expected = {
+        { 0x10, 0x18 }, { 0x08, 0x1A, 0xFF }, { 0x08, 0x1C, 0xFF },
+    };
+    REQUIRE(written_frames == expected);
+    REQUIRE(ads7138_read_events(&dummy_ctx, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
 int
 main (int argc, char *argv[])
 {
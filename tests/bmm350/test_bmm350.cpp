@@ -26,6 +26,10 @@
 #include <catch2/catch_session.hpp>
 #include <bmm350/bmm350_driver.h>
 #include "fake_i2c_functions.h"
+#include "fake_timer_functions.h"
+#include "virtual_clock.h"
+#include "common/manikin_time.h"
+#include <cstring>
 
 // // Common mocks and types
 // static uint8_t       dummy_read_buf[4];
@@ -56,6 +60,7 @@ reset_mocks ()
     RESET_FAKE(i2c_hal_read_bytes);
     RESET_FAKE(i2c_hal_write_bytes);
     RESET_FAKE(i2c_hal_deinit);
+    RESET_FAKE(timer_hal_get_tick);
 }
 
 // // --- bmm350_init_sensor ---
@@ -159,6 +164,377 @@ TEST_CASE("bmm350_init_sensor handles null parameter", "[bmm350][REQ-F4]")
 //     REQUIRE(parsed_data.sensor_time_us == -8388608); // 0x800000
 // }
 
+// --- Simulated BMM350 register file, one per I2C address ---
+#define SIM_REG_PMU_CMD_AGGR   0x04u
+#define SIM_REG_PMU_CMD        0x06u
+#define SIM_REG_PMU_CMD_STATUS 0x07u
+#define SIM_REG_INT_STATUS     0x30u
+#define SIM_REG_MAG_X_XLSB     0x31u
+#define SIM_REG_OTP_CMD        0x50u
+#define SIM_REG_OTP_DATA_MSB   0x52u
+#define SIM_REG_OTP_DATA_LSB   0x53u
+#define SIM_REG_OTP_STATUS     0x55u
+#define SIM_REG_CMD            0x7Eu
+#define SIM_NORMAL_MODE_BIT    0x08u
+
+typedef struct
+{
+    uint8_t  addr;
+    uint8_t  chip_id;
+    uint8_t  regs[128];
+    uint16_t otp[32];
+    uint8_t  reg_ptr;
+    int      otp_reads;
+} sim_bmm350_t;
+
+static sim_bmm350_t sims[2];
+
+static sim_bmm350_t *
+sim_find (uint8_t i2c_addr)
+{
+    for (sim_bmm350_t &sim : sims)
+    {
+        if (sim.addr == i2c_addr)
+        {
+            return &sim;
+        }
+    }
+    return NULL;
+}
+
+static void
+sim_write_reg (sim_bmm350_t *sim, uint8_t reg, uint8_t val)
+{
+    switch (reg)
+    {
+        case SIM_REG_CMD:
+            sim->regs[0x00] = sim->chip_id;
+            break;
+        case SIM_REG_OTP_CMD:
+            if ((val & 0xE0u) == 0x20u)
+            {
+                const uint16_t word              = sim->otp[val & 0x1Fu];
+                sim->regs[SIM_REG_OTP_DATA_MSB] = (uint8_t)(word >> 8);
+                sim->regs[SIM_REG_OTP_DATA_LSB] = (uint8_t)word;
+                sim->regs[SIM_REG_OTP_STATUS]   = 0x01u;
+                sim->otp_reads++;
+            }
+            break;
+        case SIM_REG_PMU_CMD: {
+            uint8_t normal = sim->regs[SIM_REG_PMU_CMD_STATUS] & SIM_NORMAL_MODE_BIT;
+            normal         = (val == 0x01u) ? SIM_NORMAL_MODE_BIT : (val == 0x00u) ? 0 : normal;
+            sim->regs[SIM_REG_PMU_CMD_STATUS] = (uint8_t)((val << 5) | normal);
+            break;
+        }
+        default:
+            sim->regs[reg & 0x7Fu] = val;
+            break;
+    }
+}
+
+size_t
+sim_write_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, const uint8_t *bytes, size_t len)
+{
+    (void)handle;
+    sim_bmm350_t *sim = sim_find(i2c_addr);
+    if (sim == NULL)
+    {
+        return 0;
+    }
+    sim->reg_ptr = bytes[0];
+    for (size_t i = 1; i < len; i++)
+    {
+        sim_write_reg(sim, (uint8_t)(bytes[0] + i - 1u), bytes[i]);
+    }
+    return len;
+}
+
+size_t
+sim_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, size_t len)
+{
+    (void)handle;
+    sim_bmm350_t *sim = sim_find(i2c_addr);
+    if (sim == NULL)
+    {
+        return 0;
+    }
+    // NOTE: Every register read starts with 2 dummy bytes
+    for (size_t i = 0; i < len; i++)
+    {
+        bytes[i] = (i < 2u) ? 0 : sim->regs[(sim->reg_ptr + i - 2u) & 0x7Fu];
+    }
+    return len;
+}
+
+static void
+sim_setup (sim_bmm350_t *sim, uint8_t i2c_addr, uint16_t otp_seed)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->addr                     = i2c_addr;
+    sim->chip_id                  = 0x33u;
+    sim->regs[0x00]               = sim->chip_id;
+    sim->regs[SIM_REG_INT_STATUS] = 0x04u;
+    for (uint8_t i = 0; i < 32u; i++)
+    {
+        sim->otp[i] = (uint16_t)(otp_seed + i);
+    }
+    // Raw x = 0x010000, y = -0x010000, z = 0x008000, temperature = 0x100000
+    const uint8_t raw[12] = { 0x00, 0x00, 0x01, 0x00, 0x00, 0xFF,
+                              0x00, 0x80, 0x00, 0x00, 0x00, 0x10 };
+    memcpy(&sim->regs[SIM_REG_MAG_X_XLSB], raw, sizeof(raw));
+}
+
+static void
+sim_start (void)
+{
+    reset_mocks();
+    sim_setup(&sims[0], 0x14u, 0x0100u);
+    sim_setup(&sims[1], 0x15u, 0x0200u);
+    i2c_hal_write_bytes_fake.custom_fake = sim_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = sim_read_func;
+    virtual_clock_reset();
+    virtual_clock_attach();
+    manikin_time_init();
+}
+
+static manikin_sensor_ctx_t
+sim_ctx (uint8_t i2c_addr, bmm350_instance_t *inst)
+{
+    static uint8_t       handle = 1;
+    manikin_sensor_ctx_t ctx    = {};
+    ctx.i2c                     = &handle;
+    ctx.i2c_addr                = i2c_addr;
+    ctx.driver_ctx              = inst;
+    return ctx;
+}
+
+/* Read until the warm-up after init is over, none of these reads may return a sample */
+static int
+sim_warm_up (manikin_sensor_ctx_t *ctx, bmm350_instance_t *inst)
+{
+    uint8_t  buf[BMM350_READ_BUF_SIZE];
+    uint32_t seq   = ctx->sample.seq;
+    int      reads = 0;
+    while (inst->state == BMM350_STATE_WARMUP && reads < 100)
+    {
+        REQUIRE(bmm350_read_sensor(ctx, buf) == MANIKIN_STATUS_OK);
+        virtual_clock_advance_us(10000);
+        reads++;
+    }
+    REQUIRE(inst->state == BMM350_STATE_READY);
+    REQUIRE(ctx->sample.seq == seq);
+    return reads;
+}
+
+TEST_CASE("bmm350 instances on two addresses keep their own OTP data", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst_a = {};
+    bmm350_instance_t    inst_b = {};
+    manikin_sensor_ctx_t ctx_a  = sim_ctx(0x14u, &inst_a);
+    manikin_sensor_ctx_t ctx_b  = sim_ctx(0x15u, &inst_b);
+
+    REQUIRE(bmm350_init_sensor(&ctx_a) == MANIKIN_STATUS_OK);
+    REQUIRE(bmm350_init_sensor(&ctx_b) == MANIKIN_STATUS_OK);
+    CHECK(sims[0].otp_reads == 32);
+    CHECK(sims[1].otp_reads == 32);
+    CHECK(inst_a.otp_valid == 1);
+    CHECK(inst_b.otp_valid == 1);
+    CHECK(memcmp(inst_a.dev.otp_data, sims[0].otp, sizeof(sims[0].otp)) == 0);
+    CHECK(memcmp(inst_b.dev.otp_data, sims[1].otp, sizeof(sims[1].otp)) == 0);
+
+    // Interleaved reads use the compensation data of their own device
+    uint8_t              buf_a[BMM350_READ_BUF_SIZE];
+    uint8_t              buf_b[BMM350_READ_BUF_SIZE];
+    bmm350_sample_data_t data_a;
+    bmm350_sample_data_t data_b;
+    sim_warm_up(&ctx_a, &inst_a);
+    sim_warm_up(&ctx_b, &inst_b);
+    REQUIRE(bmm350_read_sensor(&ctx_a, buf_a) == MANIKIN_STATUS_OK);
+    REQUIRE(bmm350_read_sensor(&ctx_b, buf_b) == MANIKIN_STATUS_OK);
+    REQUIRE(bmm350_parse_raw_data(buf_a, &data_a) == MANIKIN_STATUS_OK);
+    REQUIRE(bmm350_parse_raw_data(buf_b, &data_b) == MANIKIN_STATUS_OK);
+    CHECK(data_a.magneto_x_ut != data_b.magneto_x_ut);
+    CHECK(ctx_a.sample.seq == 1);
+    CHECK(ctx_b.sample.seq == 1);
+}
+
+TEST_CASE("bmm350 re-initialization does not read the OTP again", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    sim_warm_up(&ctx, &inst);
+    uint8_t first[BMM350_READ_BUF_SIZE];
+    REQUIRE(bmm350_read_sensor(&ctx, first) == MANIKIN_STATUS_OK);
+
+    ctx.needs_reinit = 1;
+    uint8_t second[BMM350_READ_BUF_SIZE];
+    REQUIRE(bmm350_read_sensor(&ctx, second) == MANIKIN_STATUS_OK);
+    CHECK(ctx.needs_reinit == 0);
+    CHECK(inst.state == BMM350_STATE_WARMUP);
+    sim_warm_up(&ctx, &inst);
+    REQUIRE(bmm350_read_sensor(&ctx, second) == MANIKIN_STATUS_OK);
+    CHECK(sims[0].otp_reads == 32);
+    // NOTE: Only the compensated values are compared, the acquisition times differ
+    CHECK(memcmp(first, second, BMM350_READ_BUF_SIZE - 4u) == 0);
+}
+
+TEST_CASE("bmm350 re-initialization fails and drops the OTP data on a wrong chip id",
+          "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+
+    sims[0].chip_id = 0x00u;
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    CHECK(inst.otp_valid == 0);
+
+    // The next init reads the OTP of the (replaced) device again
+    sims[0].chip_id = 0x33u;
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    CHECK(sims[0].otp_reads == 64);
+}
+
+TEST_CASE("bmm350 compensation modes give the same samples", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x15u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    sim_warm_up(&ctx, &inst);
+
+    bmm350_sample_data_t samples[3];
+    const uint8_t modes[3] = { BMM350_COMP_BOSCH, BMM350_COMP_FLOAT, BMM350_COMP_Q16 };
+    for (int i = 0; i < 3; i++)
+    {
+        uint8_t buf[BMM350_READ_BUF_SIZE];
+        inst.comp_mode = modes[i];
+        REQUIRE(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_OK);
+        REQUIRE(bmm350_parse_raw_data(buf, &samples[i]) == MANIKIN_STATUS_OK);
+    }
+    for (int i = 1; i < 3; i++)
+    {
+        CHECK(samples[i].magneto_x_ut
+              == Catch::Approx(samples[0].magneto_x_ut).margin(BMM350_COMP_TOLERANCE));
+        CHECK(samples[i].magneto_y_ut
+              == Catch::Approx(samples[0].magneto_y_ut).margin(BMM350_COMP_TOLERANCE));
+        CHECK(samples[i].magneto_z_ut
+              == Catch::Approx(samples[0].magneto_z_ut).margin(BMM350_COMP_TOLERANCE));
+        CHECK(samples[i].temperature_mdeg
+              == Catch::Approx(samples[0].temperature_mdeg).margin(BMM350_COMP_TOLERANCE));
+    }
+}
+
+TEST_CASE("bmm350_init_sensor fails when the device does not respond", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x16u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    CHECK(inst.otp_valid == 0);
+}
+
+TEST_CASE("bmm350 init uses 100 Hz with averaging 4 by default", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    CHECK(sims[0].regs[SIM_REG_PMU_CMD_AGGR] == (BMM350_ODR_100HZ | BMM350_AVG_4 << 4));
+    CHECK(inst.state == BMM350_STATE_WARMUP);
+}
+
+TEST_CASE("bmm350_set_rate is applied by init and while running", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    REQUIRE(bmm350_set_rate(&ctx, BMM350_DATA_RATE_400HZ, BMM350_NO_AVERAGING)
+            == MANIKIN_STATUS_OK);
+    // Not initialized yet, so only stored
+    CHECK(i2c_hal_write_bytes_fake.call_count == 0);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    CHECK(sims[0].regs[SIM_REG_PMU_CMD_AGGR] == BMM350_ODR_400HZ);
+    // 400 Hz warms up in 25 ms, every read comes 10 ms later
+    CHECK(sim_warm_up(&ctx, &inst) == 10);
+
+    REQUIRE(bmm350_set_rate(&ctx, BMM350_DATA_RATE_12_5HZ, BMM350_AVERAGING_8)
+            == MANIKIN_STATUS_OK);
+    CHECK(sims[0].regs[SIM_REG_PMU_CMD_AGGR] == (BMM350_ODR_12_5HZ | BMM350_AVG_8 << 4));
+    CHECK(sims[0].regs[SIM_REG_PMU_CMD_STATUS] >> 5 == BMM350_PMU_CMD_UPD_OAE);
+    CHECK(inst.state == BMM350_STATE_READY);
+}
+
+TEST_CASE("bmm350_set_rate rejects averaging the rate leaves no time for", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    CHECK(bmm350_set_rate(NULL, BMM350_DATA_RATE_100HZ, BMM350_AVERAGING_4)
+          == MANIKIN_STATUS_ERR_NULL_PARAM);
+    CHECK(bmm350_set_rate(&ctx, BMM350_DATA_RATE_400HZ, BMM350_AVERAGING_2)
+          == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    CHECK(bmm350_set_rate(&ctx, BMM350_DATA_RATE_200HZ, BMM350_AVERAGING_4)
+          == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    CHECK(bmm350_set_rate(&ctx, BMM350_DATA_RATE_100HZ, BMM350_AVERAGING_8)
+          == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    CHECK(bmm350_set_rate(&ctx, (enum bmm350_data_rates)0x0Bu, BMM350_NO_AVERAGING)
+          == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    CHECK(bmm350_set_rate(&ctx, BMM350_DATA_RATE_200HZ, BMM350_AVERAGING_2) == MANIKIN_STATUS_OK);
+    CHECK(bmm350_set_rate(&ctx, BMM350_DATA_RATE_50HZ, BMM350_AVERAGING_8) == MANIKIN_STATUS_OK);
+
+    // An invalid rate put into the instance directly is caught by init
+    inst.odr       = BMM350_ODR_400HZ;
+    inst.averaging = BMM350_AVG_8;
+    CHECK(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    CHECK(i2c_hal_write_bytes_fake.call_count == 0);
+}
+
+TEST_CASE("bmm350 warm-up gives up when DRDY never comes", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    REQUIRE(bmm350_init_sensor(&ctx) == MANIKIN_STATUS_OK);
+    sims[0].regs[SIM_REG_INT_STATUS] = 0;
+
+    // 100 Hz: 38 ms to normal mode plus 20 periods of 10 ms, so the read at 240 ms is too late
+    uint8_t buf[BMM350_READ_BUF_SIZE];
+    for (int i = 0; i < 24; i++)
+    {
+        REQUIRE(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_OK);
+        virtual_clock_advance_us(10000);
+    }
+    CHECK(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    CHECK(inst.state == BMM350_STATE_UNINIT);
+    CHECK(ctx.needs_reinit == 1);
+    CHECK(ctx.sample.seq == 0);
+
+    // The next read initializes the device again, without reading the OTP
+    sims[0].regs[SIM_REG_INT_STATUS] = 0x04u;
+    REQUIRE(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_OK);
+    CHECK(ctx.needs_reinit == 0);
+    CHECK(sims[0].otp_reads == 32);
+    sim_warm_up(&ctx, &inst);
+    REQUIRE(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_OK);
+    CHECK(ctx.sample.seq == 1);
+}
+
+TEST_CASE("bmm350_read_sensor fails before init", "[bmm350][REQ-F4]")
+{
+    sim_start();
+    bmm350_instance_t    inst = {};
+    manikin_sensor_ctx_t ctx  = sim_ctx(0x14u, &inst);
+    uint8_t              buf[BMM350_READ_BUF_SIZE];
+    CHECK(bmm350_read_sensor(&ctx, buf) == MANIKIN_STATUS_ERR_SENSOR_INIT_FAIL);
+    CHECK(ctx.needs_reinit == 1);
+    CHECK(i2c_hal_write_bytes_fake.call_count == 0);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -0,0 +1,261 @@
+/**
+ * @file            test_bmm350_comp.cpp
+ * @brief           Tests for the precomputed BMM350 compensation paths
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "bmm350/bmm350_comp.h"
+#include "bmm350/external/bmm350.h"
+
+#include <cmath>
+#include <cstring>
+
+/* Raw counts of +-2000 uT, the measurement range, and of -40 to 85 degC */
+#define RAW_MAG_RANGE   290000
+#define RAW_TEMP_MIN    (-70000)
+#define RAW_TEMP_MAX    115000
+
+static uint8_t raw_regs[12];
+
+/* Reference: the Bosch API reading raw_regs through a fake bus */
+static BMM350_INTF_RET_TYPE
+fake_read (uint8_t reg_addr, uint8_t *reg_data, uint32_t length, void *intf_ptr)
+{
+    (void)reg_addr;
+    (void)intf_ptr;
+    memset(reg_data, 0, length);
+    memcpy(reg_data + BMM350_DUMMY_BYTES, raw_regs, length - BMM350_DUMMY_BYTES);
+    return BMM350_INTF_RET_SUCCESS;
+}
+
+static BMM350_INTF_RET_TYPE
+fake_write (uint8_t reg_addr, const uint8_t *reg_data, uint32_t length, void *intf_ptr)
+{
+    (void)reg_addr;
+    (void)reg_data;
+    (void)length;
+    (void)intf_ptr;
+    return BMM350_INTF_RET_SUCCESS;
+}
+
+static void
+fake_delay (uint32_t period, void *intf_ptr)
+{
+    (void)period;
+    (void)intf_ptr;
+}
+
+static void
+set_raw (const struct bmm350_raw_mag_data &raw)
+{
+    const int32_t values[4] = { raw.raw_xdata, raw.raw_ydata, raw.raw_zdata, raw.raw_data_t };
+    for (int i = 0; i < 4; i++)
+    {
+        raw_regs[i * 3]     = (uint8_t)values[i];
+        raw_regs[i * 3 + 1] = (uint8_t)(values[i] >> 8);
+        raw_regs[i * 3 + 2] = (uint8_t)(values[i] >> 16);
+    }
+}
+
+static struct bmm350_mag_temp_data
+bosch_compensate (const struct bmm350_mag_compensate &mag_comp,
+                  const struct bmm350_raw_mag_data   &raw)
+{
+    struct bmm350_dev dev = {};
+    dev.read              = fake_read;
+    dev.write             = fake_write;
+    dev.delay_us          = fake_delay;
+    dev.axis_en           = BMM350_EN_XYZ_MSK;
+    dev.mag_comp          = mag_comp;
+    set_raw(raw);
+    struct bmm350_mag_temp_data out = {};
+    REQUIRE(bmm350_get_compensated_mag_xyz_temp_data(&out, &dev) == BMM350_OK);
+    return out;
+}
+
+static uint32_t lcg_state;
+
+static int32_t
+random_between (int32_t lo, int32_t hi)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lo + (int32_t)((lcg_state >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+/* Coefficients with the quantization of the OTP words, as update_mag_off_sens() decodes them */
+static struct bmm350_mag_compensate
+random_coefficients ()
+{
+    struct bmm350_mag_compensate comp = {};
+    comp.dut_offset_coef.offset_x     = (float)random_between(-2048, 2047);
+    comp.dut_offset_coef.offset_y     = (float)random_between(-2048, 2047);
+    comp.dut_offset_coef.offset_z     = (float)random_between(-2048, 2047);
+    comp.dut_offset_coef.t_offs       = (float)random_between(-128, 127) / 5.0f;
+    comp.dut_sensit_coef.sens_x       = (float)random_between(-128, 127) / 256.0f;
+    comp.dut_sensit_coef.sens_y = (float)random_between(-128, 127) / 256.0f + BMM350_SENS_CORR_Y;
+    comp.dut_sensit_coef.sens_z = (float)random_between(-128, 127) / 256.0f;
+    comp.dut_sensit_coef.t_sens = (float)random_between(-128, 127) / 512.0f;
+    comp.dut_tco.tco_x          = (float)random_between(-128, 127) / 32.0f;
+    comp.dut_tco.tco_y          = (float)random_between(-128, 127) / 32.0f;
+    comp.dut_tco.tco_z          = (float)random_between(-128, 127) / 32.0f;
+    comp.dut_tcs.tcs_x          = (float)random_between(-128, 127) / 16384.0f;
+    comp.dut_tcs.tcs_y          = (float)random_between(-128, 127) / 16384.0f;
+    comp.dut_tcs.tcs_z = (float)random_between(-128, 127) / 16384.0f - BMM350_TCS_CORR_Z;
+    comp.dut_t0        = (float)random_between(-8000, 8000) / 512.0f + 23.0f;
+    comp.cross_axis.cross_x_y = (float)random_between(-128, 127) / 800.0f;
+    comp.cross_axis.cross_y_x = (float)random_between(-128, 127) / 800.0f;
+    comp.cross_axis.cross_z_x = (float)random_between(-128, 127) / 800.0f;
+    comp.cross_axis.cross_z_y = (float)random_between(-128, 127) / 800.0f;
+    return comp;
+}
+
+static struct bmm350_raw_mag_data
+random_raw ()
+{
+    struct bmm350_raw_mag_data raw = {};
+    raw.raw_xdata                  = random_between(-RAW_MAG_RANGE, RAW_MAG_RANGE);
+    raw.raw_ydata                  = random_between(-RAW_MAG_RANGE, RAW_MAG_RANGE);
+    raw.raw_zdata                  = random_between(-RAW_MAG_RANGE, RAW_MAG_RANGE);
+    raw.raw_data_t                 = random_between(RAW_TEMP_MIN, RAW_TEMP_MAX);
+    return raw;
+}
+
+static float
+q16_to_float (int32_t val)
+{
+    return (float)val / BMM350_COMP_Q16_ONE;
+}
+
+TEST_CASE("bmm350_comp_init rejects NULL params", "[bmm350_comp]")
+{
+    bmm350_comp_t                comp     = {};
+    struct bmm350_mag_compensate mag_comp = {};
+    REQUIRE(bmm350_comp_init(NULL, &mag_comp) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_init(&comp, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("bmm350_comp_init rejects a zero cross-axis denominator", "[bmm350_comp]")
+{
+    bmm350_comp_t                comp     = {};
+    struct bmm350_mag_compensate mag_comp = {};
+    mag_comp.cross_axis.cross_x_y         = 1.0f;
+    mag_comp.cross_axis.cross_y_x         = 1.0f;
+    REQUIRE(bmm350_comp_init(&comp, &mag_comp) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+}
+
+TEST_CASE("bmm350_comp_apply rejects NULL params", "[bmm350_comp]")
+{
+    bmm350_comp_t               comp = {};
+    struct bmm350_raw_mag_data  raw  = {};
+    struct bmm350_mag_temp_data out  = {};
+    bmm350_mag_q16_t            q16  = {};
+    REQUIRE(bmm350_comp_apply_float(NULL, &raw, &out) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_apply_float(&comp, NULL, &out) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_apply_float(&comp, &raw, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_apply_q16(NULL, &raw, &q16) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_apply_q16(&comp, NULL, &q16) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(bmm350_comp_apply_q16(&comp, &raw, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("bmm350 compensation paths match the Bosch float path", "[bmm350_comp]")
+{
+    lcg_state       = 0x12345678u;
+    float max_float = 0.0f;
+    float max_q16   = 0.0f;
+    for (int set = 0; set < 200; set++)
+    {
+        const struct bmm350_mag_compensate mag_comp = random_coefficients();
+        bmm350_comp_t                      comp;
+        REQUIRE(bmm350_comp_init(&comp, &mag_comp) == MANIKIN_STATUS_OK);
+        for (int sample = 0; sample < 50; sample++)
+        {
+            const struct bmm350_raw_mag_data  raw = random_raw();
+            const struct bmm350_mag_temp_data ref = bosch_compensate(mag_comp, raw);
+            struct bmm350_mag_temp_data       out;
+            bmm350_mag_q16_t                  q16;
+            REQUIRE(bmm350_comp_apply_float(&comp, &raw, &out) == MANIKIN_STATUS_OK);
+            REQUIRE(bmm350_comp_apply_q16(&comp, &raw, &q16) == MANIKIN_STATUS_OK);
+
+            const float float_err[4] = { out.x - ref.x, out.y - ref.y, out.z - ref.z,
+                                         out.temperature - ref.temperature };
+            const float q16_err[4]   = { q16_to_float(q16.x) - ref.x,
+                                         q16_to_float(q16.y) - ref.y,
+                                         q16_to_float(q16.z) - ref.z,
+                                         q16_to_float(q16.temperature) - ref.temperature };
+            for (int i = 0; i < 4; i++)
+            {
+                max_float = std::fmax(max_float, std::fabs(float_err[i]));
+                max_q16   = std::fmax(max_q16, std::fabs(q16_err[i]));
+            }
+        }
+    }
+    INFO("float path max error " << max_float << ", Q16 path max error " << max_q16);
+    CHECK(max_float <= BMM350_COMP_TOLERANCE);
+    CHECK(max_q16 <= BMM350_COMP_TOLERANCE);
+}
+
+TEST_CASE("bmm350 Q16 compensation of a zero field is the offset", "[bmm350_comp]")
+{
+    struct bmm350_mag_compensate mag_comp = {};
+    mag_comp.dut_offset_coef.offset_x     = 12.0f;
+    mag_comp.dut_offset_coef.offset_y     = -7.0f;
+    mag_comp.dut_offset_coef.offset_z     = 3.0f;
+    mag_comp.dut_t0                       = 23.0f;
+    bmm350_comp_t comp;
+    REQUIRE(bmm350_comp_init(&comp, &mag_comp) == MANIKIN_STATUS_OK);
+
+    // A raw temperature of 0 is 0 degC, so the tco and tcs terms are 0 as well
+    struct bmm350_raw_mag_data raw = {};
+    bmm350_mag_q16_t           q16;
+    REQUIRE(bmm350_comp_apply_q16(&comp, &raw, &q16) == MANIKIN_STATUS_OK);
+    CHECK(q16.x == 12 * BMM350_COMP_Q16_ONE);
+    CHECK(q16.y == -7 * BMM350_COMP_Q16_ONE);
+    CHECK(q16.z == 3 * BMM350_COMP_Q16_ONE);
+    CHECK(q16.temperature == 0);
+}
+
+TEST_CASE("bmm350 Q16 compensation saturates out of range fields", "[bmm350_comp]")
+{
+    struct bmm350_mag_compensate mag_comp = {};
+    bmm350_comp_t                comp;
+    REQUIRE(bmm350_comp_init(&comp, &mag_comp) == MANIKIN_STATUS_OK);
+    struct bmm350_raw_mag_data raw = {};
+    raw.raw_xdata                  = 0x7FFFFF;
+    raw.raw_ydata                  = -0x800000;
+    bmm350_mag_q16_t q16;
+    REQUIRE(bmm350_comp_apply_q16(&comp, &raw, &q16) == MANIKIN_STATUS_OK);
+    CHECK(q16.x == INT32_MAX);
+    CHECK(q16.y == -INT32_MAX);
+}
+
+int
+main (int argc, char *argv[])
+{
+    // your setup ...
+
+    int result = Catch::Session().run(argc, argv);
+
+    // your clean-up...
+
+    return result;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file             test_bus_planner.cpp
+ * @brief           Test for the bus capacity planner
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "bus_planner/bus_planner.h"
+#include "ads7138/ads7138.h"
+#include "bmm350/bmm350_driver.h"
+#include "sdp810/sdp810.h"
+
+static bus_planner_sensor_t
+make_sensor (bus_planner_transfer_t transfer, uint16_t rate_hz, uint16_t min_rate_hz)
+{
+    bus_planner_sensor_t sensor {};
+    sensor.transfer    = transfer;
+    sensor.rate_hz     = rate_hz;
+    sensor.min_rate_hz = min_rate_hz;
+    return sensor;
+}
+
+static bus_planner_ctx_t
+make_planner (bus_planner_sensor_t *sensors, uint8_t sensor_cnt, bus_planner_policy_t policy)
+{
+    bus_planner_ctx_t ctx {};
+    ctx.i2c_speed_hz            = MANIKIN_I2C_SPEED_400KHz;
+    ctx.transaction_overhead_us = 50;
+    ctx.budget_permille         = 800;
+    ctx.policy                  = policy;
+    ctx.sensors                 = sensors;
+    ctx.sensor_cnt              = sensor_cnt;
+    return ctx;
+}
+
+TEST_CASE("bus_planner_read_time_us follows the I2C bit-time model", "[bus_planner][REQ-F9]")
+{
+    const bus_planner_transfer_t sdp810 = BUS_PLANNER_DRIVER_TRANSFER(SDP810);
+
+    // 1 transaction (11 bits) + 9 bytes (81 bits) at 100 kHz
+    REQUIRE(bus_planner_read_time_us(&sdp810, MANIKIN_I2C_SPEED_100KHz, 0) == 920);
+    // Rounded up to whole microseconds, plus the per-transaction overhead
+    REQUIRE(bus_planner_read_time_us(&sdp810, MANIKIN_I2C_SPEED_400KHz, 0) == 230);
+    REQUIRE(bus_planner_read_time_us(&sdp810, MANIKIN_I2C_SPEED_400KHz, 20) == 250);
+
+    REQUIRE(bus_planner_read_time_us(NULL, MANIKIN_I2C_SPEED_400KHz, 0) == 0);
+    REQUIRE(bus_planner_read_time_us(&sdp810, 0, 0) == 0);
+}
+
+TEST_CASE("bus_planner_plan rejects invalid parameters", "[bus_planner][REQ-F9]")
+{
+    bus_planner_sensor_t sensors[] = { make_sensor(BUS_PLANNER_DRIVER_TRANSFER(SDP810), 100, 0) };
+    bus_planner_ctx_t    ctx       = make_planner(sensors, 1, BUS_PLANNER_POLICY_REJECT);
+
+    REQUIRE(bus_planner_plan(NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    ctx.sensor_cnt = 0;
+    REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    ctx              = make_planner(sensors, 1, BUS_PLANNER_POLICY_REJECT);
+    ctx.i2c_speed_hz = 0;
+    REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_INVALID_I2C_BAUD);
+
+    ctx                    = make_planner(sensors, 1, BUS_PLANNER_POLICY_REJECT);
+    sensors[0].min_rate_hz = 200;
+    REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+}
+
+TEST_CASE("bus_planner_plan admits configurations within budget", "[bus_planner][REQ-F9]")
+{
+    bus_planner_sensor_t sensors[]
+        = { make_sensor(BUS_PLANNER_DRIVER_TRANSFER(ADS7138), 1000, 0),
+            make_sensor(BUS_PLANNER_DRIVER_TRANSFER(BMM350), 100, 0) };
+    bus_planner_ctx_t ctx = make_planner(sensors, 2, BUS_PLANNER_POLICY_REJECT);
+    ctx.i2c_speed_hz      = MANIKIN_I2C_SPEED_1MHz;
+
+    REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(sensors[0].read_time_us == 231 + 3 * 50);
+    REQUIRE(sensors[1].read_time_us == 215 + 4 * 50);
+    REQUIRE(sensors[0].planned_rate_hz == 1000);
+    REQUIRE(sensors[1].planned_rate_hz == 100);
+    REQUIRE(ctx.utilisation_permille == 423);
+    REQUIRE(sensors[0].worst_latency_us == 381 + 415);
+}
+
+TEST_CASE("bus_planner_plan handles over-budget configurations", "[bus_planner][REQ-F9]")
+{
+    // ADS7138 at 1 kHz next to BMM350 at 100 Hz does not fit a 400 kHz bus
+    bus_planner_sensor_t sensors[]
+        = { make_sensor(BUS_PLANNER_DRIVER_TRANSFER(ADS7138), 1000, 250),
+            make_sensor(BUS_PLANNER_DRIVER_TRANSFER(BMM350), 100, 0) };
+
+    SECTION("rejected")
+    {
+        bus_planner_ctx_t ctx = make_planner(sensors, 2, BUS_PLANNER_POLICY_REJECT);
+        REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_BUS_OVER_BUDGET);
+        REQUIRE(ctx.utilisation_permille == 802);
+        // NOTE: A BMM350 read in front of an ADS7138 read makes it miss its 1 ms deadline
+        REQUIRE(sensors[0].worst_latency_us == 728 + 738);
+        REQUIRE(sensors[0].planned_rate_hz == 1000);
+    }
+
+    SECTION("downgraded")
+    {
+        bus_planner_ctx_t ctx = make_planner(sensors, 2, BUS_PLANNER_POLICY_DOWNGRADE);
+        REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(sensors[0].planned_rate_hz == 500);
+        REQUIRE(sensors[1].planned_rate_hz == 100);
+        REQUIRE(ctx.utilisation_permille == 438);
+    }
+
+    SECTION("downgrade limited by the minimum rate")
+    {
+        sensors[0].min_rate_hz = 1000;
+        bus_planner_ctx_t ctx  = make_planner(sensors, 2, BUS_PLANNER_POLICY_DOWNGRADE);
+        REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_BUS_OVER_BUDGET);
+    }
+
+    SECTION("downgrade stops at odd rates")
+    {
+        bus_planner_sensor_t slow_bus[]
+            = { make_sensor(BUS_PLANNER_DRIVER_TRANSFER(SDP810), 100, 1) };
+        bus_planner_ctx_t ctx = make_planner(slow_bus, 1, BUS_PLANNER_POLICY_DOWNGRADE);
+        ctx.i2c_speed_hz      = MANIKIN_I2C_SPEED_100KHz;
+        ctx.budget_permille   = 10;
+
+        REQUIRE(bus_planner_plan(&ctx) == MANIKIN_STATUS_ERR_BUS_OVER_BUDGET);
+        REQUIRE(slow_bus[0].planned_rate_hz == 25);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
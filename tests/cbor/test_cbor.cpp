@@ -0,0 +1,311 @@
+/**
+ * @file             test_cbor.cpp
+ * @brief            Test for the CBOR writer/reader and sample schemas
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author: Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "cbor/cbor.h"
+#include "cbor/cbor_schemas.h"
+
+#include <cstddef>
+#include <cstring>
+
+TEST_CASE("cbor_write_uint uses the shortest encoding", "[cbor][REQ-F9]")
+{
+    uint8_t       buf[16];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buf, sizeof(buf));
+
+    REQUIRE(cbor_write_uint(&writer, 10) == MANIKIN_STATUS_OK);
+    REQUIRE(cbor_write_uint(&writer, 42) == MANIKIN_STATUS_OK);
+    REQUIRE(cbor_write_uint(&writer, 1000) == MANIKIN_STATUS_OK);
+    REQUIRE(cbor_write_int(&writer, -500) == MANIKIN_STATUS_OK);
+
+    // RFC 8949 Appendix A examples
+    const uint8_t expected[] = { 0x0A, 0x18, 0x2A, 0x19, 0x03, 0xE8, 0x39, 0x01, 0xF3 };
+    REQUIRE(writer.len == sizeof(expected));
+    REQUIRE(memcmp(buf, expected, sizeof(expected)) == 0);
+}
+
+TEST_CASE("cbor writer reports full buffer", "[cbor][REQ-F9]")
+{
+    uint8_t       buf[4];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buf, sizeof(buf));
+    REQUIRE(cbor_write_float(&writer, 1.0f) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    REQUIRE(cbor_write_uint(&writer, 0x10000) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    REQUIRE(cbor_write_uint(&writer, 0xFFFF) == MANIKIN_STATUS_OK);
+    REQUIRE(writer.len == 3);
+}
+
+TEST_CASE("cbor reader decodes generic items", "[cbor][REQ-F9]")
+{
+    // [1, -1, 1.5 (f16), 100000.0 (f32), 1.1 (f64), h'0102', {"a": [1, 2]}, 7]
+    const uint8_t encoded[]
+        = { 0x88, 0x01, 0x20, 0xF9, 0x3E, 0x00, 0xFA, 0x47, 0xC3, 0x50, 0x00, 0xFB, 0x3F,
+            0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A, 0x42, 0x01, 0x02, 0xA1, 0x61, 0x61,
+            0x82, 0x01, 0x02, 0x07 };
+    cbor_reader_t reader;
+    cbor_reader_init(&reader, encoded, sizeof(encoded));
+
+    size_t   cnt;
+    uint32_t uval;
+    int32_t  ival;
+    float    fval;
+    REQUIRE(cbor_read_array_header(&reader, &cnt) == MANIKIN_STATUS_OK);
+    REQUIRE(cnt == 8);
+    REQUIRE(cbor_read_uint(&reader, &uval) == MANIKIN_STATUS_OK);
+    REQUIRE(uval == 1);
+    REQUIRE(cbor_read_int(&reader, &ival) == MANIKIN_STATUS_OK);
+    REQUIRE(ival == -1);
+    REQUIRE(cbor_read_float(&reader, &fval) == MANIKIN_STATUS_OK);
+    REQUIRE(fval == 1.5f);
+    REQUIRE(cbor_read_float(&reader, &fval) == MANIKIN_STATUS_OK);
+    REQUIRE(fval == 100000.0f);
+    REQUIRE(cbor_read_float(&reader, &fval) == MANIKIN_STATUS_OK);
+    REQUIRE(fval == Catch::Approx(1.1f));
+    REQUIRE(cbor_skip_item(&reader) == MANIKIN_STATUS_OK);
+    REQUIRE(cbor_skip_item(&reader) == MANIKIN_STATUS_OK);
+    REQUIRE(cbor_read_uint(&reader, &uval) == MANIKIN_STATUS_OK);
+    REQUIRE(uval == 7);
+    REQUIRE(reader.offset == sizeof(encoded));
+    REQUIRE(cbor_read_uint(&reader, &uval) == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+TEST_CASE("cbor reader rejects malformed items", "[cbor][REQ-F9]")
+{
+    cbor_reader_t reader;
+    uint32_t      uval;
+    int32_t       ival;
+
+    const uint8_t truncated[] = { 0x19, 0x03 };
+    cbor_reader_init(&reader, truncated, sizeof(truncated));
+    REQUIRE(cbor_read_uint(&reader, &uval) == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+
+    const uint8_t indefinite[] = { 0x9F, 0x01, 0xFF };
+    cbor_reader_init(&reader, indefinite, sizeof(indefinite));
+    REQUIRE(cbor_skip_item(&reader) == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+
+    const uint8_t too_large[] = { 0x1A, 0x80, 0x00, 0x00, 0x00 };
+    cbor_reader_init(&reader, too_large, sizeof(too_large));
+    REQUIRE(cbor_read_int(&reader, &ival) == MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+
+    const uint8_t wrong_type[] = { 0x61, 0x61 };
+    cbor_reader_init(&reader, wrong_type, sizeof(wrong_type));
+    REQUIRE(cbor_read_uint(&reader, &uval) == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+
+    const uint8_t huge_map[] = { 0xBA, 0x00, 0x01, 0x00, 0x00 };
+    cbor_reader_init(&reader, huge_map, sizeof(huge_map));
+    REQUIRE(cbor_skip_item(&reader) == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+TEST_CASE("cbor schema encodes sdp810 sample with fixed layout", "[cbor][REQ-F2]")
+{
+    const sdp810_sample_data_t sample = { .air_pressure_mbar = 1.0f, .air_temp_mbar = -2.0f };
+    uint8_t                    out[CBOR_SDP810_SAMPLE_ENCODED_SIZE];
+    size_t                     out_len = 0;
+    REQUIRE(cbor_encode_sdp810_sample(&sample, out, sizeof(out), &out_len) == MANIKIN_STATUS_OK);
+
+    const uint8_t expected[] = { 0xA2, 0x00, 0xFA, 0x3F, 0x80, 0x00, 0x00,
+                                 0x01, 0xFA, 0xC0, 0x00, 0x00, 0x00 };
+    REQUIRE(out_len == sizeof(expected));
+    REQUIRE(memcmp(out, expected, sizeof(expected)) == 0);
+
+    REQUIRE(cbor_encode_sdp810_sample(&sample, out, sizeof(out) - 1, &out_len)
+            == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    REQUIRE(cbor_encode_sdp810_sample(nullptr, out, sizeof(out), &out_len)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("cbor schemas round-trip all sample structs", "[cbor][REQ-F9]")
+{
+    uint8_t buf[64];
+    size_t  len;
+
+    const ads7138_sample_data_t ads = { 0, 1, 23, 24, 255, 256, 3300, 0xFFFF };
+    ads7138_sample_data_t       ads_out;
+    REQUIRE(cbor_encode_ads7138_sample(&ads, buf, sizeof(buf), &len) == MANIKIN_STATUS_OK);
+    REQUIRE(len == CBOR_ADS7138_SAMPLE_ENCODED_SIZE);
+    REQUIRE(cbor_decode_ads7138_sample(buf, len, &ads_out) == MANIKIN_STATUS_OK);
+    REQUIRE(memcmp(&ads, &ads_out, sizeof(ads)) == 0);
+
+    const bmm350_sample_data_t bmm = { 12.5f, -30.25f, 45.0f, 25123.0f, -123456 };
+    bmm350_sample_data_t       bmm_out;
+    REQUIRE(cbor_encode_bmm350_sample(&bmm, buf, sizeof(buf), &len) == MANIKIN_STATUS_OK);
+    REQUIRE(len == CBOR_BMM350_SAMPLE_ENCODED_SIZE);
+    REQUIRE(cbor_decode_bmm350_sample(buf, len, &bmm_out) == MANIKIN_STATUS_OK);
+    REQUIRE(bmm_out.magneto_x_ut == bmm.magneto_x_ut);
+    REQUIRE(bmm_out.magneto_y_ut == bmm.magneto_y_ut);
+    REQUIRE(bmm_out.magneto_z_ut == bmm.magneto_z_ut);
+    REQUIRE(bmm_out.temperature_mdeg == bmm.temperature_mdeg);
+    REQUIRE(bmm_out.sensor_time_us == bmm.sensor_time_us);
+
+    const bhi360_fusion_sample_data_t bhi = { 1.0f, -90.0f, 180.0f };
+    bhi360_fusion_sample_data_t       bhi_out;
+    REQUIRE(cbor_encode_bhi360_fusion_sample(&bhi, buf, sizeof(buf), &len) == MANIKIN_STATUS_OK);
+    REQUIRE(len == CBOR_BHI360_FUSION_SAMPLE_ENCODED_SIZE);
+    REQUIRE(cbor_decode_bhi360_fusion_sample(buf, len, &bhi_out) == MANIKIN_STATUS_OK);
+    REQUIRE(bhi_out.pitch_deg == bhi.pitch_deg);
+    REQUIRE(bhi_out.roll_deg == bhi.roll_deg);
+    REQUIRE(bhi_out.yaw_deg == bhi.yaw_deg);
+}
+
+TEST_CASE("cbor schema decoder accepts generic encodings", "[cbor][REQ-F2]")
+{
+    // {9: "x", 1: 20 (int), 0: 1.5 (f16)}, as a generic host-side encoder would produce
+    const uint8_t        generic[] = { 0xA3, 0x09, 0x61, 0x78, 0x01, 0x14, 0x00, 0xF9, 0x3E, 0x00 };
+    sdp810_sample_data_t sample;
+    REQUIRE(cbor_decode_sdp810_sample(generic, sizeof(generic), &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.air_pressure_mbar == 1.5f);
+    REQUIRE(sample.air_temp_mbar == 20.0f);
+
+    const uint8_t missing_field[] = { 0xA1, 0x00, 0xF9, 0x3E, 0x00 };
+    REQUIRE(cbor_decode_sdp810_sample(missing_field, sizeof(missing_field), &sample)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+
+    // ch1_mv = 65536 does not fit in uint16_t
+    const uint8_t          overflow[] = { 0xA1, 0x00, 0x1A, 0x00, 0x01, 0x00, 0x00 };
+    ads7138_sample_data_t ads;
+    REQUIRE(cbor_decode_ads7138_sample(overflow, sizeof(overflow), &ads)
+            == MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+}
+
+namespace
+{
+    enum class naive_field_type
+    {
+        U16,
+        I32,
+        F32
+    };
+
+    struct naive_field
+    {
+        uint32_t         key;
+        size_t           offset;
+        naive_field_type type;
+    };
+
+    const naive_field bmm350_fields[] = {
+        { 0, offsetof(bmm350_sample_data_t, magneto_x_ut), naive_field_type::F32 },
+        { 1, offsetof(bmm350_sample_data_t, magneto_y_ut), naive_field_type::F32 },
+        { 2, offsetof(bmm350_sample_data_t, magneto_z_ut), naive_field_type::F32 },
+        { 3, offsetof(bmm350_sample_data_t, temperature_mdeg), naive_field_type::F32 },
+        { 4, offsetof(bmm350_sample_data_t, sensor_time_us), naive_field_type::I32 },
+    };
+
+    /**
+     * Table-driven encoder, representative of the generic code applications hand-roll: a runtime
+     * type switch and a bounds-checked writer call per item.
+     */
+    size_t
+    naive_encode (const void        *sample,
+                  const naive_field *fields,
+                  size_t             field_cnt,
+                  uint8_t           *out,
+                  size_t             out_len)
+    {
+        cbor_writer_t writer;
+        cbor_writer_init(&writer, out, out_len);
+        cbor_write_map_header(&writer, field_cnt);
+        const auto *base = static_cast<const uint8_t *>(sample);
+        for (size_t i = 0; i < field_cnt; i++)
+        {
+            cbor_write_uint(&writer, fields[i].key);
+            switch (fields[i].type)
+            {
+                case naive_field_type::U16: {
+                    uint16_t val;
+                    memcpy(&val, base + fields[i].offset, sizeof(val));
+                    cbor_write_uint(&writer, val);
+                    break;
+                }
+                case naive_field_type::I32: {
+                    int32_t val;
+                    memcpy(&val, base + fields[i].offset, sizeof(val));
+                    cbor_write_int(&writer, val);
+                    break;
+                }
+                case naive_field_type::F32: {
+                    float val;
+                    memcpy(&val, base + fields[i].offset, sizeof(val));
+                    cbor_write_float(&writer, val);
+                    break;
+                }
+            }
+        }
+        return writer.len;
+    }
+} // namespace
+
+TEST_CASE("cbor schema encoder matches naive encoder", "[cbor][REQ-F4]")
+{
+    const bmm350_sample_data_t sample = { 12.5f, -30.25f, 45.0f, 25123.0f, -123456 };
+    uint8_t                    schema_out[64];
+    uint8_t                    naive_out[64];
+    size_t                     schema_len;
+    REQUIRE(cbor_encode_bmm350_sample(&sample, schema_out, sizeof(schema_out), &schema_len)
+            == MANIKIN_STATUS_OK);
+    const size_t naive_len
+        = naive_encode(&sample, bmm350_fields, 5, naive_out, sizeof(naive_out));
+
+    // NOTE: Both pick the same widths here, as the int32 value needs the 4-byte argument anyway
+    REQUIRE(schema_len == naive_len);
+    REQUIRE(memcmp(schema_out, naive_out, schema_len) == 0);
+}
+
+TEST_CASE("cbor schema encoder benchmark", "[.][cbor][benchmark]")
+{
+    bmm350_sample_data_t sample = { 12.5f, -30.25f, 45.0f, 25123.0f, -123456 };
+    uint8_t              out[64];
+
+    BENCHMARK("schema encode bmm350")
+    {
+        size_t len;
+        sample.sensor_time_us++;
+        cbor_encode_bmm350_sample(&sample, out, sizeof(out), &len);
+        return len + out[len - 1];
+    };
+
+    BENCHMARK("naive encode bmm350")
+    {
+        sample.sensor_time_us++;
+        const size_t len = naive_encode(&sample, bmm350_fields, 5, out, sizeof(out));
+        return len + out[len - 1];
+    };
+
+    BENCHMARK("schema decode bmm350")
+    {
+        size_t len;
+        cbor_encode_bmm350_sample(&sample, out, sizeof(out), &len);
+        bmm350_sample_data_t decoded;
+        cbor_decode_bmm350_sample(out, len, &decoded);
+        return decoded.sensor_time_us;
+    };
+}
+
+int
+main (int argc, char *argv[])
+{
+    return Catch::Session().run(argc, argv);
+}
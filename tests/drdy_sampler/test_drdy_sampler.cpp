@@ -0,0 +1,261 @@
+/**
+ * @file             test_drdy_sampler.cpp
+ * @brief           Test for the data-ready interrupt driven sampler
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "drdy_sampler/drdy_sampler.h"
+#include "fake_gpio_functions.h"
+#include "fake_timer_functions.h"
+#include "fake_watchdog_functions.h"
+#include "fake_i2c_functions.h"
+
+#include <vector>
+
+#define RESET_ALL_FAKES()                     \
+    do                                        \
+    {                                         \
+        RESET_FAKE(gpio_hal_irq_enable);      \
+        RESET_FAKE(gpio_hal_irq_disable);     \
+        RESET_FAKE(timer_hal_init);           \
+        RESET_FAKE(watchdog_hal_init);        \
+        RESET_FAKE(watchdog_hal_kick);        \
+        RESET_FAKE(i2c_hal_error_flag_check); \
+        RESET_FAKE(timer_hal_get_tick);       \
+    } while (0)
+
+struct fake_sensor
+{
+    manikin_sensor_ctx_t ctx {};
+    uint8_t              line        = 0;
+    unsigned             reads       = 0;
+    manikin_status_t     read_status = MANIKIN_STATUS_OK;
+};
+
+static manikin_status_t
+fake_sensor_read (void *user)
+{
+    fake_sensor *sensor = static_cast<fake_sensor *>(user);
+    sensor->reads++;
+    return sensor->read_status;
+}
+
+/* Interrupt handlers registered through the GPIO HAL, indexed by line */
+static std::vector<std::pair<manikin_gpio_irq_cb_t, void *>> irq_handlers;
+
+static int
+fake_irq_enable (manikin_gpio_inst_t gpio, manikin_gpio_irq_cb_t cb, void *user)
+{
+    irq_handlers.at(*gpio) = { cb, user };
+    return 0;
+}
+
+static void
+raise_irq (const fake_sensor &sensor)
+{
+    irq_handlers.at(sensor.line).first(irq_handlers.at(sensor.line).second);
+}
+
+struct drdy_fixture
+{
+    std::vector<fake_sensor>          sensors;
+    std::vector<drdy_sampler_entry_t> entries;
+    drdy_sampler_ctx_t                ctx {};
+
+    explicit drdy_fixture (size_t cnt) : sensors(cnt), entries(cnt)
+    {
+        RESET_ALL_FAKES();
+        irq_handlers.assign(cnt, { nullptr, nullptr });
+        gpio_hal_irq_enable_fake.custom_fake = fake_irq_enable;
+        for (size_t i = 0; i < cnt; i++)
+        {
+            sensors[i].ctx.i2c_addr = static_cast<uint8_t>(0x10 + i);
+            sensors[i].line         = static_cast<uint8_t>(i);
+            entries[i].sensor       = &sensors[i].ctx;
+            entries[i].read         = fake_sensor_read;
+            entries[i].user         = &sensors[i];
+            entries[i].gpio         = &sensors[i].line;
+        }
+        ctx.entries   = entries.data();
+        ctx.entry_cnt = static_cast<uint8_t>(cnt);
+    }
+};
+
+TEST_CASE("drdy_sampler_init checks its parameters", "[drdy_sampler]")
+{
+    drdy_fixture fixture(2);
+    REQUIRE(drdy_sampler_init(NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    fixture.ctx.entry_cnt = 0;
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    fixture.ctx.entry_cnt = DRDY_SAMPLER_MAX_ENTRIES + 1;
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    fixture.ctx.entry_cnt   = 2;
+    fixture.entries[1].read = NULL;
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(gpio_hal_irq_enable_fake.call_count == 0);
+    REQUIRE(drdy_sampler_process(NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(drdy_sampler_pending(NULL) == 0);
+}
+
+static std::vector<manikin_gpio_inst_t> disabled_lines;
+
+static int
+fake_irq_enable_third_fails (manikin_gpio_inst_t gpio, manikin_gpio_irq_cb_t cb, void *user)
+{
+    return (gpio_hal_irq_enable_fake.call_count == 3) ? 1 : fake_irq_enable(gpio, cb, user);
+}
+
+static int
+fake_irq_disable (manikin_gpio_inst_t gpio)
+{
+    disabled_lines.push_back(gpio);
+    return 0;
+}
+
+TEST_CASE("drdy_sampler_init rolls back when an interrupt cannot be enabled", "[drdy_sampler]")
+{
+    drdy_fixture fixture(3);
+    disabled_lines.clear();
+    gpio_hal_irq_enable_fake.custom_fake  = fake_irq_enable_third_fails;
+    gpio_hal_irq_disable_fake.custom_fake = fake_irq_disable;
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_PERIPHERAL_INIT_FAIL);
+    REQUIRE(gpio_hal_irq_enable_fake.call_count == 3);
+    REQUIRE(disabled_lines.size() == 2);
+    REQUIRE(disabled_lines[0] == &fixture.sensors[1].line);
+    REQUIRE(disabled_lines[1] == &fixture.sensors[0].line);
+}
+
+TEST_CASE("drdy_sampler only reads sensors with new data", "[drdy_sampler]")
+{
+    drdy_fixture fixture(3);
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(gpio_hal_irq_enable_fake.call_count == 3);
+
+    SECTION("Nothing is read without an interrupt")
+    {
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        for (const fake_sensor &sensor : fixture.sensors)
+        {
+            REQUIRE(sensor.reads == 0);
+        }
+    }
+
+    SECTION("Every interrupt results in exactly one read of that sensor")
+    {
+        raise_irq(fixture.sensors[2]);
+        raise_irq(fixture.sensors[0]);
+        REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0x5u);
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == 1);
+        REQUIRE(fixture.sensors[1].reads == 0);
+        REQUIRE(fixture.sensors[2].reads == 1);
+        REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0);
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == 1);
+        REQUIRE(fixture.ctx.overruns == 0);
+    }
+
+    SECTION("A second interrupt before the read counts as overrun")
+    {
+        raise_irq(fixture.sensors[1]);
+        raise_irq(fixture.sensors[1]);
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[1].reads == 1);
+        REQUIRE(fixture.ctx.overruns == 1);
+    }
+
+    SECTION("A failed read stays pending")
+    {
+        fixture.sensors[1].read_status = MANIKIN_STATUS_ERR_READ_FAIL;
+        raise_irq(fixture.sensors[0]);
+        raise_irq(fixture.sensors[1]);
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_ERR_READ_FAIL);
+        REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0x2u);
+        fixture.sensors[1].read_status = MANIKIN_STATUS_OK;
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == 1);
+        REQUIRE(fixture.sensors[1].reads == 2);
+        REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0);
+    }
+
+    SECTION("Deinit disables the interrupts and drops pending reads")
+    {
+        raise_irq(fixture.sensors[0]);
+        REQUIRE(drdy_sampler_deinit(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(gpio_hal_irq_disable_fake.call_count == 3);
+        REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == 0);
+    }
+}
+
+static size_t fake_now;
+
+static size_t
+fake_get_tick ()
+{
+    return fake_now;
+}
+
+TEST_CASE("drdy_sampler isolates faults through the sample_timer hooks", "[drdy_sampler]")
+{
+    drdy_fixture       fixture(2);
+    uint8_t            timer_handle    = 0;
+    uint8_t            watchdog_handle = 0;
+    sample_timer_ctx_t timer {};
+    timer.timer                         = &timer_handle;
+    timer.watchdog                      = &watchdog_handle;
+    timer.frequency                     = 100;
+    fixture.ctx.timer                   = &timer;
+    fake_now                            = 100;
+    timer_hal_get_tick_fake.custom_fake = fake_get_tick;
+    REQUIRE(sample_timer_init(&timer) == MANIKIN_STATUS_OK);
+    REQUIRE(drdy_sampler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+
+    // Device fault: the bus itself is fine, so only this sensor backs off
+    fixture.sensors[0].read_status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    raise_irq(fixture.sensors[0]);
+    raise_irq(fixture.sensors[1]);
+    REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+    REQUIRE(fixture.sensors[0].ctx.needs_reinit == 1);
+    fixture.sensors[0].read_status = MANIKIN_STATUS_OK;
+
+    // While backing off the sensor is skipped without bus traffic, the other one keeps sampling
+    raise_irq(fixture.sensors[1]);
+    REQUIRE(drdy_sampler_process(&fixture.ctx) != MANIKIN_STATUS_OK);
+    REQUIRE(fixture.sensors[0].reads == 1);
+    REQUIRE(fixture.sensors[1].reads == 2);
+    REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0x1u);
+
+    fake_now += 1000;
+    REQUIRE(drdy_sampler_process(&fixture.ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(fixture.sensors[0].reads == 2);
+    REQUIRE(drdy_sampler_pending(&fixture.ctx) == 0);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
@@ -229,6 +229,37 @@ TEST_CASE("manikin_i2c_read_reg16 returns correct value from I2C", "[read_reg16]
     REQUIRE(val[1] == 0xFE);
 }
 
+TEST_CASE("manikin_i2c_read_regs reads consecutive registers in one burst", "[read_regs][REQ-F9]")
+{
+    reset_mocks();
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+
+    read_buffer[0] = 0x01;
+    read_buffer[1] = 0x02;
+    read_buffer[2] = 0x03;
+
+    uint8_t        handle = 1;
+    const uint16_t reg    = 0x004D;
+    uint8_t        val[3] = { 0 };
+    REQUIRE(manikin_i2c_read_regs(&handle, 0x29, reg, val, sizeof(val)) == MANIKIN_STATUS_OK);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 1);
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 1);
+    REQUIRE(i2c_hal_read_bytes_fake.arg3_val == 3);
+    REQUIRE(write_buffer[0] == GET_UPPER_8_BITS_OF_SHORT(reg));
+    REQUIRE(write_buffer[1] == GET_LOWER_8_BITS_OF_SHORT(reg));
+    REQUIRE(val[0] == 0x01);
+    REQUIRE(val[2] == 0x03);
+
+    // A short read is a failure
+    i2c_hal_read_bytes_fake.custom_fake = NULL;
+    i2c_hal_read_bytes_fake.return_val  = 2;
+    REQUIRE(manikin_i2c_read_regs(&handle, 0x29, reg, val, sizeof(val))
+            == MANIKIN_STATUS_ERR_READ_FAIL);
+    REQUIRE(manikin_i2c_read_regs(NULL, 0x29, reg, val, sizeof(val))
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -0,0 +1,192 @@
+/**
+ * @file             test_log_decoder.cpp
+ * @brief            Test for the host-side session capture decoder
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author: Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include "log_decoder.hpp"
+#include "packet_batch/packet_batch.h"
+#include "packet_parser/packet_parser.h"
+
+#include <vector>
+
+static std::vector<uint8_t>
+encapsulate (const uint8_t *payload, uint16_t len)
+{
+    std::vector<uint8_t>      frame(len + 6u);
+    const packet_parser_cmd_t cmd = { len, payload };
+    REQUIRE(packet_parser_encapsulate(&cmd, frame.data(), frame.size()) == MANIKIN_STATUS_OK);
+    return frame;
+}
+
+static void
+require_same_frames (const log_decoder::scan_result &a, const log_decoder::scan_result &b)
+{
+    REQUIRE(a.frames.size() == b.frames.size());
+    for (size_t i = 0; i < a.frames.size(); i++)
+    {
+        REQUIRE(a.frames[i].offset == b.frames[i].offset);
+        REQUIRE(a.frames[i].payload_len == b.frames[i].payload_len);
+    }
+}
+
+TEST_CASE("log_decoder crc16 matches the packet_parser CRC", "[log_decoder][REQ-F9]")
+{
+    for (uint16_t len : { 1, 7, 8, 9, 16, 255 })
+    {
+        std::vector<uint8_t> payload(len);
+        for (uint16_t i = 0; i < len; i++)
+        {
+            payload[i] = static_cast<uint8_t>(i * 37u + len);
+        }
+        const std::vector<uint8_t> frame = encapsulate(payload.data(), len);
+        const uint16_t expected = static_cast<uint16_t>(frame[3u + len] | (frame[4u + len] << 8));
+        REQUIRE(log_decoder::crc16(payload.data(), len) == expected);
+        REQUIRE(log_decoder::check_frame(frame.data(), frame.size(), 0) == len);
+    }
+}
+
+TEST_CASE("log_decoder check_frame classifies invalid frames", "[log_decoder][REQ-F9]")
+{
+    const uint8_t        payload[] = { 0x10, 0x20, 0x30 };
+    std::vector<uint8_t> frame     = encapsulate(payload, sizeof(payload));
+
+    // Truncated frame
+    REQUIRE(log_decoder::check_frame(frame.data(), frame.size() - 1, 0) == -1);
+
+    // Missing end byte
+    frame.back() = 0x00;
+    REQUIRE(log_decoder::check_frame(frame.data(), frame.size(), 0) == -1);
+
+    // Corrupted payload
+    frame        = encapsulate(payload, sizeof(payload));
+    frame[4]     ^= 0x01;
+    REQUIRE(log_decoder::check_frame(frame.data(), frame.size(), 0) == -2);
+}
+
+TEST_CASE("log_decoder parallel scan equals the sequential scan", "[log_decoder][REQ-F9]")
+{
+    const std::vector<uint8_t>     capture   = log_decoder::synthesize_capture(64 * 1024, 7, 42);
+    const log_decoder::scan_result reference = log_decoder::scan_frames_sequential(capture.data(),
+                                                                                   capture.size());
+    REQUIRE(reference.frames.size() > 100);
+    REQUIRE(reference.crc_rejects > 0);
+
+    // NOTE: Small chunks put many frames across chunk boundaries
+    const size_t   chunk_size = GENERATE(1u, 13u, 100u, 4096u, 0u);
+    const unsigned thread_cnt = GENERATE(1u, 4u);
+    const log_decoder::scan_result scan
+        = log_decoder::scan_frames(capture.data(), capture.size(), thread_cnt, chunk_size);
+    require_same_frames(scan, reference);
+}
+
+TEST_CASE("log_decoder parallel scan resyncs like the sequential scan", "[log_decoder][REQ-F9]")
+{
+    // A valid frame hidden inside a larger frame, the outer frame wins when it is valid
+    const uint8_t              inner_payload[] = { 0xAB, 0xCD };
+    const std::vector<uint8_t> inner           = encapsulate(inner_payload, sizeof(inner_payload));
+    std::vector<uint8_t>       outer_payload(40, 0x55);
+    std::copy(inner.begin(), inner.end(), outer_payload.begin() + 10);
+
+    std::vector<uint8_t> capture = { 0x01, 0x01, 0x3A };
+    std::vector<uint8_t> outer   = encapsulate(outer_payload.data(), 40);
+    capture.insert(capture.end(), outer.begin(), outer.end());
+    outer[30] ^= 0xFF;
+    capture.insert(capture.end(), outer.begin(), outer.end());
+    capture.insert(capture.end(), inner.begin(), inner.end());
+
+    const log_decoder::scan_result reference = log_decoder::scan_frames_sequential(capture.data(),
+                                                                                   capture.size());
+    REQUIRE(reference.frames.size() == 3);
+    REQUIRE(reference.frames[0].payload_len == 40);
+    REQUIRE(reference.frames[1].payload_len == 2);
+    REQUIRE(reference.frames[2].payload_len == 2);
+    REQUIRE(reference.crc_rejects == 1);
+
+    for (size_t chunk_size = 1; chunk_size < capture.size(); chunk_size++)
+    {
+        require_same_frames(log_decoder::scan_frames(capture.data(), capture.size(), 3, chunk_size),
+                            reference);
+    }
+}
+
+TEST_CASE("log_decoder decodes batches into per-sensor columns", "[log_decoder][REQ-F9]")
+{
+    uint8_t              buf[PACKET_PARSER_MAX_PAYLOAD_LEN];
+    packet_batch_ctx_t   batch = {};
+    packet_parser_cmd_t  cmd   = {};
+    std::vector<uint8_t> capture;
+
+    batch.buf         = buf;
+    batch.buf_size    = sizeof(buf);
+    batch.max_samples = 4;
+    REQUIRE(packet_batch_init(&batch) == MANIKIN_STATUS_OK);
+
+    // 3 batches of 4 samples, sensor 1 has 2-byte samples and sensor 2 has 3-byte samples
+    for (uint32_t tick = 0; tick < 12; tick++)
+    {
+        const uint8_t sample[3] = { static_cast<uint8_t>(tick), 0xEE, 0xFF };
+        const uint8_t sensor_id = static_cast<uint8_t>(1u + tick % 2u);
+        REQUIRE(packet_batch_add(&batch, sensor_id, 100u + tick, sample, 1u + sensor_id)
+                == MANIKIN_STATUS_OK);
+        if (packet_batch_flush_needed(&batch, 100u + tick))
+        {
+            REQUIRE(packet_batch_flush(&batch, &cmd) == MANIKIN_STATUS_OK);
+            const std::vector<uint8_t> frame = encapsulate(cmd.data, cmd.len);
+            capture.insert(capture.end(), frame.begin(), frame.end());
+        }
+    }
+    // A valid frame that is not a sample batch
+    const uint8_t              junk[] = { 0x09, 0x00 };
+    const std::vector<uint8_t> frame  = encapsulate(junk, sizeof(junk));
+    capture.insert(capture.end(), frame.begin(), frame.end());
+
+    const unsigned                   thread_cnt = GENERATE(1u, 2u, 8u);
+    const log_decoder::scan_result   scan = log_decoder::scan_frames(capture.data(), capture.size(),
+                                                                     thread_cnt);
+    const log_decoder::decode_result decoded
+        = log_decoder::decode_batches(capture.data(), scan.frames, thread_cnt);
+
+    REQUIRE(scan.frames.size() == 4);
+    REQUIRE(decoded.undecodable_frames == 1);
+    REQUIRE(decoded.length_mismatches == 0);
+    REQUIRE(decoded.sensors.size() == 2);
+    for (uint8_t sensor_id : { 1, 2 })
+    {
+        const log_decoder::sensor_columns &columns = decoded.sensors.at(sensor_id);
+        REQUIRE(columns.sample_len == 1u + sensor_id);
+        REQUIRE(columns.count() == 6);
+        REQUIRE(columns.samples.size() == 6u * columns.sample_len);
+        for (size_t i = 0; i < columns.count(); i++)
+        {
+            const uint32_t tick = static_cast<uint32_t>(i * 2u + sensor_id - 1u);
+            REQUIRE(columns.ticks[i] == 100u + tick);
+            REQUIRE(columns.samples[i * columns.sample_len] == tick);
+        }
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    return Catch::Session().run(argc, argv);
+}
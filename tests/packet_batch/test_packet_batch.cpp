@@ -0,0 +1,230 @@
+/**
+ * @file             test_packet_batch.cpp
+ * @brief            Test for multi-sample batch frame module
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author: Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include "packet_batch/packet_batch.h"
+#include "packet_parser/packet_parser.h"
+
+#include <cstring>
+
+static constexpr uint8_t ads7138_sample[16] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                                                0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10 };
+static constexpr uint8_t sdp810_sample[9]   = { 0xAA, 0xBB, 0x00, 0xCC, 0xDD, 0x00, 0x00, 0x3C, 0x00 };
+
+static packet_batch_ctx_t
+make_batch_ctx (uint8_t *buf, size_t buf_size, uint8_t max_samples, uint32_t max_latency)
+{
+    packet_batch_ctx_t ctx = {};
+    ctx.buf                = buf;
+    ctx.buf_size           = buf_size;
+    ctx.max_samples        = max_samples;
+    ctx.max_latency_ticks  = max_latency;
+    return ctx;
+}
+
+TEST_CASE("packet_batch_init rejects invalid settings", "[packet_batch][REQ-F9]")
+{
+    uint8_t buf[PACKET_PARSER_MAX_PAYLOAD_LEN + 1];
+    REQUIRE(packet_batch_init(nullptr) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    packet_batch_ctx_t ctx = make_batch_ctx(nullptr, sizeof(buf), 4, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    ctx = make_batch_ctx(buf, sizeof(buf), 4, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    ctx = make_batch_ctx(buf, PACKET_BATCH_HEADER_SIZE, 4, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    ctx = make_batch_ctx(buf, 64, 0, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    ctx           = make_batch_ctx(buf, 64, 4, 0);
+    ctx.flush_len = 65;
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+}
+
+TEST_CASE("packet_batch round-trips samples from multiple sensors", "[packet_batch][REQ-F9]")
+{
+    uint8_t            buf[PACKET_PARSER_MAX_PAYLOAD_LEN];
+    packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 8, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+
+    REQUIRE(packet_batch_add(&ctx, 1, 1000, ads7138_sample, sizeof(ads7138_sample))
+            == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_add(&ctx, 2, 1001, sdp810_sample, sizeof(sdp810_sample))
+            == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_add(&ctx, 1, 1003, ads7138_sample, sizeof(ads7138_sample))
+            == MANIKIN_STATUS_OK);
+
+    packet_parser_cmd_t batch;
+    REQUIRE(packet_batch_flush(&ctx, &batch) == MANIKIN_STATUS_OK);
+    REQUIRE(batch.len
+            == PACKET_BATCH_HEADER_SIZE + 3 * PACKET_BATCH_RECORD_HEADER_SIZE
+                   + 2 * sizeof(ads7138_sample) + sizeof(sdp810_sample));
+
+    // Batch must survive the packet encapsulation round-trip
+    uint8_t frame[PACKET_PARSER_MAX_PAYLOAD_LEN + 6];
+    REQUIRE(packet_parser_encapsulate(&batch, frame, sizeof(frame)) == MANIKIN_STATUS_OK);
+    packet_parser_cmd_t received;
+    REQUIRE(packet_parser_parse(frame, batch.len + 6u, &received) == MANIKIN_STATUS_OK);
+
+    packet_batch_reader_t reader;
+    packet_batch_sample_t sample;
+    REQUIRE(packet_batch_reader_init(&reader, &received) == MANIKIN_STATUS_OK);
+    REQUIRE(reader.remaining == 3);
+
+    REQUIRE(packet_batch_reader_next(&reader, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.sensor_id == 1);
+    REQUIRE(sample.tick == 1000);
+    REQUIRE(sample.len == sizeof(ads7138_sample));
+    REQUIRE(memcmp(sample.data, ads7138_sample, sample.len) == 0);
+
+    REQUIRE(packet_batch_reader_next(&reader, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.sensor_id == 2);
+    REQUIRE(sample.tick == 1001);
+    REQUIRE(sample.len == sizeof(sdp810_sample));
+    REQUIRE(memcmp(sample.data, sdp810_sample, sample.len) == 0);
+
+    REQUIRE(packet_batch_reader_next(&reader, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.sensor_id == 1);
+    REQUIRE(sample.tick == 1003);
+
+    REQUIRE(packet_batch_reader_next(&reader, &sample) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+}
+
+TEST_CASE("packet_batch flushes on count, size and latency thresholds", "[packet_batch][REQ-F9]")
+{
+    uint8_t buf[PACKET_PARSER_MAX_PAYLOAD_LEN];
+
+    SECTION("Count threshold")
+    {
+        packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 2, 0);
+        REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 0) == 0);
+        REQUIRE(packet_batch_add(&ctx, 1, 0, sdp810_sample, sizeof(sdp810_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 0) == 0);
+        REQUIRE(packet_batch_add(&ctx, 1, 1, sdp810_sample, sizeof(sdp810_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 1) == 1);
+        REQUIRE(packet_batch_add(&ctx, 1, 2, sdp810_sample, sizeof(sdp810_sample))
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    }
+
+    SECTION("Size threshold")
+    {
+        packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 255, 0);
+        ctx.flush_len          = 60;
+        REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_add(&ctx, 1, 0, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_add(&ctx, 1, 1, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 1) == 0);
+        REQUIRE(packet_batch_add(&ctx, 1, 2, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 2) == 1);
+    }
+
+    SECTION("Buffer full")
+    {
+        packet_batch_ctx_t ctx = make_batch_ctx(buf, 40, 255, 0);
+        REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_add(&ctx, 1, 0, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_add(&ctx, 1, 1, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+        packet_parser_cmd_t batch;
+        REQUIRE(packet_batch_flush(&ctx, &batch) == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_add(&ctx, 1, 1, ads7138_sample, sizeof(ads7138_sample))
+                == MANIKIN_STATUS_OK);
+    }
+
+    SECTION("Latency threshold")
+    {
+        packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 255, 5);
+        REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 100) == 0);
+        REQUIRE(packet_batch_add(&ctx, 1, 0xFFFFFFFEu, sdp810_sample, sizeof(sdp810_sample))
+                == MANIKIN_STATUS_OK);
+        REQUIRE(packet_batch_flush_needed(&ctx, 1) == 0);
+        // NOTE: Latency must be computed correctly across the tick wrap-around
+        REQUIRE(packet_batch_flush_needed(&ctx, 3) == 1);
+    }
+}
+
+TEST_CASE("packet_batch rejects too large tick deltas", "[packet_batch][REQ-F9]")
+{
+    uint8_t            buf[64];
+    packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 8, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_add(&ctx, 1, 0, sdp810_sample, sizeof(sdp810_sample))
+            == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_add(&ctx, 1, 0x10000u, sdp810_sample, sizeof(sdp810_sample))
+            == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+}
+
+TEST_CASE("packet_batch_flush fails on empty batch and nulls", "[packet_batch][REQ-F9]")
+{
+    uint8_t            buf[64];
+    packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 8, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+
+    packet_parser_cmd_t batch;
+    REQUIRE(packet_batch_flush(&ctx, &batch) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    REQUIRE(packet_batch_flush(nullptr, &batch) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(packet_batch_flush(&ctx, nullptr) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(packet_batch_add(&ctx, 1, 0, nullptr, 1) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("packet_batch_reader detects truncated batches", "[packet_batch][REQ-F9]")
+{
+    uint8_t            buf[64];
+    packet_batch_ctx_t ctx = make_batch_ctx(buf, sizeof(buf), 8, 0);
+    REQUIRE(packet_batch_init(&ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_add(&ctx, 1, 0, ads7138_sample, sizeof(ads7138_sample))
+            == MANIKIN_STATUS_OK);
+
+    packet_parser_cmd_t batch;
+    REQUIRE(packet_batch_flush(&ctx, &batch) == MANIKIN_STATUS_OK);
+    batch.len -= 1;
+
+    packet_batch_reader_t reader;
+    packet_batch_sample_t sample;
+    REQUIRE(packet_batch_reader_init(&reader, &batch) == MANIKIN_STATUS_OK);
+    REQUIRE(packet_batch_reader_next(&reader, &sample)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+
+    batch.len = PACKET_BATCH_HEADER_SIZE - 1;
+    REQUIRE(packet_batch_reader_init(&reader, &batch)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+int
+main (int argc, char *argv[])
+{
+    return Catch::Session().run(argc, argv);
+}
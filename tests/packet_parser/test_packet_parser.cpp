@@ -26,6 +26,11 @@
 #include "packet_parser/packet_parser.h"
 #include "common/manikin_bit_manipulation.h"
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
 // Fake CBOR message: {1: 42} = A1 01 18 2A
 static constexpr uint8_t test_cbor_data[] = { 0xA1, 0x01, 0x18, 0x2A }; // CBOR map
 static constexpr size_t  test_cbor_len    = sizeof(test_cbor_data);
@@ -137,6 +142,220 @@ TEST_CASE("packet_parser_encapsulate fails on nulls", "[packet_parser][REQ-F1]")
             == MANIKIN_STATUS_ERR_NULL_PARAM);
 }
 
+TEST_CASE("packet_parser_encapsulate_segments matches packet_parser_encapsulate",
+          "[packet_parser][REQ-F1]")
+{
+    packet_parser_cmd_t cmd
+        = { .len = static_cast<uint16_t>(test_cbor_len), .data = test_cbor_data };
+
+    uint8_t                 header[PACKET_PARSER_HEADER_SIZE]   = { 0 };
+    uint8_t                 trailer[PACKET_PARSER_TRAILER_SIZE] = { 0 };
+    packet_parser_segment_t segments[PACKET_PARSER_SEGMENT_CNT];
+    REQUIRE(packet_parser_encapsulate_segments(&cmd, header, trailer, segments)
+            == MANIKIN_STATUS_OK);
+
+    // Payload must be referenced, not copied
+    REQUIRE(segments[1].data == test_cbor_data);
+    REQUIRE(segments[1].len == test_cbor_len);
+    REQUIRE(segments[0].data == header);
+    REQUIRE(segments[2].data == trailer);
+
+    uint8_t gathered[64] = { 0 };
+    size_t  gathered_len = 0;
+    for (const auto &segment : segments)
+    {
+        memcpy(&gathered[gathered_len], segment.data, segment.len);
+        gathered_len += segment.len;
+    }
+
+    uint8_t expected[64] = { 0 };
+    REQUIRE(packet_parser_encapsulate(&cmd, expected, sizeof(expected)) == MANIKIN_STATUS_OK);
+    REQUIRE(gathered_len == test_cbor_len + 6);
+    REQUIRE(memcmp(gathered, expected, gathered_len) == 0);
+
+    packet_parser_cmd_t parsed_cmd;
+    REQUIRE(packet_parser_parse(gathered, gathered_len, &parsed_cmd) == MANIKIN_STATUS_OK);
+    REQUIRE(parsed_cmd.len == test_cbor_len);
+}
+
+TEST_CASE("packet_parser_encapsulate_segments fails on invalid params", "[packet_parser][REQ-F1]")
+{
+    uint8_t                 header[PACKET_PARSER_HEADER_SIZE];
+    uint8_t                 trailer[PACKET_PARSER_TRAILER_SIZE];
+    packet_parser_segment_t segments[PACKET_PARSER_SEGMENT_CNT];
+
+    packet_parser_cmd_t valid_cmd = { .len = 4, .data = test_cbor_data };
+    REQUIRE(packet_parser_encapsulate_segments(nullptr, header, trailer, segments)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(packet_parser_encapsulate_segments(&valid_cmd, nullptr, trailer, segments)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(packet_parser_encapsulate_segments(&valid_cmd, header, nullptr, segments)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(packet_parser_encapsulate_segments(&valid_cmd, header, trailer, nullptr)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    static const uint8_t big_payload[PACKET_PARSER_MAX_PAYLOAD_LEN + 1] = { 0 };
+    packet_parser_cmd_t  too_long_cmd = { .len = sizeof(big_payload), .data = big_payload };
+    REQUIRE(packet_parser_encapsulate_segments(&too_long_cmd, header, trailer, segments)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+TEST_CASE("packet_parser_cobs_encode matches reference vectors", "[packet_parser][REQ-F1]")
+{
+    struct cobs_vector
+    {
+        std::vector<uint8_t> decoded;
+        std::vector<uint8_t> encoded;
+    };
+
+    std::vector<uint8_t> seq_01_fe(254);
+    std::iota(seq_01_fe.begin(), seq_01_fe.end(), 0x01);
+    std::vector<uint8_t> seq_00_fe(255);
+    std::iota(seq_00_fe.begin(), seq_00_fe.end(), 0x00);
+    std::vector<uint8_t> seq_01_ff(255);
+    std::iota(seq_01_ff.begin(), seq_01_ff.end(), 0x01);
+
+    std::vector<uint8_t> enc_01_fe = { 0xFF };
+    enc_01_fe.insert(enc_01_fe.end(), seq_01_fe.begin(), seq_01_fe.end());
+    std::vector<uint8_t> enc_00_fe = { 0x01, 0xFF };
+    enc_00_fe.insert(enc_00_fe.end(), seq_01_fe.begin(), seq_01_fe.end());
+    std::vector<uint8_t> enc_01_ff = enc_01_fe;
+    enc_01_ff.insert(enc_01_ff.end(), { 0x02, 0xFF });
+
+    // Examples from the original COBS paper / RFC draft
+    const std::vector<cobs_vector> vectors = {
+        { {}, { 0x01 } },
+        { { 0x00 }, { 0x01, 0x01 } },
+        { { 0x00, 0x00 }, { 0x01, 0x01, 0x01 } },
+        { { 0x00, 0x11, 0x00 }, { 0x01, 0x02, 0x11, 0x01 } },
+        { { 0x11, 0x22, 0x00, 0x33 }, { 0x03, 0x11, 0x22, 0x02, 0x33 } },
+        { { 0x11, 0x22, 0x33, 0x44 }, { 0x05, 0x11, 0x22, 0x33, 0x44 } },
+        { { 0x11, 0x00, 0x00, 0x00 }, { 0x02, 0x11, 0x01, 0x01, 0x01 } },
+        { seq_01_fe, enc_01_fe },
+        { seq_00_fe, enc_00_fe },
+        { seq_01_ff, enc_01_ff },
+    };
+
+    for (const auto &vector : vectors)
+    {
+        std::vector<uint8_t> buf = vector.decoded;
+        buf.resize(PACKET_PARSER_COBS_MAX_ENCODED_LEN(vector.decoded.size()));
+        size_t encoded_len = 0;
+        REQUIRE(
+            packet_parser_cobs_encode(buf.data(), vector.decoded.size(), buf.size(), &encoded_len)
+            == MANIKIN_STATUS_OK);
+        buf.resize(encoded_len);
+        REQUIRE(buf == vector.encoded);
+
+        size_t decoded_len = 0;
+        REQUIRE(packet_parser_cobs_decode(buf.data(), buf.size(), &decoded_len)
+                == MANIKIN_STATUS_OK);
+        buf.resize(decoded_len);
+        REQUIRE(buf == vector.decoded);
+    }
+}
+
+TEST_CASE("packet_parser_cobs rejects invalid input", "[packet_parser][REQ-F1]")
+{
+    uint8_t data[4] = { 0x11, 0x22, 0x33, 0x44 };
+    size_t  len;
+    REQUIRE(packet_parser_cobs_encode(data, sizeof(data), sizeof(data), &len)
+            == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    REQUIRE(packet_parser_cobs_encode(nullptr, sizeof(data), sizeof(data), &len)
+            == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    uint8_t with_zero[] = { 0x03, 0x11, 0x00 };
+    REQUIRE(packet_parser_cobs_decode(with_zero, sizeof(with_zero), &len)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+    uint8_t truncated[] = { 0x05, 0x11, 0x22 };
+    REQUIRE(packet_parser_cobs_decode(truncated, sizeof(truncated), &len)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+TEST_CASE("packet_parser_link round-trips both framing modes", "[packet_parser][REQ-F1]")
+{
+    const packet_parser_framing_t framing
+        = GENERATE(PACKET_PARSER_FRAMING_LEGACY, PACKET_PARSER_FRAMING_COBS);
+    packet_parser_link_t link;
+    REQUIRE(packet_parser_link_init(&link, framing) == MANIKIN_STATUS_OK);
+
+    // NOTE: Payload full of the legacy framing bytes and zeros
+    uint8_t payload[PACKET_PARSER_MAX_PAYLOAD_LEN];
+    for (size_t i = 0; i < sizeof(payload); i++)
+    {
+        const uint8_t pattern[] = { 0x00, 0x01, 0x3A, 0x17, 0xFF };
+        payload[i]              = pattern[i % sizeof(pattern)];
+    }
+    const packet_parser_cmd_t cmd = { .len = sizeof(payload), .data = payload };
+
+    uint8_t frame[PACKET_PARSER_LINK_MAX_FRAME_LEN(PACKET_PARSER_MAX_PAYLOAD_LEN)];
+    size_t  frame_len = 0;
+    REQUIRE(packet_parser_link_encapsulate(&link, &cmd, frame, sizeof(frame), &frame_len)
+            == MANIKIN_STATUS_OK);
+    if (framing == PACKET_PARSER_FRAMING_COBS)
+    {
+        // Only the delimiter may be zero
+        REQUIRE(std::count(frame, frame + frame_len, 0x00) == 1);
+        REQUIRE(frame[frame_len - 1] == 0x00);
+        REQUIRE(frame_len <= PACKET_PARSER_COBS_MAX_FRAME_LEN(sizeof(payload)));
+    }
+    else
+    {
+        REQUIRE(frame_len == sizeof(payload) + 6);
+    }
+
+    packet_parser_cmd_t parsed;
+    REQUIRE(packet_parser_link_parse(&link, frame, frame_len, &parsed) == MANIKIN_STATUS_OK);
+    REQUIRE(parsed.len == sizeof(payload));
+    REQUIRE(memcmp(parsed.data, payload, sizeof(payload)) == 0);
+
+    REQUIRE(packet_parser_link_encapsulate(&link, &cmd, frame, 10, &frame_len)
+            == MANIKIN_STATUS_ERR_INVALID_PACKET_MALFORMED);
+}
+
+TEST_CASE("packet_parser_link COBS framing resyncs at the next delimiter",
+          "[packet_parser][REQ-F1]")
+{
+    packet_parser_link_t link;
+    REQUIRE(packet_parser_link_init(&link, PACKET_PARSER_FRAMING_COBS) == MANIKIN_STATUS_OK);
+
+    std::vector<uint8_t> stream;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        const uint8_t             payload[] = { i, 0x00, 0x17, 0x01, 0x3A, i };
+        const packet_parser_cmd_t cmd       = { .len = sizeof(payload), .data = payload };
+        uint8_t                   frame[PACKET_PARSER_COBS_MAX_FRAME_LEN(sizeof(payload))];
+        size_t                    frame_len;
+        REQUIRE(packet_parser_link_encapsulate(&link, &cmd, frame, sizeof(frame), &frame_len)
+                == MANIKIN_STATUS_OK);
+        stream.insert(stream.end(), frame, frame + frame_len);
+    }
+    // Corrupt the first code byte of the first frame
+    stream[0] ^= 0x04;
+
+    std::vector<manikin_status_t> results;
+    std::vector<uint8_t>          first_bytes;
+    auto                          frame_start = stream.begin();
+    for (auto it = stream.begin(); it != stream.end(); ++it)
+    {
+        if (*it == PACKET_PARSER_COBS_DELIMITER)
+        {
+            std::vector<uint8_t> frame(frame_start, it);
+            packet_parser_cmd_t  cmd;
+            results.push_back(packet_parser_link_parse(&link, frame.data(), frame.size(), &cmd));
+            first_bytes.push_back(results.back() == MANIKIN_STATUS_OK ? cmd.data[0] : 0xFF);
+            frame_start = it + 1;
+        }
+    }
+
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0] != MANIKIN_STATUS_OK);
+    REQUIRE(results[1] == MANIKIN_STATUS_OK);
+    REQUIRE(results[2] == MANIKIN_STATUS_OK);
+    REQUIRE(first_bytes[1] == 1);
+    REQUIRE(first_bytes[2] == 2);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -0,0 +1,263 @@
+/**
+ * @file             test_reliable_link.cpp
+ * @brief            Loopback test for the sliding-window reliable link layer
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author: Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include "reliable_link/reliable_link.h"
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    constexpr uint8_t  link_window    = 8;
+    constexpr size_t   link_slot_size = 130;
+    constexpr uint32_t link_rto_ticks = 20;
+
+    using frame_t = std::vector<uint8_t>;
+
+    /**
+     * One direction of the simulated wire. Frames are queued with a fixed latency and may get a
+     * flipped bit to emulate corruption, a deterministic LCG keeps the runs reproducible.
+     */
+    struct lossy_wire
+    {
+        std::deque<std::pair<uint32_t, frame_t>> frames;
+        uint32_t                                 corrupt_permille = 0;
+        uint32_t                                 rng_state        = 12345;
+        uint32_t                                 latency_ticks    = 2;
+        uint32_t                                 now_tick         = 0;
+        size_t                                   wire_bytes       = 0;
+
+        uint32_t
+        next_random ()
+        {
+            rng_state = rng_state * 1103515245u + 12345u;
+            return (rng_state >> 16) & 0x7FFFu;
+        }
+    };
+
+    struct endpoint
+    {
+        reliable_link_ctx_t  link{};
+        uint8_t              tx_storage[link_window * link_slot_size];
+        reliable_link_slot_t tx_slots[link_window];
+        uint8_t              rx_storage[link_window * link_slot_size];
+        reliable_link_slot_t rx_slots[link_window];
+        lossy_wire          *out_wire = nullptr;
+        std::vector<frame_t> received;
+    };
+
+    manikin_status_t
+    wire_tx (void *user_ctx, const packet_parser_segment_t *segments, size_t segment_cnt)
+    {
+        auto   *ep = static_cast<endpoint *>(user_ctx);
+        frame_t frame;
+        for (size_t i = 0; i < segment_cnt; i++)
+        {
+            frame.insert(frame.end(), segments[i].data, segments[i].data + segments[i].len);
+        }
+        lossy_wire *wire = ep->out_wire;
+        wire->wire_bytes += frame.size();
+        if (wire->next_random() % 1000u < wire->corrupt_permille)
+        {
+            frame[wire->next_random() % frame.size()] ^= 0x10;
+        }
+        wire->frames.emplace_back(wire->now_tick + wire->latency_ticks, std::move(frame));
+        return MANIKIN_STATUS_OK;
+    }
+
+    void
+    wire_rx (void *user_ctx, const uint8_t *data, size_t len)
+    {
+        auto *ep = static_cast<endpoint *>(user_ctx);
+        ep->received.emplace_back(data, data + len);
+    }
+
+    void
+    setup_endpoint (endpoint &ep, lossy_wire &out_wire)
+    {
+        ep.link.tx_storage = ep.tx_storage;
+        ep.link.tx_slots   = ep.tx_slots;
+        ep.link.rx_storage = ep.rx_storage;
+        ep.link.rx_slots   = ep.rx_slots;
+        ep.link.slot_size  = link_slot_size;
+        ep.link.window     = link_window;
+        ep.link.rto_ticks  = link_rto_ticks;
+        ep.link.tx         = wire_tx;
+        ep.link.rx         = wire_rx;
+        ep.link.user_ctx   = &ep;
+        ep.out_wire        = &out_wire;
+        REQUIRE(reliable_link_init(&ep.link) == MANIKIN_STATUS_OK);
+    }
+
+    void
+    deliver_due_frames (lossy_wire &wire, endpoint &dst, uint32_t now_tick)
+    {
+        while (!wire.frames.empty() && wire.frames.front().first <= now_tick)
+        {
+            const frame_t frame = std::move(wire.frames.front().second);
+            wire.frames.pop_front();
+            reliable_link_receive(&dst.link, frame.data(), frame.size(), now_tick);
+        }
+    }
+
+    frame_t
+    make_message (size_t idx)
+    {
+        frame_t msg(100 + idx % 28);
+        for (size_t i = 0; i < msg.size(); i++)
+        {
+            msg[i] = static_cast<uint8_t>(idx * 31u + i);
+        }
+        return msg;
+    }
+
+    /**
+     * Streams msg_cnt messages from sender to receiver and returns the goodput (delivered
+     * payload bytes / bytes on the wire in both directions).
+     */
+    double
+    run_transfer (uint32_t corrupt_permille, size_t msg_cnt, endpoint &sender, endpoint &receiver)
+    {
+        lossy_wire to_receiver;
+        lossy_wire to_sender;
+        to_receiver.corrupt_permille = corrupt_permille;
+        to_sender.corrupt_permille   = corrupt_permille;
+        to_sender.rng_state          = 54321;
+        setup_endpoint(sender, to_receiver);
+        setup_endpoint(receiver, to_sender);
+
+        size_t   next_msg = 0;
+        uint32_t now_tick = 0;
+        while (receiver.received.size() < msg_cnt && now_tick < 100000u)
+        {
+            to_receiver.now_tick = now_tick;
+            to_sender.now_tick   = now_tick;
+            // NOTE: Stream as fast as the window allows
+            while (next_msg < msg_cnt)
+            {
+                const frame_t    msg = make_message(next_msg);
+                manikin_status_t res
+                    = reliable_link_send(&sender.link, msg.data(), msg.size(), now_tick);
+                if (res != MANIKIN_STATUS_OK)
+                {
+                    REQUIRE(res == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+                    break;
+                }
+                next_msg++;
+            }
+            deliver_due_frames(to_receiver, receiver, now_tick);
+            deliver_due_frames(to_sender, sender, now_tick);
+            reliable_link_poll(&sender.link, now_tick);
+            now_tick++;
+        }
+
+        REQUIRE(receiver.received.size() == msg_cnt);
+        for (size_t i = 0; i < msg_cnt; i++)
+        {
+            REQUIRE(receiver.received[i] == make_message(i));
+        }
+        return static_cast<double>(receiver.link.stats.delivered_bytes)
+               / static_cast<double>(to_receiver.wire_bytes + to_sender.wire_bytes);
+    }
+} // namespace
+
+TEST_CASE("reliable_link_init rejects invalid settings", "[reliable_link][REQ-F7]")
+{
+    endpoint   ep;
+    lossy_wire wire;
+    setup_endpoint(ep, wire);
+
+    ep.link.window = 6;
+    REQUIRE(reliable_link_init(&ep.link) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ep.link.window = 64;
+    REQUIRE(reliable_link_init(&ep.link) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ep.link.window    = link_window;
+    ep.link.slot_size = 256;
+    REQUIRE(reliable_link_init(&ep.link) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ep.link.slot_size = link_slot_size;
+    ep.link.tx        = nullptr;
+    REQUIRE(reliable_link_init(&ep.link) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(reliable_link_init(nullptr) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("reliable_link blocks when the window is full", "[reliable_link][REQ-F7]")
+{
+    endpoint   ep;
+    lossy_wire wire;
+    setup_endpoint(ep, wire);
+
+    const uint8_t msg[4] = { 1, 2, 3, 4 };
+    for (uint8_t i = 0; i < link_window; i++)
+    {
+        REQUIRE(reliable_link_send(&ep.link, msg, sizeof(msg), 0) == MANIKIN_STATUS_OK);
+    }
+    REQUIRE(reliable_link_in_flight(&ep.link) == link_window);
+    REQUIRE(reliable_link_send(&ep.link, msg, sizeof(msg), 0)
+            == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+    uint8_t too_long[link_slot_size] = { 0 };
+    REQUIRE(reliable_link_send(&ep.link, too_long, sizeof(too_long), 0)
+            == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+}
+
+TEST_CASE("reliable_link delivers in order on a clean link", "[reliable_link][REQ-F7]")
+{
+    endpoint     sender;
+    endpoint     receiver;
+    const double goodput = run_transfer(0, 300, sender, receiver);
+    CAPTURE(goodput);
+    REQUIRE(sender.link.stats.retransmissions == 0);
+    // NOTE: 2 link + 6 framing bytes per data frame, plus one 12-byte ACK frame
+    REQUIRE(goodput > 0.8);
+}
+
+TEST_CASE("reliable_link recovers corrupted frames selectively", "[reliable_link][REQ-F7]")
+{
+    endpoint     sender;
+    endpoint     receiver;
+    const double goodput = run_transfer(100, 300, sender, receiver);
+    CAPTURE(goodput);
+    CAPTURE(sender.link.stats.retransmissions);
+    REQUIRE(receiver.link.stats.rx_errors > 0);
+    // NOTE: Only lost frames are resent, a go-back-N scheme would resend up to the whole window
+    REQUIRE(sender.link.stats.retransmissions < 300 / 4);
+    REQUIRE(goodput > 0.6);
+}
+
+TEST_CASE("reliable_link survives heavy corruption", "[reliable_link][REQ-F7]")
+{
+    endpoint     sender;
+    endpoint     receiver;
+    const double goodput = run_transfer(400, 100, sender, receiver);
+    CAPTURE(goodput);
+    REQUIRE(goodput > 0.2);
+}
+
+int
+main (int argc, char *argv[])
+{
+    return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,365 @@
+/**
+ * @file            test_sample_ring.cpp
+ * @brief           Tests for the lock-free SPSC sample ring
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "common/manikin_sample_ring.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+struct test_record
+{
+    uint32_t seq;
+    uint32_t check;
+    uint8_t  payload[8];
+};
+
+static test_record
+make_record (uint32_t seq)
+{
+    test_record record {};
+    record.seq   = seq;
+    record.check = seq * 2654435761u;
+    std::memset(record.payload, static_cast<int>(seq & 0xFFu), sizeof(record.payload));
+    return record;
+}
+
+static bool
+record_is_valid (const test_record &record)
+{
+    for (uint8_t byte : record.payload)
+    {
+        if (byte != (record.seq & 0xFFu))
+        {
+            return false;
+        }
+    }
+    return record.check == record.seq * 2654435761u;
+}
+
+struct ring_fixture
+{
+    std::vector<test_record> storage;
+    manikin_sample_ring_t    ring {};
+
+    ring_fixture (uint32_t capacity, manikin_sample_ring_policy_t policy) : storage(capacity)
+    {
+        ring.buf         = reinterpret_cast<uint8_t *>(storage.data());
+        ring.record_size = sizeof(test_record);
+        ring.capacity    = capacity;
+        ring.policy      = policy;
+        REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_OK);
+    }
+
+    /**
+     * @brief Write cnt records with consecutive sequence numbers into a reservation
+     */
+    static void
+    fill_span (const manikin_sample_ring_span_t &span, uint32_t first_seq)
+    {
+        auto *first  = reinterpret_cast<test_record *>(span.first);
+        auto *second = reinterpret_cast<test_record *>(span.second);
+        for (uint32_t i = 0; i < span.first_cnt; i++)
+        {
+            first[i] = make_record(first_seq + i);
+        }
+        for (uint32_t i = 0; i < span.second_cnt; i++)
+        {
+            second[i] = make_record(first_seq + span.first_cnt + i);
+        }
+    }
+
+    static const test_record &
+    span_record (const manikin_sample_ring_span_t &span, uint32_t idx)
+    {
+        return (idx < span.first_cnt)
+                   ? reinterpret_cast<const test_record *>(span.first)[idx]
+                   : reinterpret_cast<const test_record *>(span.second)[idx - span.first_cnt];
+    }
+};
+
+TEST_CASE("manikin_sample_ring_init", "[sample_ring]")
+{
+    test_record           storage[8];
+    manikin_sample_ring_t ring {};
+    ring.buf         = reinterpret_cast<uint8_t *>(storage);
+    ring.record_size = sizeof(test_record);
+
+    REQUIRE(manikin_sample_ring_init(nullptr) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    ring.capacity = 6;
+    REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring.capacity = 1;
+    REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring.capacity    = 8;
+    ring.record_size = 0;
+    REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    ring.record_size = sizeof(test_record);
+    ring.buf         = nullptr;
+    REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    ring.buf = reinterpret_cast<uint8_t *>(storage);
+    REQUIRE(manikin_sample_ring_init(&ring) == MANIKIN_STATUS_OK);
+    REQUIRE(manikin_sample_ring_count(&ring) == 0);
+}
+
+TEST_CASE("manikin_sample_ring keeps records in order", "[sample_ring]")
+{
+    ring_fixture fixture(8, MANIKIN_SAMPLE_RING_DROP_NEWEST);
+
+    SECTION("push and pop")
+    {
+        test_record record {};
+        REQUIRE(manikin_sample_ring_pop(&fixture.ring, &record)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+        for (uint32_t seq = 0; seq < 5; seq++)
+        {
+            const test_record pushed = make_record(seq);
+            REQUIRE(manikin_sample_ring_push(&fixture.ring, &pushed) == MANIKIN_STATUS_OK);
+        }
+        REQUIRE(manikin_sample_ring_count(&fixture.ring) == 5);
+        for (uint32_t seq = 0; seq < 5; seq++)
+        {
+            REQUIRE(manikin_sample_ring_pop(&fixture.ring, &record) == MANIKIN_STATUS_OK);
+            REQUIRE(record.seq == seq);
+            REQUIRE(record_is_valid(record));
+        }
+        REQUIRE(manikin_sample_ring_count(&fixture.ring) == 0);
+    }
+
+    SECTION("batches wrap into two spans and are peeked without copying")
+    {
+        manikin_sample_ring_span_t span;
+        // Move the indices close to the end of the storage
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 6, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 6) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_peek(&fixture.ring, 8, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_release(&fixture.ring, 6) == MANIKIN_STATUS_OK);
+
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 5, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(span.first == reinterpret_cast<uint8_t *>(&fixture.storage[6]));
+        REQUIRE(span.first_cnt == 2);
+        REQUIRE(span.second == fixture.ring.buf);
+        REQUIRE(span.second_cnt == 3);
+        ring_fixture::fill_span(span, 100);
+        // Only 4 of the 5 reserved records are published
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 6)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 5, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 4) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_count(&fixture.ring) == 4);
+
+        REQUIRE(manikin_sample_ring_peek(&fixture.ring, 8, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(span.first == reinterpret_cast<uint8_t *>(&fixture.storage[6]));
+        REQUIRE(span.first_cnt + span.second_cnt == 4);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            REQUIRE(ring_fixture::span_record(span, i).seq == 100 + i);
+        }
+        REQUIRE(manikin_sample_ring_release(&fixture.ring, 5)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+        REQUIRE(manikin_sample_ring_peek(&fixture.ring, 8, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_release(&fixture.ring, 3) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_count(&fixture.ring) == 1);
+    }
+}
+
+TEST_CASE("manikin_sample_ring overflow policies", "[sample_ring]")
+{
+    manikin_sample_ring_span_t  span;
+    manikin_sample_ring_stats_t stats;
+
+    SECTION("drop newest rejects records while full")
+    {
+        ring_fixture fixture(4, MANIKIN_SAMPLE_RING_DROP_NEWEST);
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 3, &span) == MANIKIN_STATUS_OK);
+        ring_fixture::fill_span(span, 0);
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 3) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 2, &span)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 1)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+
+        REQUIRE(manikin_sample_ring_get_stats(&fixture.ring, &stats) == MANIKIN_STATUS_OK);
+        REQUIRE(stats.dropped_newest == 2);
+        REQUIRE(stats.dropped_oldest == 0);
+
+        test_record record {};
+        REQUIRE(manikin_sample_ring_pop(&fixture.ring, &record) == MANIKIN_STATUS_OK);
+        REQUIRE(record.seq == 0);
+    }
+
+    SECTION("drop oldest overwrites the oldest records")
+    {
+        ring_fixture fixture(4, MANIKIN_SAMPLE_RING_DROP_OLDEST);
+        for (uint32_t seq = 0; seq < 6; seq++)
+        {
+            const test_record pushed = make_record(seq);
+            REQUIRE(manikin_sample_ring_push(&fixture.ring, &pushed) == MANIKIN_STATUS_OK);
+        }
+        REQUIRE(manikin_sample_ring_count(&fixture.ring) == 4);
+        REQUIRE(manikin_sample_ring_get_stats(&fixture.ring, &stats) == MANIKIN_STATUS_OK);
+        REQUIRE(stats.dropped_newest == 0);
+        REQUIRE(stats.dropped_oldest == 2);
+
+        test_record record {};
+        REQUIRE(manikin_sample_ring_pop(&fixture.ring, &record) == MANIKIN_STATUS_OK);
+        REQUIRE(record.seq == 2);
+    }
+
+    SECTION("drop oldest reports an overrun of peeked records")
+    {
+        ring_fixture fixture(4, MANIKIN_SAMPLE_RING_DROP_OLDEST);
+        REQUIRE(manikin_sample_ring_reserve(&fixture.ring, 4, &span) == MANIKIN_STATUS_OK);
+        ring_fixture::fill_span(span, 0);
+        REQUIRE(manikin_sample_ring_commit(&fixture.ring, 4) == MANIKIN_STATUS_OK);
+
+        REQUIRE(manikin_sample_ring_peek(&fixture.ring, 2, &span) == MANIKIN_STATUS_OK);
+        const test_record pushed = make_record(4);
+        REQUIRE(manikin_sample_ring_push(&fixture.ring, &pushed) == MANIKIN_STATUS_OK);
+        REQUIRE(manikin_sample_ring_release(&fixture.ring, 2) == MANIKIN_STATUS_ERR_BUFFER_OVERRUN);
+
+        // The records which were not overwritten are peeked again
+        REQUIRE(manikin_sample_ring_peek(&fixture.ring, 4, &span) == MANIKIN_STATUS_OK);
+        REQUIRE(span.first_cnt + span.second_cnt == 4);
+        REQUIRE(ring_fixture::span_record(span, 0).seq == 1);
+        REQUIRE(ring_fixture::span_record(span, 3).seq == 4);
+        REQUIRE(manikin_sample_ring_release(&fixture.ring, 4) == MANIKIN_STATUS_OK);
+    }
+}
+
+/**
+ * @brief Run a producer and a consumer thread on one ring
+ * @return Sequence numbers of the records the consumer released, in order
+ */
+static std::vector<uint32_t>
+run_stress (ring_fixture &fixture, uint32_t total, bool producer_waits)
+{
+    std::vector<uint32_t> received;
+    received.reserve(total);
+    bool              all_valid = true;
+    std::atomic<bool> done { false };
+
+    std::thread producer([&] {
+        uint32_t seq = 0;
+        while (seq < total)
+        {
+            const uint32_t             batch = 1u + (seq % 7u);
+            const uint32_t             cnt   = (total - seq < batch) ? total - seq : batch;
+            manikin_sample_ring_span_t span;
+            if (manikin_sample_ring_reserve(&fixture.ring, cnt, &span) != MANIKIN_STATUS_OK)
+            {
+                // NOTE: Drop newest, the test producer retries instead of losing records
+                std::this_thread::yield();
+                continue;
+            }
+            ring_fixture::fill_span(span, seq);
+            manikin_sample_ring_commit(&fixture.ring, cnt);
+            seq += cnt;
+            if (producer_waits && (seq % 64u) == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+        done.store(true);
+    });
+
+    std::thread consumer([&] {
+        while (true)
+        {
+            const bool                 finished = done.load();
+            manikin_sample_ring_span_t span;
+            manikin_sample_ring_peek(&fixture.ring, 16, &span);
+            const uint32_t cnt = span.first_cnt + span.second_cnt;
+            if (cnt == 0)
+            {
+                if (finished)
+                {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            std::vector<test_record> copy;
+            for (uint32_t i = 0; i < cnt; i++)
+            {
+                copy.push_back(ring_fixture::span_record(span, i));
+            }
+            if (manikin_sample_ring_release(&fixture.ring, cnt) != MANIKIN_STATUS_OK)
+            {
+                // Overwritten while reading, discard the copy
+                continue;
+            }
+            for (const test_record &record : copy)
+            {
+                all_valid = all_valid && record_is_valid(record);
+                received.push_back(record.seq);
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+    REQUIRE(all_valid);
+    return received;
+}
+
+TEST_CASE("manikin_sample_ring survives a producer and consumer thread",
+          "[sample_ring][stress]")
+{
+    const uint32_t total = 200000;
+
+    SECTION("drop newest delivers every record exactly once")
+    {
+        ring_fixture                fixture(64, MANIKIN_SAMPLE_RING_DROP_NEWEST);
+        const std::vector<uint32_t> received = run_stress(fixture, total, true);
+        REQUIRE(received.size() == total);
+        for (uint32_t i = 0; i < total; i++)
+        {
+            REQUIRE(received[i] == i);
+        }
+    }
+
+    SECTION("drop oldest delivers intact records in order and counts the rest")
+    {
+        ring_fixture                fixture(64, MANIKIN_SAMPLE_RING_DROP_OLDEST);
+        const std::vector<uint32_t> received = run_stress(fixture, total, false);
+        manikin_sample_ring_stats_t stats;
+        REQUIRE(manikin_sample_ring_get_stats(&fixture.ring, &stats) == MANIKIN_STATUS_OK);
+        REQUIRE(received.size() + stats.dropped_oldest == total);
+        for (size_t i = 1; i < received.size(); i++)
+        {
+            REQUIRE(received[i] > received[i - 1]);
+        }
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
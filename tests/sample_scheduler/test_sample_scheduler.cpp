@@ -0,0 +1,330 @@
+/**
+ * @file             test_sample_scheduler.cpp
+ * @brief           Test for the multi-rate sample scheduler
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "sample_scheduler/sample_scheduler.h"
+#include "fake_timer_functions.h"
+#include "fake_watchdog_functions.h"
+#include "fake_i2c_functions.h"
+
+#include <vector>
+
+#define RESET_ALL_FAKES()                       \
+    do                                          \
+    {                                           \
+        RESET_FAKE(timer_hal_init);             \
+        RESET_FAKE(timer_hal_start);            \
+        RESET_FAKE(timer_hal_stop);             \
+        RESET_FAKE(watchdog_hal_init);          \
+        RESET_FAKE(watchdog_hal_kick);          \
+        RESET_FAKE(i2c_hal_error_flag_check);   \
+        RESET_FAKE(i2c_hal_bus_reset);          \
+        RESET_FAKE(i2c_hal_bus_recover);        \
+        RESET_FAKE(i2c_hal_device_acknowledge); \
+        RESET_FAKE(timer_hal_get_tick);         \
+    } while (0)
+
+struct fake_sensor
+{
+    manikin_sensor_ctx_t ctx {};
+    unsigned             reads       = 0;
+    manikin_status_t     read_status = MANIKIN_STATUS_OK;
+};
+
+static std::vector<uint8_t> read_log;
+
+static manikin_status_t
+fake_sensor_read (void *user)
+{
+    fake_sensor *sensor = static_cast<fake_sensor *>(user);
+    sensor->reads++;
+    read_log.push_back(sensor->ctx.i2c_addr);
+    return sensor->read_status;
+}
+
+struct scheduler_fixture
+{
+    uint8_t                               timer_handle    = 0;
+    uint8_t                               watchdog_handle = 0;
+    sample_timer_ctx_t                    timer {};
+    std::vector<fake_sensor>              sensors;
+    std::vector<sample_scheduler_entry_t> entries;
+    sample_scheduler_slot_t               slots[64] {};
+    sample_scheduler_ctx_t                ctx {};
+
+    explicit scheduler_fixture (const std::vector<uint16_t> &rates)
+        : sensors(rates.size()), entries(rates.size())
+    {
+        timer.timer    = &timer_handle;
+        timer.watchdog = &watchdog_handle;
+        for (size_t i = 0; i < rates.size(); i++)
+        {
+            sensors[i].ctx.i2c_addr = static_cast<uint8_t>(i);
+            entries[i]              = { &sensors[i].ctx,
+                                        fake_sensor_read,
+                                        &sensors[i],
+                                        rates[i],
+                                        SAMPLE_SCHEDULER_PHASE_AUTO };
+        }
+        ctx.timer         = &timer;
+        ctx.entries       = entries.data();
+        ctx.entry_cnt     = static_cast<uint8_t>(entries.size());
+        ctx.slots         = slots;
+        ctx.slot_capacity = sizeof(slots) / sizeof(slots[0]);
+        read_log.clear();
+    }
+
+    uint8_t
+    max_slot_load () const
+    {
+        uint8_t max = 0;
+        for (uint16_t slot = 0; slot < ctx.hyperperiod; slot++)
+        {
+            uint8_t load = 0;
+            for (uint8_t i = 0; i < ctx.entry_cnt; i++)
+            {
+                load += (slots[slot] >> i) & 1u;
+            }
+            max = (load > max) ? load : max;
+        }
+        return max;
+    }
+};
+
+TEST_CASE("sample_scheduler_init rejects invalid schedules", "[sample_scheduler][REQ-F9]")
+{
+    RESET_ALL_FAKES();
+    REQUIRE(sample_scheduler_init(NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    SECTION("rate of zero")
+    {
+        scheduler_fixture fixture({ 100, 0 });
+        REQUIRE(sample_scheduler_init(&fixture.ctx)
+                == MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    SECTION("base rate above the maximum timer rate")
+    {
+        scheduler_fixture fixture({ 400, 300 });
+        REQUIRE(sample_scheduler_init(&fixture.ctx)
+                == MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    SECTION("phase outside the sensor period")
+    {
+        scheduler_fixture fixture({ 100, 50 });
+        fixture.entries[1].phase = 2;
+        REQUIRE(sample_scheduler_init(&fixture.ctx)
+                == MANIKIN_STATUS_ERR_INVALID_TIMER_SAMPLE_RATE);
+    }
+    SECTION("hyperperiod larger than the slot table")
+    {
+        scheduler_fixture fixture({ 1000, 10 });
+        REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+    }
+    SECTION("missing read function")
+    {
+        scheduler_fixture fixture({ 100 });
+        fixture.entries[0].read = NULL;
+        REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    }
+}
+
+TEST_CASE("sample_scheduler runs every sensor at its own rate from one timer",
+          "[sample_scheduler][REQ-F9]")
+{
+    RESET_ALL_FAKES();
+    scheduler_fixture fixture({ 100, 50, 25, 20 });
+
+    REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(timer_hal_init_fake.call_count == 1);
+    REQUIRE(timer_hal_init_fake.arg1_val == 100);
+    REQUIRE(fixture.ctx.hyperperiod == 20);
+
+    // NOTE: One second of ticks at the base rate
+    for (int tick = 0; tick < 100; tick++)
+    {
+        REQUIRE(sample_scheduler_tick(&fixture.ctx) == MANIKIN_STATUS_OK);
+    }
+    REQUIRE(fixture.sensors[0].reads == 100);
+    REQUIRE(fixture.sensors[1].reads == 50);
+    REQUIRE(fixture.sensors[2].reads == 25);
+    REQUIRE(fixture.sensors[3].reads == 20);
+    REQUIRE(watchdog_hal_kick_fake.call_count == 2 * read_log.size());
+
+    // Reads of a sensor are evenly spaced
+    for (uint8_t sensor = 0; sensor < 4; sensor++)
+    {
+        const uint16_t period = static_cast<uint16_t>(100 / fixture.entries[sensor].rate_hz);
+        for (uint16_t slot = 0; slot < fixture.ctx.hyperperiod; slot++)
+        {
+            const bool scheduled = (fixture.slots[slot] >> sensor) & 1u;
+            REQUIRE(scheduled == (slot % period == fixture.entries[sensor].phase));
+        }
+    }
+}
+
+TEST_CASE("sample_scheduler spreads phases to keep the bus load flat", "[sample_scheduler][REQ-F9]")
+{
+    RESET_ALL_FAKES();
+
+    SECTION("automatic phases")
+    {
+        scheduler_fixture fixture({ 100, 25, 25, 25, 25 });
+        REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.ctx.hyperperiod == 4);
+        REQUIRE(fixture.max_slot_load() == 2);
+
+        for (int tick = 0; tick < 4; tick++)
+        {
+            read_log.clear();
+            REQUIRE(sample_scheduler_tick(&fixture.ctx) == MANIKIN_STATUS_OK);
+            REQUIRE(read_log.size() == 2);
+            REQUIRE(read_log[0] == 0);
+        }
+    }
+
+    SECTION("automatic phases avoid fixed phases")
+    {
+        scheduler_fixture fixture({ 25, 25, 50 });
+        fixture.entries[0].phase = 1;
+        REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.entries[0].phase == 1);
+        REQUIRE(fixture.entries[1].phase == 0);
+        REQUIRE(fixture.max_slot_load() == 2);
+    }
+
+    SECTION("fixed phases are kept even when they collide")
+    {
+        scheduler_fixture fixture({ 100, 25, 25, 25, 25 });
+        for (size_t i = 1; i < fixture.entries.size(); i++)
+        {
+            fixture.entries[i].phase = 0;
+        }
+        REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.max_slot_load() == 5);
+    }
+}
+
+static size_t             fake_now;
+static manikin_i2c_inst_t blocked_bus;
+
+static size_t
+fake_get_tick ()
+{
+    return fake_now;
+}
+
+static uint32_t
+fake_error_flag_check (manikin_i2c_inst_t i2c)
+{
+    return (i2c == blocked_bus) ? MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG : MANIKIN_STATUS_OK;
+}
+
+/**
+ * @brief Run ticks at 100 Hz on a 1 ms HAL tick and return the first error
+ */
+static manikin_status_t
+run_ticks (scheduler_fixture &fixture, int ticks)
+{
+    manikin_status_t status = MANIKIN_STATUS_OK;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        const manikin_status_t tick_status = sample_scheduler_tick(&fixture.ctx);
+        status   = (status == MANIKIN_STATUS_OK) ? tick_status : status;
+        fake_now += 10;
+    }
+    return status;
+}
+
+TEST_CASE("sample_scheduler isolates faults per sensor", "[sample_scheduler][REQ-F7][REQ-F8]")
+{
+    RESET_ALL_FAKES();
+    uint8_t           bus_handles[2] = { 0, 0 };
+    scheduler_fixture fixture({ 100, 100 });
+    fixture.sensors[0].ctx.i2c                 = &bus_handles[0];
+    fixture.sensors[1].ctx.i2c                 = &bus_handles[1];
+    timer_hal_get_tick_fake.custom_fake        = fake_get_tick;
+    i2c_hal_error_flag_check_fake.custom_fake = fake_error_flag_check;
+    blocked_bus                                = nullptr;
+    fake_now                                   = 0;
+    REQUIRE(sample_scheduler_init(&fixture.ctx) == MANIKIN_STATUS_OK);
+
+    SECTION("read errors are reported without starting a bus reset")
+    {
+        fixture.sensors[1].read_status = MANIKIN_STATUS_ERR_READ_FAIL;
+        REQUIRE(run_ticks(fixture, 2) == MANIKIN_STATUS_ERR_READ_FAIL);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 0);
+    }
+
+    SECTION("device fault only backs off the faulty sensor")
+    {
+        fixture.sensors[0].read_status = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+        REQUIRE(run_ticks(fixture, 100) == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(fixture.sensors[1].reads == 100);
+        REQUIRE(fixture.sensors[0].reads < 10);
+        REQUIRE(fixture.sensors[0].ctx.recovery.fault_cnt > 1);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 0);
+        REQUIRE(timer_hal_init_fake.call_count == 1);
+
+        // The device answers again, it is sampled at its full rate after the back-off
+        fixture.sensors[0].read_status = MANIKIN_STATUS_OK;
+        REQUIRE(run_ticks(fixture, 100) == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        const unsigned reads = fixture.sensors[0].reads;
+        REQUIRE(run_ticks(fixture, 10) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == reads + 10);
+        REQUIRE(fixture.sensors[0].ctx.recovery.fault_cnt == 0);
+    }
+
+    SECTION("bus fault only pauses the sensors on that bus")
+    {
+        blocked_bus = fixture.sensors[0].ctx.i2c;
+        REQUIRE(run_ticks(fixture, 50) == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 1);
+        REQUIRE(fixture.sensors[0].reads == 0);
+        REQUIRE(fixture.sensors[1].reads == 50);
+
+        // Power cycle and power up time of the bus, the timer keeps its base rate
+        blocked_bus = nullptr;
+        REQUIRE(run_ticks(fixture, 200) == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(i2c_hal_bus_recover_fake.call_count == 1);
+        REQUIRE(timer_hal_init_fake.call_count == 1);
+        REQUIRE(timer_hal_init_fake.arg1_val == 100);
+        REQUIRE(fixture.sensors[0].ctx.needs_reinit == 1);
+        REQUIRE(fixture.sensors[1].reads == 250);
+
+        // Operational again
+        const unsigned reads = fixture.sensors[0].reads;
+        REQUIRE(reads > 0);
+        REQUIRE(run_ticks(fixture, 10) == MANIKIN_STATUS_OK);
+        REQUIRE(fixture.sensors[0].reads == reads + 10);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
@@ -28,6 +28,7 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include "sdp810/sdp810.h"
 #include "fake_i2c_functions.h"
+#include <vector>
 
 // Common mocks and types
 static uint8_t       dummy_read_buf[4];
@@ -50,6 +51,22 @@ custom_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, s
     return len;
 }
 
+// Pressure 2000, temperature 1000 and scale factor 1000, each followed by its CRC
+static const uint8_t sensor_words[SDP810_SAMPLE_SIZE]
+    = { 0x07, 0xD0, 0x2B, 0x03, 0xE8, 0xD4, 0x03, 0xE8, 0xD4 };
+static std::vector<size_t> read_lengths;
+static uint8_t             corrupt_pressure;
+
+size_t
+sensor_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, size_t len)
+{
+    REQUIRE(len <= sizeof(sensor_words));
+    read_lengths.push_back(len);
+    memcpy(bytes, sensor_words, len);
+    bytes[2] ^= corrupt_pressure;
+    return len;
+}
+
 void
 reset_mocks ()
 {
@@ -58,6 +75,9 @@ reset_mocks ()
     RESET_FAKE(i2c_hal_read_bytes);
     RESET_FAKE(i2c_hal_write_bytes);
     RESET_FAKE(i2c_hal_deinit);
+    read_lengths.clear();
+    corrupt_pressure     = 0;
+    dummy_ctx.driver_ctx = NULL;
 }
 
 // --- sdp810_init_sensor ---
@@ -128,19 +148,20 @@ TEST_CASE("sdp810_parse_raw_data handles null raw_data", "[sdp810][REQ-F3]")
 
 TEST_CASE("sdp810_parse_raw_data handles null data pointer", "[sdp810][REQ-F3]")
 {
-    uint8_t dummy_raw[8] = { 0 }; // Minimum required length
+    uint8_t dummy_raw[SDP810_SAMPLE_SIZE] = { 0 }; // Minimum required length
     REQUIRE(sdp810_parse_raw_data(dummy_raw, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
 }
 
 TEST_CASE("sdp810_parse_raw_data successfully converts valid raw data", "[sdp810][REQ-F3]")
 {
     // Example: raw pressure = 0x07D0 (2000), temp = 0x03E8 (1000), scale = 0x03E8 (1000)
-    uint8_t raw_data[8] = {
+    uint8_t raw_data[SDP810_SAMPLE_SIZE] = {
         0x07, 0xD0, // raw_pressure = 2000
-        0x00,       // dummy CRC or unused
+        0x2B,       // CRC
         0x03, 0xE8, // temp = 1000
-        0x00,       // dummy CRC or unused
-        0x03, 0xE8  // scale factor = 1000
+        0xD4,       // CRC
+        0x03, 0xE8, // scale factor = 1000
+        0xD4        // CRC
     };
 
     sdp810_sample_data_t parsed_data;
@@ -153,6 +174,78 @@ TEST_CASE("sdp810_parse_raw_data successfully converts valid raw data", "[sdp810
     REQUIRE(parsed_data.air_temp_mbar == Catch::Approx(1.0f));
 }
 
+TEST_CASE("sdp810_parse_raw_data rejects corrupt words", "[sdp810][REQ-F3]")
+{
+    sdp810_sample_data_t parsed_data;
+    for (size_t i = 0; i < SDP810_SAMPLE_SIZE; i++)
+    {
+        uint8_t raw_data[SDP810_SAMPLE_SIZE];
+        memcpy(raw_data, sensor_words, sizeof(raw_data));
+        raw_data[i] ^= 0x10u;
+        REQUIRE(sdp810_parse_raw_data(raw_data, &parsed_data)
+                == MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+    }
+    // Sensirion's example: 0xBEEF has CRC 0x92, a zero scale factor is rejected as well
+    const uint8_t zero_scale[SDP810_SAMPLE_SIZE]
+        = { 0xBE, 0xEF, 0x92, 0xBE, 0xEF, 0x92, 0x00, 0x00, 0x81 };
+    REQUIRE(sdp810_parse_raw_data(zero_scale, &parsed_data)
+            == MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+}
+
+TEST_CASE("sdp810 fast mode reads only the pressure most of the time", "[sdp810][REQ-F2]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = SDP810_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = sensor_read_func;
+    sdp810_fast_ctx_t fast               = {};
+    fast.temp_refresh_interval           = 3;
+    dummy_ctx.driver_ctx                 = &fast;
+    REQUIRE(sdp810_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+
+    for (int i = 0; i < 7; i++)
+    {
+        uint8_t read_buf[SDP810_SAMPLE_SIZE] = { 0 };
+        REQUIRE(sdp810_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+        // Cached words fill the rest, so every sample parses the same
+        REQUIRE(memcmp(read_buf, sensor_words, sizeof(read_buf)) == 0);
+        sdp810_sample_data_t parsed_data;
+        REQUIRE(sdp810_parse_raw_data(read_buf, &parsed_data) == MANIKIN_STATUS_OK);
+        REQUIRE(parsed_data.air_pressure_mbar == Catch::Approx(2.0f));
+    }
+    // Scale factor once, then the temperature every third sample
+    REQUIRE(read_lengths == std::vector<size_t> { 9, 3, 3, 6, 3, 3, 6 });
+
+    // A re-initialization fetches the scale factor again
+    REQUIRE(sdp810_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    uint8_t read_buf[SDP810_SAMPLE_SIZE] = { 0 };
+    REQUIRE(sdp810_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(read_lengths.back() == 9);
+    dummy_ctx.driver_ctx = NULL;
+}
+
+TEST_CASE("sdp810 fast mode detects a corrupt pressure", "[sdp810][REQ-F2]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = SDP810_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = sensor_read_func;
+    sdp810_fast_ctx_t fast               = {};
+    dummy_ctx.driver_ctx                 = &fast;
+    REQUIRE(sdp810_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+
+    uint8_t read_buf[SDP810_SAMPLE_SIZE] = { 0 };
+    REQUIRE(sdp810_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    corrupt_pressure = 0x01u;
+    REQUIRE(sdp810_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_ERR_READ_FAIL);
+    REQUIRE(dummy_ctx.sample.status == MANIKIN_STATUS_ERR_READ_FAIL);
+    // Without a refresh interval the temperature is only read with the scale factor
+    REQUIRE(read_lengths == std::vector<size_t> { 9, 3 });
+    dummy_ctx.driver_ctx = NULL;
+}
+
 int
 main (int argc, char *argv[])
 {
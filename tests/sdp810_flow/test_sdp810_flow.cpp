@@ -0,0 +1,276 @@
+/**
+ * @file            test_sdp810_flow.cpp
+ * @brief           Tests for the SDP810 flow-to-volume integrator
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "sdp810/sdp810.h"
+#include "sdp810/sdp810_flow.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+/* With a scale factor of 1000 the raw pressure counts are mPa */
+static std::array<uint8_t, SDP810_SAMPLE_SIZE>
+make_sample (int16_t raw_dp, uint16_t scale_factor = 1000)
+{
+    std::array<uint8_t, SDP810_SAMPLE_SIZE> sample {};
+    sample[0] = (uint8_t)((uint16_t)raw_dp >> 8u);
+    sample[1] = (uint8_t)((uint16_t)raw_dp & 0xFFu);
+    sample[6] = (uint8_t)(scale_factor >> 8u);
+    sample[7] = (uint8_t)(scale_factor & 0xFFu);
+    return sample;
+}
+
+/* Linear table: 1 mPa gives 1 mL/s */
+static const sdp810_flow_cal_point_t linear_table[] = {
+    { -30000, -30000000 },
+    { 30000, 30000000 },
+};
+
+static sdp810_flow_config_t
+linear_config ()
+{
+    sdp810_flow_config_t config {};
+    config.cal_type          = SDP810_FLOW_CAL_TABLE;
+    config.table             = linear_table;
+    config.table_len         = 2;
+    config.breath_start_ul_s = 50000;
+    config.breath_end_ul_s   = 20000;
+    config.min_breath_us     = 20000;
+    return config;
+}
+
+TEST_CASE("sdp810_flow init rejects invalid configs", "[sdp810_flow]")
+{
+    sdp810_flow_ctx_t    ctx {};
+    sdp810_flow_config_t config = linear_config();
+    REQUIRE(sdp810_flow_init(NULL, &config) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(sdp810_flow_init(&ctx, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    const sdp810_flow_cal_point_t unsorted[] = { { 0, 0 }, { 1000, 10 }, { 1000, 20 } };
+    config.table                             = unsorted;
+    config.table_len                         = 3;
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config.table_len = 1;
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config.table = NULL;
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_ERR_NULL_PARAM);
+
+    config                 = linear_config();
+    config.breath_end_ul_s = config.breath_start_ul_s + 1;
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    config          = linear_config();
+    config.cal_type = 7;
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+
+    config = linear_config();
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+}
+
+TEST_CASE("sdp810_flow converts pressure with the square-root law", "[sdp810_flow]")
+{
+    sdp810_flow_config_t config {};
+    config.cal_type   = SDP810_FLOW_CAL_SQRT;
+    config.sqrt_coeff = 10000;
+    REQUIRE(sdp810_flow_from_pressure(&config, 0) == 0);
+    REQUIRE(sdp810_flow_from_pressure(&config, 1000) == 10000);
+    REQUIRE(sdp810_flow_from_pressure(&config, 4000) == 20000);
+    REQUIRE(sdp810_flow_from_pressure(&config, -9000) == -30000);
+    // sqrt(2 Pa) * 10000 = 14142.1
+    REQUIRE(sdp810_flow_from_pressure(&config, 2000) == 14142);
+    REQUIRE(sdp810_flow_from_pressure(NULL, 2000) == 0);
+}
+
+TEST_CASE("sdp810_flow interpolates and clamps the calibration table", "[sdp810_flow]")
+{
+    const sdp810_flow_cal_point_t table[] = {
+        { -1000, -5000 }, { 0, 0 }, { 1000, 10000 }, { 4000, 20000 },
+    };
+    sdp810_flow_config_t config {};
+    config.cal_type  = SDP810_FLOW_CAL_TABLE;
+    config.table     = table;
+    config.table_len = 4;
+    REQUIRE(sdp810_flow_from_pressure(&config, 500) == 5000);
+    REQUIRE(sdp810_flow_from_pressure(&config, 2500) == 15000);
+    REQUIRE(sdp810_flow_from_pressure(&config, -500) == -2500);
+    REQUIRE(sdp810_flow_from_pressure(&config, 1000) == 10000);
+    REQUIRE(sdp810_flow_from_pressure(&config, 9000) == 20000);
+    REQUIRE(sdp810_flow_from_pressure(&config, -9000) == -5000);
+}
+
+TEST_CASE("sdp810_flow integrates a breath with the trapezoidal rule", "[sdp810_flow]")
+{
+    sdp810_flow_ctx_t    ctx {};
+    sdp810_flow_config_t config = linear_config();
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+
+    // Samples every 10 ms in mL/s, the breath runs from the second to the sixth sample
+    const int16_t        flows_ml_s[] = { 0, 10, 500, 500, 500, 500, 0, 0 };
+    sdp810_flow_breath_t breath {};
+    std::vector<size_t>  completed;
+    for (size_t i = 0; i < sizeof(flows_ml_s) / sizeof(flows_ml_s[0]); i++)
+    {
+        const auto sample = make_sample(flows_ml_s[i]);
+        REQUIRE(sdp810_flow_update(&ctx, sample.data(), 1000000u + i * 10000u, &breath)
+                == MANIKIN_STATUS_OK);
+        if (breath.complete)
+        {
+            completed.push_back(i);
+            // 30 ms at 500 mL/s plus the 10 ms ramp down to 0
+            REQUIRE(breath.volume_ul == 17500);
+            REQUIRE(breath.peak_flow_ul_s == 500000);
+            REQUIRE(breath.start_us == 1020000u);
+            REQUIRE(breath.duration_us == 40000u);
+        }
+    }
+    REQUIRE(completed == std::vector<size_t> { 6 });
+    REQUIRE(ctx.flow_ul_s == 0);
+}
+
+TEST_CASE("sdp810_flow keeps integrating between the start and end thresholds", "[sdp810_flow]")
+{
+    sdp810_flow_ctx_t    ctx {};
+    sdp810_flow_config_t config = linear_config();
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+
+    // 30 mL/s is below the start but above the end threshold, the breath only ends at 10
+    const int16_t        flows_ml_s[] = { 100, 30, 30, 10 };
+    sdp810_flow_breath_t breath {};
+    for (size_t i = 0; i < sizeof(flows_ml_s) / sizeof(flows_ml_s[0]); i++)
+    {
+        const auto sample = make_sample(flows_ml_s[i]);
+        REQUIRE(sdp810_flow_update(&ctx, sample.data(), i * 10000u, &breath)
+                == MANIKIN_STATUS_OK);
+        REQUIRE(breath.complete == (i == 3));
+    }
+    // (100 + 30) / 2 + 30 + (30 + 10) / 2 mL/s over 10 ms each
+    REQUIRE(breath.volume_ul == 1150);
+    REQUIRE(breath.duration_us == 30000u);
+}
+
+TEST_CASE("sdp810_flow drops breaths shorter than the minimum", "[sdp810_flow]")
+{
+    sdp810_flow_ctx_t    ctx {};
+    sdp810_flow_config_t config = linear_config();
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+
+    sdp810_flow_breath_t breath {};
+    const int16_t        flows_ml_s[] = { 0, 800, 0, 0 };
+    for (size_t i = 0; i < sizeof(flows_ml_s) / sizeof(flows_ml_s[0]); i++)
+    {
+        const auto sample = make_sample(flows_ml_s[i]);
+        REQUIRE(sdp810_flow_update(&ctx, sample.data(), i * 10000u, &breath)
+                == MANIKIN_STATUS_OK);
+        REQUIRE(breath.complete == 0);
+    }
+    REQUIRE(ctx.in_breath == 0);
+}
+
+TEST_CASE("sdp810_flow ignores samples with a zero scale factor", "[sdp810_flow]")
+{
+    sdp810_flow_ctx_t    ctx {};
+    sdp810_flow_config_t config = linear_config();
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+
+    sdp810_flow_breath_t breath {};
+    const auto           sample = make_sample(500, 0);
+    REQUIRE(sdp810_flow_update(&ctx, sample.data(), 0, &breath)
+            == MANIKIN_STATUS_ERR_CONVERSION_FAILED);
+    REQUIRE(ctx.in_breath == 0);
+    REQUIRE(sdp810_flow_update(&ctx, NULL, 0, &breath) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(sdp810_flow_update(&ctx, sample.data(), 0, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+}
+
+TEST_CASE("sdp810_flow volumes match a float reference over many breaths", "[sdp810_flow]")
+{
+    // SDP810-500Pa scale factor with an orifice of 25 mL/s at 1 Pa
+    const uint16_t       scale_factor = 60;
+    sdp810_flow_config_t config {};
+    config.cal_type          = SDP810_FLOW_CAL_SQRT;
+    config.sqrt_coeff        = 25000;
+    config.breath_start_ul_s = 20000;
+    config.breath_end_ul_s   = 10000;
+    config.min_breath_us     = 100000;
+    sdp810_flow_ctx_t ctx {};
+    REQUIRE(sdp810_flow_init(&ctx, &config) == MANIKIN_STATUS_OK);
+
+    const double period_us   = 5000000.0;
+    const double inflate_us  = 1000000.0;
+    const double sample_us   = 2000.0;
+    const double peak_pa     = 300.0;
+    unsigned     breaths     = 0;
+    double       ref_volume  = 0;
+    double       prev_flow   = 0;
+    double       ref_peak    = 0;
+    bool         ref_inside  = false;
+    for (uint64_t t = 0; t < 4u * (uint64_t)period_us; t += (uint64_t)sample_us)
+    {
+        // Half-sine inflation followed by a pause
+        const double phase = std::fmod((double)t, period_us);
+        const double  pa
+            = (phase < inflate_us) ? peak_pa * std::sin(M_PI * phase / inflate_us) : 0;
+        const int16_t raw = (int16_t)std::lround(pa * scale_factor);
+
+        // Float reference on the same quantized pressure
+        const double flow = 25.0 * std::sqrt((double)raw / scale_factor) * 1000.0;
+        if (!ref_inside && flow > 20000)
+        {
+            ref_inside = true;
+            ref_volume = 0;
+            ref_peak   = flow;
+        }
+        else if (ref_inside)
+        {
+            ref_volume += (prev_flow + flow) / 2.0 * sample_us / 1e6;
+            ref_peak = std::max(ref_peak, flow);
+        }
+        prev_flow = flow;
+
+        sdp810_flow_breath_t breath {};
+        const auto           sample = make_sample(raw, scale_factor);
+        REQUIRE(sdp810_flow_update(&ctx, sample.data(), t, &breath) == MANIKIN_STATUS_OK);
+        if (ref_inside && flow < 10000)
+        {
+            ref_inside = false;
+            REQUIRE(breath.complete == 1);
+            REQUIRE(std::fabs((double)breath.volume_ul - ref_volume) < ref_volume * 0.001);
+            REQUIRE(std::fabs((double)breath.peak_flow_ul_s - ref_peak) < ref_peak * 0.001);
+            breaths++;
+        }
+        else
+        {
+            REQUIRE(breath.complete == 0);
+        }
+    }
+    REQUIRE(breaths == 4);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
@@ -34,6 +34,7 @@ extern "C"
 #include "fake_watchdog_functions.h"
 #include "fake_spi_functions.h"
 #include "fake_timing_functions.h"
+#include "fake_gpio_functions.h"
 
 /**
  * @brief Manikin Delay uS
@@ -160,6 +161,11 @@ extern "C"
  */
 #define MANIKIN_HAL_GET_TICK() timer_hal_get_tick()
 
+/**
+ * @brief Length of one MANIKIN_HAL_GET_TICK() tick in microseconds, used by manikin_time
+ */
+#define MANIKIN_HAL_TICK_PERIOD_US 1000u
+
 /**
  * @brief Reset the I2C peripheral and sensor by toggling the physical voltage line of sensor
  * @param i2c_inst I2C instance
@@ -173,6 +179,29 @@ extern "C"
  */
 #define MANIKIN_I2C_BUS_RECOVER(i2c_inst) i2c_hal_bus_recover(i2c_inst)
 
+/**
+ * @brief Release a stuck I2C bus by clocking out SCL pulses until SDA is high, followed by a STOP
+ * @param i2c_inst I2C instance
+ * @return Integer value 0 on success, 1 on fail
+ */
+#define MANIKIN_I2C_BUS_CLEAR(i2c_inst) i2c_hal_bus_clear(i2c_inst)
+
+/**
+ * @brief Call cb from ISR-context every time the GPIO line becomes active (e.g. a data-ready line)
+ * @param gpio GPIO instance, its active level is part of the platform pin description
+ * @param cb Function called from ISR-context
+ * @param user Ptr passed to cb
+ * @return Integer value 0 on success, 1 on fail
+ */
+#define MANIKIN_GPIO_IRQ_ENABLE(gpio, cb, user) gpio_hal_irq_enable(gpio, cb, user)
+
+/**
+ * @brief Stop calling the callback registered with MANIKIN_GPIO_IRQ_ENABLE()
+ * @param gpio GPIO instance
+ * @return Integer value 0 on success, 1 on fail
+ */
+#define MANIKIN_GPIO_IRQ_DISABLE(gpio) gpio_hal_irq_disable(gpio)
+
 /**
  * @brief Get the current baud rate of the I2C peripheral
  * @param i2c_inst I2C instance
@@ -49,6 +49,10 @@ extern "C"
 
     typedef uint8_t *manikin_spi_inst_t;
 
+    typedef uint8_t *manikin_gpio_inst_t;
+
+    typedef void (*manikin_gpio_irq_cb_t)(void *user);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,10 +22,12 @@
  * Author:          Victor Hogeweij
  */
 #include "fake_timing_functions.h"
+#include "virtual_clock.h"
 #include <manikin_software_conf.h>
 
 int
 manikin_hal_delay_us (size_t us)
 {
+    virtual_clock_advance_us(us);
     return 0;
 }
\ No newline at end of file
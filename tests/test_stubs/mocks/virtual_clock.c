@@ -0,0 +1,268 @@
+/**
+ * @file             virtual_clock.c
+ * @brief            Discrete-event virtual clock driving the HAL time fakes in host tests
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "virtual_clock.h"
+#include "fake_timer_functions.h"
+#include "manikin_platform.h"
+
+typedef struct
+{
+    int                      id; /* 0 == free slot */
+    uint64_t                 due_us;
+    uint64_t                 period_us;
+    virtual_clock_event_fn_t fn;
+    void                    *user;
+} virtual_clock_event_t;
+
+typedef struct
+{
+    manikin_timer_inst_t     inst; /* NULL == free slot */
+    uint64_t                 period_us;
+    virtual_clock_event_fn_t fn;
+    void                    *user;
+    int                      event_id;
+} virtual_clock_timer_t;
+
+static uint64_t              now_us;
+static uint8_t               firing;
+static int                   next_id = 1;
+static virtual_clock_event_t events[VIRTUAL_CLOCK_MAX_EVENTS];
+static virtual_clock_timer_t timers[VIRTUAL_CLOCK_MAX_TIMERS];
+
+void
+virtual_clock_reset (void)
+{
+    now_us  = 0;
+    firing  = 0;
+    next_id = 1;
+    for (size_t i = 0; i < VIRTUAL_CLOCK_MAX_EVENTS; i++)
+    {
+        events[i].id = 0;
+    }
+    for (size_t i = 0; i < VIRTUAL_CLOCK_MAX_TIMERS; i++)
+    {
+        timers[i].inst     = NULL;
+        timers[i].fn       = NULL;
+        timers[i].event_id = VIRTUAL_CLOCK_NO_EVENT;
+    }
+}
+
+uint64_t
+virtual_clock_now_us (void)
+{
+    return now_us;
+}
+
+static virtual_clock_event_t *
+virtual_clock_next_event (uint64_t until_us)
+{
+    virtual_clock_event_t *next = NULL;
+    for (size_t i = 0; i < VIRTUAL_CLOCK_MAX_EVENTS; i++)
+    {
+        virtual_clock_event_t *event = &events[i];
+        if (event->id == 0 || event->due_us > until_us)
+        {
+            continue;
+        }
+        // NOTE: Events due at the same time fire in the order they were scheduled
+        if (next == NULL || event->due_us < next->due_us
+            || (event->due_us == next->due_us && event->id < next->id))
+        {
+            next = event;
+        }
+    }
+    return next;
+}
+
+void
+virtual_clock_advance_us (uint64_t us)
+{
+    const uint64_t target_us = now_us + us;
+    if (firing)
+    {
+        now_us = target_us;
+        return;
+    }
+    //
+    // Events only fire up to the requested time. A callback consuming more time than its period
+    // makes the clock run ahead of the events, instead of chasing them forever.
+    //
+    virtual_clock_event_t *event;
+    while ((event = virtual_clock_next_event(target_us)) != NULL)
+    {
+        now_us                              = (event->due_us > now_us) ? event->due_us : now_us;
+        const virtual_clock_event_fn_t fn   = event->fn;
+        void                          *user = event->user;
+        if (event->period_us != 0)
+        {
+            event->due_us += event->period_us;
+        }
+        else
+        {
+            event->id = 0;
+        }
+        firing = 1;
+        fn(user);
+        firing = 0;
+    }
+    now_us = (target_us > now_us) ? target_us : now_us;
+}
+
+int
+virtual_clock_schedule_us (uint64_t                 delay_us,
+                           uint64_t                 period_us,
+                           virtual_clock_event_fn_t fn,
+                           void                    *user)
+{
+    if (fn == NULL)
+    {
+        return VIRTUAL_CLOCK_NO_EVENT;
+    }
+    for (size_t i = 0; i < VIRTUAL_CLOCK_MAX_EVENTS; i++)
+    {
+        if (events[i].id == 0)
+        {
+            events[i].id        = next_id++;
+            events[i].due_us    = now_us + delay_us;
+            events[i].period_us = period_us;
+            events[i].fn        = fn;
+            events[i].user      = user;
+            return events[i].id;
+        }
+    }
+    return VIRTUAL_CLOCK_NO_EVENT;
+}
+
+void
+virtual_clock_cancel (int event_id)
+{
+    for (size_t i = 0; event_id > 0 && i < VIRTUAL_CLOCK_MAX_EVENTS; i++)
+    {
+        if (events[i].id == event_id)
+        {
+            events[i].id = 0;
+        }
+    }
+}
+
+static virtual_clock_timer_t *
+virtual_clock_find_timer (manikin_timer_inst_t inst, uint8_t create)
+{
+    virtual_clock_timer_t *free_slot = NULL;
+    for (size_t i = 0; i < VIRTUAL_CLOCK_MAX_TIMERS; i++)
+    {
+        if (timers[i].inst == inst)
+        {
+            return &timers[i];
+        }
+        free_slot = (free_slot == NULL && timers[i].inst == NULL) ? &timers[i] : free_slot;
+    }
+    if (create && free_slot != NULL)
+    {
+        free_slot->inst      = inst;
+        free_slot->period_us = 0;
+        free_slot->fn        = NULL;
+        free_slot->event_id  = VIRTUAL_CLOCK_NO_EVENT;
+    }
+    return create ? free_slot : NULL;
+}
+
+int
+virtual_clock_set_timer_handler (manikin_timer_inst_t     timer,
+                                 virtual_clock_event_fn_t fn,
+                                 void                    *user)
+{
+    virtual_clock_timer_t *slot = virtual_clock_find_timer(timer, 1);
+    if (slot == NULL)
+    {
+        return 1;
+    }
+    slot->fn   = fn;
+    slot->user = user;
+    return 0;
+}
+
+static void
+virtual_clock_timer_isr (void *user)
+{
+    virtual_clock_timer_t *slot = (virtual_clock_timer_t *)user;
+    if (slot->fn != NULL)
+    {
+        slot->fn(slot->user);
+    }
+}
+
+static size_t
+virtual_clock_get_tick (void)
+{
+    return (size_t)(now_us / MANIKIN_HAL_TICK_PERIOD_US);
+}
+
+static int
+virtual_clock_timer_init (manikin_timer_inst_t timer, uint32_t freq)
+{
+    virtual_clock_timer_t *slot = virtual_clock_find_timer(timer, 1);
+    if (slot == NULL || freq == 0)
+    {
+        return 1;
+    }
+    slot->period_us = 1000000u / freq;
+    return 0;
+}
+
+static int
+virtual_clock_timer_stop (manikin_timer_inst_t timer)
+{
+    virtual_clock_timer_t *slot = virtual_clock_find_timer(timer, 0);
+    if (slot == NULL)
+    {
+        return 1;
+    }
+    virtual_clock_cancel(slot->event_id);
+    slot->event_id = VIRTUAL_CLOCK_NO_EVENT;
+    return 0;
+}
+
+static int
+virtual_clock_timer_start (manikin_timer_inst_t timer)
+{
+    virtual_clock_timer_t *slot = virtual_clock_find_timer(timer, 0);
+    if (slot == NULL || slot->period_us == 0)
+    {
+        return 1;
+    }
+    virtual_clock_timer_stop(timer);
+    slot->event_id = virtual_clock_schedule_us(
+        slot->period_us, slot->period_us, virtual_clock_timer_isr, slot);
+    return (slot->event_id == VIRTUAL_CLOCK_NO_EVENT) ? 1 : 0;
+}
+
+void
+virtual_clock_attach (void)
+{
+    timer_hal_get_tick_fake.custom_fake = virtual_clock_get_tick;
+    timer_hal_init_fake.custom_fake     = virtual_clock_timer_init;
+    timer_hal_start_fake.custom_fake    = virtual_clock_timer_start;
+    timer_hal_stop_fake.custom_fake     = virtual_clock_timer_stop;
+}
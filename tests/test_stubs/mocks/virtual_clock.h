@@ -0,0 +1,99 @@
+/**
+ * @file             virtual_clock.h
+ * @brief            Discrete-event virtual clock driving the HAL time fakes in host tests
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+#include <stdint.h>
+#include <stddef.h>
+#include "manikin_software_conf.h"
+
+/**
+ * One simulated timeline for host tests. MANIKIN_DELAY_US() always advances it, once attached
+ * MANIKIN_HAL_GET_TICK() reads it and started timers fire their callback from it. Device models
+ * call virtual_clock_advance_us() for the time a transfer or conversion takes.
+ *
+ * Events fire in due order while the clock advances, so hours of sampling run in milliseconds
+ * and every run is identical. Time advanced from within an event callback only moves the clock
+ * forward, events due in the meantime fire after the callback returns (like a non-reentrant ISR).
+ */
+#define VIRTUAL_CLOCK_MAX_EVENTS 16u
+#define VIRTUAL_CLOCK_MAX_TIMERS 4u
+#define VIRTUAL_CLOCK_NO_EVENT   (-1)
+
+    typedef void (*virtual_clock_event_fn_t)(void *user);
+
+    /**
+     * @brief Restart the timeline at 0 and drop all events and timers
+     */
+    void virtual_clock_reset(void);
+
+    /**
+     * @brief Route timer_hal_get_tick, timer_hal_init, timer_hal_start and timer_hal_stop to the
+     *        virtual clock. Call after RESET_FAKE(), which detaches them again.
+     */
+    void virtual_clock_attach(void);
+
+    /**
+     * @brief Current virtual time
+     * @return Microseconds since virtual_clock_reset()
+     */
+    uint64_t virtual_clock_now_us(void);
+
+    /**
+     * @brief Let time pass, firing all events which become due
+     * @param us Microseconds to advance
+     */
+    void virtual_clock_advance_us(uint64_t us);
+
+    /**
+     * @brief Fire fn once after delay_us, or every period_us when period_us is not 0
+     * @return Event id for virtual_clock_cancel(), VIRTUAL_CLOCK_NO_EVENT when the table is full
+     */
+    int virtual_clock_schedule_us(uint64_t                 delay_us,
+                                  uint64_t                 period_us,
+                                  virtual_clock_event_fn_t fn,
+                                  void                    *user);
+
+    /**
+     * @brief Cancel an event, ids of events that already fired are ignored
+     */
+    void virtual_clock_cancel(int event_id);
+
+    /**
+     * @brief Set the interrupt handler of a timer, it fires at the rate given to
+     *        MANIKIN_TIMER_HAL_INIT() while the timer is started
+     * @return 0 on success, 1 when all VIRTUAL_CLOCK_MAX_TIMERS are in use
+     */
+    int virtual_clock_set_timer_handler(manikin_timer_inst_t     timer,
+                                        virtual_clock_event_fn_t fn,
+                                        void                    *user);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* VIRTUAL_CLOCK_H */
@@ -0,0 +1,150 @@
+/**
+ * @file            test_time.cpp
+ * @brief           Tests for the 64-bit time base and sample timestamping
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "common/manikin_time.h"
+#include "sdp810/sdp810.h"
+#include "vl6180x/vl6180x.h"
+#include "fake_i2c_functions.h"
+#include "fake_timer_functions.h"
+
+#include <cstring>
+
+static size_t fake_now;
+
+static size_t
+fake_get_tick ()
+{
+    return fake_now;
+}
+
+static size_t
+fake_read_bytes (manikin_i2c_inst_t, uint8_t, uint8_t *bytes, size_t len)
+{
+    memset(bytes, 0x01, len);
+    return len;
+}
+
+static size_t
+fake_read_bytes_once (manikin_i2c_inst_t, uint8_t, uint8_t *bytes, size_t len)
+{
+    return (i2c_hal_read_bytes_fake.call_count == 1) ? fake_read_bytes(NULL, 0, bytes, len) : 0;
+}
+
+static size_t
+fake_write_bytes (manikin_i2c_inst_t, uint8_t, const uint8_t *, size_t len)
+{
+    return len;
+}
+
+static void
+reset_fakes ()
+{
+    RESET_FAKE(timer_hal_get_tick);
+    RESET_FAKE(i2c_hal_read_bytes);
+    RESET_FAKE(i2c_hal_write_bytes);
+    timer_hal_get_tick_fake.custom_fake  = fake_get_tick;
+    i2c_hal_read_bytes_fake.custom_fake  = fake_read_bytes;
+    i2c_hal_write_bytes_fake.custom_fake = fake_write_bytes;
+}
+
+TEST_CASE("manikin_time extends the HAL tick to 64-bit microseconds", "[time]")
+{
+    reset_fakes();
+
+    SECTION("starts at zero and counts in microseconds")
+    {
+        fake_now = 5000;
+        manikin_time_init();
+        REQUIRE(manikin_time_now_us() == 0);
+        fake_now = 5010;
+        REQUIRE(manikin_time_now_us() == 10000);
+    }
+
+    SECTION("keeps counting across wraps of the 32-bit tick")
+    {
+        fake_now = 0xFFFFFFF0u;
+        manikin_time_init();
+        fake_now = 0xFFFFFFFFu;
+        REQUIRE(manikin_time_now_us() == 15000);
+        fake_now = 0x10;
+        REQUIRE(manikin_time_now_us() == 32000);
+        fake_now = 0xFFFFFFF0u;
+        REQUIRE(manikin_time_now_us() == 0x100000000ull * 1000u);
+        fake_now = 0x5;
+        REQUIRE(manikin_time_now_us() == (0x100000000ull + 0x15u) * 1000u);
+    }
+}
+
+TEST_CASE("driver reads stamp their samples", "[time]")
+{
+    reset_fakes();
+    fake_now = 0;
+    manikin_time_init();
+
+    uint8_t              handle = 1;
+    manikin_sensor_ctx_t sensor {};
+    sensor.i2c      = &handle;
+    sensor.i2c_addr = 0x25;
+
+    SECTION("timestamp, sequence and status of successful reads")
+    {
+        uint8_t read_buf[9];
+        fake_now = 20;
+        REQUIRE(sdp810_read_sensor(&sensor, read_buf) == MANIKIN_STATUS_OK);
+        REQUIRE(sensor.sample.timestamp_us == 20000);
+        REQUIRE(sensor.sample.seq == 1);
+        REQUIRE(sensor.sample.sensor_id == 0x25);
+        REQUIRE(sensor.sample.status == MANIKIN_STATUS_OK);
+
+        fake_now = 30;
+        REQUIRE(sdp810_read_sensor(&sensor, read_buf) == MANIKIN_STATUS_OK);
+        REQUIRE(sensor.sample.timestamp_us == 30000);
+        REQUIRE(sensor.sample.seq == 2);
+        // Stamping needs no extra bus traffic
+        REQUIRE(i2c_hal_read_bytes_fake.call_count == 2);
+    }
+
+    SECTION("failed reads keep their stamp with an error status")
+    {
+        uint8_t read_buf[VL6180X_SAMPLE_SIZE] = { 0 };
+        // The status read succeeds, the range read after it fails
+        sensor.drdy_irq                     = 1;
+        i2c_hal_read_bytes_fake.custom_fake = fake_read_bytes_once;
+        fake_now                            = 40;
+        REQUIRE(vl6180x_read_sensor(&sensor, read_buf) != MANIKIN_STATUS_OK);
+        REQUIRE(sensor.sample.timestamp_us == 40000);
+        REQUIRE(sensor.sample.seq == 1);
+        REQUIRE(sensor.sample.status == MANIKIN_STATUS_ERR_READ_FAIL);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
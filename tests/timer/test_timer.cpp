@@ -29,6 +29,8 @@
 #include "fake_watchdog_functions.h"
 #include "fake_i2c_functions.h"
 
+#include <cstring>
+
 #define RESET_ALL_FAKES()                       \
     do                                          \
     {                                           \
@@ -43,6 +45,9 @@
         RESET_FAKE(i2c_hal_bus_reset);          \
         RESET_FAKE(i2c_hal_device_acknowledge); \
         RESET_FAKE(i2c_hal_bus_recover);        \
+        RESET_FAKE(timer_hal_get_tick);         \
+        RESET_FAKE(i2c_hal_bus_clear);          \
+        RESET_FAKE(i2c_hal_init);               \
     } while (0)
 
 sample_timer_ctx_t
@@ -161,6 +166,14 @@ TEST_CASE("sample_timer_start_cb_handler", "[cb_start][REQ-F9][REQ-F7]")
     }
 }
 
+static size_t fake_now;
+
+static size_t
+fake_get_tick ()
+{
+    return fake_now;
+}
+
 TEST_CASE("sample_timer_end_cb_handler", "[cb_end][REQ-F9][REQ-F7]")
 {
     RESET_ALL_FAKES();
@@ -196,10 +209,11 @@ TEST_CASE("sample_timer_end_cb_handler", "[cb_end][REQ-F9][REQ-F7]")
     SECTION("Perform reset sequence")
     {
         const uint16_t     example_sample_rate = 100;
-        const uint16_t     timeout_sample_rate = 1;
         sample_timer_ctx_t ctx                 = sample_timer_ctx_init_with_valid_param();
         ctx.frequency                          = example_sample_rate;
         manikin_sensor_ctx_t sensor {};
+        timer_hal_get_tick_fake.custom_fake = fake_get_tick;
+        fake_now                            = 0;
 
         auto status = sample_timer_init(&ctx);
         REQUIRE(status == MANIKIN_STATUS_OK);
@@ -210,58 +224,338 @@ TEST_CASE("sample_timer_end_cb_handler", "[cb_end][REQ-F9][REQ-F7]")
         /* 1: It should now notice the fault flag and return it, so that the SM can start */
         status = sample_timer_start_cb_handler(&ctx, &sensor);
         REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
-        REQUIRE(timer_hal_init_fake.arg1_val == example_sample_rate);
         REQUIRE(watchdog_hal_kick_fake.call_count == 1);
         REQUIRE(ctx.state == 0);
 
-        /* 2: Great, it should now set the bus reset in action */
+        /* 2: Great, it should now set the bus reset in action, the timer keeps its rate */
         status = sample_timer_end_cb_handler(&ctx, &sensor, status);
         REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
-        REQUIRE(timer_hal_init_fake.call_count == 2);
-        REQUIRE(timer_hal_init_fake.arg1_val == timeout_sample_rate);
+        REQUIRE(timer_hal_init_fake.call_count == 1);
+        REQUIRE(timer_hal_init_fake.arg1_val == example_sample_rate);
         REQUIRE(watchdog_hal_kick_fake.call_count == 2);
         REQUIRE(i2c_hal_bus_reset_fake.call_count == 1);
         REQUIRE(ctx.state == 2);
 
-        /* 3: Bus is reset, now it should recover the bus */
-        status = sample_timer_start_cb_handler(&ctx, &sensor);
+        /* 3: The bus stays off for the hold time, samples are skipped meanwhile */
+        fake_now = 500;
+        status   = sample_timer_start_cb_handler(&ctx, &sensor);
+        REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(i2c_hal_bus_recover_fake.call_count == 0);
+        status = sample_timer_end_cb_handler(&ctx, &sensor, status);
+        REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 1);
+
+        /* 4: Hold time passed, now it should recover the bus */
+        fake_now = 1000;
+        status   = sample_timer_start_cb_handler(&ctx, &sensor);
         REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
-        REQUIRE(watchdog_hal_kick_fake.call_count == 3);
-        REQUIRE(timer_hal_init_fake.arg1_val == timeout_sample_rate);
         REQUIRE(i2c_hal_bus_recover_fake.call_count == 1);
         REQUIRE(ctx.state == 1);
-
-        /* 4: In this state the end cb will do nothing, as it has timeout of 1 period */
         status = sample_timer_end_cb_handler(&ctx, &sensor, status);
-        REQUIRE(watchdog_hal_kick_fake.call_count == 4);
-        REQUIRE(timer_hal_init_fake.call_count == 3);
-        REQUIRE(timer_hal_init_fake.arg1_val == timeout_sample_rate);
         REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
 
         /* Reset the fault-state */
         i2c_hal_error_flag_check_fake.return_val = 0;
 
-        /* 5: Bus recovered: It will finish the state-machine now */
-        status = sample_timer_start_cb_handler(&ctx, &sensor);
+        /* 5: Sensors had time to power up: It will finish the state-machine now */
+        fake_now = 2000;
+        status   = sample_timer_start_cb_handler(&ctx, &sensor);
         REQUIRE(ctx.state == 0);
-        REQUIRE(watchdog_hal_kick_fake.call_count == 5);
-        REQUIRE(timer_hal_init_fake.arg1_val == example_sample_rate);
-        REQUIRE(timer_hal_init_fake.call_count == 4);
-        REQUIRE(status == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(status == MANIKIN_STATUS_OK);
+        REQUIRE(sensor.needs_reinit == 1);
+        REQUIRE(timer_hal_init_fake.call_count == 1);
 
         /* 6: It should now be operational in original state */
-        status = sample_timer_end_cb_handler(&ctx, &sensor, status);
-        REQUIRE(watchdog_hal_kick_fake.call_count == 6);
+        status = sample_timer_end_cb_handler(&ctx, &sensor, MANIKIN_STATUS_OK);
+        REQUIRE(watchdog_hal_kick_fake.call_count == 8);
         REQUIRE(status == MANIKIN_STATUS_OK);
+    }
 
-        /* 7: Start handler decides, whether reset was successful */
-        status = sample_timer_start_cb_handler(&ctx, &sensor);
+    SECTION("device fault only backs off the faulty sensor")
+    {
+        uint8_t              bus_a = 0;
+        uint8_t              bus_b = 0;
+        sample_timer_ctx_t   ctx   = sample_timer_ctx_init_with_valid_param();
+        manikin_sensor_ctx_t faulty {};
+        manikin_sensor_ctx_t healthy {};
+        faulty.i2c                          = &bus_a;
+        healthy.i2c                         = &bus_b;
+        timer_hal_get_tick_fake.custom_fake = fake_get_tick;
+        fake_now                            = 0;
+        REQUIRE(sample_timer_init(&ctx) == MANIKIN_STATUS_OK);
+
+        /* Bus lines are fine, but the device NAKs */
+        i2c_hal_error_flag_check_fake.return_val = MANIKIN_STATUS_OK;
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &faulty) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &faulty, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 0);
         REQUIRE(ctx.state == 0);
-        REQUIRE(watchdog_hal_kick_fake.call_count == 7);
-        /* Check it is back to originally set sample-rate */
-        REQUIRE(timer_hal_init_fake.arg1_val == example_sample_rate);
-        /* It is back to operational state! */
-        REQUIRE(status == MANIKIN_STATUS_OK);
+        REQUIRE(faulty.recovery.fault_cnt == 1);
+        REQUIRE(faulty.needs_reinit == 1);
+
+        /* The faulty sensor is skipped during its back-off, the healthy one is not */
+        fake_now = 5;
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &faulty)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &faulty, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(faulty.recovery.fault_cnt == 1);
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &healthy) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &healthy, MANIKIN_STATUS_OK)
+                == MANIKIN_STATUS_OK);
+
+        /* A second fault doubles the back-off */
+        fake_now = 10;
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &faulty) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &faulty, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(faulty.recovery.fault_cnt == 2);
+        REQUIRE(faulty.recovery.retry_tick == 30);
+
+        /* A good read clears the back-off */
+        fake_now = 30;
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &faulty) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &faulty, MANIKIN_STATUS_OK)
+                == MANIKIN_STATUS_OK);
+        REQUIRE(faulty.recovery.fault_cnt == 0);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 0);
+        REQUIRE(timer_hal_init_fake.call_count == 1);
+    }
+}
+
+static void
+run_instrumented_sample (sample_timer_ctx_t   *ctx,
+                         manikin_sensor_ctx_t *sensor,
+                         size_t                start_tick,
+                         size_t                end_tick)
+{
+    fake_now = start_tick;
+    REQUIRE(sample_timer_start_cb_handler(ctx, sensor) == MANIKIN_STATUS_OK);
+    fake_now = end_tick;
+    REQUIRE(sample_timer_end_cb_handler(ctx, sensor, MANIKIN_STATUS_OK) == MANIKIN_STATUS_OK);
+}
+
+TEST_CASE("sample_timer stats instrumentation", "[stats][REQ-F9][REQ-F7]")
+{
+    RESET_ALL_FAKES();
+    timer_hal_get_tick_fake.custom_fake = fake_get_tick;
+
+    manikin_sensor_ctx_t sensor {};
+    manikin_sensor_ctx_t other_sensor {};
+    sample_timer_stats_t stats {};
+    sample_timer_ctx_t   ctx = sample_timer_ctx_init_with_valid_param();
+    sensor.i2c_addr          = 0x25;
+    stats.sensor             = &sensor;
+    stats.period_ticks       = 10;
+    ctx.stats                = &stats;
+    ctx.stats_cnt            = 1;
+
+    SECTION("records start latency, read duration and deadline misses")
+    {
+        // On time, 2 ticks read
+        run_instrumented_sample(&ctx, &sensor, 100, 102);
+        // Due at 110, starts 3 ticks late and finishes after its deadline
+        run_instrumented_sample(&ctx, &sensor, 113, 125);
+        // Due at 130, the overrun did not shift the grid
+        run_instrumented_sample(&ctx, &sensor, 130, 131);
+
+        sample_timer_stats_snapshot_t snapshot;
+        REQUIRE(sample_timer_stats_snapshot(&stats, &snapshot) == MANIKIN_STATUS_OK);
+        REQUIRE(snapshot.sensor_addr == 0x25);
+        REQUIRE(snapshot.samples == 3);
+        REQUIRE(snapshot.deadline_misses == 1);
+        REQUIRE(snapshot.max_start_latency == 3);
+        REQUIRE(snapshot.max_read_duration == 12);
+        REQUIRE(snapshot.start_latency_hist[0] == 2);
+        REQUIRE(snapshot.start_latency_hist[2] == 1);
+        REQUIRE(snapshot.read_duration_hist[1] == 1);
+        REQUIRE(snapshot.read_duration_hist[2] == 1);
+        REQUIRE(snapshot.read_duration_hist[4] == 1);
+
+        REQUIRE(sample_timer_stats_reset(&stats) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_stats_snapshot(&stats, &snapshot) == MANIKIN_STATUS_OK);
+        REQUIRE(snapshot.samples == 0);
+        REQUIRE(stats.period_ticks == 10);
+    }
+
+    SECTION("sensors without stats are not instrumented")
+    {
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &other_sensor) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &other_sensor, MANIKIN_STATUS_OK)
+                == MANIKIN_STATUS_OK);
+        REQUIRE(timer_hal_get_tick_fake.call_count == 0);
+        REQUIRE(stats.counters.samples == 0);
+    }
+
+    SECTION("serializes into a single packet payload")
+    {
+        run_instrumented_sample(&ctx, &sensor, 0x01020300, 0x01020305);
+
+        sample_timer_stats_snapshot_t snapshot;
+        uint8_t                       buf[SAMPLE_TIMER_STATS_SERIALIZED_SIZE];
+        size_t                        len = 0;
+        REQUIRE(sample_timer_stats_snapshot(&stats, &snapshot) == MANIKIN_STATUS_OK);
+        REQUIRE(sample_timer_stats_serialize(&snapshot, buf, sizeof(buf) - 1, &len)
+                == MANIKIN_STATUS_ERR_INVALID_BUFFER_SIZE);
+        REQUIRE(sample_timer_stats_serialize(&snapshot, buf, sizeof(buf), &len)
+                == MANIKIN_STATUS_OK);
+        REQUIRE(len == SAMPLE_TIMER_STATS_SERIALIZED_SIZE);
+        REQUIRE(len <= 255);
+
+        const uint8_t expected_head[] = { 0x25,                   /* sensor_addr */
+                                          0x01, 0x00, 0x00, 0x00, /* samples */
+                                          0x00, 0x00, 0x00, 0x00, /* deadline_misses */
+                                          0x00, 0x00, 0x00, 0x00, /* max_start_latency */
+                                          0x05, 0x00, 0x00, 0x00, /* max_read_duration */
+                                          0x01, 0x00, 0x00, 0x00 /* start_latency_hist[0] */ };
+        REQUIRE(memcmp(buf, expected_head, sizeof(expected_head)) == 0);
+        // read_duration_hist[3] counts the 5 tick read
+        REQUIRE(buf[1 + 4 * (4 + 8 + 3)] == 1);
+    }
+
+    SECTION("bus reset restarts the sampling grid")
+    {
+        run_instrumented_sample(&ctx, &sensor, 100, 101);
+
+        i2c_hal_error_flag_check_fake.return_val = MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+        fake_now                                 = 110;
+        REQUIRE(sample_timer_start_cb_handler(&ctx, &sensor)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(sample_timer_end_cb_handler(&ctx, &sensor, MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG)
+                == MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG);
+        REQUIRE(stats.synced == 0);
+
+        // Back to sampling mode much later, that is no start latency
+        ctx.state                                = 0;
+        i2c_hal_error_flag_check_fake.return_val = MANIKIN_STATUS_OK;
+        run_instrumented_sample(&ctx, &sensor, 5000, 5001);
+        REQUIRE(stats.counters.samples == 2);
+        REQUIRE(stats.counters.max_start_latency == 0);
+        REQUIRE(stats.counters.deadline_misses == 0);
+    }
+}
+
+/**
+ * @brief Simulated i2c bus, a device can hold SDA low until it is clocked out or power cycled
+ */
+struct simulated_bus
+{
+    bool     stuck       = false;
+    bool     clearable   = true;  /* SCL pulses free the bus */
+    unsigned rehang_cnt  = 0;     /* Times the bus hangs again until it is power cycled */
+    unsigned clear_cnt   = 0;
+    unsigned power_cycle = 0;
+};
+
+static simulated_bus sim_bus;
+
+static uint32_t
+sim_bus_error_flag_check (manikin_i2c_inst_t)
+{
+    return sim_bus.stuck ? MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG : MANIKIN_STATUS_OK;
+}
+
+static int
+sim_bus_clear (manikin_i2c_inst_t)
+{
+    sim_bus.clear_cnt++;
+    sim_bus.stuck = !sim_bus.clearable;
+    return 0;
+}
+
+static int
+sim_bus_recover (manikin_i2c_inst_t)
+{
+    sim_bus.power_cycle++;
+    sim_bus.stuck      = false;
+    sim_bus.rehang_cnt = 0;
+    return 0;
+}
+
+/**
+ * @brief Sample one period on the simulated bus and advance the clock by the 10 ms period
+ */
+static manikin_status_t
+sim_bus_sample (sample_timer_ctx_t *ctx, manikin_sensor_ctx_t *sensor)
+{
+    manikin_status_t status = sample_timer_start_cb_handler(ctx, sensor);
+    if (status == MANIKIN_STATUS_OK)
+    {
+        status = sim_bus.stuck ? MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG : MANIKIN_STATUS_OK;
+    }
+    status = sample_timer_end_cb_handler(ctx, sensor, status);
+    if (sim_bus.rehang_cnt > 0 && !sim_bus.stuck && sim_bus.clear_cnt > 0)
+    {
+        sim_bus.rehang_cnt--;
+        sim_bus.stuck = true;
+    }
+    fake_now += 10;
+    return status;
+}
+
+/**
+ * @brief Glitch the bus and return the time in ticks until the sensor samples again
+ */
+static size_t
+sim_bus_time_to_recover (sample_timer_ctx_t *ctx, manikin_sensor_ctx_t *sensor)
+{
+    sim_bus.stuck       = true;
+    const size_t glitch = fake_now;
+    while (sim_bus_sample(ctx, sensor) != MANIKIN_STATUS_OK)
+    {
+        REQUIRE(fake_now - glitch < 10000);
+    }
+    return fake_now - 10 - glitch;
+}
+
+TEST_CASE("sample_timer fast bus recovery", "[cb_end][REQ-F7][REQ-F9]")
+{
+    RESET_ALL_FAKES();
+    timer_hal_get_tick_fake.custom_fake       = fake_get_tick;
+    i2c_hal_error_flag_check_fake.custom_fake = sim_bus_error_flag_check;
+    i2c_hal_bus_clear_fake.custom_fake        = sim_bus_clear;
+    i2c_hal_bus_recover_fake.custom_fake      = sim_bus_recover;
+    sim_bus                                   = simulated_bus {};
+    fake_now                                  = 0;
+
+    uint8_t              bus = 0;
+    manikin_sensor_ctx_t sensor {};
+    sample_timer_ctx_t   ctx = sample_timer_ctx_init_with_valid_param();
+    sensor.i2c               = &bus;
+    REQUIRE(sample_timer_init(&ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(sim_bus_sample(&ctx, &sensor) == MANIKIN_STATUS_OK);
+
+    SECTION("a glitch is recovered within one sample period")
+    {
+        const size_t time_to_recover = sim_bus_time_to_recover(&ctx, &sensor);
+        REQUIRE(time_to_recover <= 10);
+        REQUIRE(sim_bus.clear_cnt == 1);
+        REQUIRE(sim_bus.power_cycle == 0);
+        REQUIRE(i2c_hal_bus_reset_fake.call_count == 0);
+        REQUIRE(sensor.needs_reinit == 1);
+
+        // The bus worked again, so the next glitch takes the fast path as well
+        REQUIRE(sim_bus_time_to_recover(&ctx, &sensor) <= 10);
+        REQUIRE(sim_bus.clear_cnt == 2);
+        REQUIRE(sim_bus.power_cycle == 0);
+    }
+
+    SECTION("falls back to a power cycle when clearing does not free the bus")
+    {
+        sim_bus.clearable            = false;
+        const size_t time_to_recover = sim_bus_time_to_recover(&ctx, &sensor);
+        REQUIRE(time_to_recover >= 2000);
+        REQUIRE(sim_bus.clear_cnt == 1);
+        REQUIRE(sim_bus.power_cycle == 1);
+    }
+
+    SECTION("falls back to a power cycle when the bus keeps hanging")
+    {
+        sim_bus.rehang_cnt = 10;
+        sim_bus_time_to_recover(&ctx, &sensor);
+        REQUIRE(sim_bus.clear_cnt == 3);
+        REQUIRE(sim_bus.power_cycle == 1);
     }
 }
 
@@ -0,0 +1,232 @@
+/**
+ * @file             test_virtual_clock.cpp
+ * @brief           Test for the virtual HAL clock used by host tests
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "catch2/catch_all.hpp"
+#include <catch2/catch_session.hpp>
+#include "sample_scheduler/sample_scheduler.h"
+#include "virtual_clock.h"
+#include "manikin_platform.h"
+
+#include <string>
+#include <vector>
+
+#define RESET_ALL_FAKES()                     \
+    do                                        \
+    {                                         \
+        RESET_FAKE(timer_hal_init);           \
+        RESET_FAKE(timer_hal_start);          \
+        RESET_FAKE(timer_hal_stop);           \
+        RESET_FAKE(timer_hal_get_tick);       \
+        RESET_FAKE(watchdog_hal_init);        \
+        RESET_FAKE(watchdog_hal_kick);        \
+        RESET_FAKE(i2c_hal_error_flag_check); \
+    } while (0)
+
+static std::vector<std::string> event_log;
+
+static void
+log_event (void *user)
+{
+    event_log.push_back(std::string(static_cast<const char *>(user)) + "@"
+                        + std::to_string(virtual_clock_now_us()));
+}
+
+static void
+slow_event (void *user)
+{
+    log_event(user);
+    MANIKIN_DELAY_US(150);
+}
+
+TEST_CASE("virtual_clock advances one timeline for delays and ticks", "[virtual_clock]")
+{
+    RESET_ALL_FAKES();
+    virtual_clock_reset();
+    virtual_clock_attach();
+    REQUIRE(MANIKIN_HAL_GET_TICK() == 0);
+    MANIKIN_DELAY_US(2500);
+    REQUIRE(virtual_clock_now_us() == 2500);
+    REQUIRE(MANIKIN_HAL_GET_TICK() == 2);
+    virtual_clock_advance_us(500);
+    REQUIRE(MANIKIN_HAL_GET_TICK() == 3);
+}
+
+TEST_CASE("virtual_clock fires events in due order", "[virtual_clock]")
+{
+    RESET_ALL_FAKES();
+    virtual_clock_reset();
+    event_log.clear();
+
+    SECTION("One-shot and periodic events")
+    {
+        virtual_clock_schedule_us(300, 0, log_event, (void *)"A");
+        virtual_clock_schedule_us(100, 0, log_event, (void *)"B");
+        const int periodic = virtual_clock_schedule_us(200, 200, log_event, (void *)"C");
+        virtual_clock_advance_us(1000);
+        REQUIRE(event_log
+                == std::vector<std::string> {
+                    "B@100", "C@200", "A@300", "C@400", "C@600", "C@800", "C@1000" });
+        virtual_clock_cancel(periodic);
+        virtual_clock_advance_us(1000);
+        REQUIRE(event_log.size() == 7);
+        REQUIRE(virtual_clock_now_us() == 2000);
+    }
+
+    SECTION("Time spent in a callback delays the events due meanwhile")
+    {
+        virtual_clock_schedule_us(100, 0, slow_event, (void *)"slow");
+        virtual_clock_schedule_us(200, 0, log_event, (void *)"late");
+        virtual_clock_schedule_us(200, 0, log_event, (void *)"later");
+        virtual_clock_advance_us(1000);
+        REQUIRE(event_log == std::vector<std::string> { "slow@100", "late@250", "later@250" });
+        REQUIRE(virtual_clock_now_us() == 1000);
+    }
+
+    SECTION("A callback slower than its period does not stall the clock")
+    {
+        virtual_clock_schedule_us(100, 100, slow_event, (void *)"slow");
+        virtual_clock_advance_us(500);
+        // Due at 100..500, each one starts when the previous one returned
+        REQUIRE(event_log.size() == 5);
+        REQUIRE(event_log.back() == "slow@700");
+        REQUIRE(virtual_clock_now_us() == 850);
+    }
+}
+
+static unsigned timer_fired;
+
+static void
+count_timer (void *user)
+{
+    (void)user;
+    timer_fired++;
+}
+
+TEST_CASE("virtual_clock runs the timer HAL", "[virtual_clock]")
+{
+    RESET_ALL_FAKES();
+    virtual_clock_reset();
+    virtual_clock_attach();
+    timer_fired                     = 0;
+    uint8_t            timer_handle = 0;
+    uint8_t            wdt_handle   = 0;
+    sample_timer_ctx_t timer {};
+    timer.timer     = &timer_handle;
+    timer.watchdog  = &wdt_handle;
+    timer.frequency = 100;
+    REQUIRE(virtual_clock_set_timer_handler(&timer_handle, count_timer, NULL) == 0);
+    REQUIRE(sample_timer_init(&timer) == MANIKIN_STATUS_OK);
+    virtual_clock_advance_us(50000);
+    REQUIRE(timer_fired == 0);
+    REQUIRE(sample_timer_start(&timer) == MANIKIN_STATUS_OK);
+    virtual_clock_advance_us(1000000);
+    REQUIRE(timer_fired == 100);
+    REQUIRE(sample_timer_stop(&timer) == MANIKIN_STATUS_OK);
+    virtual_clock_advance_us(1000000);
+    REQUIRE(timer_fired == 100);
+}
+
+struct simulated_sensor
+{
+    manikin_sensor_ctx_t ctx {};
+    uint32_t             read_time_us   = 0;
+    uint64_t             fault_from_us  = 0;
+    uint64_t             fault_until_us = 0;
+    unsigned             reads          = 0;
+};
+
+static manikin_status_t
+simulated_sensor_read (void *user)
+{
+    simulated_sensor *sensor = static_cast<simulated_sensor *>(user);
+    MANIKIN_DELAY_US(sensor->read_time_us);
+    const uint64_t now = virtual_clock_now_us();
+    if (now >= sensor->fault_from_us && now < sensor->fault_until_us)
+    {
+        return MANIKIN_STATUS_ERR_PERIPHERAL_FAULT_FLAG;
+    }
+    sensor->reads++;
+    return MANIKIN_STATUS_OK;
+}
+
+static void
+scheduler_isr (void *user)
+{
+    sample_scheduler_tick(static_cast<sample_scheduler_ctx_t *>(user));
+}
+
+TEST_CASE("virtual_clock runs an hour of sampling with a sensor fault", "[virtual_clock]")
+{
+    RESET_ALL_FAKES();
+    virtual_clock_reset();
+    virtual_clock_attach();
+    uint8_t                  i2c_handle   = 0;
+    uint8_t                  timer_handle = 0;
+    uint8_t                  wdt_handle   = 0;
+    simulated_sensor         healthy;
+    simulated_sensor         faulty;
+    sample_timer_ctx_t       timer {};
+    sample_scheduler_entry_t entries[2] {};
+    sample_scheduler_slot_t  slots[8] {};
+    sample_scheduler_ctx_t   ctx {};
+    healthy.ctx.i2c       = &i2c_handle;
+    healthy.read_time_us  = 300;
+    faulty.ctx.i2c        = &i2c_handle;
+    faulty.ctx.i2c_addr   = 1;
+    faulty.read_time_us   = 500;
+    faulty.fault_from_us  = 600ull * 1000000u;
+    faulty.fault_until_us = 660ull * 1000000u;
+    entries[0]            = { &healthy.ctx, simulated_sensor_read, &healthy, 100, 0 };
+    entries[1]            = { &faulty.ctx, simulated_sensor_read, &faulty, 50, 1 };
+    timer.timer           = &timer_handle;
+    timer.watchdog        = &wdt_handle;
+    ctx.timer             = &timer;
+    ctx.entries           = entries;
+    ctx.entry_cnt         = 2;
+    ctx.slots             = slots;
+    ctx.slot_capacity     = 8;
+    REQUIRE(virtual_clock_set_timer_handler(&timer_handle, scheduler_isr, &ctx) == 0);
+    REQUIRE(sample_scheduler_init(&ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(sample_scheduler_start(&ctx) == MANIKIN_STATUS_OK);
+
+    virtual_clock_advance_us(3000ull * 1000000u);
+    const unsigned faulty_reads = faulty.reads;
+    virtual_clock_advance_us(600ull * 1000000u);
+
+    // The healthy sensor never missed a sample, the faulty one is back at its full rate
+    REQUIRE(healthy.reads == 100u * 3600u);
+    REQUIRE(faulty.reads - faulty_reads == 50u * 600u);
+    REQUIRE(faulty.reads < 50u * 3600u);
+    REQUIRE(faulty.reads > 50u * (3600u - 61u));
+    // The reads of the last tick (300 + 500 us) ran past the end
+    REQUIRE(virtual_clock_now_us() == 3600ull * 1000000u + 800u);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int result = Catch::Session().run(argc, argv);
+
+    return result;
+}
@@ -27,6 +27,7 @@
 #include "vl53l4cd/vl53l4cd.h"
 #include "fake_i2c_functions.h"
 #include "common/manikin_bit_manipulation.h"
+#include <cstring>
 
 // Common mocks and types
 static uint8_t       dummy_read_buf[4];
@@ -36,14 +37,33 @@ manikin_sensor_ctx_t dummy_ctx;
 #define VL53L4CD_I2C_ADDR                  0x52u
 #define VL53L4CD_SYSTEM_FRESH_OUT_OF_RESET 0x0016u
 #define VL53L4CD_IDENTIFICATION_MODEL_ID   0x010Fu
-#define VL53L4CD_RESULT_FINAL_RANGE_MM     0x0096u
+#define VL53L4CD_RESULT_RANGE_STATUS       0x0089u
 #define VL53L4CD_SYSTEM_INTERRUPT_CLEAR    0x0086u
+#define VL53L4CD_SYSTEM_START              0x0087u
+#define VL53L4CD_INTERMEASUREMENT_MS       0x006Cu
+#define VL53L4CD_OSC_FREQUENCY             0x0006u
+#define VL53L4CD_RESULT_BURST_SIZE         15u
 
 // For simulating sensor values
 uint16_t cur_reg;
 uint8_t  data_ready    = 1;
 uint8_t  model_id_high = 0xEA;
 uint8_t  model_id_low  = 0xCC;
+uint8_t  last_start    = 0;
+uint32_t last_inter_measurement;
+int      osc_reads;
+
+// Fill a result burst the way the sensor lays it out, starting at RESULT_RANGE_STATUS
+static void
+fill_result_burst (uint8_t *bytes, uint16_t distance_mm)
+{
+    memset(bytes, 0, VL53L4CD_RESULT_BURST_SIZE);
+    bytes[0]  = 9u;    // Raw status of a valid range
+    bytes[5]  = 0x00u; // Signal rate 100 * 8 kcps
+    bytes[6]  = 0x64u;
+    bytes[13] = GET_UPPER_8_BITS_OF_SHORT(distance_mm);
+    bytes[14] = GET_LOWER_8_BITS_OF_SHORT(distance_mm);
+}
 
 // Custom read function that simulates a large distance value (over 255mm)
 size_t
@@ -65,12 +85,11 @@ custom_read_large_distance (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t
         bytes[0] = data_ready; // Data ready flag
         cur_reg  = 0;
     }
-    else if (cur_reg == VL53L4CD_RESULT_FINAL_RANGE_MM && len >= 2)
+    else if (cur_reg == VL53L4CD_RESULT_RANGE_STATUS && len == VL53L4CD_RESULT_BURST_SIZE)
     {
         // Return simulated distance of 500mm (larger than 255)
-        bytes[0] = 0x01; // high byte
-        bytes[1] = 0xF4; // low byte (500 decimal = 0x01F4)
-        cur_reg  = 0;
+        fill_result_burst(bytes, 500u);
+        cur_reg = 0;
     }
     else
     {
@@ -94,6 +113,19 @@ custom_write_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, const uint8_t *b
     {
         cur_reg = CONSTRUCT_SHORT_FROM_BYTES(bytes[0], bytes[1]);
     }
+    if (len == 3 && cur_reg == VL53L4CD_SYSTEM_START)
+    {
+        last_start = bytes[2];
+    }
+    if (len == 6 && cur_reg == VL53L4CD_INTERMEASUREMENT_MS)
+    {
+        last_inter_measurement = ((uint32_t)bytes[2] << 24) | ((uint32_t)bytes[3] << 16)
+                                 | ((uint32_t)bytes[4] << 8) | bytes[5];
+    }
+    if (len == 2 && cur_reg == VL53L4CD_OSC_FREQUENCY)
+    {
+        osc_reads++;
+    }
     return len;
 }
 
@@ -119,12 +151,11 @@ custom_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, s
         bytes[0] = data_ready;
         cur_reg  = 0;
     }
-    else if (cur_reg == VL53L4CD_RESULT_FINAL_RANGE_MM && len >= 2)
+    else if (cur_reg == VL53L4CD_RESULT_RANGE_STATUS && len == VL53L4CD_RESULT_BURST_SIZE)
     {
         // Return simulated distance of 150mm
-        bytes[0] = 0x00;
-        bytes[1] = 0x96; // 150 decimal
-        cur_reg  = 0;
+        fill_result_burst(bytes, 150u);
+        cur_reg = 0;
     }
     else
     {
@@ -141,6 +172,14 @@ custom_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, s
     return len;
 }
 
+size_t
+custom_read_unknown_status (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, size_t len)
+{
+    fill_result_burst(bytes, 40u);
+    bytes[0] = 0x1Fu; // Beyond the translation table
+    return len;
+}
+
 void
 reset_mocks ()
 {
@@ -149,8 +188,12 @@ reset_mocks ()
     RESET_FAKE(i2c_hal_read_bytes);
     RESET_FAKE(i2c_hal_write_bytes);
     RESET_FAKE(i2c_hal_deinit);
-    data_ready = 1;
-    cur_reg    = 0;
+    data_ready             = 1;
+    cur_reg                = 0;
+    last_start             = 0;
+    last_inter_measurement = 0xFFFFFFFFu;
+    osc_reads              = 0;
+    dummy_ctx.driver_ctx   = NULL;
 }
 
 TEST_CASE("vl53l4cd_init_sensor handles null parameter", "[vl53l4cd][REQ-F1]")
@@ -192,12 +235,36 @@ TEST_CASE("vl53l4cd_read_sensor reads successfully", "[vl53l4cd][REQ-F1]")
     dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
     i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
     i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
-    uint8_t read_buf[1]                  = { 0 };
+    uint8_t read_buf[VL53L4CD_SAMPLE_SIZE] = { 0 };
     REQUIRE(vl53l4cd_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
-    REQUIRE(read_buf[0] == 150);
+    vl53l4cd_sample_data_t sample;
+    REQUIRE(vl53l4cd_parse_raw_data(read_buf, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.distance_mm == 150);
+    REQUIRE(sample.range_status == VL53L4CD_RANGE_STATUS_VALID);
+    REQUIRE(sample.signal_rate_kcps == 800);
+    // Status poll, one result burst and the interrupt clear
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 2);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 3);
 }
 
-TEST_CASE("vl53l4cd_read_sensor clips distances over 255mm to 255", "[vl53l4cd][REQ-F1]")
+TEST_CASE("vl53l4cd_read_sensor skips the status poll in drdy mode", "[vl53l4cd][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
+    dummy_ctx.drdy_irq                   = 1;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    uint8_t read_buf[VL53L4CD_SAMPLE_SIZE] = { 0 };
+    REQUIRE(vl53l4cd_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    dummy_ctx.drdy_irq = 0;
+    REQUIRE(CONSTRUCT_SHORT_FROM_BYTES(read_buf[0], read_buf[1]) == 150);
+    // Only the distance is read, the interrupt is still cleared afterwards
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 1);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 2);
+}
+
+TEST_CASE("vl53l4cd_read_sensor keeps distances over 255mm", "[vl53l4cd][REQ-F1]")
 {
     reset_mocks();
     dummy_ctx.i2c                        = &handle;
@@ -205,9 +272,82 @@ TEST_CASE("vl53l4cd_read_sensor clips distances over 255mm to 255", "[vl53l4cd][
     i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
     i2c_hal_read_bytes_fake.custom_fake  = custom_read_large_distance;
 
-    uint8_t read_buf[1] = { 0 };
+    uint8_t read_buf[VL53L4CD_SAMPLE_SIZE] = { 0 };
+    REQUIRE(vl53l4cd_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(CONSTRUCT_SHORT_FROM_BYTES(read_buf[0], read_buf[1]) == 500);
+}
+
+TEST_CASE("vl53l4cd_read_sensor maps unknown range statuses to undefined", "[vl53l4cd][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_unknown_status;
+    dummy_ctx.drdy_irq                   = 1;
+    uint8_t read_buf[VL53L4CD_SAMPLE_SIZE] = { 0 };
     REQUIRE(vl53l4cd_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
-    REQUIRE(read_buf[0] == 255); // Should be clipped to 255
+    dummy_ctx.drdy_irq = 0;
+    REQUIRE(read_buf[2] == VL53L4CD_RANGE_STATUS_UNDEFINED);
+}
+
+TEST_CASE("vl53l4cd_init_sensor applies the profile in driver_ctx", "[vl53l4cd][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    vl53l4cd_profile_t profile           = { 20, 0, 0, 0 };
+    dummy_ctx.driver_ctx                 = &profile;
+    REQUIRE(vl53l4cd_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    // Continuous ranging, the calibration is cached in the profile
+    REQUIRE(last_start == 0x21u);
+    REQUIRE(last_inter_measurement == 0);
+    REQUIRE(osc_reads == 1);
+    REQUIRE(profile.osc_frequency == 0x0101u);
+    REQUIRE(profile.clock_pll == 0x0101u);
+
+    // A re-initialization reuses the cached calibration
+    REQUIRE(vl53l4cd_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(osc_reads == 1);
+}
+
+TEST_CASE("vl53l4cd_set_profile switches to autonomous ranging", "[vl53l4cd][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    vl53l4cd_profile_t profile           = { 20, 100, 0x0BE0u, 1000u };
+    REQUIRE(vl53l4cd_set_profile(&dummy_ctx, &profile) == MANIKIN_STATUS_OK);
+    REQUIRE(dummy_ctx.driver_ctx == &profile);
+    REQUIRE(last_start == 0x40u);
+    // 100 ms in PLL clocks, with the 1.055 correction factor
+    REQUIRE(last_inter_measurement == 105500u);
+    // The calibration was filled in already, so it is not read
+    REQUIRE(osc_reads == 0);
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 0);
+}
+
+TEST_CASE("vl53l4cd_set_profile rejects timings outside the sensor limits", "[vl53l4cd][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL53L4CD_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    vl53l4cd_profile_t too_short         = { 1, 0, 0, 0 };
+    vl53l4cd_profile_t too_long          = { 201, 0, 0, 0 };
+    vl53l4cd_profile_t overlapping       = { 50, 50, 0, 0 };
+    REQUIRE(vl53l4cd_set_profile(&dummy_ctx, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
+    REQUIRE(vl53l4cd_set_profile(&dummy_ctx, &too_short) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    REQUIRE(vl53l4cd_set_profile(&dummy_ctx, &too_long) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    REQUIRE(vl53l4cd_set_profile(&dummy_ctx, &overlapping) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    // Ranging keeps running with the old timing
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 0);
+    REQUIRE(dummy_ctx.driver_ctx == NULL);
 }
 
 TEST_CASE("vl53l4cd_deinit_sensor handles null context", "[vl53l4cd][REQ-F1]")
@@ -234,7 +374,7 @@ TEST_CASE("vl53l4cd_read_sensor reinitializes when needed", "[vl53l4cd][REQ-F1]"
     dummy_ctx.needs_reinit               = 1; // Needs reinitialization
     i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
     i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
-    uint8_t read_buf[1]                  = { 0 };
+    uint8_t read_buf[VL53L4CD_SAMPLE_SIZE] = { 0 };
     REQUIRE(vl53l4cd_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
     REQUIRE(dummy_ctx.needs_reinit == 0); // Flag should be cleared
 }
@@ -247,17 +387,20 @@ TEST_CASE("vl53l4cd_parse_raw_data handles null raw_data", "[vl53l4cd][REQ-F3]")
 
 TEST_CASE("vl53l4cd_parse_raw_data handles null data pointer", "[vl53l4cd][REQ-F3]")
 {
-    uint8_t dummy_raw[1] = { 0x00 }; // Dummy distance data
+    uint8_t dummy_raw[VL53L4CD_SAMPLE_SIZE] = { 0x00 }; // Dummy distance data
     REQUIRE(vl53l4cd_parse_raw_data(dummy_raw, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
 }
 
 TEST_CASE("vl53l4cd_parse_raw_data successfully converts valid raw data", "[vl53l4cd][REQ-F3]")
 {
-    uint8_t                raw_data[1] = { 0x5A }; // Example: 90 mm
+    // Example: 1300 mm, signal too low, 2 * 8 kcps
+    uint8_t                raw_data[VL53L4CD_SAMPLE_SIZE] = { 0x05, 0x14, 0x02, 0x00, 0x02 };
     vl53l4cd_sample_data_t parsed_data;
 
     REQUIRE(vl53l4cd_parse_raw_data(raw_data, &parsed_data) == MANIKIN_STATUS_OK);
-    REQUIRE(parsed_data.distance_mm == 0x5A);
+    REQUIRE(parsed_data.distance_mm == 1300);
+    REQUIRE(parsed_data.range_status == VL53L4CD_RANGE_STATUS_SIGNAL_LOW);
+    REQUIRE(parsed_data.signal_rate_kcps == 16);
 }
 
 int
@@ -27,6 +27,7 @@
 #include "vl6180x/vl6180x.h"
 #include "fake_i2c_functions.h"
 #include "common/manikin_bit_manipulation.h"
+#include <map>
 
 // Common mocks and types
 static uint8_t       dummy_read_buf[4];
@@ -35,10 +36,24 @@ manikin_sensor_ctx_t dummy_ctx;
 
 #define VL6180X_I2C_ADDR           0x29u
 #define VL6180X_FRESH_OUT_OF_RESET 0x0016u
+#define VL6180X_RESULT_RANGE_STATUS 0x004Du
+#define VL6180X_RESULT_RANGE_VAL    0x0062u
+#define VL6180X_INTERRUPT_CLEAR     0x0015u
+#define VL6180X_SYSRANGE_START      0x0018u
+#define VL6180X_SYSALS_START        0x0038u
+#define VL6180X_INTERLEAVED_MODE    0x02A3u
 
 // NOTE: Used for simulating sensor detection
 uint16_t cur_reg;
 
+// Simulated result registers
+uint8_t range_status;
+uint8_t interrupt_status;
+uint8_t range_val;
+
+// Last value written to each register
+std::map<uint16_t, uint8_t> written;
+
 size_t
 custom_write_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, const uint8_t *bytes, size_t len)
 {
@@ -46,6 +61,10 @@ custom_write_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, const uint8_t *b
     {
         cur_reg = CONSTRUCT_SHORT_FROM_BYTES(bytes[0], bytes[1]);
     }
+    if (len == 3)
+    {
+        written[cur_reg] = bytes[2];
+    }
     return len;
 }
 
@@ -58,6 +77,24 @@ custom_read_func (manikin_i2c_inst_t handle, uint8_t i2c_addr, uint8_t *bytes, s
         // Signal that sensor is ready
         bytes[0] = 1u;
     }
+    else if (cur_reg == VL6180X_RESULT_RANGE_STATUS && len >= 3)
+    {
+        cur_reg  = 0;
+        bytes[0] = range_status;
+        bytes[1] = 0u;
+        bytes[2] = interrupt_status;
+        if (len == 5)
+        {
+            // ALS count of 300
+            bytes[3] = 0x01u;
+            bytes[4] = 0x2Cu;
+        }
+    }
+    else if (cur_reg == VL6180X_RESULT_RANGE_VAL)
+    {
+        cur_reg  = 0;
+        bytes[0] = range_val;
+    }
     else
     {
         cur_reg  = 0u;
@@ -74,6 +111,12 @@ reset_mocks ()
     RESET_FAKE(i2c_hal_read_bytes);
     RESET_FAKE(i2c_hal_write_bytes);
     RESET_FAKE(i2c_hal_deinit);
+    written.clear();
+    range_status         = 0x01u; // No error, device ready
+    interrupt_status     = 0x04u; // New range sample
+    range_val            = 200u;
+    dummy_ctx.drdy_irq   = 0;
+    dummy_ctx.driver_ctx = NULL;
 }
 
 TEST_CASE("vl6180x_init_sensor handles null parameter", "[vl6180x][REQ-F1]")
@@ -113,8 +156,126 @@ TEST_CASE("vl6180x_read_sensor reads successfully", "[vl6180x][REQ-F1]")
     dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
     i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
     i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
-    uint8_t read_buf[1]                  = { 0 };
+    uint8_t read_buf[VL6180X_SAMPLE_SIZE] = { 0 };
+    REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    vl6180x_sample_data_t sample;
+    REQUIRE(vl6180x_parse_raw_data(read_buf, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.distance_mm == 200);
+    REQUIRE(sample.range_error == 0);
+    REQUIRE(sample.als_mlux == 0);
+    REQUIRE(dummy_ctx.sample.status == MANIKIN_STATUS_OK);
+    // Status burst, range read and one write clearing all interrupts
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 2);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 3);
+    REQUIRE(written[VL6180X_INTERRUPT_CLEAR] == 0x07u);
+}
+
+TEST_CASE("vl6180x_read_sensor skips the sample without a new range", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    interrupt_status                     = 0x00u;
+
+    const uint32_t seq                           = dummy_ctx.sample.seq;
+    uint8_t        read_buf[VL6180X_SAMPLE_SIZE] = { 0xAA, 0xAA, 0xAA, 0xAA };
+    REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    // Only the status was read, nothing is stamped or cleared
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 1);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 1);
+    REQUIRE(dummy_ctx.sample.seq == seq);
+    REQUIRE(read_buf[0] == 0xAA);
+}
+
+TEST_CASE("vl6180x_read_sensor accepts a 0mm range", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    range_val                            = 0u;
+    uint8_t read_buf[VL6180X_SAMPLE_SIZE] = { 0xAA };
+    REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(read_buf[0] == 0);
+    REQUIRE(read_buf[1] == 0);
+
+    // A range error is reported next to the distance instead
+    range_status = 0xB1u; // Range underflow
+    REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    REQUIRE(read_buf[1] == 0x0Bu);
+}
+
+TEST_CASE("vl6180x_init_sensor starts continuous ranging", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    REQUIRE(vl6180x_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(written[VL6180X_SYSRANGE_START] == 0x03u);
+    REQUIRE(written[VL6180X_INTERLEAVED_MODE] == 0x00u);
+    REQUIRE(written.count(VL6180X_SYSALS_START) == 0);
+}
+
+TEST_CASE("vl6180x interleaved mode reads the ambient light with the range", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    vl6180x_config_t config              = { 1, VL6180X_INTERLEAVED_MIN_PERIOD };
+    dummy_ctx.driver_ctx                 = &config;
+    REQUIRE(vl6180x_init_sensor(&dummy_ctx) == MANIKIN_STATUS_OK);
+    REQUIRE(written[VL6180X_INTERLEAVED_MODE] == 0x01u);
+    REQUIRE(written[VL6180X_SYSALS_START] == 0x03u);
+    REQUIRE(written.count(VL6180X_SYSRANGE_START) == 0);
+
+    uint8_t read_buf[VL6180X_SAMPLE_SIZE] = { 0 };
+    REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    vl6180x_sample_data_t sample;
+    REQUIRE(vl6180x_parse_raw_data(read_buf, &sample) == MANIKIN_STATUS_OK);
+    REQUIRE(sample.distance_mm == 200);
+    REQUIRE(sample.als_mlux == 300u * 16u);
+    dummy_ctx.driver_ctx = NULL;
+}
+
+TEST_CASE("vl6180x interleaved mode needs room for the ALS integration", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    vl6180x_config_t config              = { 1, VL6180X_INTERLEAVED_MIN_PERIOD - 1u };
+    dummy_ctx.driver_ctx                 = &config;
+    REQUIRE(vl6180x_init_sensor(&dummy_ctx) == MANIKIN_STATUS_ERR_INVALID_CONFIG);
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 0);
+    dummy_ctx.driver_ctx = NULL;
+}
+
+TEST_CASE("vl6180x_read_sensor clears the data-ready interrupt in drdy mode", "[vl6180x][REQ-F1]")
+{
+    reset_mocks();
+    dummy_ctx.i2c                        = &handle;
+    dummy_ctx.i2c_addr                   = VL6180X_I2C_ADDR;
+    dummy_ctx.drdy_irq                   = 1;
+    i2c_hal_write_bytes_fake.custom_fake = custom_write_func;
+    i2c_hal_read_bytes_fake.custom_fake  = custom_read_func;
+    interrupt_status                     = 0x00u; // The line is not gated on the status
+    uint8_t read_buf[VL6180X_SAMPLE_SIZE] = { 0 };
     REQUIRE(vl6180x_read_sensor(&dummy_ctx, read_buf) == MANIKIN_STATUS_OK);
+    dummy_ctx.drdy_irq = 0;
+    REQUIRE(read_buf[0] == 200);
+    REQUIRE(i2c_hal_read_bytes_fake.call_count == 2);
+    // Status and range register address writes, followed by SYSTEM_INTERRUPT_CLEAR = 0x07
+    REQUIRE(i2c_hal_write_bytes_fake.call_count == 3);
+    REQUIRE(cur_reg == 0x0015u);
+    REQUIRE(written[VL6180X_INTERRUPT_CLEAR] == 0x07u);
 }
 
 TEST_CASE("vl6180x_deinit_sensor handles null context", "[vl6180x][REQ-F1]")
@@ -141,17 +302,20 @@ TEST_CASE("vl6180x_parse_raw_data handles null raw_data", "[vl6180x][REQ-F3]")
 
 TEST_CASE("vl6180x_parse_raw_data handles null data pointer", "[vl6180x][REQ-F3]")
 {
-    uint8_t dummy_raw[1] = { 0x00 }; // One-byte dummy data
+    uint8_t dummy_raw[VL6180X_SAMPLE_SIZE] = { 0x00 }; // Dummy data
     REQUIRE(vl6180x_parse_raw_data(dummy_raw, NULL) == MANIKIN_STATUS_ERR_NULL_PARAM);
 }
 
 TEST_CASE("vl6180x_parse_raw_data successfully converts valid raw data", "[vl6180x][REQ-F3]")
 {
-    uint8_t               raw_data[1] = { 0x3A }; // Example distance: 58 mm
+    // Example distance: 58 mm, no range error, ALS count of 2
+    uint8_t               raw_data[VL6180X_SAMPLE_SIZE] = { 0x3A, 0x00, 0x00, 0x02 };
     vl6180x_sample_data_t parsed_data;
 
     REQUIRE(vl6180x_parse_raw_data(raw_data, &parsed_data) == MANIKIN_STATUS_OK);
     REQUIRE(parsed_data.distance_mm == 0x3A);
+    REQUIRE(parsed_data.range_error == 0);
+    REQUIRE(parsed_data.als_mlux == 32);
 }
 
 int
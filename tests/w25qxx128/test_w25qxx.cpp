@@ -27,6 +27,8 @@
 #include <w25qxx128/w25qxx128.h>
 #include "fake_spi_functions.h"
 #include "fake_timer_functions.h"
+#include "virtual_clock.h"
+#include "manikin_platform.h"
 
 #include <vector>
 #include <algorithm>
@@ -320,6 +322,37 @@ TEST_CASE("w25qxx_write handles SPI write timeout", "[write][timeout][REQ-F6][RE
     CHECK(spi_hal_write_bytes_fake.call_count == 2); // Expecting 2 write calls
 }
 
+// NOTE: Every status poll of the flash takes 20 us on the (virtual) bus
+size_t
+always_busy_spi_read (manikin_spi_inst_t inst, uint8_t *data, size_t len)
+{
+    virtual_clock_advance_us(20);
+    std::fill(data, data + len, 0x01u);
+    return len;
+}
+
+TEST_CASE("w25qxx_write gives up on a flash that stays busy", "[write][timeout][REQ-F6][REQ-F7]")
+{
+    reset_spi_mocks();
+    virtual_clock_reset();
+    virtual_clock_attach();
+
+    uint8_t                  spi_handle;
+    manikin_spi_cs_t         cs_handle = { .port = 5, .pin = 1 };
+    manikin_spi_memory_ctx_t mem_ctx
+        = { .spi = &spi_handle, .spi_cs = cs_handle, .mem_size = 16000000, .fault_cnt = 0 };
+    uint8_t test_data[4] = { 1u, 2u, 3u, 4u };
+
+    spi_hal_read_bytes_fake.custom_fake  = &always_busy_spi_read;
+    spi_hal_write_bytes_fake.custom_fake = &custom_spi_write;
+    REQUIRE(w25qxx_write(&mem_ctx, test_data, 0, sizeof(test_data))
+            == MANIKIN_MEMORY_RESULT_ERROR);
+    REQUIRE(mem_ctx.fault_cnt == 1);
+    // Polled until MANIKIN_SOFTWARE_MAX_TIMEOUT ticks passed, not a poll longer
+    REQUIRE(timer_hal_get_tick() == MANIKIN_SOFTWARE_MAX_TIMEOUT);
+    REQUIRE(spi_hal_read_bytes_fake.call_count == MANIKIN_HAL_TICK_PERIOD_US / 20u);
+}
+
 TEST_CASE("w25qxx_write handles invalid data during write", "[write][invalid_data][REQ-F6]")
 {
     reset_spi_mocks();
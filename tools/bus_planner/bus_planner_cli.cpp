@@ -0,0 +1,205 @@
+/**
+ * @file            bus_planner_cli.cpp
+ * @brief           Command line front-end of the bus capacity planner
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "ads7138/ads7138.h"
+#include "bmm350/bmm350_driver.h"
+#include "bus_planner/bus_planner.h"
+#include "sdp810/sdp810.h"
+#include "vl53l4cd/vl53l4cd.h"
+#include "vl6180x/vl6180x.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct known_driver
+    {
+        const char            *name;
+        bus_planner_transfer_t transfer;
+    };
+
+    const known_driver known_drivers[] = {
+        { "ads7138", BUS_PLANNER_DRIVER_TRANSFER(ADS7138) },
+        { "ads7138_auto", BUS_PLANNER_DRIVER_TRANSFER(ADS7138_AUTO) },
+        { "ads7138_idle", BUS_PLANNER_DRIVER_TRANSFER(ADS7138_IDLE) },
+        { "bmm350", BUS_PLANNER_DRIVER_TRANSFER(BMM350) },
+        { "sdp810", BUS_PLANNER_DRIVER_TRANSFER(SDP810) },
+        { "vl53l4cd", BUS_PLANNER_DRIVER_TRANSFER(VL53L4CD) },
+        { "vl6180x", BUS_PLANNER_DRIVER_TRANSFER(VL6180X) },
+    };
+
+    void
+    print_usage (const char *prog)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--speed hz] [--overhead us] [--budget permille] [--downgrade]\n"
+                     "          sensor@rate[:min_rate]...\n"
+                     "sensor is one of ads7138, ads7138_auto, ads7138_idle, bmm350, sdp810,\n"
+                     "vl53l4cd, vl6180x or a custom transfer given as <transactions>x<bytes>,\n"
+                     "e.g. 2x12@200\n",
+                     prog);
+    }
+
+    bool
+    parse_sensor (const std::string &arg, std::string &name, bus_planner_sensor_t &sensor)
+    {
+        const size_t at = arg.find('@');
+        if (at == std::string::npos)
+        {
+            return false;
+        }
+        name = arg.substr(0, at);
+
+        bool found = false;
+        for (const known_driver &driver : known_drivers)
+        {
+            if (name == driver.name)
+            {
+                sensor.transfer = driver.transfer;
+                found           = true;
+            }
+        }
+        unsigned transactions = 0;
+        unsigned bytes        = 0;
+        if (!found && std::sscanf(name.c_str(), "%ux%u", &transactions, &bytes) == 2)
+        {
+            sensor.transfer.transactions = static_cast<uint8_t>(transactions);
+            sensor.transfer.bytes        = static_cast<uint16_t>(bytes);
+            found                        = true;
+        }
+
+        unsigned rate     = 0;
+        unsigned min_rate = 0;
+        const int fields  = std::sscanf(arg.c_str() + at + 1, "%u:%u", &rate, &min_rate);
+        sensor.rate_hz     = static_cast<uint16_t>(rate);
+        sensor.min_rate_hz = static_cast<uint16_t>(min_rate);
+        return found && fields >= 1;
+    }
+
+    const char *
+    status_to_string (manikin_status_t status)
+    {
+        switch (status)
+        {
+            case MANIKIN_STATUS_OK:
+                return "admitted";
+            case MANIKIN_STATUS_ERR_BUS_OVER_BUDGET:
+                return "OVER BUDGET";
+            default:
+                return "invalid configuration";
+        }
+    }
+} // namespace
+
+int
+main (int argc, char **argv)
+{
+    bus_planner_ctx_t                 ctx {};
+    std::vector<bus_planner_sensor_t> sensors;
+    std::vector<std::string>          names;
+
+    ctx.i2c_speed_hz            = MANIKIN_I2C_SPEED_400KHz;
+    ctx.transaction_overhead_us = 0;
+    ctx.budget_permille         = 700;
+    ctx.policy                  = BUS_PLANNER_POLICY_REJECT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--speed") == 0 && has_value)
+        {
+            ctx.i2c_speed_hz = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--overhead") == 0 && has_value)
+        {
+            ctx.transaction_overhead_us
+                = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--budget") == 0 && has_value)
+        {
+            ctx.budget_permille = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--downgrade") == 0)
+        {
+            ctx.policy = BUS_PLANNER_POLICY_DOWNGRADE;
+        }
+        else
+        {
+            std::string          name;
+            bus_planner_sensor_t sensor {};
+            if (argv[i][0] == '-' || !parse_sensor(argv[i], name, sensor))
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            names.push_back(name);
+            sensors.push_back(sensor);
+        }
+    }
+    if (sensors.empty())
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ctx.sensors                   = sensors.data();
+    ctx.sensor_cnt                = static_cast<uint8_t>(sensors.size());
+    const manikin_status_t status = bus_planner_plan(&ctx);
+
+    std::printf("I2C %u Hz, %u us/transaction overhead, budget %u.%u%%\n\n",
+                ctx.i2c_speed_hz,
+                ctx.transaction_overhead_us,
+                ctx.budget_permille / 10u,
+                ctx.budget_permille % 10u);
+    std::printf("%-10s %6s %7s %6s %9s %12s %10s\n",
+                "sensor",
+                "trans",
+                "bytes",
+                "rate",
+                "read us",
+                "latency us",
+                "period us");
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        const bus_planner_sensor_t &sensor = sensors[i];
+        std::printf("%-10s %6u %7u %6u %9u %12u %10u%s\n",
+                    names[i].c_str(),
+                    sensor.transfer.transactions,
+                    sensor.transfer.bytes,
+                    sensor.planned_rate_hz,
+                    sensor.read_time_us,
+                    sensor.worst_latency_us,
+                    sensor.planned_rate_hz ? 1000000u / sensor.planned_rate_hz : 0u,
+                    sensor.planned_rate_hz != sensor.rate_hz ? "  (downgraded)" : "");
+    }
+    std::printf("\nutilisation %u.%u%%: %s\n",
+                ctx.utilisation_permille / 10u,
+                ctx.utilisation_permille % 10u,
+                status_to_string(status));
+    return (status == MANIKIN_STATUS_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
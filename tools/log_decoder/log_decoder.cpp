@@ -0,0 +1,445 @@
+/**
+ * @file            log_decoder.cpp
+ * @brief           Multi-threaded host-side decoder for packet_parser session captures
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "log_decoder.hpp"
+#include "packet_batch/packet_batch.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace log_decoder
+{
+    namespace
+    {
+        constexpr uint8_t  start_byte     = 0x01;
+        constexpr uint8_t  colon          = 0x3A;
+        constexpr uint8_t  end_byte       = 0x17;
+        constexpr uint16_t crc16_poly     = 0x8D95;
+        constexpr size_t   frame_overhead = 6;
+        constexpr size_t   min_chunk_size = 64 * 1024;
+
+        using crc16_tables_t = std::array<std::array<uint16_t, 256>, 8>;
+
+        constexpr crc16_tables_t
+        make_crc16_tables ()
+        {
+            crc16_tables_t tables{};
+            for (unsigned byte = 0; byte < 256; byte++)
+            {
+                uint16_t crc = static_cast<uint16_t>(byte);
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc & 1u) ? static_cast<uint16_t>((crc >> 1) ^ crc16_poly)
+                                     : static_cast<uint16_t>(crc >> 1);
+                }
+                tables[0][byte] = crc;
+            }
+            for (size_t table = 1; table < tables.size(); table++)
+            {
+                for (unsigned byte = 0; byte < 256; byte++)
+                {
+                    const uint16_t prev    = tables[table - 1][byte];
+                    tables[table][byte]
+                        = static_cast<uint16_t>((prev >> 8) ^ tables[0][prev & 0xFFu]);
+                }
+            }
+            return tables;
+        }
+
+        constexpr crc16_tables_t crc16_tables = make_crc16_tables();
+
+        unsigned
+        resolve_thread_cnt (unsigned thread_cnt)
+        {
+            if (thread_cnt == 0)
+            {
+                thread_cnt = std::max(1u, std::thread::hardware_concurrency());
+            }
+            return thread_cnt;
+        }
+
+        /**
+         * @brief Run fn(worker_idx) on thread_cnt threads, the calling thread takes part as well
+         */
+        template <typename Fn>
+        void
+        run_parallel (unsigned thread_cnt, Fn &&fn)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(thread_cnt - 1);
+            for (unsigned i = 1; i < thread_cnt; i++)
+            {
+                workers.emplace_back(fn, i);
+            }
+            fn(0u);
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        /**
+         * @brief Greedy scan of all frames starting in [begin, end), frames may extend past end
+         */
+        void
+        scan_range (const uint8_t *data, size_t len, size_t begin, size_t end, scan_result &out)
+        {
+            size_t pos = begin;
+            while (pos < end)
+            {
+                // NOTE: memchr is vectorised by the C library, most bytes are skipped here
+                const void *hit = memchr(data + pos, start_byte, end - pos);
+                if (hit == nullptr)
+                {
+                    break;
+                }
+                pos                 = static_cast<size_t>(static_cast<const uint8_t *>(hit) - data);
+                const int payload_len = check_frame(data, len, pos);
+                if (payload_len >= 0)
+                {
+                    out.frames.push_back({ pos, static_cast<uint16_t>(payload_len) });
+                    pos += static_cast<size_t>(payload_len) + frame_overhead;
+                }
+                else
+                {
+                    out.crc_rejects += (payload_len == -2) ? 1u : 0u;
+                    pos++;
+                }
+            }
+        }
+
+        size_t
+        frame_end (const frame_ref &frame)
+        {
+            return frame.offset + frame.payload_len + frame_overhead;
+        }
+    } // namespace
+
+    uint16_t
+    crc16 (const uint8_t *data, size_t len)
+    {
+        uint16_t crc = 0xFFFF;
+        while (len >= 8)
+        {
+            crc ^= static_cast<uint16_t>(data[0] | (data[1] << 8));
+            crc = crc16_tables[7][crc & 0xFFu] ^ crc16_tables[6][crc >> 8]
+                  ^ crc16_tables[5][data[2]] ^ crc16_tables[4][data[3]]
+                  ^ crc16_tables[3][data[4]] ^ crc16_tables[2][data[5]]
+                  ^ crc16_tables[1][data[6]] ^ crc16_tables[0][data[7]];
+            data += 8;
+            len -= 8;
+        }
+        while (len-- > 0)
+        {
+            crc = static_cast<uint16_t>((crc >> 8) ^ crc16_tables[0][(crc ^ *data++) & 0xFFu]);
+        }
+        return crc;
+    }
+
+    int
+    check_frame (const uint8_t *data, size_t len, size_t offset)
+    {
+        if (len - offset < frame_overhead || data[offset] != start_byte
+            || data[offset + 2] != colon)
+        {
+            return -1;
+        }
+        const size_t payload_len = data[offset + 1];
+        if (len - offset < payload_len + frame_overhead
+            || data[offset + 5 + payload_len] != end_byte)
+        {
+            return -1;
+        }
+        const uint16_t received_crc = static_cast<uint16_t>(
+            data[offset + 3 + payload_len] | (data[offset + 4 + payload_len] << 8));
+        if (crc16(&data[offset + 3], payload_len) != received_crc)
+        {
+            return -2;
+        }
+        return static_cast<int>(payload_len);
+    }
+
+    scan_result
+    scan_frames_sequential (const uint8_t *data, size_t len)
+    {
+        scan_result result;
+        scan_range(data, len, 0, len, result);
+        return result;
+    }
+
+    scan_result
+    scan_frames (const uint8_t *data, size_t len, unsigned thread_cnt, size_t chunk_size)
+    {
+        thread_cnt = resolve_thread_cnt(thread_cnt);
+        if (chunk_size == 0)
+        {
+            // NOTE: A few chunks per thread keeps the threads busy when frame density varies
+            chunk_size = std::max(min_chunk_size, len / (thread_cnt * 4u) + 1u);
+        }
+        const size_t chunk_cnt = (len + chunk_size - 1) / chunk_size;
+        thread_cnt
+            = static_cast<unsigned>(std::min<size_t>(thread_cnt, std::max<size_t>(chunk_cnt, 1)));
+
+        //
+        // Phase 1: every chunk is scanned as if a frame starts at its first byte
+        //
+        std::vector<scan_result> chunk_results(chunk_cnt);
+        std::atomic<size_t>      next_chunk{ 0 };
+        run_parallel(thread_cnt, [&](unsigned) {
+            for (size_t chunk = next_chunk++; chunk < chunk_cnt; chunk = next_chunk++)
+            {
+                const size_t begin = chunk * chunk_size;
+                const size_t end   = std::min(len, begin + chunk_size);
+                scan_range(data, len, begin, end, chunk_results[chunk]);
+            }
+        });
+
+        //
+        // Phase 2: boundary fix-up. A frame found at the end of the previous chunk can overlap
+        // the first frames found in this chunk. Where that happens, the chunk's own scan
+        // skipped positions the sequential scan would have tried, so these are rescanned until
+        // both scans land on the same position again.
+        //
+        scan_result result;
+        size_t      pos = 0;
+        for (size_t chunk = 0; chunk < chunk_cnt; chunk++)
+        {
+            const std::vector<frame_ref> &frames = chunk_results[chunk].frames;
+            result.crc_rejects += chunk_results[chunk].crc_rejects;
+            const size_t chunk_end = std::min(len, (chunk + 1) * chunk_size);
+
+            size_t idx = 0;
+            while (true)
+            {
+                while (idx < frames.size() && frame_end(frames[idx]) <= pos)
+                {
+                    idx++;
+                }
+                if (idx >= frames.size() || frames[idx].offset >= pos || pos >= chunk_end)
+                {
+                    break;
+                }
+                // NOTE: pos lies inside a frame of this chunk, so the chunk scan never tried it
+                const int payload_len = check_frame(data, len, pos);
+                if (payload_len >= 0)
+                {
+                    result.frames.push_back({ pos, static_cast<uint16_t>(payload_len) });
+                    pos += static_cast<size_t>(payload_len) + frame_overhead;
+                }
+                else
+                {
+                    pos++;
+                }
+            }
+            for (; idx < frames.size(); idx++)
+            {
+                if (frames[idx].offset >= pos)
+                {
+                    result.frames.push_back(frames[idx]);
+                    pos = frame_end(frames[idx]);
+                }
+            }
+            pos = std::max(pos, chunk_end);
+        }
+        return result;
+    }
+
+    decode_result
+    decode_batches (const uint8_t *data, const std::vector<frame_ref> &frames, unsigned thread_cnt)
+    {
+        thread_cnt = resolve_thread_cnt(thread_cnt);
+        thread_cnt = static_cast<unsigned>(
+            std::min<size_t>(thread_cnt, std::max<size_t>(frames.size(), 1)));
+
+        //
+        // Every thread decodes a contiguous range of frames into its own columns, the columns
+        // are concatenated in frame order afterwards so sample order is preserved.
+        //
+        std::vector<decode_result> partial(thread_cnt);
+        run_parallel(thread_cnt, [&](unsigned worker) {
+            const size_t   begin = frames.size() * worker / thread_cnt;
+            const size_t   end   = frames.size() * (worker + 1) / thread_cnt;
+            decode_result &out   = partial[worker];
+            // NOTE: Direct lookup by sensor id, std::map nodes stay put while inserting
+            std::array<sensor_columns *, 256> lookup{};
+            for (size_t i = begin; i < end; i++)
+            {
+                const packet_parser_cmd_t cmd
+                    = { frames[i].payload_len, &data[frames[i].offset + 3] };
+                packet_batch_reader_t reader;
+                packet_batch_sample_t sample;
+                if (packet_batch_reader_init(&reader, &cmd) != MANIKIN_STATUS_OK)
+                {
+                    out.undecodable_frames++;
+                    continue;
+                }
+                while (reader.remaining > 0)
+                {
+                    if (packet_batch_reader_next(&reader, &sample) != MANIKIN_STATUS_OK)
+                    {
+                        out.undecodable_frames++;
+                        break;
+                    }
+                    sensor_columns *&columns = lookup[sample.sensor_id];
+                    if (columns == nullptr)
+                    {
+                        columns             = &out.sensors[sample.sensor_id];
+                        columns->sensor_id  = sample.sensor_id;
+                        columns->sample_len = sample.len;
+                    }
+                    else if (columns->sample_len != sample.len)
+                    {
+                        out.length_mismatches++;
+                        continue;
+                    }
+                    columns->ticks.push_back(sample.tick);
+                    columns->samples.insert(
+                        columns->samples.end(), sample.data, sample.data + sample.len);
+                }
+            }
+        });
+
+        decode_result result;
+        for (decode_result &part : partial)
+        {
+            result.undecodable_frames += part.undecodable_frames;
+            result.length_mismatches += part.length_mismatches;
+            for (auto &[sensor_id, columns] : part.sensors)
+            {
+                auto [it, inserted] = result.sensors.try_emplace(sensor_id, std::move(columns));
+                if (inserted)
+                {
+                    continue;
+                }
+                sensor_columns &merged = it->second;
+                if (merged.sample_len != columns.sample_len)
+                {
+                    result.length_mismatches += columns.count();
+                    continue;
+                }
+                merged.ticks.insert(merged.ticks.end(), columns.ticks.begin(), columns.ticks.end());
+                merged.samples.insert(
+                    merged.samples.end(), columns.samples.begin(), columns.samples.end());
+            }
+        }
+        return result;
+    }
+
+    std::vector<uint8_t>
+    synthesize_capture (size_t target_len, size_t corrupt_every, uint32_t seed)
+    {
+        constexpr uint8_t sensor_lens[] = { 6, 2, 12, 16 };
+
+        std::mt19937          rng(seed);
+        std::vector<uint8_t>  capture;
+        std::array<uint8_t, PACKET_PARSER_MAX_PAYLOAD_LEN> batch_buf;
+        std::array<uint8_t, PACKET_PARSER_MAX_PAYLOAD_LEN + frame_overhead> frame;
+        std::array<uint8_t, 16> sample;
+        packet_batch_ctx_t    batch     = {};
+        packet_parser_cmd_t   cmd       = {};
+        uint32_t              tick      = 0;
+        size_t                frame_cnt = 0;
+
+        batch.buf      = batch_buf.data();
+        batch.buf_size = batch_buf.size();
+        batch.max_samples = 32;
+        packet_batch_init(&batch);
+        capture.reserve(target_len + frame.size());
+        while (capture.size() < target_len)
+        {
+            const uint8_t sensor_id = static_cast<uint8_t>(tick % 4u);
+            for (uint8_t i = 0; i < sensor_lens[sensor_id]; i++)
+            {
+                sample[i] = static_cast<uint8_t>(rng());
+            }
+            if (packet_batch_add(&batch, sensor_id, tick, sample.data(), sensor_lens[sensor_id])
+                == MANIKIN_STATUS_OK)
+            {
+                tick++;
+                continue;
+            }
+
+            packet_batch_flush(&batch, &cmd);
+            packet_parser_encapsulate(&cmd, frame.data(), frame.size());
+            const size_t frame_len = cmd.len + frame_overhead;
+            if (corrupt_every != 0 && ++frame_cnt % corrupt_every == 0)
+            {
+                frame[3 + rng() % cmd.len] ^= static_cast<uint8_t>(1u << (rng() % 8u));
+            }
+            capture.insert(capture.end(), frame.begin(), frame.begin() + frame_len);
+            for (uint32_t garbage = rng() % 4u; garbage > 0; garbage--)
+            {
+                capture.push_back(static_cast<uint8_t>(rng()));
+            }
+        }
+        return capture;
+    }
+
+    mapped_file::mapped_file (const std::string &path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("unable to open " + path);
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("unable to stat " + path);
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+        if (size_ > 0)
+        {
+            void *map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("unable to map " + path);
+            }
+            // NOTE: Chunks are read front-to-back, let the kernel read ahead aggressively
+            madvise(map, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const uint8_t *>(map);
+        }
+        close(fd);
+    }
+
+    mapped_file::~mapped_file ()
+    {
+        if (data_ != nullptr)
+        {
+            munmap(const_cast<uint8_t *>(data_), size_);
+        }
+    }
+} // namespace log_decoder
@@ -0,0 +1,152 @@
+/**
+ * @file            log_decoder.hpp
+ * @brief           Multi-threaded host-side decoder for packet_parser session captures
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#ifndef LOG_DECODER_HPP
+#define LOG_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace log_decoder
+{
+    /**
+     * @brief Location of one valid packet_parser frame inside a capture
+     */
+    struct frame_ref
+    {
+        size_t   offset;      ///< Offset of the START byte
+        uint16_t payload_len; ///< Number of payload bytes
+    };
+
+    struct scan_result
+    {
+        std::vector<frame_ref> frames;
+        size_t                 crc_rejects = 0; ///< Candidates with valid framing but bad CRC
+    };
+
+    /**
+     * @brief Samples of one sensor stored column-wise
+     *        Sample i consists of ticks[i] and samples[i * sample_len .. (i + 1) * sample_len).
+     */
+    struct sensor_columns
+    {
+        uint8_t               sensor_id  = 0;
+        uint8_t               sample_len = 0;
+        std::vector<uint32_t> ticks;
+        std::vector<uint8_t>  samples;
+
+        size_t
+        count () const
+        {
+            return ticks.size();
+        }
+    };
+
+    struct decode_result
+    {
+        std::map<uint8_t, sensor_columns> sensors;
+        size_t undecodable_frames = 0; ///< Frames whose payload is not a valid sample batch
+        size_t length_mismatches  = 0; ///< Samples dropped because their length changed
+    };
+
+    /**
+     * @brief CRC16 as used by packet_parser (poly 0x8D95 reflected, init 0xFFFF)
+     *        Table driven, slicing-by-8: eight bytes per step without a bit loop.
+     */
+    uint16_t crc16(const uint8_t *data, size_t len);
+
+    /**
+     * @brief Check whether a valid frame starts at offset
+     * @return Payload length when valid, -1 when framing is invalid, -2 when only the CRC fails
+     */
+    int check_frame(const uint8_t *data, size_t len, size_t offset);
+
+    /**
+     * @brief Reference single-threaded scan, resyncs byte-by-byte after invalid data
+     */
+    scan_result scan_frames_sequential(const uint8_t *data, size_t len);
+
+    /**
+     * @brief Find all frames, scanning chunks of the capture in parallel
+     *        Every chunk is scanned independently, a fix-up pass then stitches the chunks
+     *        together, so the result is identical to scan_frames_sequential().
+     * @param thread_cnt Number of worker threads, 0 == all cores
+     * @param chunk_size Bytes per work item, 0 == derived from len and thread_cnt
+     */
+    scan_result scan_frames(const uint8_t *data,
+                            size_t         len,
+                            unsigned       thread_cnt,
+                            size_t         chunk_size = 0);
+
+    /**
+     * @brief Decode the packet_batch payloads of all frames into per-sensor columns
+     * @param thread_cnt Number of worker threads, 0 == all cores
+     */
+    decode_result decode_batches(const uint8_t                *data,
+                                 const std::vector<frame_ref> &frames,
+                                 unsigned                      thread_cnt);
+
+    /**
+     * @brief Build a synthetic capture of sample batches for benchmarking and testing
+     *        Frames carry batches of 4 interleaved sensors, every corrupt_every-th frame gets
+     *        a flipped payload bit and random garbage is inserted between frames.
+     * @param target_len Approximate capture size in bytes
+     * @param corrupt_every Corrupt one in this many frames, 0 == never
+     * @param seed Seed for the garbage and sample contents
+     */
+    std::vector<uint8_t> synthesize_capture(size_t target_len, size_t corrupt_every, uint32_t seed);
+
+    /**
+     * @brief Read-only memory mapping of a capture file
+     */
+    class mapped_file
+    {
+      public:
+        explicit mapped_file(const std::string &path);
+        ~mapped_file();
+        mapped_file(const mapped_file &)            = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        const uint8_t *
+        data () const
+        {
+            return data_;
+        }
+
+        size_t
+        size () const
+        {
+            return size_;
+        }
+
+      private:
+        const uint8_t *data_ = nullptr;
+        size_t         size_ = 0;
+    };
+} // namespace log_decoder
+
+#endif // LOG_DECODER_HPP
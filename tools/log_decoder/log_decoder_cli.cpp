@@ -0,0 +1,191 @@
+/**
+ * @file            log_decoder_cli.cpp
+ * @brief           Command line front-end of the session capture decoder
+ *
+ * @par
+ * Copyright 2025 (C) RobotPatient Simulators
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of the Manikin Software Libraries V3 project
+ *
+ * Author:          Victor Hogeweij
+ */
+
+#include "log_decoder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t synthetic_capture_len = 256u * 1024u * 1024u;
+
+    void
+    print_usage (const char *prog)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [-j threads] capture...\n"
+                     "       %s --bench [-j max_threads] [capture]\n"
+                     "Decodes packet_parser session captures into per-sensor sample columns.\n"
+                     "Without a capture, --bench generates a synthetic one.\n",
+                     prog,
+                     prog);
+    }
+
+    double
+    seconds_since (std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void
+    decode_capture (const std::string &path, unsigned thread_cnt)
+    {
+        const log_decoder::mapped_file capture(path);
+        const auto                     start = std::chrono::steady_clock::now();
+        const log_decoder::scan_result scan
+            = log_decoder::scan_frames(capture.data(), capture.size(), thread_cnt);
+        const log_decoder::decode_result decoded
+            = log_decoder::decode_batches(capture.data(), scan.frames, thread_cnt);
+        const double elapsed = seconds_since(start);
+
+        std::printf("%s: %zu bytes, %zu frames, %zu crc rejects, %zu undecodable, "
+                    "%zu length mismatches\n",
+                    path.c_str(),
+                    capture.size(),
+                    scan.frames.size(),
+                    scan.crc_rejects,
+                    decoded.undecodable_frames,
+                    decoded.length_mismatches);
+        for (const auto &[sensor_id, columns] : decoded.sensors)
+        {
+            std::printf("  sensor 0x%02X: %zu samples of %u bytes, ticks %u..%u\n",
+                        sensor_id,
+                        columns.count(),
+                        columns.sample_len,
+                        columns.ticks.front(),
+                        columns.ticks.back());
+        }
+        std::printf("  %.3f s, %.2f GB/s\n",
+                    elapsed,
+                    static_cast<double>(capture.size()) / elapsed / 1e9);
+    }
+
+    void
+    bench (const uint8_t *data, size_t len, unsigned max_threads)
+    {
+        const auto reference_start = std::chrono::steady_clock::now();
+        const log_decoder::scan_result reference = log_decoder::scan_frames_sequential(data, len);
+        const double reference_time = seconds_since(reference_start);
+        std::printf("%zu bytes, %zu frames\n", len, reference.frames.size());
+        std::printf("sequential scan: %.2f GB/s\n",
+                    static_cast<double>(len) / reference_time / 1e9);
+
+        for (unsigned thread_cnt = 1; thread_cnt <= max_threads; thread_cnt *= 2)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const log_decoder::scan_result scan = log_decoder::scan_frames(data, len, thread_cnt);
+            const double scan_time = seconds_since(start);
+            const log_decoder::decode_result decoded
+                = log_decoder::decode_batches(data, scan.frames, thread_cnt);
+            const double total_time = seconds_since(start);
+
+            size_t sample_cnt = 0;
+            for (const auto &entry : decoded.sensors)
+            {
+                sample_cnt += entry.second.count();
+            }
+            std::printf("%2u threads: scan %.2f GB/s, scan+decode %.2f GB/s, %zu samples%s\n",
+                        thread_cnt,
+                        static_cast<double>(len) / scan_time / 1e9,
+                        static_cast<double>(len) / total_time / 1e9,
+                        sample_cnt,
+                        scan.frames.size() == reference.frames.size() ? "" : " (MISMATCH)");
+        }
+    }
+} // namespace
+
+int
+main (int argc, char **argv)
+{
+    unsigned                 thread_cnt = 0;
+    bool                     bench_mode = false;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            thread_cnt = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--bench") == 0)
+        {
+            bench_mode = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            paths.emplace_back(argv[i]);
+        }
+    }
+    if (thread_cnt == 0)
+    {
+        thread_cnt = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    try
+    {
+        if (bench_mode)
+        {
+            if (paths.empty())
+            {
+                const std::vector<uint8_t> capture
+                    = log_decoder::synthesize_capture(synthetic_capture_len, 100, 1);
+                bench(capture.data(), capture.size(), thread_cnt);
+            }
+            else
+            {
+                const log_decoder::mapped_file capture(paths.front());
+                bench(capture.data(), capture.size(), thread_cnt);
+            }
+            return EXIT_SUCCESS;
+        }
+        if (paths.empty())
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        for (const std::string &path : paths)
+        {
+            decode_capture(path, thread_cnt);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}